@@ -3,9 +3,9 @@
 layout(location = 0) out vec4 outputColor;
 
 smooth in vec2 ioVertexTexCoord;
+smooth in vec4 ioVertexColor;
 
 uniform sampler2D sampler;
-uniform vec4 color;
 
 void main()
 {
@@ -15,5 +15,5 @@ void main()
 		discard;
 	}
 
-	outputColor = texel * color;
+	outputColor = texel * ioVertexColor;
 }
@@ -1,16 +1,17 @@
 #version 330 core
 
-uniform mat4 model;
 uniform mat4 projection;
 
-layout(location = 0) in vec2 vertexPosition; // Model space
-layout(location = 1) in vec2 vertexTexCoord; // Model space
+layout(location = 0) in vec2 vertexPosition; // Screen space
+layout(location = 1) in vec2 vertexTexCoord; // Atlas space
+layout(location = 2) in vec4 vertexColor;
 
 smooth out vec2 ioVertexTexCoord;
+smooth out vec4 ioVertexColor;
 
 void main()
 {
-	mat4 mvp = projection * model;
-	gl_Position = mvp * vec4(vertexPosition, 0.0, 1.0);
+	gl_Position = projection * vec4(vertexPosition, 0.0, 1.0);
 	ioVertexTexCoord = vertexTexCoord;
+	ioVertexColor = vertexColor;
 }
@@ -0,0 +1,21 @@
+#version 330 core
+
+layout(location = 0) out vec4 outputColor;
+
+smooth in vec2 ioVertexTexCoord;
+smooth in vec4 ioVertexColor;
+
+uniform sampler2D sampler;
+
+void main()
+{
+	// The outline sits at 0.5, the edge is smoothed over roughly one screen pixel at any scale
+	float distance = texture(sampler, ioVertexTexCoord).r;
+	float width = max(fwidth(distance), 1e-4) * 0.7;
+	float alpha = smoothstep(0.5 - width, 0.5 + width, distance);
+	if(alpha == 0) {
+		discard;
+	}
+
+	outputColor = vec4(ioVertexColor.rgb, ioVertexColor.a * alpha);
+}
@@ -3,7 +3,7 @@
 layout(location = 0) in vec3 vertexPosition; // Model space
 layout(location = 1) in vec2 vertexUV; // Model space
 layout(location = 2) in vec3 vertexNormal; // Model space
-layout(location = 3) in vec3 vertexTangent; // Model space
+layout(location = 3) in vec4 vertexTangent; // Model space, w = bitangent handedness
 layout(location = 4) in vec3 vertexBitangent; // Model space
 
 uniform mat4 model;
@@ -24,8 +24,11 @@ void main()
 
     if(useNormalMapping)
     {
-        vec3 T = normalize(vec3(model * vec4(vertexTangent, 0)));
-        vec3 B = normalize(vec3(model * vec4(vertexBitangent, 0)));
+        // Packed meshes have no bitangent stream (attribute defaults to zero), rebuild it from the handedness sign
+        vec3 bitangent = dot(vertexBitangent, vertexBitangent) > 0 ? vertexBitangent : cross(vertexNormal, vertexTangent.xyz) * vertexTangent.w;
+
+        vec3 T = normalize(vec3(model * vec4(vertexTangent.xyz, 0)));
+        vec3 B = normalize(vec3(model * vec4(bitangent, 0)));
         vec3 N = normalize(vec3(model * vec4(vertexNormal, 0)));
         TBN = mat3(T, B, N);
     }
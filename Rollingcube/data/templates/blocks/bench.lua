@@ -0,0 +1,47 @@
+openlib "blocks"
+openlib "tiles"
+
+-- Same work as the test block without console output, used by rollingcube_bench --
+
+---@type Tile
+MainTile = nil
+
+
+function OnInit()
+    MainTile = Theme.getTile("normal1")
+end
+
+
+---@param block Block
+function OnBlockConstruct(block)
+end
+
+
+---@param side BlockSide
+function OnBlockSideConstruct(side)
+end
+
+
+---@param block Block
+---@param cam Camera
+function OnRender(block, cam)
+end
+
+
+---@param side BlockSide
+---@param cam Camera
+function OnRenderSide(side, cam)
+    side:renderTile(cam, MainTile)
+end
+
+
+---@param block Block
+---@param elapsedTime number
+function OnUpdate(block, elapsedTime)
+end
+
+
+---@param side BlockSide
+---@param elapsedTime number
+function OnUpdateSide(side, elapsedTime)
+end
@@ -23,6 +23,7 @@ function include(path, fromRoot) end
 ---| '"models"'
 ---| '"balls"'
 ---| '"skyboxes"'
+---| '"tasks"'
 
 
 --- class vec2 ---
@@ -279,6 +280,128 @@ GL = {
 }
 
 
+--- namespace Profiler ---
+
+Profiler = {
+    ---Writes the last seconds of recorded frames as Chrome Trace Event JSON into user/traces, at the end of the current frame
+    ---@param seconds number|nil defaults to 10
+    dumpTrace = function(seconds) end,
+
+    ---Frames longer than the threshold dump a trace automatically, 0 disables it. A threshold turns trace recording on
+    ---@param milliseconds number
+    setHitchThreshold = function(milliseconds) end,
+
+    ---@return number
+    getHitchThreshold = function() end,
+
+    ---Off by default, dumpTrace turns it on when it was off instead of writing an empty trace
+    ---@param recording boolean
+    setTraceRecording = function(recording) end,
+
+    ---@return boolean
+    isTraceRecording = function() end,
+}
+
+
+--- namespace FrameStats ---
+
+FrameStats = {
+    ---Value of a counter in the last finished frame.
+    ---Counters: drawCalls, triangles, shaderBinds, textureBinds, uniformUploads, visibleBlocks, culledBlocks, luaCalls, luaGcCycles, uploadedBytes, updatedTransforms
+    ---@param counter string
+    ---@return number
+    get = function(counter) end,
+
+    ---Calls of a Lua hook (OnUpdate, OnRender, ...) in the last finished frame
+    ---@param hook string
+    ---@return number
+    getLuaHookCalls = function(hook) end,
+
+    ---Lua heap size in bytes at the end of the last finished frame
+    ---@return number
+    getLuaMemory = function() end,
+
+    ---@return number milliseconds
+    getFrameTime = function() end,
+
+    ---Min, average and max of a counter over the last frames
+    ---@param counter string
+    ---@param frames integer|nil defaults to the whole history (240 frames)
+    ---@return { min: number, avg: number, max: number }
+    getHistory = function(counter, frames) end,
+
+    ---@param frames integer|nil defaults to the whole history (240 frames)
+    ---@return { min: number, avg: number, max: number }
+    getFrameTimeHistory = function(frames) end,
+
+    ---Time from the start of the simulation to the end of the render of the last frame shown
+    ---@return number milliseconds
+    getLatency = function() end,
+
+    ---@param frames integer|nil defaults to the whole history (240 frames)
+    ---@return { min: number, avg: number, max: number }
+    getLatencyHistory = function(frames) end,
+
+    ---Present to present timing of the main window: last interval, its moving average, and the standard and worst
+    ---deviation of the intervals over the last 120 frames
+    ---@return { frame: number, smoothed: number, jitter: number, maxDeviation: number }
+    getPacing = function() end,
+
+    ---@param enabled boolean
+    setEnabled = function(enabled) end,
+
+    ---@return boolean
+    isEnabled = function() end,
+
+    ---@param visible boolean
+    setOverlayVisible = function(visible) end,
+
+    ---@return boolean
+    isOverlayVisible = function() end,
+}
+
+
+--- library tasks ---
+
+---Suspends the running task for the given simulation time. Only valid inside a task.
+---@param seconds number
+function wait(seconds) end
+
+---Suspends the running task for a number of simulation ticks, at least one. Only valid inside a task.
+---@param frames integer|nil defaults to 1
+function waitFrames(frames) end
+
+---Suspends the running task until predicate returns true. It is checked once per tick, from the next one on.
+---Only valid inside a task.
+---@param predicate fun(): boolean
+function waitUntil(predicate) end
+
+Tasks = {
+    ---Runs fn as a coroutine up to its first wait. Tasks live until they return, fail, are cancelled or the level
+    ---is cleared.
+    ---@param fn function
+    ---@param ... any arguments passed to fn
+    ---@return integer id
+    spawn = function(fn, ...) end,
+
+    ---A task cancelled while it runs stops at its next wait
+    ---@param id integer
+    ---@return boolean false when the task was already gone
+    cancel = function(id) end,
+
+    ---@param id integer
+    ---@return boolean
+    isAlive = function(id) end,
+
+    ---@return integer
+    getCount = function() end,
+
+    ---Simulation time the task clock has advanced since start
+    ---@return number seconds
+    getTime = function() end,
+}
+
+
 --- class Camera ---
 
 ---@class Camera
@@ -499,6 +622,7 @@ ShaderProgram = {
     ---@field freetypeFont ShaderProgram readonly
     ---@field sky ShaderProgram readonly
     ---@field lines ShaderProgram readonly
+    ---@field freetypeFontSdf ShaderProgram readonly
     defaults = {}
 }
 
@@ -808,6 +932,12 @@ Theme = {
     ---@return Texture
     getTexture = function(name) end,
 
+    ---static method
+    ---Loads the textures that are not loaded yet in one batch, returns how many were loaded
+    ---@param names string[]
+    ---@return integer
+    preloadTextures = function(names) end,
+
     ---static method
     ---@param name string
     ---@return CubeMapTexture
@@ -926,6 +1056,65 @@ Block = {
 }
 
 
+--- class BlockUpdateContext ---
+
+---Received by OnUpdate instead of the Block when the block template sets ParallelSafe = true.
+---Such templates are also loaded into one Lua state per job thread, where OnUpdate runs; OnInit and the
+---other hooks keep running on the main state. Each block always goes to the same worker state.
+---Only the geometry library can be opened there, openlib of any other library fails the worker load.
+---Values that leave the hook may only be nil, booleans, numbers or strings.
+---@class BlockUpdateContext
+---@field blockId integer readonly
+---@field slot vec3 readonly
+---@field position vec3
+---@field rotationAngles vec3
+---@field scalation vec3
+BlockUpdateContext = {
+    ---method
+    ---@param self BlockUpdateContext
+    ---@param sideId BlockSideId
+    ---@return vec3
+    getSidePosition = function(self, sideId) end,
+
+    ---method
+    ---@param self BlockUpdateContext
+    ---@param sideId BlockSideId
+    ---@return vec3
+    getSideNormal = function(self, sideId) end,
+
+    ---method, deferred until the parallel phase is over
+    ---@param self BlockUpdateContext
+    ---@param x integer
+    ---@param y integer
+    ---@param z integer
+    ---@param templateName string
+    createBlock = function(self, x, y, z, templateName) end,
+
+    ---method, deferred until the parallel phase is over
+    ---@param self BlockUpdateContext
+    removeBlock = function(self) end,
+
+    ---method, deferred until the parallel phase is over
+    ---@param self BlockUpdateContext
+    ---@param x integer
+    ---@param y integer
+    ---@param z integer
+    removeBlockAt = function(self, x, y, z) end,
+
+    ---method, deferred; sets the local value of the block on the main state
+    ---@param self BlockUpdateContext
+    ---@param name string
+    ---@param value nil|boolean|number|string
+    setLocalValue = function(self, name, value) end,
+
+    ---method, deferred; calls function(block, value) of the block template on the main state
+    ---@param self BlockUpdateContext
+    ---@param functionName string
+    ---@param value nil|boolean|number|string
+    callOnMain = function(self, functionName, value) end,
+}
+
+
 --- class ModelObjectRenderData ---
 
 ---@class ModelObjectRenderData
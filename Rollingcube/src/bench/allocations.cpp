@@ -0,0 +1,44 @@
+#include "allocations.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+
+namespace
+{
+	static constinit std::atomic<std::uint64_t> allocationCount = 0;
+	static constinit std::atomic<std::uint64_t> allocationBytes = 0;
+
+	static inline void* allocate(std::size_t size) noexcept
+	{
+		allocationCount.fetch_add(1, std::memory_order_relaxed);
+		allocationBytes.fetch_add(size, std::memory_order_relaxed);
+		return std::malloc(size > 0 ? size : 1);
+	}
+}
+
+bench::AllocationStats bench::getAllocationStats()
+{
+	return { allocationCount.load(std::memory_order_relaxed), allocationBytes.load(std::memory_order_relaxed) };
+}
+
+
+// Over-aligned allocations keep the default operators, they are rare enough to not matter here //
+void* operator new(std::size_t size)
+{
+	if (void* ptr = allocate(size))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) { return ::operator new(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+
+namespace bench
+{
+	struct AllocationStats
+	{
+		std::uint64_t count = 0;
+		std::uint64_t bytes = 0;
+
+		constexpr AllocationStats operator- (const AllocationStats& right) const { return { count - right.count, bytes - right.bytes }; }
+		constexpr AllocationStats& operator+= (const AllocationStats& right) { return count += right.count, bytes += right.bytes, *this; }
+	};
+
+	// Totals since startup, counted by the global operator new replacement that only the bench links //
+	AllocationStats getAllocationStats();
+}
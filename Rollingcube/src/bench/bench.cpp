@@ -0,0 +1,448 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <algorithm>
+#include <numeric>
+#include <charconv>
+#include <cmath>
+
+#include "core/gl_backend.h"
+#include "core/profiler.h"
+#include "core/trace_recorder.h"
+#include "engine/camera.h"
+#include "game/block.h"
+#include "game/theme.h"
+#include "game/properties.h"
+#include "game/luadefs.h"
+#include "utils/json.h"
+#include "utils/logger.h"
+
+#include "allocations.h"
+#include "job_scaling.h"
+#include "pipeline.h"
+#include "null_gl.h"
+
+
+namespace
+{
+	struct BenchOptions
+	{
+		std::vector<std::size_t> blockCounts = { 1000, 10000, 100000 };
+		std::size_t frames = 300;
+		std::size_t warmupFrames = 30;
+		std::string theme = "test_theme";
+		std::string blockTemplate = "bench";
+		bool recordCommands = false;
+		bool pipeline = false;
+		bool traceOverhead = false;
+		std::vector<std::size_t> jobThreads;
+		std::optional<Path> output;
+	};
+
+	struct PhaseSamples
+	{
+		std::vector<ProfileTimestamp> times;
+		bench::AllocationStats allocations;
+		std::uint64_t luaCalls = 0;
+		gl::BackendStats glStats;
+	};
+
+	// Snapshot of every counter a phase is measured with //
+	struct Counters
+	{
+		ProfileTimestamp time = 0;
+		bench::AllocationStats allocations;
+		std::uint64_t luaCalls = 0;
+		gl::BackendStats glStats;
+
+		static inline Counters now(const gl::NullBackend& backend)
+		{
+			return { Profiler::now(), bench::getAllocationStats(), LuaTemplate::getCallCount(), backend.getStats() };
+		}
+	};
+
+
+	static std::optional<std::size_t> parseCount(std::string_view text)
+	{
+		std::size_t value = 0;
+		auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+		if (result.ec != std::errc() || result.ptr != text.data() + text.size())
+			return std::nullopt;
+		return value;
+	}
+
+	static std::optional<std::vector<std::size_t>> parseCountList(std::string_view text)
+	{
+		std::vector<std::size_t> values;
+		for (std::size_t first = 0; first <= text.size();)
+		{
+			const std::size_t last = std::min(text.find(',', first), text.size());
+			auto count = parseCount(text.substr(first, last - first));
+			if (!count)
+				return std::nullopt;
+
+			values.push_back(*count);
+			first = last + 1;
+		}
+		return values;
+	}
+
+	static void printUsage()
+	{
+		std::cerr << "Usage: rollingcube_bench [--blocks 1000,10000,100000] [--frames 300] [--warmup 30]"
+			" [--theme test_theme] [--block bench] [--gl null|recording] [--job-threads 1,2,4,8] [--pipeline off|on] [--trace off|on] [--output file.json]\n";
+	}
+
+	static std::optional<BenchOptions> parseOptions(int argc, char** argv)
+	{
+		BenchOptions options;
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string_view arg = argv[i];
+			if (i + 1 >= argc)
+			{
+				logger::error("Missing value for bench option {}.", arg);
+				return std::nullopt;
+			}
+
+			const std::string_view value = argv[++i];
+			if (arg == "--blocks" || arg == "--job-threads")
+			{
+				auto counts = parseCountList(value);
+				if (!counts)
+				{
+					logger::error("Invalid count list {}.", value);
+					return std::nullopt;
+				}
+
+				(arg == "--blocks" ? options.blockCounts : options.jobThreads) = std::move(*counts);
+			}
+			else if (arg == "--frames" || arg == "--warmup")
+			{
+				auto count = parseCount(value);
+				if (!count)
+				{
+					logger::error("Invalid frame count {}.", value);
+					return std::nullopt;
+				}
+
+				(arg == "--frames" ? options.frames : options.warmupFrames) = *count;
+			}
+			else if (arg == "--theme")
+				options.theme = value;
+			else if (arg == "--block")
+				options.blockTemplate = value;
+			else if (arg == "--gl")
+			{
+				if (value != "null" && value != "recording")
+				{
+					logger::error("Unknown bench GL backend {}.", value);
+					return std::nullopt;
+				}
+				options.recordCommands = value == "recording";
+			}
+			else if (arg == "--pipeline")
+			{
+				if (value != "off" && value != "on")
+				{
+					logger::error("Invalid pipeline switch {}.", value);
+					return std::nullopt;
+				}
+				options.pipeline = value == "on";
+			}
+			else if (arg == "--trace")
+			{
+				if (value != "off" && value != "on")
+				{
+					logger::error("Invalid trace switch {}.", value);
+					return std::nullopt;
+				}
+				options.traceOverhead = value == "on";
+			}
+			else if (arg == "--output")
+				options.output = Path(value);
+			else
+			{
+				logger::error("Unknown bench option {}.", arg);
+				return std::nullopt;
+			}
+		}
+
+		if (options.frames == 0)
+		{
+			logger::error("At least one measured frame is required.");
+			return std::nullopt;
+		}
+
+		return options;
+	}
+
+
+	static JsonValue summarize(const PhaseSamples& samples)
+	{
+		std::vector<ProfileTimestamp> sorted = samples.times;
+		std::sort(sorted.begin(), sorted.end());
+
+		// Nearest rank, so every reported value is a frame that actually happened //
+		const auto percentile = [&sorted](double p) {
+			const std::size_t rank = static_cast<std::size_t>(std::ceil(p * double(sorted.size())));
+			return Profiler::toMilliseconds(sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1]);
+		};
+
+		const double frames = double(samples.times.size());
+		const ProfileTimestamp total = std::accumulate(sorted.begin(), sorted.end(), ProfileTimestamp(0));
+
+		return {
+			{ "p50Ms", percentile(0.50) },
+			{ "p90Ms", percentile(0.90) },
+			{ "p99Ms", percentile(0.99) },
+			{ "maxMs", Profiler::toMilliseconds(sorted.back()) },
+			{ "meanMs", Profiler::toMilliseconds(total) / frames },
+			{ "allocationsPerFrame", double(samples.allocations.count) / frames },
+			{ "allocatedBytesPerFrame", double(samples.allocations.bytes) / frames },
+			{ "luaCallsPerFrame", double(samples.luaCalls) / frames },
+			{ "glCallsPerFrame", double(samples.glStats.calls) / frames },
+			{ "drawCallsPerFrame", double(samples.glStats.drawCalls) / frames },
+			{ "verticesPerFrame", double(samples.glStats.vertices) / frames },
+			{ "uploadedBytesPerFrame", double(samples.glStats.uploadedBytes) / frames }
+		};
+	}
+
+	static void accumulate(PhaseSamples& samples, const Counters& begin, const Counters& end)
+	{
+		samples.times.push_back(end.time - begin.time);
+		samples.allocations += end.allocations - begin.allocations;
+		samples.luaCalls += end.luaCalls - begin.luaCalls;
+		samples.glStats.calls += end.glStats.calls - begin.glStats.calls;
+		samples.glStats.drawCalls += end.glStats.drawCalls - begin.glStats.drawCalls;
+		samples.glStats.vertices += end.glStats.vertices - begin.glStats.vertices;
+		samples.glStats.uploadedBytes += end.glStats.uploadedBytes - begin.glStats.uploadedBytes;
+	}
+
+
+	// Fills a cube of slots row by row, the last layer is left partially filled //
+	static std::size_t fillLevel(BlockContainer& container, std::size_t blockCount, const std::string& blockTemplate)
+	{
+		const int side = std::max(1, static_cast<int>(std::ceil(std::cbrt(double(blockCount)))));
+
+		std::size_t created = 0;
+		for (int y = 0; y < side && created < blockCount; ++y)
+			for (int z = 0; z < side && created < blockCount; ++z)
+				for (int x = 0; x < side && created < blockCount; ++x)
+				{
+					if (container.createBlock({ x, y, z }, blockTemplate) == nullptr)
+						return created;
+					++created;
+				}
+
+		return created;
+	}
+
+	// Looks at the level from one corner, so frustum culling drops part of it like in game //
+	static Camera makeCamera(std::size_t blockCount)
+	{
+		const float side = std::max(1.f, std::ceil(std::cbrt(float(blockCount))));
+		const glm::vec3 center = glm::vec3(side * 0.5f);
+
+		Camera cam;
+		cam.setToPerspective(glm::radians(45.f), 16.f / 9.f, 0.1f, side * 4.f);
+		cam.lookAt(center + glm::vec3(-side * 0.25f, side * 0.75f, -side * 0.25f), center + glm::vec3(side * 0.25f, 0, side * 0.25f), glm::vec3(0, 1, 0));
+		return cam;
+	}
+
+	// Whole frames, endFrame included: that is where the events are copied into the trace ring //
+	static PhaseSamples runProfiledFrames(BlockContainer& container, const Camera& cam, gl::NullBackend& backend, const BenchOptions& options, const Time& elapsedTime)
+	{
+		PhaseSamples samples;
+		samples.times.reserve(options.frames);
+
+		for (std::size_t i = 0; i < options.warmupFrames + options.frames; ++i)
+		{
+			if (options.recordCommands)
+				static_cast<gl::RecordingBackend&>(backend).clear();
+
+			const Counters frameBegin = Counters::now(backend);
+			Profiler::instance().beginFrame();
+			container.update(elapsedTime);
+			container.render(cam);
+			Profiler::instance().endFrame();
+			const Counters frameEnd = Counters::now(backend);
+
+			if (i >= options.warmupFrames)
+				accumulate(samples, frameBegin, frameEnd);
+		}
+
+		return samples;
+	}
+
+	static JsonValue measureTraceOverhead(BlockContainer& container, const Camera& cam, gl::NullBackend& backend, const BenchOptions& options, const Time& elapsedTime)
+	{
+		auto& recorder = TraceRecorder::instance();
+
+		const PhaseSamples off = runProfiledFrames(container, cam, backend, options, elapsedTime);
+		recorder.setRecording(true);
+		const PhaseSamples on = runProfiledFrames(container, cam, backend, options, elapsedTime);
+		const std::size_t recordedEvents = recorder.getEventCount();
+		recorder.setRecording(false);
+
+		JsonValue offReport = summarize(off);
+		JsonValue onReport = summarize(on);
+		const double offMs = offReport["p50Ms"].get<double>();
+		const double onMs = onReport["p50Ms"].get<double>();
+
+		return {
+			{ "recordingOff", std::move(offReport) },
+			{ "recordingOn", std::move(onReport) },
+			{ "recordedEvents", recordedEvents },
+			{ "p50OverheadMs", onMs - offMs },
+			{ "p50OverheadPercent", offMs > 0 ? (onMs - offMs) / offMs * 100.0 : 0.0 }
+		};
+	}
+
+	static JsonValue runLevel(const BenchOptions& options, gl::NullBackend& backend, std::size_t blockCount)
+	{
+		BlockContainer container;
+		const Camera cam = makeCamera(blockCount);
+		const Time elapsedTime = Time::seconds(1.0 / 60.0);
+
+		const Counters setupBegin = Counters::now(backend);
+		const std::size_t created = fillLevel(container, blockCount, options.blockTemplate);
+		const Counters setupEnd = Counters::now(backend);
+
+		if (created < blockCount)
+			logger::error("Only {} of {} blocks could be created from template {}.", created, blockCount, options.blockTemplate);
+
+		for (std::size_t i = 0; i < options.warmupFrames; ++i)
+		{
+			if (options.recordCommands)
+				static_cast<gl::RecordingBackend&>(backend).clear();
+
+			Profiler::instance().beginFrame();
+			container.update(elapsedTime);
+			container.render(cam);
+			Profiler::instance().endFrame();
+		}
+
+		PhaseSamples update, render, frame;
+		update.times.reserve(options.frames);
+		render.times.reserve(options.frames);
+		frame.times.reserve(options.frames);
+
+		for (std::size_t i = 0; i < options.frames; ++i)
+		{
+			// Only the last frame is kept, so the recording cost stays per frame //
+			if (options.recordCommands)
+				static_cast<gl::RecordingBackend&>(backend).clear();
+
+			Profiler::instance().beginFrame();
+
+			const Counters frameBegin = Counters::now(backend);
+			container.update(elapsedTime);
+			const Counters updateEnd = Counters::now(backend);
+			container.render(cam);
+			const Counters frameEnd = Counters::now(backend);
+
+			Profiler::instance().endFrame();
+
+			accumulate(update, frameBegin, updateEnd);
+			accumulate(render, updateEnd, frameEnd);
+			accumulate(frame, frameBegin, frameEnd);
+		}
+
+		const std::size_t recordedCommands = options.recordCommands ? static_cast<gl::RecordingBackend&>(backend).getCommands().size() : 0;
+
+		JsonValue report = {
+			{ "blocks", blockCount },
+			{ "createdBlocks", created },
+			{ "setup", {
+				{ "timeMs", Profiler::toMilliseconds(setupEnd.time - setupBegin.time) },
+				{ "allocations", (setupEnd.allocations - setupBegin.allocations).count },
+				{ "allocatedBytes", (setupEnd.allocations - setupBegin.allocations).bytes },
+				{ "luaCalls", setupEnd.luaCalls - setupBegin.luaCalls },
+				{ "glCalls", setupEnd.glStats.calls - setupBegin.glStats.calls },
+				{ "uploadedBytes", setupEnd.glStats.uploadedBytes - setupBegin.glStats.uploadedBytes }
+			} },
+			{ "update", summarize(update) },
+			{ "render", summarize(render) },
+			{ "frame", summarize(frame) },
+			{ "recordedCommandsLastFrame", recordedCommands }
+		};
+
+		if (options.pipeline)
+			report["pipeline"] = bench::runPipelineModes(container, cam, backend, options.recordCommands, options.warmupFrames, options.frames);
+
+		if (options.traceOverhead)
+			report["traceOverhead"] = measureTraceOverhead(container, cam, backend, options, elapsedTime);
+
+		return report;
+	}
+}
+
+
+// Runs the CPU side of the block update and render loop on synthetic levels, without a window or a GL context //
+int main(int argc, char** argv)
+{
+	auto options = parseOptions(argc, argv);
+	if (!options)
+	{
+		printUsage();
+		return 1;
+	}
+
+	// The engine wrappers go through the backend, null_gl only covers the GL calls made around them //
+	bench::null_gl::install();
+
+	gl::NullBackend nullBackend;
+	gl::RecordingBackend recordingBackend;
+	gl::NullBackend& backend = options->recordCommands ? recordingBackend : nullBackend;
+	gl::Backend::setCurrent(&backend);
+
+	Properties::load();
+	lua::initGameLibs();
+
+	if (!Theme::changeCurrentTheme(options->theme))
+	{
+		logger::error("Cannot load bench theme {}.", options->theme);
+		return 1;
+	}
+
+	JsonArray runs;
+	for (std::size_t blockCount : options->blockCounts)
+		runs.push_back(runLevel(*options, backend, blockCount));
+
+	JsonValue report = {
+		{ "theme", options->theme },
+		{ "blockTemplate", options->blockTemplate },
+		{ "gl", options->recordCommands ? "recording" : "null" },
+		{ "frames", options->frames },
+		{ "warmupFrames", options->warmupFrames },
+		{ "runs", std::move(runs) }
+	};
+
+	// Same entity count as the largest level, so the speedup reads against its update times //
+	if (!options->jobThreads.empty())
+	{
+		const std::size_t entities = *std::max_element(options->blockCounts.begin(), options->blockCounts.end());
+		report["jobScaling"] = bench::runJobScaling(options->jobThreads, entities, options->frames);
+	}
+
+	if (options->output)
+	{
+		std::ofstream os(*options->output);
+		if (!os)
+		{
+			logger::error("Cannot write bench report {}.", options->output->string());
+			return 1;
+		}
+		json::write(os, report);
+	}
+	else
+		json::write(std::cout, report);
+
+	Theme::releaseCurrentTheme();
+	gl::Backend::setCurrent(nullptr);
+	return 0;
+}
@@ -0,0 +1,90 @@
+#include "job_scaling.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "core/job_system.h"
+#include "core/profiler.h"
+#include "engine/basics.h"
+
+
+namespace
+{
+	static constexpr std::size_t GrainSize = 64;
+
+	struct SyntheticEntity
+	{
+		Transformable transform;
+		glm::vec3 boundsMin = {};
+		glm::vec3 boundsMax = {};
+	};
+
+	// The per block work BlockContainer::update hands to the jobs: a new model matrix and the world bounds of a unit cube //
+	static void updateEntity(SyntheticEntity& entity, float step)
+	{
+		entity.transform.rotate(step, step * 0.5f, 0);
+
+		const glm::mat4& model = entity.transform.getModelMatrix();
+		entity.boundsMin = glm::vec3(std::numeric_limits<float>::max());
+		entity.boundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+		for (int corner = 0; corner < 8; ++corner)
+		{
+			const glm::vec4 local = { corner & 1 ? 0.5f : -0.5f, corner & 2 ? 0.5f : -0.5f, corner & 4 ? 0.5f : -0.5f, 1.f };
+			const glm::vec3 world = model * local;
+			entity.boundsMin = glm::min(entity.boundsMin, world);
+			entity.boundsMax = glm::max(entity.boundsMax, world);
+		}
+	}
+
+	static double runFrames(std::size_t threadCount, std::vector<SyntheticEntity>& entities, std::size_t frames)
+	{
+		JobSystem jobs(threadCount > 0 ? threadCount - 1 : 0);
+
+		std::vector<ProfileTimestamp> times;
+		times.reserve(frames);
+		for (std::size_t frame = 0; frame < frames; ++frame)
+		{
+			const float step = 0.001f * float(frame % 100);
+			const ProfileTimestamp start = Profiler::now();
+			jobs.parallelFor(entities.size(), GrainSize, [&entities, step](std::size_t begin, std::size_t end) {
+				for (std::size_t i = begin; i < end; ++i)
+					updateEntity(entities[i], step);
+			});
+			times.push_back(Profiler::now() - start);
+		}
+
+		std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+		return Profiler::toMilliseconds(times[times.size() / 2]);
+	}
+}
+
+namespace bench
+{
+	JsonValue runJobScaling(const std::vector<std::size_t>& threadCounts, std::size_t entityCount, std::size_t frames)
+	{
+		std::vector<SyntheticEntity> entities(entityCount);
+		for (std::size_t i = 0; i < entityCount; ++i)
+			entities[i].transform.setPosition(float(i % 100), float(i / 100 % 100), float(i / 10000));
+
+		JsonArray runs;
+		double baseline = 0;
+		for (std::size_t threadCount : threadCounts)
+		{
+			const double median = runFrames(std::max<std::size_t>(threadCount, 1), entities, frames);
+			if (runs.empty())
+				baseline = median;
+
+			runs.push_back({
+				{ "threads", threadCount },
+				{ "medianMs", median },
+				{ "speedup", median > 0 ? baseline / median : 0.0 }
+			});
+		}
+
+		return {
+			{ "entities", entityCount },
+			{ "frames", frames },
+			{ "runs", std::move(runs) }
+		};
+	}
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <vector>
+
+#include "utils/json.h"
+
+
+namespace bench
+{
+	// Runs a synthetic transform and bounds update over entityCount entities with 1..N threads (one JobSystem per
+	// thread count) and reports the median frame time and the speedup over the first thread count //
+	JsonValue runJobScaling(const std::vector<std::size_t>& threadCounts, std::size_t entityCount, std::size_t frames);
+}
@@ -0,0 +1,157 @@
+#include "null_gl.h"
+
+#include <atomic>
+#include <type_traits>
+
+
+namespace
+{
+	static constinit std::atomic<GLuint> nextName = 1;
+
+	template <typename _Ty>
+	struct NullFunction;
+
+	template <typename _RetTy, typename... _ArgsTys>
+	struct NullFunction<_RetTy (GLAPIENTRY*)(_ArgsTys...)>
+	{
+		static _RetTy GLAPIENTRY invoke(_ArgsTys...)
+		{
+			if constexpr (!std::is_void_v<_RetTy>)
+				return _RetTy();
+		}
+	};
+
+	static void GLAPIENTRY genNames(GLsizei count, GLuint* names)
+	{
+		for (GLsizei i = 0; i < count; ++i)
+			names[i] = nextName.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	static GLuint GLAPIENTRY createShader(GLenum) { return nextName.fetch_add(1, std::memory_order_relaxed); }
+	static GLuint GLAPIENTRY createProgram() { return nextName.fetch_add(1, std::memory_order_relaxed); }
+
+	// Every compile and link succeeds with an empty info log //
+	static void GLAPIENTRY getObjectiv(GLuint, GLenum pname, GLint* params)
+	{
+		switch (pname)
+		{
+			case GL_COMPILE_STATUS:
+			case GL_LINK_STATUS:
+			case GL_VALIDATE_STATUS:
+				*params = GL_TRUE;
+				break;
+
+			default:
+				*params = 0;
+				break;
+		}
+	}
+
+	static void GLAPIENTRY getInfoLog(GLuint, GLsizei bufSize, GLsizei* length, GLchar* infoLog)
+	{
+		if (length)
+			*length = 0;
+		if (infoLog && bufSize > 0)
+			infoLog[0] = '\0';
+	}
+
+	static GLint GLAPIENTRY getUniformLocation(GLuint, const GLchar*) { return 0; }
+
+	static GLenum GLAPIENTRY checkFramebufferStatus(GLenum) { return GL_FRAMEBUFFER_COMPLETE; }
+
+	static void GLAPIENTRY getQueryObjectiv(GLuint, GLenum pname, GLint* params) { *params = pname == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0; }
+}
+
+#define NULL_GL_STUB(_Function) _Function = &NullFunction<decltype(_Function)>::invoke
+
+
+void bench::null_gl::install()
+{
+	glGenBuffers = &genNames;
+	glGenFramebuffers = &genNames;
+	glGenQueries = &genNames;
+	glGenRenderbuffers = &genNames;
+	glGenSamplers = &genNames;
+	glGenVertexArrays = &genNames;
+
+	glCreateShader = &createShader;
+	glCreateProgram = &createProgram;
+	glGetShaderiv = &getObjectiv;
+	glGetProgramiv = &getObjectiv;
+	glGetShaderInfoLog = &getInfoLog;
+	glGetProgramInfoLog = &getInfoLog;
+	glGetUniformLocation = &getUniformLocation;
+	glCheckFramebufferStatus = &checkFramebufferStatus;
+	glGetQueryObjectiv = &getQueryObjectiv;
+
+	NULL_GL_STUB(glActiveTexture);
+	NULL_GL_STUB(glAttachShader);
+	NULL_GL_STUB(glBindBuffer);
+	NULL_GL_STUB(glBindFramebuffer);
+	NULL_GL_STUB(glBindRenderbuffer);
+	NULL_GL_STUB(glBindSampler);
+	NULL_GL_STUB(glBindVertexArray);
+	NULL_GL_STUB(glBlitFramebuffer);
+	NULL_GL_STUB(glBufferData);
+	NULL_GL_STUB(glBufferSubData);
+	NULL_GL_STUB(glCompileShader);
+	NULL_GL_STUB(glDeleteBuffers);
+	NULL_GL_STUB(glDeleteFramebuffers);
+	NULL_GL_STUB(glDeleteProgram);
+	NULL_GL_STUB(glDeleteQueries);
+	NULL_GL_STUB(glDeleteRenderbuffers);
+	NULL_GL_STUB(glDeleteSamplers);
+	NULL_GL_STUB(glDeleteShader);
+	NULL_GL_STUB(glDeleteVertexArrays);
+	NULL_GL_STUB(glDetachShader);
+	NULL_GL_STUB(glDisableVertexAttribArray);
+	NULL_GL_STUB(glEnableVertexAttribArray);
+	NULL_GL_STUB(glFramebufferRenderbuffer);
+	NULL_GL_STUB(glFramebufferTexture2D);
+	NULL_GL_STUB(glGenerateMipmap);
+	NULL_GL_STUB(glGetFramebufferAttachmentParameteriv);
+	NULL_GL_STUB(glGetQueryObjectui64v);
+	NULL_GL_STUB(glGetRenderbufferParameteriv);
+	NULL_GL_STUB(glLinkProgram);
+	NULL_GL_STUB(glQueryCounter);
+	NULL_GL_STUB(glRenderbufferStorage);
+	NULL_GL_STUB(glSamplerParameteri);
+	NULL_GL_STUB(glShaderSource);
+	NULL_GL_STUB(glTextureParameteri);
+	NULL_GL_STUB(glUseProgram);
+	NULL_GL_STUB(glVertexAttribPointer);
+
+	NULL_GL_STUB(glUniform1f);
+	NULL_GL_STUB(glUniform1fv);
+	NULL_GL_STUB(glUniform1i);
+	NULL_GL_STUB(glUniform1iv);
+	NULL_GL_STUB(glUniform1ui);
+	NULL_GL_STUB(glUniform1uiv);
+	NULL_GL_STUB(glUniform2f);
+	NULL_GL_STUB(glUniform2fv);
+	NULL_GL_STUB(glUniform2i);
+	NULL_GL_STUB(glUniform2iv);
+	NULL_GL_STUB(glUniform2ui);
+	NULL_GL_STUB(glUniform2uiv);
+	NULL_GL_STUB(glUniform3f);
+	NULL_GL_STUB(glUniform3fv);
+	NULL_GL_STUB(glUniform3i);
+	NULL_GL_STUB(glUniform3iv);
+	NULL_GL_STUB(glUniform3ui);
+	NULL_GL_STUB(glUniform3uiv);
+	NULL_GL_STUB(glUniform4f);
+	NULL_GL_STUB(glUniform4fv);
+	NULL_GL_STUB(glUniform4i);
+	NULL_GL_STUB(glUniform4iv);
+	NULL_GL_STUB(glUniform4ui);
+	NULL_GL_STUB(glUniform4uiv);
+	NULL_GL_STUB(glUniformMatrix2fv);
+	NULL_GL_STUB(glUniformMatrix2x3fv);
+	NULL_GL_STUB(glUniformMatrix2x4fv);
+	NULL_GL_STUB(glUniformMatrix3fv);
+	NULL_GL_STUB(glUniformMatrix3x2fv);
+	NULL_GL_STUB(glUniformMatrix3x4fv);
+	NULL_GL_STUB(glUniformMatrix4fv);
+	NULL_GL_STUB(glUniformMatrix4x2fv);
+	NULL_GL_STUB(glUniformMatrix4x3fv);
+}
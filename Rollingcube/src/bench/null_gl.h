@@ -0,0 +1,11 @@
+#pragma once
+
+#include "core/gl.h"
+
+
+namespace bench::null_gl
+{
+	// Points every GLEW loaded entry point the engine uses at a stub, so the engine runs without a context.
+	// Core 1.1 functions are exported by the system GL library and are already no-ops without a current context //
+	void install();
+}
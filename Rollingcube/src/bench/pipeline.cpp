@@ -0,0 +1,100 @@
+#include "pipeline.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+
+#include "core/frame_pipeline.h"
+#include "core/profiler.h"
+#include "engine/render_snapshot.h"
+
+
+namespace
+{
+	static double percentile(std::vector<ProfileTimestamp>& times, double p)
+	{
+		std::sort(times.begin(), times.end());
+		const std::size_t rank = static_cast<std::size_t>(std::ceil(p * double(times.size())));
+		return Profiler::toMilliseconds(times[std::clamp<std::size_t>(rank, 1, times.size()) - 1]);
+	}
+
+	static JsonValue runMode(FramePipeline::Mode mode, BlockContainer& container, const Camera& cam, gl::NullBackend& backend,
+		bool recordCommands, std::size_t warmupFrames, std::size_t frames)
+	{
+		const Time elapsedTime = Time::seconds(1.0 / 60.0);
+		std::array<RenderSnapshot, FramePipeline::SlotCount> snapshots;
+		const bool pipelined = mode == FramePipeline::Mode::Pipelined;
+
+		// Same split as GameController: serial renders straight from the level, pipelined replays the captured snapshot //
+		FramePipeline pipeline(
+			[&](std::size_t slot) {
+				container.update(elapsedTime);
+				if (pipelined)
+				{
+					snapshots[slot].reset();
+					RenderCaptureScope capture(snapshots[slot]);
+					container.render(cam);
+				}
+			},
+			[&](std::size_t slot) {
+				if (pipelined)
+					snapshots[slot].render();
+				else
+					container.render(cam);
+			}
+		);
+		pipeline.setMode(mode);
+
+		std::vector<ProfileTimestamp> latencies, intervals, renders;
+		latencies.reserve(frames);
+		intervals.reserve(frames);
+		renders.reserve(frames);
+
+		for (std::size_t i = 0; i < warmupFrames + frames; ++i)
+		{
+			if (recordCommands)
+				static_cast<gl::RecordingBackend&>(backend).clear();
+
+			Profiler::instance().beginFrame();
+			pipeline.frame();
+			Profiler::instance().endFrame();
+
+			if (i >= warmupFrames)
+			{
+				latencies.push_back(pipeline.getTimes().latency);
+				intervals.push_back(pipeline.getTimes().interval);
+				renders.push_back(pipeline.getTimes().render);
+			}
+		}
+
+		pipeline.setMode(FramePipeline::Mode::Serial);
+
+		const double meanInterval = Profiler::toMilliseconds(std::accumulate(intervals.begin(), intervals.end(), ProfileTimestamp(0))) / double(frames);
+		return {
+			{ "latencyP50Ms", percentile(latencies, 0.50) },
+			{ "latencyP99Ms", percentile(latencies, 0.99) },
+			{ "intervalP50Ms", percentile(intervals, 0.50) },
+			{ "intervalMeanMs", meanInterval },
+			{ "framesPerSecond", meanInterval > 0 ? 1000.0 / meanInterval : 0.0 },
+			{ "renderP50Ms", percentile(renders, 0.50) },
+			{ "snapshotItems", pipelined ? snapshots[0].size() : 0 },
+			{ "snapshotArenaBytes", pipelined ? snapshots[0].getArena().getCapacityBytes() : 0 }
+		};
+	}
+}
+
+namespace bench
+{
+	JsonValue runPipelineModes(BlockContainer& container, const Camera& cam, gl::NullBackend& backend, bool recordCommands,
+		std::size_t warmupFrames, std::size_t frames)
+	{
+		if (frames == 0)
+			return {};
+
+		return {
+			{ "serial", runMode(FramePipeline::Mode::Serial, container, cam, backend, recordCommands, warmupFrames, frames) },
+			{ "pipelined", runMode(FramePipeline::Mode::Pipelined, container, cam, backend, recordCommands, warmupFrames, frames) }
+		};
+	}
+}
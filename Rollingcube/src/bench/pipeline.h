@@ -0,0 +1,15 @@
+#pragma once
+
+#include "core/gl_backend.h"
+#include "engine/camera.h"
+#include "game/block.h"
+#include "utils/json.h"
+
+
+namespace bench
+{
+	// Runs the level through a FramePipeline in serial and in pipelined mode and reports the latency from the start
+	// of a frame's update to the end of its render next to the frame interval, whose inverse is the throughput //
+	JsonValue runPipelineModes(BlockContainer& container, const Camera& cam, gl::NullBackend& backend, bool recordCommands,
+		std::size_t warmupFrames, std::size_t frames);
+}
@@ -0,0 +1,56 @@
+#include "fixed_timestep.h"
+
+
+FixedTimestep::FixedTimestep(unsigned int tickRate, unsigned int maxSubsteps)
+{
+	setTickRate(tickRate);
+	setMaxSubsteps(maxSubsteps);
+}
+
+unsigned int FixedTimestep::advance(Time elapsedTime)
+{
+	if (!isFixed())
+	{
+		_tickTime = elapsedTime;
+		++_tickCount;
+		return 1;
+	}
+
+	_accumulator += Time::max(elapsedTime, Time::zero());
+
+	const std::int64_t tickNanos = _tickTime.toNanoseconds();
+	std::int64_t ticks = _accumulator.toNanoseconds() / tickNanos;
+	if (ticks > std::int64_t(_maxSubsteps))
+	{
+		const Time dropped = Time::nanoseconds(tickNanos * (ticks - std::int64_t(_maxSubsteps)));
+		_droppedTime += dropped;
+		_accumulator -= dropped;
+		ticks = _maxSubsteps;
+	}
+
+	_accumulator -= Time::nanoseconds(tickNanos * ticks);
+	_tickCount += std::uint64_t(ticks);
+	return static_cast<unsigned int>(ticks);
+}
+
+float FixedTimestep::getAlpha() const
+{
+	if (!isFixed())
+		return 1.f;
+
+	return float(_accumulator.toNanoseconds()) / float(_tickTime.toNanoseconds());
+}
+
+void FixedTimestep::reset()
+{
+	_accumulator = Time::zero();
+	_droppedTime = Time::zero();
+	_tickCount = 0;
+}
+
+void FixedTimestep::setTickRate(unsigned int tickRate)
+{
+	_tickRate = tickRate;
+	_tickTime = tickRate > 0 ? Time::nanoseconds(1000000000 / std::int64_t(tickRate)) : Time::zero();
+	_accumulator = Time::zero();
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+
+#include "time.h"
+
+
+/*
+	Accumulator for fixed step simulation: every frame adds its elapsed time and advance() says how many ticks of
+	getTickTime() fit in it. At most maxSubsteps ticks run per frame, the time beyond them is dropped so a slow frame
+	cannot snowball into slower ones. A tick rate of 0 disables the fixed step, one tick then covers the whole frame.
+*/
+class FixedTimestep
+{
+public:
+	static constexpr unsigned int DefaultTickRate = 120;
+	static constexpr unsigned int DefaultMaxSubsteps = 8;
+
+private:
+	unsigned int _tickRate = 0;
+	unsigned int _maxSubsteps = DefaultMaxSubsteps;
+	Time _tickTime = {};
+	Time _accumulator = {};
+	Time _droppedTime = {};
+	std::uint64_t _tickCount = 0;
+
+public:
+	explicit FixedTimestep(unsigned int tickRate = DefaultTickRate, unsigned int maxSubsteps = DefaultMaxSubsteps);
+	FixedTimestep(const FixedTimestep&) = default;
+	FixedTimestep(FixedTimestep&&) noexcept = default;
+	~FixedTimestep() = default;
+
+	FixedTimestep& operator= (const FixedTimestep&) = default;
+	FixedTimestep& operator= (FixedTimestep&&) noexcept = default;
+
+public:
+	// Returns the ticks to run this frame, each one of getTickTime() //
+	unsigned int advance(Time elapsedTime);
+
+	// Fraction of a tick left in the accumulator, how far render is between the last two ticks //
+	float getAlpha() const;
+
+	void reset();
+
+	void setTickRate(unsigned int tickRate);
+	constexpr unsigned int getTickRate() const { return _tickRate; }
+	constexpr bool isFixed() const { return _tickRate > 0; }
+
+	constexpr void setMaxSubsteps(unsigned int maxSubsteps) { _maxSubsteps = maxSubsteps > 0 ? maxSubsteps : 1; }
+	constexpr unsigned int getMaxSubsteps() const { return _maxSubsteps; }
+
+	constexpr Time getTickTime() const { return _tickTime; }
+	constexpr Time getDroppedTime() const { return _droppedTime; }
+	constexpr std::uint64_t getTickCount() const { return _tickCount; }
+};
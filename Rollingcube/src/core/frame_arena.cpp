@@ -0,0 +1,69 @@
+#include "frame_arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+
+FrameArena::FrameArena(std::size_t blockSize) :
+	_blocks(),
+	_blockSize(std::max<std::size_t>(blockSize, 1))
+{}
+
+void FrameArena::reset()
+{
+	if (_blocks.size() > 1)
+	{
+		const std::size_t capacity = getCapacityBytes();
+		_blocks.clear();
+		addBlock(capacity);
+	}
+
+	_currentBlock = 0;
+	_offset = 0;
+	_usedBytes = 0;
+}
+
+std::size_t FrameArena::getCapacityBytes() const
+{
+	std::size_t capacity = 0;
+	for (const auto& block : _blocks)
+		capacity += block.size;
+	return capacity;
+}
+
+void* FrameArena::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+	while (true)
+	{
+		if (_currentBlock < _blocks.size())
+		{
+			Block& block = _blocks[_currentBlock];
+			const std::uintptr_t base = reinterpret_cast<std::uintptr_t>(block.data.get());
+			const std::uintptr_t aligned = (base + _offset + alignment - 1) & ~std::uintptr_t(alignment - 1);
+			const std::size_t end = std::size_t(aligned - base) + bytes;
+			if (end <= block.size)
+			{
+				_usedBytes += end - _offset;
+				_offset = end;
+				return reinterpret_cast<void*>(aligned);
+			}
+
+			if (_currentBlock + 1 < _blocks.size())
+			{
+				++_currentBlock;
+				_offset = 0;
+				continue;
+			}
+		}
+
+		// Grows geometrically, so a big frame only needs a few blocks until the next reset merges them //
+		addBlock(std::max({ _blockSize, bytes + alignment, _blocks.empty() ? 0 : _blocks.back().size * 2 }));
+		_currentBlock = _blocks.size() - 1;
+		_offset = 0;
+	}
+}
+
+void FrameArena::addBlock(std::size_t minSize)
+{
+	_blocks.push_back({ std::make_unique_for_overwrite<std::byte[]>(minSize), minSize });
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+
+/*
+	Bump allocator for data that lives for one frame. Deallocation does nothing, reset() rewinds the whole arena at
+	once and keeps its memory, so a frame that fits in the previous ones never reaches the heap.
+*/
+class FrameArena : public std::pmr::memory_resource
+{
+public:
+	static constexpr std::size_t DefaultBlockSize = 64 * 1024;
+
+private:
+	struct Block
+	{
+		std::unique_ptr<std::byte[]> data;
+		std::size_t size = 0;
+	};
+
+private:
+	std::vector<Block> _blocks;
+	std::size_t _blockSize;
+	std::size_t _currentBlock = 0;
+	std::size_t _offset = 0;
+	std::size_t _usedBytes = 0;
+
+public:
+	explicit FrameArena(std::size_t blockSize = DefaultBlockSize);
+	FrameArena(const FrameArena&) = delete;
+	FrameArena(FrameArena&&) noexcept = delete;
+	~FrameArena() override = default;
+
+	FrameArena& operator= (const FrameArena&) = delete;
+	FrameArena& operator= (FrameArena&&) noexcept = delete;
+
+public:
+	// Everything allocated so far becomes invalid. A frame that overflowed into several blocks leaves a single
+	// block as big as all of them, so the next one allocates linearly again //
+	void reset();
+
+	inline std::size_t getUsedBytes() const { return _usedBytes; }
+	std::size_t getCapacityBytes() const;
+
+protected:
+	void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+	inline void do_deallocate(void*, std::size_t, std::size_t) override {}
+	inline bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+	void addBlock(std::size_t minSize);
+};
@@ -0,0 +1,149 @@
+#include "frame_pacer.h"
+
+#include <thread>
+#include <cmath>
+#include <algorithm>
+
+#ifdef _WIN32
+#	define WIN32_LEAN_AND_MEAN
+#	define NOMINMAX
+#	include <Windows.h>
+#	include <timeapi.h>
+#endif
+
+
+FramePacer::~FramePacer()
+{
+	setTimerResolutionRaised(false);
+}
+
+void FramePacer::setTargetFps(double fps)
+{
+	_targetFps = fps > 0 ? fps : 0;
+	_period = _targetFps > 0 ? static_cast<ProfileTimestamp>(1000000000.0 / _targetFps) : 0;
+	_nextFrame = 0;
+
+	// Only while capped, a raised resolution costs power system wide //
+	setTimerResolutionRaised(_period > 0);
+}
+
+void FramePacer::setVSync(VSyncMode mode)
+{
+	_vsync = mode;
+	switch (mode)
+	{
+		case VSyncMode::Off:
+			glfwSwapInterval(0);
+			break;
+
+		case VSyncMode::On:
+			glfwSwapInterval(1);
+			break;
+
+		case VSyncMode::Adaptive:
+			glfwSwapInterval(glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear") ? -1 : 1);
+			break;
+	}
+}
+
+void FramePacer::wait()
+{
+	if (_period == 0)
+		return;
+
+	ProfileTimestamp now = Profiler::now();
+
+	// A frame that ran late starts a new schedule, the ones after it must not hurry to catch up //
+	if (_nextFrame == 0 || now > _nextFrame + _period)
+	{
+		_nextFrame = now + _period;
+		return;
+	}
+
+	PROFILE_SCOPE_CATEGORY("FramePacer::wait", ProfileCategory::Wait);
+
+	while (now < _nextFrame && _nextFrame - now > _sleepOvershoot + SpinMargin)
+	{
+		std::this_thread::sleep_for(std::chrono::nanoseconds(SleepQuantum));
+
+		// Quick to grow and slow to shrink, one short sleep does not make the next one short too //
+		const ProfileTimestamp slept = Profiler::now() - now;
+		_sleepOvershoot = slept > _sleepOvershoot ? slept : _sleepOvershoot - (_sleepOvershoot - slept) / 16;
+
+		now = Profiler::now();
+	}
+
+	// Its own scope, so the profiler shows how much of the wait burns a core //
+	{
+		PROFILE_SCOPE_CATEGORY("FramePacer::spin", ProfileCategory::Wait);
+		while (now < _nextFrame)
+		{
+			std::this_thread::yield();
+			now = Profiler::now();
+		}
+	}
+
+	_nextFrame += _period;
+}
+
+void FramePacer::setTimerResolutionRaised(bool raised)
+{
+	if (raised == _timerResolutionRaised)
+		return;
+
+#ifdef _WIN32
+	if ((raised ? timeBeginPeriod(1) : timeEndPeriod(1)) != TIMERR_NOERROR)
+		return;
+#endif
+
+	_timerResolutionRaised = raised;
+
+	// Learned at the old resolution, it would take many frames to shrink back //
+	_sleepOvershoot = SleepQuantum;
+}
+
+void FramePacer::presented()
+{
+	const ProfileTimestamp now = Profiler::now();
+	if (_lastPresent != 0)
+		updateStats(Profiler::toMilliseconds(now - _lastPresent));
+	_lastPresent = now;
+}
+
+Time FramePacer::smooth(Time elapsedTime) const
+{
+	const std::int64_t smoothed = _smoothedNanos.load(std::memory_order_relaxed);
+	if (!_smoothing || smoothed <= 0)
+		return elapsedTime;
+
+	return Time::nanoseconds(smoothed);
+}
+
+void FramePacer::updateStats(double intervalMilliseconds)
+{
+	_stats.frameMilliseconds = intervalMilliseconds;
+	_stats.smoothedMilliseconds = _intervalCount == 0
+		? intervalMilliseconds
+		: _stats.smoothedMilliseconds + (intervalMilliseconds - _stats.smoothedMilliseconds) * SmoothingFactor;
+	_smoothedNanos.store(static_cast<std::int64_t>(_stats.smoothedMilliseconds * 1000000.0), std::memory_order_relaxed);
+
+	_intervals[_intervalNext] = intervalMilliseconds;
+	_intervalNext = (_intervalNext + 1) % JitterWindow;
+	_intervalCount = std::min(_intervalCount + 1, JitterWindow);
+
+	double mean = 0;
+	for (std::size_t i = 0; i < _intervalCount; ++i)
+		mean += _intervals[i];
+	mean /= double(_intervalCount);
+
+	double variance = 0, maxDeviation = 0;
+	for (std::size_t i = 0; i < _intervalCount; ++i)
+	{
+		const double deviation = _intervals[i] - mean;
+		variance += deviation * deviation;
+		maxDeviation = std::max(maxDeviation, std::abs(deviation));
+	}
+
+	_stats.jitterMilliseconds = std::sqrt(variance / double(_intervalCount));
+	_stats.maxDeviationMilliseconds = maxDeviation;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <array>
+#include <atomic>
+
+#include "gl.h"
+#include "time.h"
+#include "profiler.h"
+
+
+enum class VSyncMode
+{
+	Off = 0,
+	On = 1,
+	Adaptive = -1 // Tears instead of waiting a whole refresh when a frame is late, plain vsync where unsupported
+};
+
+
+struct FramePacerStats
+{
+	double frameMilliseconds = 0; // Last present to present interval
+	double smoothedMilliseconds = 0;
+	double jitterMilliseconds = 0; // Standard deviation of the intervals over the recent window
+	double maxDeviationMilliseconds = 0; // Worst distance of an interval in the window from their mean
+};
+
+
+/*
+	Caps the frame rate and measures how evenly frames are presented. wait() is called right before the buffer swap:
+	it sleeps while the next frame slot is clearly ahead and spins the rest, since sleeps overshoot by a platform
+	dependent amount that is learned from the sleeps themselves. While a cap is set the system timer resolution is
+	raised to 1 ms, Windows wakes sleeps every 15.6 ms otherwise. presented() is called after the swap.
+*/
+class FramePacer
+{
+public:
+	static constexpr std::size_t JitterWindow = 120;
+	static constexpr double SmoothingFactor = 0.1;
+
+private:
+	static constexpr ProfileTimestamp SleepQuantum = 1000000; // 1 ms
+	static constexpr ProfileTimestamp SpinMargin = 200000; // 0.2 ms
+
+private:
+	double _targetFps = 0;
+	ProfileTimestamp _period = 0;
+	ProfileTimestamp _nextFrame = 0;
+	ProfileTimestamp _sleepOvershoot = SleepQuantum;
+
+	VSyncMode _vsync = VSyncMode::Off;
+	bool _smoothing = false;
+	bool _timerResolutionRaised = false;
+
+	ProfileTimestamp _lastPresent = 0;
+	std::array<double, JitterWindow> _intervals = {};
+	std::size_t _intervalNext = 0;
+	std::size_t _intervalCount = 0;
+	FramePacerStats _stats = {};
+	std::atomic<std::int64_t> _smoothedNanos = 0; // Read by smooth() from the simulation thread in pipelined mode
+
+public:
+	FramePacer() = default;
+	FramePacer(const FramePacer&) = delete;
+	FramePacer(FramePacer&&) noexcept = delete;
+	~FramePacer();
+
+	FramePacer& operator= (const FramePacer&) = delete;
+	FramePacer& operator= (FramePacer&&) noexcept = delete;
+
+public:
+	// 0 leaves the frame rate uncapped //
+	void setTargetFps(double fps);
+	constexpr double getTargetFps() const { return _targetFps; }
+
+	// Needs the window context current //
+	void setVSync(VSyncMode mode);
+	constexpr VSyncMode getVSync() const { return _vsync; }
+
+	constexpr void setSmoothingEnabled(bool enabled) { _smoothing = enabled; }
+	constexpr bool isSmoothingEnabled() const { return _smoothing; }
+
+	void wait();
+	void presented();
+
+	// The smoothed present interval while smoothing is enabled, elapsedTime otherwise. Over many frames both add up
+	// to the same time, the smoothed one just spreads hitches over the following frames. Any thread //
+	Time smooth(Time elapsedTime) const;
+
+	constexpr const FramePacerStats& getStats() const { return _stats; }
+
+private:
+	void updateStats(double intervalMilliseconds);
+	void setTimerResolutionRaised(bool raised);
+};
@@ -0,0 +1,115 @@
+#include "frame_pipeline.h"
+
+
+FramePipeline::FramePipeline(StageFunction simulate, StageFunction render) :
+	_simulate(std::move(simulate)),
+	_render(std::move(render))
+{}
+
+FramePipeline::~FramePipeline()
+{
+	stopThread();
+}
+
+void FramePipeline::setMode(Mode mode)
+{
+	if (mode == _mode)
+		return;
+
+	_mode = mode;
+	if (mode == Mode::Pipelined)
+		startThread();
+	else
+		stopThread();
+}
+
+void FramePipeline::frame()
+{
+	ProfileTimestamp renderBegin = 0;
+	if (_mode == Mode::Serial)
+	{
+		simulate();
+		acquire();
+		renderBegin = Profiler::now();
+		_render(_readSlot);
+	}
+	else
+	{
+		// The first frame has nothing to overlap with //
+		if (!_primed)
+		{
+			_simStart.release();
+			_simDone.acquire();
+			_primed = true;
+		}
+
+		acquire();
+		_simStart.release();
+
+		renderBegin = Profiler::now();
+		_render(_readSlot);
+
+		PROFILE_SCOPE_CATEGORY("FramePipeline::waitSimulation", ProfileCategory::Wait);
+		_simDone.acquire();
+	}
+
+	const ProfileTimestamp end = Profiler::now();
+	_times.simulate = _simulateTime[_readSlot];
+	_times.render = end - renderBegin;
+	_times.latency = end - _simulateBegin[_readSlot];
+	_times.interval = _lastFrameEnd != 0 ? end - _lastFrameEnd : end - _simulateBegin[_readSlot];
+	_lastFrameEnd = end;
+}
+
+void FramePipeline::simulate()
+{
+	const ProfileTimestamp begin = Profiler::now();
+	_simulate(_writeSlot);
+	_simulateBegin[_writeSlot] = begin;
+	_simulateTime[_writeSlot] = Profiler::now() - begin;
+
+	// Publishes the slot and takes back the one the renderer left there //
+	_writeSlot = _readySlot.exchange(std::uint32_t(_writeSlot) | FreshBit, std::memory_order_acq_rel) & SlotMask;
+}
+
+void FramePipeline::acquire()
+{
+	if ((_readySlot.load(std::memory_order_relaxed) & FreshBit) != 0)
+		_readSlot = _readySlot.exchange(std::uint32_t(_readSlot), std::memory_order_acq_rel) & SlotMask;
+}
+
+void FramePipeline::startThread()
+{
+	_stop = false;
+	_primed = false;
+	_simThread = std::thread(&FramePipeline::threadLoop, this);
+}
+
+void FramePipeline::stopThread()
+{
+	if (!_simThread.joinable())
+		return;
+
+	_stop = true;
+	_simStart.release();
+	_simThread.join();
+
+	// frame() always leaves the thread idle, but its start signal may still be pending after the join //
+	_simStart.try_acquire();
+	_simDone.try_acquire();
+}
+
+void FramePipeline::threadLoop()
+{
+	Profiler::instance().setThreadName("Simulation");
+
+	while (true)
+	{
+		_simStart.acquire();
+		if (_stop)
+			break;
+
+		simulate();
+		_simDone.release();
+	}
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <array>
+#include <thread>
+#include <semaphore>
+#include <functional>
+
+#include "profiler.h"
+
+
+enum class FramePipelineMode
+{
+	Serial,
+	Pipelined
+};
+
+
+struct FramePipelineTimes
+{
+	ProfileTimestamp simulate = 0; // Simulation of the frame that was just rendered
+	ProfileTimestamp render = 0;
+	ProfileTimestamp latency = 0; // From the start of its simulation to the end of its render
+	ProfileTimestamp interval = 0; // Between the end of the previous frame and this one, the inverse of throughput
+};
+
+
+/*
+	Runs simulate(slot) and render(slot) once per frame over three slots of render state. Serial mode calls both in
+	turn on the calling thread. Pipelined mode simulates the next frame on its own thread while the calling thread
+	renders the last finished one: simulate fills the write slot, publishing swaps it with the ready slot, and the
+	renderer takes the ready slot when it starts a frame, so neither side ever touches the slot the other one owns.
+	frame() returns with the simulation thread idle, shared state may be touched between two calls.
+*/
+class FramePipeline
+{
+public:
+	using Mode = FramePipelineMode;
+	using Times = FramePipelineTimes;
+	using StageFunction = std::function<void(std::size_t slot)>;
+
+	static constexpr std::size_t SlotCount = 3;
+
+private:
+	static constexpr std::uint32_t SlotMask = 0x3;
+	static constexpr std::uint32_t FreshBit = 0x4;
+
+private:
+	StageFunction _simulate;
+	StageFunction _render;
+	Mode _mode = Mode::Serial;
+
+	std::thread _simThread;
+	std::binary_semaphore _simStart{ 0 };
+	std::binary_semaphore _simDone{ 0 };
+	std::atomic<bool> _stop = false;
+	bool _primed = false;
+
+	std::size_t _writeSlot = 0; // Simulation side
+	std::atomic<std::uint32_t> _readySlot = 1;
+	std::size_t _readSlot = 2; // Render side
+
+	std::array<ProfileTimestamp, SlotCount> _simulateBegin = {};
+	std::array<ProfileTimestamp, SlotCount> _simulateTime = {};
+	ProfileTimestamp _lastFrameEnd = 0;
+	Times _times = {};
+
+public:
+	FramePipeline(StageFunction simulate, StageFunction render);
+	FramePipeline(const FramePipeline&) = delete;
+	FramePipeline(FramePipeline&&) noexcept = delete;
+	~FramePipeline();
+
+	FramePipeline& operator= (const FramePipeline&) = delete;
+	FramePipeline& operator= (FramePipeline&&) noexcept = delete;
+
+public:
+	// Only between frames. Switching to serial joins the simulation thread, a frame simulated ahead is dropped //
+	void setMode(Mode mode);
+	constexpr Mode getMode() const { return _mode; }
+	constexpr bool isPipelined() const { return _mode == Mode::Pipelined; }
+
+	void frame();
+
+	constexpr const Times& getTimes() const { return _times; }
+
+private:
+	void simulate();
+	void acquire();
+
+	void startThread();
+	void stopThread();
+	void threadLoop();
+};
@@ -0,0 +1,250 @@
+#include "frame_stats.h"
+
+#include "window.h"
+
+#include "engine/lua/module.h"
+#include "utils/lualib_constants.h"
+
+
+FrameStats FrameStats::Instance;
+
+
+namespace
+{
+	static constexpr std::array<std::string_view, FrameStats::CounterCount> CounterNames = {
+		"drawCalls",
+		"triangles",
+		"shaderBinds",
+		"textureBinds",
+		"uniformUploads",
+		"visibleBlocks",
+		"culledBlocks",
+		"luaCalls",
+		"luaGcCycles",
+		"uploadedBytes",
+		"updatedTransforms"
+	};
+
+	static constexpr std::array<std::string_view, FrameStats::LuaHookCount> LuaHookNames = {
+		"OnInit",
+		"OnDestroy",
+		"OnLoad",
+		"OnConstruct",
+		"OnBlockConstruct",
+		"OnBlockSideConstruct",
+		"OnUpdate",
+		"OnUpdateSide",
+		"OnLevelPostUpdate",
+		"OnRender",
+		"OnRenderSide",
+		"OnRenderMesh",
+		"OnCollide",
+		"Task",
+		"Other"
+	};
+}
+
+std::string_view getFrameCounterName(FrameCounter counter)
+{
+	const std::size_t index = static_cast<std::size_t>(counter);
+	return index < CounterNames.size() ? CounterNames[index] : "<unknown-counter>";
+}
+
+std::optional<FrameCounter> findFrameCounter(std::string_view name)
+{
+	for (std::size_t i = 0; i < CounterNames.size(); ++i)
+		if (CounterNames[i] == name)
+			return static_cast<FrameCounter>(i);
+
+	return std::nullopt;
+}
+
+std::string_view getLuaHookName(LuaHook hook)
+{
+	const std::size_t index = static_cast<std::size_t>(hook);
+	return index < LuaHookNames.size() ? LuaHookNames[index] : "<unknown-hook>";
+}
+
+LuaHook findLuaHook(std::string_view name)
+{
+	for (std::size_t i = 0; i < LuaHookNames.size() - 1; ++i)
+		if (LuaHookNames[i] == name)
+			return static_cast<LuaHook>(i);
+
+	return LuaHook::Other;
+}
+
+
+
+
+void FrameStats::endFrame(double frameMilliseconds)
+{
+	auto& sample = _history[_historyNext];
+	for (std::size_t i = 0; i < CounterCount; ++i)
+		sample.counters[i] = _counters[i].exchange(0, std::memory_order_relaxed);
+	for (std::size_t i = 0; i < LuaHookCount; ++i)
+		sample.luaHookCalls[i] = _luaHookCalls[i].exchange(0, std::memory_order_relaxed);
+
+	lua_State* state = lua::state();
+	sample.luaMemoryBytes = state != nullptr
+		? std::uint64_t(lua_gc(state, LUA_GCCOUNT, 0)) * 1024 + std::uint64_t(lua_gc(state, LUA_GCCOUNTB, 0))
+		: 0;
+	sample.frameMilliseconds = frameMilliseconds;
+	sample.latencyMilliseconds = _latencyMilliseconds;
+
+	_historyNext = (_historyNext + 1) % HistoryCapacity;
+	_historySize = std::min(_historySize + 1, HistoryCapacity);
+}
+
+void FrameStats::clearHistory()
+{
+	_history = {};
+	_historyNext = 0;
+	_historySize = 0;
+}
+
+const FrameStatsSample& FrameStats::getSample(std::size_t age) const
+{
+	static constexpr FrameStatsSample Empty = {};
+	if (age >= _historySize)
+		return Empty;
+
+	return _history[(_historyNext + HistoryCapacity - 1 - age) % HistoryCapacity];
+}
+
+template <typename _Fn>
+FrameStatsSummary FrameStats::summarize(std::size_t frames, _Fn&& value) const
+{
+	frames = std::min(frames, _historySize);
+	if (frames == 0)
+		return {};
+
+	FrameStatsSummary summary = { value(getSample(0)), 0, value(getSample(0)) };
+	double total = 0;
+	for (std::size_t age = 0; age < frames; ++age)
+	{
+		const double current = value(getSample(age));
+		summary.min = std::min(summary.min, current);
+		summary.max = std::max(summary.max, current);
+		total += current;
+	}
+
+	summary.average = total / double(frames);
+	return summary;
+}
+
+FrameStatsSummary FrameStats::summarize(FrameCounter counter, std::size_t frames) const
+{
+	return summarize(frames, [counter](const FrameStatsSample& sample) { return double(sample.get(counter)); });
+}
+
+FrameStatsSummary FrameStats::summarizeFrameTime(std::size_t frames) const
+{
+	return summarize(frames, [](const FrameStatsSample& sample) { return sample.frameMilliseconds; });
+}
+
+FrameStatsSummary FrameStats::summarizeLatency(std::size_t frames) const
+{
+	return summarize(frames, [](const FrameStatsSample& sample) { return sample.latencyMilliseconds; });
+}
+
+
+
+
+namespace lua::lib
+{
+	namespace LUA_stats { static defineLuaLibraryConstructor(registerToLua, root, state); }
+
+	void registerStatsLibToLua()
+	{
+		LuaLibraryManager::instance().registerLibrary(
+			::lua::lib::names::stats,
+			&LUA_stats::registerToLua,
+			{}
+		);
+	}
+}
+
+namespace lua::lib::LUA_stats
+{
+	static std::optional<FrameCounter> toCounter(const std::string& name)
+	{
+		auto counter = findFrameCounter(name);
+		if (!counter)
+			logger::warn("Unknown frame counter {}.", name);
+		return counter;
+	}
+
+	static std::size_t toFrames(LuaRef frames)
+	{
+		return frames.isNumber() ? std::size_t(std::max(frames.cast<int>().value(), 0)) : FrameStats::HistoryCapacity;
+	}
+
+	static LuaRef toTable(const FrameStatsSummary& summary)
+	{
+		LuaRef table = lua::utils::newTableRef();
+		table["min"] = summary.min;
+		table["avg"] = summary.average;
+		table["max"] = summary.max;
+		return table;
+	}
+
+	static double get(const std::string& name)
+	{
+		auto counter = toCounter(name);
+		return counter ? double(FrameStats::instance().getSample().get(*counter)) : 0;
+	}
+
+	static double getLuaHookCalls(const std::string& hook) { return double(FrameStats::instance().getSample().get(findLuaHook(hook))); }
+	static double getLuaMemory() { return double(FrameStats::instance().getSample().luaMemoryBytes); }
+	static double getFrameTime() { return FrameStats::instance().getSample().frameMilliseconds; }
+	static double getLatency() { return FrameStats::instance().getSample().latencyMilliseconds; }
+
+	static LuaRef getPacing()
+	{
+		const FramePacerStats& pacing = window::getFramePacer().getStats();
+		LuaRef table = lua::utils::newTableRef();
+		table["frame"] = pacing.frameMilliseconds;
+		table["smoothed"] = pacing.smoothedMilliseconds;
+		table["jitter"] = pacing.jitterMilliseconds;
+		table["maxDeviation"] = pacing.maxDeviationMilliseconds;
+		return table;
+	}
+
+	static LuaRef getHistory(const std::string& name, LuaRef frames)
+	{
+		auto counter = toCounter(name);
+		return toTable(counter ? FrameStats::instance().summarize(*counter, toFrames(frames)) : FrameStatsSummary{});
+	}
+
+	static LuaRef getFrameTimeHistory(LuaRef frames) { return toTable(FrameStats::instance().summarizeFrameTime(toFrames(frames))); }
+	static LuaRef getLatencyHistory(LuaRef frames) { return toTable(FrameStats::instance().summarizeLatency(toFrames(frames))); }
+
+	static void setEnabled(bool enabled) { FrameStats::instance().setEnabled(enabled); }
+	static bool isEnabled() { return FrameStats::instance().isEnabled(); }
+
+	static void setOverlayVisible(bool visible) { FrameStats::instance().setOverlayVisible(visible); }
+	static bool isOverlayVisible() { return FrameStats::instance().isOverlayVisible(); }
+
+
+	static defineLuaLibraryConstructor(registerToLua, root, state)
+	{
+		root = root.beginNamespace("FrameStats")
+				.addFunction("get", &get)
+				.addFunction("getLuaHookCalls", &getLuaHookCalls)
+				.addFunction("getLuaMemory", &getLuaMemory)
+				.addFunction("getFrameTime", &getFrameTime)
+				.addFunction("getHistory", &getHistory)
+				.addFunction("getFrameTimeHistory", &getFrameTimeHistory)
+				.addFunction("getLatency", &getLatency)
+				.addFunction("getLatencyHistory", &getLatencyHistory)
+				.addFunction("getPacing", &getPacing)
+				.addFunction("setEnabled", &setEnabled)
+				.addFunction("isEnabled", &isEnabled)
+				.addFunction("setOverlayVisible", &setOverlayVisible)
+				.addFunction("isOverlayVisible", &isOverlayVisible)
+			.endNamespace();
+
+		return true;
+	}
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <array>
+#include <string_view>
+#include <optional>
+#include <algorithm>
+
+#include "gl.h"
+
+
+namespace lua::lib { void registerStatsLibToLua(); }
+
+
+enum class FrameCounter : std::uint8_t
+{
+	DrawCalls,
+	Triangles,
+	ShaderBinds,
+	TextureBinds,
+	UniformUploads,
+	VisibleBlocks,
+	CulledBlocks,
+	LuaCalls,
+	LuaGcCycles,
+	UploadedBytes,
+	UpdatedTransforms,
+
+	Count
+};
+
+enum class LuaHook : std::uint8_t
+{
+	OnInit,
+	OnDestroy,
+	OnLoad,
+	OnConstruct,
+	OnBlockConstruct,
+	OnBlockSideConstruct,
+	OnUpdate,
+	OnUpdateSide,
+	OnLevelPostUpdate,
+	OnRender,
+	OnRenderSide,
+	OnRenderMesh,
+	OnCollide,
+	Task,
+	Other,
+
+	Count
+};
+
+std::string_view getFrameCounterName(FrameCounter counter);
+std::optional<FrameCounter> findFrameCounter(std::string_view name);
+
+std::string_view getLuaHookName(LuaHook hook);
+LuaHook findLuaHook(std::string_view name); // Unknown names are counted as Other
+
+
+struct FrameStatsSample
+{
+	static constexpr std::size_t CounterCount = static_cast<std::size_t>(FrameCounter::Count);
+	static constexpr std::size_t LuaHookCount = static_cast<std::size_t>(LuaHook::Count);
+
+	std::array<std::uint64_t, CounterCount> counters = {};
+	std::array<std::uint64_t, LuaHookCount> luaHookCalls = {};
+	std::uint64_t luaMemoryBytes = 0;
+	double frameMilliseconds = 0;
+	double latencyMilliseconds = 0; // From the start of the simulation to the end of the render of the frame shown
+
+	constexpr std::uint64_t get(FrameCounter counter) const { return counters[static_cast<std::size_t>(counter)]; }
+	constexpr std::uint64_t get(LuaHook hook) const { return luaHookCalls[static_cast<std::size_t>(hook)]; }
+};
+
+struct FrameStatsSummary
+{
+	double min = 0;
+	double average = 0;
+	double max = 0;
+};
+
+
+// Counters are bumped with relaxed atomics from any thread, endFrame moves them into a rolling history
+// on the main thread. Only sums per frame are kept, so increments never wait on each other //
+class FrameStats
+{
+public:
+	static constexpr std::size_t CounterCount = FrameStatsSample::CounterCount;
+	static constexpr std::size_t LuaHookCount = FrameStatsSample::LuaHookCount;
+	static constexpr std::size_t HistoryCapacity = 240;
+
+private:
+	static FrameStats Instance;
+
+private:
+	std::atomic<bool> _enabled = true;
+	std::array<std::atomic<std::uint64_t>, CounterCount> _counters = {};
+	std::array<std::atomic<std::uint64_t>, LuaHookCount> _luaHookCalls = {};
+
+	std::array<FrameStatsSample, HistoryCapacity> _history = {};
+	std::size_t _historyNext = 0;
+	std::size_t _historySize = 0;
+
+	double _latencyMilliseconds = 0;
+
+	bool _overlayVisible = false;
+
+public:
+	FrameStats(const FrameStats&) = delete;
+	FrameStats(FrameStats&&) noexcept = delete;
+	~FrameStats() = default;
+
+	FrameStats& operator= (const FrameStats&) = delete;
+	FrameStats& operator= (FrameStats&&) noexcept = delete;
+
+private:
+	FrameStats() = default;
+
+public:
+	// Called once per frame on the main thread, Lua memory is sampled here //
+	void endFrame(double frameMilliseconds);
+
+	// Main thread, kept for the frame that ends next //
+	constexpr void setLatency(double milliseconds) { _latencyMilliseconds = milliseconds; }
+
+	void clearHistory();
+
+	// Age 0 is the last finished frame //
+	const FrameStatsSample& getSample(std::size_t age = 0) const;
+
+	FrameStatsSummary summarize(FrameCounter counter, std::size_t frames = HistoryCapacity) const;
+	FrameStatsSummary summarizeFrameTime(std::size_t frames = HistoryCapacity) const;
+	FrameStatsSummary summarizeLatency(std::size_t frames = HistoryCapacity) const;
+
+public:
+	inline bool isEnabled() const { return _enabled.load(std::memory_order_relaxed); }
+	inline void setEnabled(bool enabled) { _enabled.store(enabled, std::memory_order_relaxed); }
+
+	constexpr bool isOverlayVisible() const { return _overlayVisible; }
+	constexpr void setOverlayVisible(bool visible) { _overlayVisible = visible; }
+
+	constexpr std::size_t getHistorySize() const { return _historySize; }
+
+	inline void add(FrameCounter counter, std::uint64_t amount = 1)
+	{
+		if (isEnabled())
+			_counters[static_cast<std::size_t>(counter)].fetch_add(amount, std::memory_order_relaxed);
+	}
+
+	inline void addLuaCall(LuaHook hook)
+	{
+		if (isEnabled())
+		{
+			_counters[static_cast<std::size_t>(FrameCounter::LuaCalls)].fetch_add(1, std::memory_order_relaxed);
+			_luaHookCalls[static_cast<std::size_t>(hook)].fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	inline void addDraw(GLenum mode, GLsizei count)
+	{
+		if (!isEnabled())
+			return;
+
+		std::uint64_t triangles = 0;
+		switch (mode)
+		{
+			case GL_TRIANGLES: triangles = std::uint64_t(std::max(count, 0) / 3); break;
+			case GL_TRIANGLE_STRIP:
+			case GL_TRIANGLE_FAN: triangles = std::uint64_t(std::max(count - 2, 0)); break;
+		}
+
+		_counters[static_cast<std::size_t>(FrameCounter::DrawCalls)].fetch_add(1, std::memory_order_relaxed);
+		_counters[static_cast<std::size_t>(FrameCounter::Triangles)].fetch_add(triangles, std::memory_order_relaxed);
+	}
+
+public:
+	static constexpr FrameStats& instance() { return Instance; }
+
+private:
+	template <typename _Fn>
+	FrameStatsSummary summarize(std::size_t frames, _Fn&& value) const;
+};
@@ -10,6 +10,9 @@
 
 #include "engine/lua/module.h"
 #include "utils/lualib_constants.h"
+#include "profiler.h"
+#include "trace_recorder.h"
+#include "upload_queue.h"
 
 
 namespace gl
@@ -49,6 +52,12 @@ namespace gl
 
 	void terminate()
 	{
+		TraceRecorder::instance().uninstallLuaGcProbe();
+
+		// Pending completions may still hand their results to the managers cleared below //
+		UploadQueue::instance().stopUploadThread();
+		UploadQueue::instance().flush();
+
 		SkyboxTemplateManager::instance().clear();
 		BlockTemplateManager::instance().clear();
 		TileTemplateManager::instance().clear();
@@ -64,6 +73,7 @@ namespace gl
 		ShaderManager::fragment().clear();
 		ShaderManager::geometry().clear();
 		ShaderProgramManager::instance().clear();
+		Profiler::instance().releaseGpuResources();
 
 		glfwTerminate();
 	}
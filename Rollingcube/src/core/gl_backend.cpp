@@ -0,0 +1,439 @@
+#include "gl_backend.h"
+
+#include <algorithm>
+
+
+namespace
+{
+	static constinit gl::RealBackend DefaultBackend;
+}
+
+std::uint64_t gl::getPixelSize(GLenum format, GLenum type)
+{
+	std::uint64_t components = 4;
+	switch (format)
+	{
+		case GL_RED: case GL_GREEN: case GL_BLUE: case GL_ALPHA:
+		case GL_DEPTH_COMPONENT: case GL_STENCIL_INDEX:
+			components = 1;
+			break;
+
+		case GL_RG: case GL_DEPTH_STENCIL:
+			components = 2;
+			break;
+
+		case GL_RGB: case GL_BGR:
+			components = 3;
+			break;
+	}
+
+	switch (type)
+	{
+		case GL_UNSIGNED_BYTE: case GL_BYTE: return components;
+		case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT: return components * 2;
+		case GL_UNSIGNED_INT: case GL_INT: case GL_FLOAT: return components * 4;
+		default: return 4; // Packed formats
+	}
+}
+
+std::uint64_t gl::getImageSize(GLsizei width, GLsizei height, GLenum format, GLenum type)
+{
+	return std::uint64_t(std::max(width, 0)) * std::uint64_t(std::max(height, 0)) * getPixelSize(format, type);
+}
+
+gl::Backend* gl::Backend::Current = &DefaultBackend;
+
+void gl::Backend::setCurrent(Backend* backend)
+{
+	Current = backend != nullptr ? backend : &DefaultBackend;
+}
+
+
+
+
+namespace gl
+{
+	GLuint RealBackend::genBuffer() { GLuint buffer = 0; glGenBuffers(1, &buffer); return buffer; }
+	void RealBackend::deleteBuffer(GLuint buffer) { glDeleteBuffers(1, &buffer); }
+	void RealBackend::bindBuffer(GLenum target, GLuint buffer) { glBindBuffer(target, buffer); }
+	void RealBackend::bufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) { glBufferData(target, size, data, usage); }
+	void RealBackend::bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) { glBufferSubData(target, offset, size, data); }
+
+	GLuint RealBackend::genVertexArray() { GLuint vertexArray = 0; glGenVertexArrays(1, &vertexArray); return vertexArray; }
+	void RealBackend::deleteVertexArray(GLuint vertexArray) { glDeleteVertexArrays(1, &vertexArray); }
+	void RealBackend::bindVertexArray(GLuint vertexArray) { glBindVertexArray(vertexArray); }
+	void RealBackend::enableVertexAttribArray(GLuint index) { glEnableVertexAttribArray(index); }
+	void RealBackend::disableVertexAttribArray(GLuint index) { glDisableVertexAttribArray(index); }
+	void RealBackend::vertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, GLsizeiptr offset)
+	{
+		glVertexAttribPointer(index, size, type, normalized, stride, reinterpret_cast<void*>(offset));
+	}
+
+	void RealBackend::drawArrays(GLenum mode, GLint first, GLsizei count) { glDrawArrays(mode, first, count); }
+	void RealBackend::drawElements(GLenum mode, GLsizei count, GLenum type, GLsizeiptr offset) { glDrawElements(mode, count, type, reinterpret_cast<void*>(offset)); }
+
+	GLuint RealBackend::genTexture() { GLuint texture = 0; glGenTextures(1, &texture); return texture; }
+	void RealBackend::deleteTexture(GLuint texture) { glDeleteTextures(1, &texture); }
+	void RealBackend::bindTexture(GLenum target, GLuint texture) { glBindTexture(target, texture); }
+	void RealBackend::activeTexture(GLenum unit) { glActiveTexture(unit); }
+	void RealBackend::texImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* data)
+	{
+		glTexImage2D(target, level, internalFormat, width, height, 0, format, type, data);
+	}
+	void RealBackend::texSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* data)
+	{
+		glTexSubImage2D(target, level, x, y, width, height, format, type, data);
+	}
+	void RealBackend::getTexImage(GLenum target, GLint level, GLenum format, GLenum type, void* pixels) { glGetTexImage(target, level, format, type, pixels); }
+	void RealBackend::generateMipmap(GLenum target) { glGenerateMipmap(target); }
+	void RealBackend::texParameteri(GLenum target, GLenum pname, GLint param) { glTexParameteri(target, pname, param); }
+	void RealBackend::textureParameteri(GLuint texture, GLenum pname, GLint param) { glTextureParameteri(texture, pname, param); }
+	GLint RealBackend::getTexParameteri(GLenum target, GLenum pname) { GLint value = 0; glGetTexParameteriv(target, pname, &value); return value; }
+	void RealBackend::pixelStorei(GLenum pname, GLint param) { glPixelStorei(pname, param); }
+	GLint RealBackend::getInteger(GLenum pname) { GLint value = 0; glGetIntegerv(pname, &value); return value; }
+	std::string RealBackend::getString(GLenum name)
+	{
+		const GLubyte* value = glGetString(name);
+		return value != nullptr ? std::string(reinterpret_cast<const char*>(value)) : std::string();
+	}
+
+	GLuint RealBackend::createShader(GLenum type) { return glCreateShader(type); }
+	void RealBackend::shaderSource(GLuint shader, const GLchar* code) { glShaderSource(shader, 1, &code, nullptr); }
+	void RealBackend::compileShader(GLuint shader) { glCompileShader(shader); }
+	GLint RealBackend::getShaderi(GLuint shader, GLenum pname) { GLint value = 0; glGetShaderiv(shader, pname, &value); return value; }
+	std::string RealBackend::getShaderInfoLog(GLuint shader)
+	{
+		std::string log(std::size_t(std::max(getShaderi(shader, GL_INFO_LOG_LENGTH), 0)), '\0');
+		if (!log.empty())
+			glGetShaderInfoLog(shader, GLsizei(log.size()), nullptr, log.data());
+		return log;
+	}
+	void RealBackend::deleteShader(GLuint shader) { glDeleteShader(shader); }
+	void RealBackend::maxShaderCompilerThreads(GLuint count)
+	{
+		if (GLEW_KHR_parallel_shader_compile)
+			glMaxShaderCompilerThreadsKHR(count);
+		else if (GLEW_ARB_parallel_shader_compile)
+			glMaxShaderCompilerThreadsARB(count);
+	}
+
+	GLuint RealBackend::createProgram() { return glCreateProgram(); }
+	void RealBackend::attachShader(GLuint program, GLuint shader) { glAttachShader(program, shader); }
+	void RealBackend::linkProgram(GLuint program) { glLinkProgram(program); }
+	GLint RealBackend::getProgrami(GLuint program, GLenum pname) { GLint value = 0; glGetProgramiv(program, pname, &value); return value; }
+	std::string RealBackend::getProgramInfoLog(GLuint program)
+	{
+		std::string log(std::size_t(std::max(getProgrami(program, GL_INFO_LOG_LENGTH), 0)), '\0');
+		if (!log.empty())
+			glGetProgramInfoLog(program, GLsizei(log.size()), nullptr, log.data());
+		return log;
+	}
+	void RealBackend::programParameteri(GLuint program, GLenum pname, GLint value) { glProgramParameteri(program, pname, value); }
+	GLenum RealBackend::getProgramBinary(GLuint program, std::vector<std::uint8_t>& binary)
+	{
+		GLenum format = 0;
+		GLsizei length = 0;
+		binary.resize(std::size_t(std::max(getProgrami(program, GL_PROGRAM_BINARY_LENGTH), 0)));
+		if (!binary.empty())
+			glGetProgramBinary(program, GLsizei(binary.size()), &length, &format, binary.data());
+		binary.resize(std::size_t(length));
+		return format;
+	}
+	void RealBackend::programBinary(GLuint program, GLenum format, const void* binary, GLsizei length) { glProgramBinary(program, format, binary, length); }
+	void RealBackend::deleteProgram(GLuint program) { glDeleteProgram(program); }
+	void RealBackend::useProgram(GLuint program) { glUseProgram(program); }
+	GLint RealBackend::getUniformLocation(GLuint program, const GLchar* name) { return glGetUniformLocation(program, name); }
+
+	void RealBackend::uniform(GLint location, UniformType type, GLsizei count, const void* values)
+	{
+		const auto floats = static_cast<const GLfloat*>(values);
+		const auto ints = static_cast<const GLint*>(values);
+		const auto uints = static_cast<const GLuint*>(values);
+
+		switch (type)
+		{
+			case UniformType::Float: glUniform1fv(location, count, floats); break;
+			case UniformType::Float2: glUniform2fv(location, count, floats); break;
+			case UniformType::Float3: glUniform3fv(location, count, floats); break;
+			case UniformType::Float4: glUniform4fv(location, count, floats); break;
+			case UniformType::Int: glUniform1iv(location, count, ints); break;
+			case UniformType::Int2: glUniform2iv(location, count, ints); break;
+			case UniformType::Int3: glUniform3iv(location, count, ints); break;
+			case UniformType::Int4: glUniform4iv(location, count, ints); break;
+			case UniformType::UnsignedInt: glUniform1uiv(location, count, uints); break;
+			case UniformType::UnsignedInt2: glUniform2uiv(location, count, uints); break;
+			case UniformType::UnsignedInt3: glUniform3uiv(location, count, uints); break;
+			case UniformType::UnsignedInt4: glUniform4uiv(location, count, uints); break;
+			case UniformType::Matrix3: glUniformMatrix3fv(location, count, GL_FALSE, floats); break;
+			case UniformType::Matrix4: glUniformMatrix4fv(location, count, GL_FALSE, floats); break;
+		}
+	}
+
+	GLuint RealBackend::genFramebuffer() { GLuint framebuffer = 0; glGenFramebuffers(1, &framebuffer); return framebuffer; }
+	void RealBackend::deleteFramebuffer(GLuint framebuffer) { glDeleteFramebuffers(1, &framebuffer); }
+	void RealBackend::bindFramebuffer(GLenum target, GLuint framebuffer) { glBindFramebuffer(target, framebuffer); }
+	void RealBackend::framebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbufferTarget, GLuint renderbuffer)
+	{
+		glFramebufferRenderbuffer(target, attachment, renderbufferTarget, renderbuffer);
+	}
+	void RealBackend::framebufferTexture2D(GLenum target, GLenum attachment, GLenum textureTarget, GLuint texture, GLint level)
+	{
+		glFramebufferTexture2D(target, attachment, textureTarget, texture, level);
+	}
+	GLenum RealBackend::checkFramebufferStatus(GLenum target) { return glCheckFramebufferStatus(target); }
+	GLint RealBackend::getFramebufferAttachmentParameteri(GLenum target, GLenum attachment, GLenum pname)
+	{
+		GLint value = -1;
+		glGetFramebufferAttachmentParameteriv(target, attachment, pname, &value);
+		return value;
+	}
+	void RealBackend::blitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter)
+	{
+		glBlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+	}
+	void RealBackend::readPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels) { glReadPixels(x, y, width, height, format, type, pixels); }
+	void RealBackend::viewport(GLint x, GLint y, GLsizei width, GLsizei height) { glViewport(x, y, width, height); }
+
+	GLenum RealBackend::getError() { return glGetError(); }
+}
+
+
+
+
+namespace gl
+{
+	void NullBackend::command(BackendCommand command, std::initializer_list<std::int64_t> args, std::uint64_t uploadedBytes)
+	{
+		++_stats.calls;
+		_stats.uploadedBytes += uploadedBytes;
+		onCommand(command, args);
+	}
+
+	GLuint NullBackend::genBuffer() { const GLuint name = nextName(); command(BackendCommand::GenBuffer, { name }); return name; }
+	void NullBackend::deleteBuffer(GLuint buffer) { command(BackendCommand::DeleteBuffer, { buffer }); }
+	void NullBackend::bindBuffer(GLenum target, GLuint buffer) { command(BackendCommand::BindBuffer, { target, buffer }); }
+	void NullBackend::bufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+	{
+		command(BackendCommand::BufferData, { target, size, usage }, data != nullptr ? std::uint64_t(size) : 0);
+	}
+	void NullBackend::bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+	{
+		command(BackendCommand::BufferSubData, { target, offset, size }, std::uint64_t(size));
+	}
+
+	GLuint NullBackend::genVertexArray() { const GLuint name = nextName(); command(BackendCommand::GenVertexArray, { name }); return name; }
+	void NullBackend::deleteVertexArray(GLuint vertexArray) { command(BackendCommand::DeleteVertexArray, { vertexArray }); }
+	void NullBackend::bindVertexArray(GLuint vertexArray) { command(BackendCommand::BindVertexArray, { vertexArray }); }
+	void NullBackend::enableVertexAttribArray(GLuint index) { command(BackendCommand::EnableVertexAttribArray, { index }); }
+	void NullBackend::disableVertexAttribArray(GLuint index) { command(BackendCommand::DisableVertexAttribArray, { index }); }
+	void NullBackend::vertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, GLsizeiptr offset)
+	{
+		command(BackendCommand::VertexAttribPointer, { index, size, type, normalized, stride, offset });
+	}
+
+	void NullBackend::drawArrays(GLenum mode, GLint first, GLsizei count)
+	{
+		++_stats.drawCalls;
+		_stats.vertices += std::uint64_t(std::max(count, 0));
+		command(BackendCommand::DrawArrays, { mode, first, count });
+	}
+	void NullBackend::drawElements(GLenum mode, GLsizei count, GLenum type, GLsizeiptr offset)
+	{
+		++_stats.drawCalls;
+		_stats.vertices += std::uint64_t(std::max(count, 0));
+		command(BackendCommand::DrawElements, { mode, count, type, offset });
+	}
+
+	GLuint NullBackend::genTexture() { const GLuint name = nextName(); command(BackendCommand::GenTexture, { name }); return name; }
+	void NullBackend::deleteTexture(GLuint texture) { command(BackendCommand::DeleteTexture, { texture }); }
+	void NullBackend::bindTexture(GLenum target, GLuint texture) { command(BackendCommand::BindTexture, { target, texture }); }
+	void NullBackend::activeTexture(GLenum unit) { command(BackendCommand::ActiveTexture, { unit }); }
+	void NullBackend::texImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* data)
+	{
+		command(BackendCommand::TexImage2D, { target, level, internalFormat, width, height, format, type }, data != nullptr ? getImageSize(width, height, format, type) : 0);
+	}
+	void NullBackend::texSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* data)
+	{
+		command(BackendCommand::TexSubImage2D, { target, level, x, y, width, height, format, type }, data != nullptr ? getImageSize(width, height, format, type) : 0);
+	}
+	void NullBackend::getTexImage(GLenum target, GLint level, GLenum format, GLenum type, void*) { command(BackendCommand::GetTexImage, { target, level, format, type }); }
+	void NullBackend::generateMipmap(GLenum target) { command(BackendCommand::GenerateMipmap, { target }); }
+	void NullBackend::texParameteri(GLenum target, GLenum pname, GLint param) { command(BackendCommand::TexParameteri, { target, pname, param }); }
+	void NullBackend::textureParameteri(GLuint texture, GLenum pname, GLint param) { command(BackendCommand::TextureParameteri, { texture, pname, param }); }
+	GLint NullBackend::getTexParameteri(GLenum target, GLenum pname) { command(BackendCommand::GetTexParameteri, { target, pname }); return 0; }
+	void NullBackend::pixelStorei(GLenum pname, GLint param) { command(BackendCommand::PixelStorei, { pname, param }); }
+	GLint NullBackend::getInteger(GLenum pname)
+	{
+		command(BackendCommand::GetInteger, { pname });
+		return pname == GL_MAX_TEXTURE_IMAGE_UNITS ? 16 : 0;
+	}
+	std::string NullBackend::getString(GLenum name) { command(BackendCommand::GetString, { name }); return {}; }
+
+	GLuint NullBackend::createShader(GLenum type) { const GLuint name = nextName(); command(BackendCommand::CreateShader, { type, name }); return name; }
+	void NullBackend::shaderSource(GLuint shader, const GLchar*) { command(BackendCommand::ShaderSource, { shader }); }
+	void NullBackend::compileShader(GLuint shader) { command(BackendCommand::CompileShader, { shader }); }
+	GLint NullBackend::getShaderi(GLuint shader, GLenum pname)
+	{
+		command(BackendCommand::GetShaderi, { shader, pname });
+		return pname == GL_COMPILE_STATUS ? GL_TRUE : 0;
+	}
+	std::string NullBackend::getShaderInfoLog(GLuint shader) { command(BackendCommand::GetShaderInfoLog, { shader }); return {}; }
+	void NullBackend::deleteShader(GLuint shader) { command(BackendCommand::DeleteShader, { shader }); }
+	void NullBackend::maxShaderCompilerThreads(GLuint count) { command(BackendCommand::MaxShaderCompilerThreads, { count }); }
+
+	GLuint NullBackend::createProgram() { const GLuint name = nextName(); command(BackendCommand::CreateProgram, { name }); return name; }
+	void NullBackend::attachShader(GLuint program, GLuint shader) { command(BackendCommand::AttachShader, { program, shader }); }
+	void NullBackend::linkProgram(GLuint program) { command(BackendCommand::LinkProgram, { program }); }
+	GLint NullBackend::getProgrami(GLuint program, GLenum pname)
+	{
+		command(BackendCommand::GetProgrami, { program, pname });
+		return pname == GL_LINK_STATUS || pname == GL_VALIDATE_STATUS ? GL_TRUE : 0;
+	}
+	std::string NullBackend::getProgramInfoLog(GLuint program) { command(BackendCommand::GetProgramInfoLog, { program }); return {}; }
+	void NullBackend::programParameteri(GLuint program, GLenum pname, GLint value) { command(BackendCommand::ProgramParameteri, { program, pname, value }); }
+	GLenum NullBackend::getProgramBinary(GLuint program, std::vector<std::uint8_t>& binary)
+	{
+		command(BackendCommand::GetProgramBinary, { program });
+		binary.clear();
+		return 0;
+	}
+	void NullBackend::programBinary(GLuint program, GLenum format, const void*, GLsizei length)
+	{
+		command(BackendCommand::ProgramBinary, { program, format, length }, std::uint64_t(std::max(length, 0)));
+	}
+	void NullBackend::deleteProgram(GLuint program) { command(BackendCommand::DeleteProgram, { program }); }
+	void NullBackend::useProgram(GLuint program) { command(BackendCommand::UseProgram, { program }); }
+	GLint NullBackend::getUniformLocation(GLuint program, const GLchar*) { command(BackendCommand::GetUniformLocation, { program }); return 0; }
+	void NullBackend::uniform(GLint location, UniformType type, GLsizei count, const void*)
+	{
+		command(BackendCommand::Uniform, { location, std::int64_t(type), count });
+	}
+
+	GLuint NullBackend::genFramebuffer() { const GLuint name = nextName(); command(BackendCommand::GenFramebuffer, { name }); return name; }
+	void NullBackend::deleteFramebuffer(GLuint framebuffer) { command(BackendCommand::DeleteFramebuffer, { framebuffer }); }
+	void NullBackend::bindFramebuffer(GLenum target, GLuint framebuffer) { command(BackendCommand::BindFramebuffer, { target, framebuffer }); }
+	void NullBackend::framebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbufferTarget, GLuint renderbuffer)
+	{
+		command(BackendCommand::FramebufferRenderbuffer, { target, attachment, renderbufferTarget, renderbuffer });
+	}
+	void NullBackend::framebufferTexture2D(GLenum target, GLenum attachment, GLenum textureTarget, GLuint texture, GLint level)
+	{
+		command(BackendCommand::FramebufferTexture2D, { target, attachment, textureTarget, texture, level });
+	}
+	GLenum NullBackend::checkFramebufferStatus(GLenum target) { command(BackendCommand::CheckFramebufferStatus, { target }); return GL_FRAMEBUFFER_COMPLETE; }
+	GLint NullBackend::getFramebufferAttachmentParameteri(GLenum target, GLenum attachment, GLenum pname)
+	{
+		command(BackendCommand::GetFramebufferAttachmentParameteri, { target, attachment, pname });
+		return 0;
+	}
+	void NullBackend::blitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter)
+	{
+		command(BackendCommand::BlitFramebuffer, { srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter });
+	}
+	void NullBackend::readPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void*)
+	{
+		command(BackendCommand::ReadPixels, { x, y, width, height, format, type });
+	}
+	void NullBackend::viewport(GLint x, GLint y, GLsizei width, GLsizei height) { command(BackendCommand::Viewport, { x, y, width, height }); }
+
+	GLenum NullBackend::getError() { command(BackendCommand::GetError, {}); return GL_NO_ERROR; }
+}
+
+
+
+
+namespace gl
+{
+	std::size_t RecordingBackend::count(BackendCommand command) const
+	{
+		return std::size_t(std::count_if(_commands.begin(), _commands.end(), [command](const RecordedCommand& recorded) { return recorded.command == command; }));
+	}
+
+	std::string RecordingBackend::toString() const
+	{
+		std::string text;
+		for (const auto& recorded : _commands)
+		{
+			text += getBackendCommandName(recorded.command);
+			for (std::size_t i = 0; i < recorded.argCount; ++i)
+				text += ' ' + std::to_string(recorded.args[i]);
+			text += '\n';
+		}
+		return text;
+	}
+
+	void RecordingBackend::onCommand(BackendCommand command, std::initializer_list<std::int64_t> args)
+	{
+		auto& recorded = _commands.emplace_back();
+		recorded.command = command;
+		recorded.argCount = std::uint8_t(std::min(args.size(), RecordedCommand::MaxArgs));
+		std::copy_n(args.begin(), recorded.argCount, recorded.args.begin());
+	}
+
+
+	std::string_view getBackendCommandName(BackendCommand command)
+	{
+		switch (command)
+		{
+			case BackendCommand::GenBuffer: return "GenBuffer";
+			case BackendCommand::DeleteBuffer: return "DeleteBuffer";
+			case BackendCommand::BindBuffer: return "BindBuffer";
+			case BackendCommand::BufferData: return "BufferData";
+			case BackendCommand::BufferSubData: return "BufferSubData";
+			case BackendCommand::GenVertexArray: return "GenVertexArray";
+			case BackendCommand::DeleteVertexArray: return "DeleteVertexArray";
+			case BackendCommand::BindVertexArray: return "BindVertexArray";
+			case BackendCommand::EnableVertexAttribArray: return "EnableVertexAttribArray";
+			case BackendCommand::DisableVertexAttribArray: return "DisableVertexAttribArray";
+			case BackendCommand::VertexAttribPointer: return "VertexAttribPointer";
+			case BackendCommand::DrawArrays: return "DrawArrays";
+			case BackendCommand::DrawElements: return "DrawElements";
+			case BackendCommand::GenTexture: return "GenTexture";
+			case BackendCommand::DeleteTexture: return "DeleteTexture";
+			case BackendCommand::BindTexture: return "BindTexture";
+			case BackendCommand::ActiveTexture: return "ActiveTexture";
+			case BackendCommand::TexImage2D: return "TexImage2D";
+			case BackendCommand::TexSubImage2D: return "TexSubImage2D";
+			case BackendCommand::GetTexImage: return "GetTexImage";
+			case BackendCommand::GenerateMipmap: return "GenerateMipmap";
+			case BackendCommand::TexParameteri: return "TexParameteri";
+			case BackendCommand::TextureParameteri: return "TextureParameteri";
+			case BackendCommand::GetTexParameteri: return "GetTexParameteri";
+			case BackendCommand::PixelStorei: return "PixelStorei";
+			case BackendCommand::GetInteger: return "GetInteger";
+			case BackendCommand::GetString: return "GetString";
+			case BackendCommand::CreateShader: return "CreateShader";
+			case BackendCommand::ShaderSource: return "ShaderSource";
+			case BackendCommand::CompileShader: return "CompileShader";
+			case BackendCommand::GetShaderi: return "GetShaderi";
+			case BackendCommand::GetShaderInfoLog: return "GetShaderInfoLog";
+			case BackendCommand::DeleteShader: return "DeleteShader";
+			case BackendCommand::MaxShaderCompilerThreads: return "MaxShaderCompilerThreads";
+			case BackendCommand::CreateProgram: return "CreateProgram";
+			case BackendCommand::AttachShader: return "AttachShader";
+			case BackendCommand::LinkProgram: return "LinkProgram";
+			case BackendCommand::GetProgrami: return "GetProgrami";
+			case BackendCommand::GetProgramInfoLog: return "GetProgramInfoLog";
+			case BackendCommand::ProgramParameteri: return "ProgramParameteri";
+			case BackendCommand::GetProgramBinary: return "GetProgramBinary";
+			case BackendCommand::ProgramBinary: return "ProgramBinary";
+			case BackendCommand::DeleteProgram: return "DeleteProgram";
+			case BackendCommand::UseProgram: return "UseProgram";
+			case BackendCommand::GetUniformLocation: return "GetUniformLocation";
+			case BackendCommand::Uniform: return "Uniform";
+			case BackendCommand::GenFramebuffer: return "GenFramebuffer";
+			case BackendCommand::DeleteFramebuffer: return "DeleteFramebuffer";
+			case BackendCommand::BindFramebuffer: return "BindFramebuffer";
+			case BackendCommand::FramebufferRenderbuffer: return "FramebufferRenderbuffer";
+			case BackendCommand::FramebufferTexture2D: return "FramebufferTexture2D";
+			case BackendCommand::CheckFramebufferStatus: return "CheckFramebufferStatus";
+			case BackendCommand::GetFramebufferAttachmentParameteri: return "GetFramebufferAttachmentParameteri";
+			case BackendCommand::BlitFramebuffer: return "BlitFramebuffer";
+			case BackendCommand::ReadPixels: return "ReadPixels";
+			case BackendCommand::Viewport: return "Viewport";
+			case BackendCommand::GetError: return "GetError";
+
+			default: return "<unknown-command>";
+		}
+	}
+}
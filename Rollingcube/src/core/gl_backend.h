@@ -0,0 +1,341 @@
+#pragma once
+
+#include <cstdint>
+#include <array>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <initializer_list>
+
+#include "gl.h"
+
+
+namespace gl
+{
+	enum class UniformType : std::uint8_t
+	{
+		Float, Float2, Float3, Float4,
+		Int, Int2, Int3, Int4,
+		UnsignedInt, UnsignedInt2, UnsignedInt3, UnsignedInt4,
+		Matrix3, Matrix4
+	};
+
+	// Bytes of client pixel data read by an upload of the given size, format and type //
+	std::uint64_t getPixelSize(GLenum format, GLenum type);
+	std::uint64_t getImageSize(GLsizei width, GLsizei height, GLenum format, GLenum type);
+
+
+	// Every GL call made by the engine wrappers (VAO, VBO, EBO, Texture, ShaderProgram, FrameBuffer
+	// and gl::render) goes through the current backend, so they can run and be measured without a context //
+	class Backend
+	{
+	private:
+		static Backend* Current;
+
+	public:
+		constexpr Backend() = default;
+		Backend(const Backend&) = delete;
+		Backend(Backend&&) noexcept = delete;
+		constexpr virtual ~Backend() = default;
+
+		Backend& operator= (const Backend&) = delete;
+		Backend& operator= (Backend&&) noexcept = delete;
+
+	public:
+		virtual GLuint genBuffer() = 0;
+		virtual void deleteBuffer(GLuint buffer) = 0;
+		virtual void bindBuffer(GLenum target, GLuint buffer) = 0;
+		virtual void bufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) = 0;
+		virtual void bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) = 0;
+
+		virtual GLuint genVertexArray() = 0;
+		virtual void deleteVertexArray(GLuint vertexArray) = 0;
+		virtual void bindVertexArray(GLuint vertexArray) = 0;
+		virtual void enableVertexAttribArray(GLuint index) = 0;
+		virtual void disableVertexAttribArray(GLuint index) = 0;
+		virtual void vertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, GLsizeiptr offset) = 0;
+
+		virtual void drawArrays(GLenum mode, GLint first, GLsizei count) = 0;
+		virtual void drawElements(GLenum mode, GLsizei count, GLenum type, GLsizeiptr offset) = 0;
+
+		virtual GLuint genTexture() = 0;
+		virtual void deleteTexture(GLuint texture) = 0;
+		virtual void bindTexture(GLenum target, GLuint texture) = 0;
+		virtual void activeTexture(GLenum unit) = 0;
+		virtual void texImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* data) = 0;
+		virtual void texSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* data) = 0;
+		virtual void getTexImage(GLenum target, GLint level, GLenum format, GLenum type, void* pixels) = 0;
+		virtual void generateMipmap(GLenum target) = 0;
+		virtual void texParameteri(GLenum target, GLenum pname, GLint param) = 0;
+		virtual void textureParameteri(GLuint texture, GLenum pname, GLint param) = 0;
+		virtual GLint getTexParameteri(GLenum target, GLenum pname) = 0;
+		virtual void pixelStorei(GLenum pname, GLint param) = 0;
+		virtual GLint getInteger(GLenum pname) = 0;
+		virtual std::string getString(GLenum name) = 0;
+
+		virtual GLuint createShader(GLenum type) = 0;
+		virtual void shaderSource(GLuint shader, const GLchar* code) = 0;
+		virtual void compileShader(GLuint shader) = 0;
+		virtual GLint getShaderi(GLuint shader, GLenum pname) = 0;
+		virtual std::string getShaderInfoLog(GLuint shader) = 0;
+		virtual void deleteShader(GLuint shader) = 0;
+		virtual void maxShaderCompilerThreads(GLuint count) = 0;
+
+		virtual GLuint createProgram() = 0;
+		virtual void attachShader(GLuint program, GLuint shader) = 0;
+		virtual void linkProgram(GLuint program) = 0;
+		virtual GLint getProgrami(GLuint program, GLenum pname) = 0;
+		virtual std::string getProgramInfoLog(GLuint program) = 0;
+		virtual void programParameteri(GLuint program, GLenum pname, GLint value) = 0;
+		virtual GLenum getProgramBinary(GLuint program, std::vector<std::uint8_t>& binary) = 0;
+		virtual void programBinary(GLuint program, GLenum format, const void* binary, GLsizei length) = 0;
+		virtual void deleteProgram(GLuint program) = 0;
+		virtual void useProgram(GLuint program) = 0;
+		virtual GLint getUniformLocation(GLuint program, const GLchar* name) = 0;
+		virtual void uniform(GLint location, UniformType type, GLsizei count, const void* values) = 0;
+
+		virtual GLuint genFramebuffer() = 0;
+		virtual void deleteFramebuffer(GLuint framebuffer) = 0;
+		virtual void bindFramebuffer(GLenum target, GLuint framebuffer) = 0;
+		virtual void framebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbufferTarget, GLuint renderbuffer) = 0;
+		virtual void framebufferTexture2D(GLenum target, GLenum attachment, GLenum textureTarget, GLuint texture, GLint level) = 0;
+		virtual GLenum checkFramebufferStatus(GLenum target) = 0;
+		virtual GLint getFramebufferAttachmentParameteri(GLenum target, GLenum attachment, GLenum pname) = 0;
+		virtual void blitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter) = 0;
+		virtual void readPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels) = 0;
+		virtual void viewport(GLint x, GLint y, GLsizei width, GLsizei height) = 0;
+
+		virtual GLenum getError() = 0;
+
+	public:
+		static inline Backend& current() { return *Current; }
+
+		// The backend is not owned, nullptr goes back to the real GL one //
+		static void setCurrent(Backend* backend);
+	};
+
+	inline Backend& backend() { return Backend::current(); }
+
+
+	class RealBackend final : public Backend
+	{
+	public:
+		constexpr RealBackend() = default;
+
+	public:
+		GLuint genBuffer() override;
+		void deleteBuffer(GLuint buffer) override;
+		void bindBuffer(GLenum target, GLuint buffer) override;
+		void bufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) override;
+		void bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) override;
+
+		GLuint genVertexArray() override;
+		void deleteVertexArray(GLuint vertexArray) override;
+		void bindVertexArray(GLuint vertexArray) override;
+		void enableVertexAttribArray(GLuint index) override;
+		void disableVertexAttribArray(GLuint index) override;
+		void vertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, GLsizeiptr offset) override;
+
+		void drawArrays(GLenum mode, GLint first, GLsizei count) override;
+		void drawElements(GLenum mode, GLsizei count, GLenum type, GLsizeiptr offset) override;
+
+		GLuint genTexture() override;
+		void deleteTexture(GLuint texture) override;
+		void bindTexture(GLenum target, GLuint texture) override;
+		void activeTexture(GLenum unit) override;
+		void texImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* data) override;
+		void texSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* data) override;
+		void getTexImage(GLenum target, GLint level, GLenum format, GLenum type, void* pixels) override;
+		void generateMipmap(GLenum target) override;
+		void texParameteri(GLenum target, GLenum pname, GLint param) override;
+		void textureParameteri(GLuint texture, GLenum pname, GLint param) override;
+		GLint getTexParameteri(GLenum target, GLenum pname) override;
+		void pixelStorei(GLenum pname, GLint param) override;
+		GLint getInteger(GLenum pname) override;
+		std::string getString(GLenum name) override;
+
+		GLuint createShader(GLenum type) override;
+		void shaderSource(GLuint shader, const GLchar* code) override;
+		void compileShader(GLuint shader) override;
+		GLint getShaderi(GLuint shader, GLenum pname) override;
+		std::string getShaderInfoLog(GLuint shader) override;
+		void deleteShader(GLuint shader) override;
+		void maxShaderCompilerThreads(GLuint count) override;
+
+		GLuint createProgram() override;
+		void attachShader(GLuint program, GLuint shader) override;
+		void linkProgram(GLuint program) override;
+		GLint getProgrami(GLuint program, GLenum pname) override;
+		std::string getProgramInfoLog(GLuint program) override;
+		void programParameteri(GLuint program, GLenum pname, GLint value) override;
+		GLenum getProgramBinary(GLuint program, std::vector<std::uint8_t>& binary) override;
+		void programBinary(GLuint program, GLenum format, const void* binary, GLsizei length) override;
+		void deleteProgram(GLuint program) override;
+		void useProgram(GLuint program) override;
+		GLint getUniformLocation(GLuint program, const GLchar* name) override;
+		void uniform(GLint location, UniformType type, GLsizei count, const void* values) override;
+
+		GLuint genFramebuffer() override;
+		void deleteFramebuffer(GLuint framebuffer) override;
+		void bindFramebuffer(GLenum target, GLuint framebuffer) override;
+		void framebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbufferTarget, GLuint renderbuffer) override;
+		void framebufferTexture2D(GLenum target, GLenum attachment, GLenum textureTarget, GLuint texture, GLint level) override;
+		GLenum checkFramebufferStatus(GLenum target) override;
+		GLint getFramebufferAttachmentParameteri(GLenum target, GLenum attachment, GLenum pname) override;
+		void blitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter) override;
+		void readPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels) override;
+		void viewport(GLint x, GLint y, GLsizei width, GLsizei height) override;
+
+		GLenum getError() override;
+	};
+
+
+
+
+	enum class BackendCommand : std::uint8_t
+	{
+		GenBuffer, DeleteBuffer, BindBuffer, BufferData, BufferSubData,
+		GenVertexArray, DeleteVertexArray, BindVertexArray, EnableVertexAttribArray, DisableVertexAttribArray, VertexAttribPointer,
+		DrawArrays, DrawElements,
+		GenTexture, DeleteTexture, BindTexture, ActiveTexture, TexImage2D, TexSubImage2D, GetTexImage, GenerateMipmap,
+		TexParameteri, TextureParameteri, GetTexParameteri, PixelStorei, GetInteger, GetString,
+		CreateShader, ShaderSource, CompileShader, GetShaderi, GetShaderInfoLog, DeleteShader, MaxShaderCompilerThreads,
+		CreateProgram, AttachShader, LinkProgram, GetProgrami, GetProgramInfoLog, ProgramParameteri, GetProgramBinary, ProgramBinary,
+		DeleteProgram, UseProgram, GetUniformLocation, Uniform,
+		GenFramebuffer, DeleteFramebuffer, BindFramebuffer, FramebufferRenderbuffer, FramebufferTexture2D, CheckFramebufferStatus,
+		GetFramebufferAttachmentParameteri, BlitFramebuffer, ReadPixels, Viewport,
+		GetError
+	};
+
+	std::string_view getBackendCommandName(BackendCommand command);
+
+	struct BackendStats
+	{
+		std::uint64_t calls = 0;
+		std::uint64_t drawCalls = 0;
+		std::uint64_t vertices = 0; // Vertices or indices submitted by draw calls
+		std::uint64_t uploadedBytes = 0; // Buffer and texture data handed to the driver
+	};
+
+
+	// Hands out names, reports every compile, link and framebuffer as complete, and only counts //
+	class NullBackend : public Backend
+	{
+	private:
+		BackendStats _stats = {};
+		GLuint _nextName = 1;
+
+	public:
+		constexpr NullBackend() = default;
+
+	public:
+		constexpr const BackendStats& getStats() const { return _stats; }
+		constexpr void resetStats() { _stats = {}; }
+
+	public:
+		GLuint genBuffer() override;
+		void deleteBuffer(GLuint buffer) override;
+		void bindBuffer(GLenum target, GLuint buffer) override;
+		void bufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) override;
+		void bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) override;
+
+		GLuint genVertexArray() override;
+		void deleteVertexArray(GLuint vertexArray) override;
+		void bindVertexArray(GLuint vertexArray) override;
+		void enableVertexAttribArray(GLuint index) override;
+		void disableVertexAttribArray(GLuint index) override;
+		void vertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, GLsizeiptr offset) override;
+
+		void drawArrays(GLenum mode, GLint first, GLsizei count) override;
+		void drawElements(GLenum mode, GLsizei count, GLenum type, GLsizeiptr offset) override;
+
+		GLuint genTexture() override;
+		void deleteTexture(GLuint texture) override;
+		void bindTexture(GLenum target, GLuint texture) override;
+		void activeTexture(GLenum unit) override;
+		void texImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* data) override;
+		void texSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* data) override;
+		void getTexImage(GLenum target, GLint level, GLenum format, GLenum type, void* pixels) override;
+		void generateMipmap(GLenum target) override;
+		void texParameteri(GLenum target, GLenum pname, GLint param) override;
+		void textureParameteri(GLuint texture, GLenum pname, GLint param) override;
+		GLint getTexParameteri(GLenum target, GLenum pname) override;
+		void pixelStorei(GLenum pname, GLint param) override;
+		GLint getInteger(GLenum pname) override;
+		std::string getString(GLenum name) override;
+
+		GLuint createShader(GLenum type) override;
+		void shaderSource(GLuint shader, const GLchar* code) override;
+		void compileShader(GLuint shader) override;
+		GLint getShaderi(GLuint shader, GLenum pname) override;
+		std::string getShaderInfoLog(GLuint shader) override;
+		void deleteShader(GLuint shader) override;
+		void maxShaderCompilerThreads(GLuint count) override;
+
+		GLuint createProgram() override;
+		void attachShader(GLuint program, GLuint shader) override;
+		void linkProgram(GLuint program) override;
+		GLint getProgrami(GLuint program, GLenum pname) override;
+		std::string getProgramInfoLog(GLuint program) override;
+		void programParameteri(GLuint program, GLenum pname, GLint value) override;
+		GLenum getProgramBinary(GLuint program, std::vector<std::uint8_t>& binary) override;
+		void programBinary(GLuint program, GLenum format, const void* binary, GLsizei length) override;
+		void deleteProgram(GLuint program) override;
+		void useProgram(GLuint program) override;
+		GLint getUniformLocation(GLuint program, const GLchar* name) override;
+		void uniform(GLint location, UniformType type, GLsizei count, const void* values) override;
+
+		GLuint genFramebuffer() override;
+		void deleteFramebuffer(GLuint framebuffer) override;
+		void bindFramebuffer(GLenum target, GLuint framebuffer) override;
+		void framebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbufferTarget, GLuint renderbuffer) override;
+		void framebufferTexture2D(GLenum target, GLenum attachment, GLenum textureTarget, GLuint texture, GLint level) override;
+		GLenum checkFramebufferStatus(GLenum target) override;
+		GLint getFramebufferAttachmentParameteri(GLenum target, GLenum attachment, GLenum pname) override;
+		void blitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter) override;
+		void readPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels) override;
+		void viewport(GLint x, GLint y, GLsizei width, GLsizei height) override;
+
+		GLenum getError() override;
+
+	protected:
+		// Called once per backend call with its integer arguments, pointers to client data are left out //
+		virtual void onCommand(BackendCommand command, std::initializer_list<std::int64_t> args) {}
+
+	private:
+		void command(BackendCommand command, std::initializer_list<std::int64_t> args, std::uint64_t uploadedBytes = 0);
+		inline GLuint nextName() { return _nextName++; }
+	};
+
+
+	struct RecordedCommand
+	{
+		static constexpr std::size_t MaxArgs = 10;
+
+		BackendCommand command = BackendCommand::GetError;
+		std::uint8_t argCount = 0;
+		std::array<std::int64_t, MaxArgs> args = {};
+	};
+
+	// Null backend that also keeps the command stream, for tests and for diffing render paths //
+	class RecordingBackend final : public NullBackend
+	{
+	private:
+		std::vector<RecordedCommand> _commands;
+
+	public:
+		RecordingBackend() = default;
+
+	public:
+		inline const std::vector<RecordedCommand>& getCommands() const { return _commands; }
+		inline void clear() { _commands.clear(); }
+
+		std::size_t count(BackendCommand command) const;
+
+		// One command per line, name followed by its arguments //
+		std::string toString() const;
+
+	protected:
+		void onCommand(BackendCommand command, std::initializer_list<std::int64_t> args) override;
+	};
+}
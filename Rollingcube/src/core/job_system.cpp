@@ -0,0 +1,288 @@
+#include "job_system.h"
+
+#include "thread_pool.h"
+#include "profiler.h"
+
+
+JobSystem JobSystem::Instance;
+
+
+namespace
+{
+	// Deque owned by the current thread, only valid while it runs inside currentSystem //
+	static thread_local const JobSystem* currentSystem = nullptr;
+	static thread_local std::size_t currentDeque = 0;
+}
+
+
+bool WorkStealingDeque::push(Job* job)
+{
+	const std::int64_t bottom = _bottom.load(std::memory_order_relaxed);
+	const std::int64_t top = _top.load(std::memory_order_acquire);
+	if (bottom - top >= Capacity)
+		return false;
+
+	_jobs[bottom & Mask].store(job, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	_bottom.store(bottom + 1, std::memory_order_relaxed);
+	return true;
+}
+
+Job* WorkStealingDeque::pop()
+{
+	const std::int64_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+	_bottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	std::int64_t top = _top.load(std::memory_order_relaxed);
+
+	if (top > bottom)
+	{
+		_bottom.store(bottom + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Job* job = _jobs[bottom & Mask].load(std::memory_order_relaxed);
+	if (top == bottom)
+	{
+		// Last job, race the thieves for it //
+		if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			job = nullptr;
+		_bottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+
+	return job;
+}
+
+Job* WorkStealingDeque::steal()
+{
+	std::int64_t top = _top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	const std::int64_t bottom = _bottom.load(std::memory_order_acquire);
+
+	if (top >= bottom)
+		return nullptr;
+
+	Job* job = _jobs[top & Mask].load(std::memory_order_relaxed);
+	if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		return nullptr;
+
+	return job;
+}
+
+
+
+
+JobSystem::JobSystem(std::size_t workerCount) :
+	_workers(),
+	_deques(),
+	_mainThreadId(std::this_thread::get_id())
+{
+	_deques.reserve(workerCount + 1);
+	for (std::size_t i = 0; i <= workerCount; ++i)
+		_deques.push_back(std::make_unique<WorkStealingDeque>());
+
+	_workers.reserve(workerCount);
+	for (std::size_t i = 0; i < workerCount; ++i)
+		_workers.emplace_back(&JobSystem::workerLoop, this, i + 1);
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::scoped_lock lock(_sleepMutex);
+		_stop.store(true);
+	}
+
+	_sleepCondition.notify_all();
+	for (auto& worker : _workers)
+		if (worker.joinable())
+			worker.join();
+}
+
+void JobSystem::run(JobCounter& counter, Function&& function)
+{
+	counter._pending.fetch_add(1, std::memory_order_relaxed);
+	schedule(new Job{ std::move(function), &counter });
+}
+
+void JobSystem::run(JobCounter& counter, JobCounter& dependency, Function&& function)
+{
+	counter._pending.fetch_add(1, std::memory_order_relaxed);
+	Job* job = new Job{ std::move(function), &counter };
+
+	{
+		// finish() drains the continuations under this lock after the count reached zero //
+		std::scoped_lock lock(dependency._continuationsMutex);
+		if (!dependency.isDone())
+		{
+			dependency._continuations.push_back(job);
+			return;
+		}
+	}
+
+	schedule(job);
+}
+
+void JobSystem::wait(JobCounter& counter)
+{
+	const std::size_t ownDeque = getCurrentDequeIndex();
+	while (!counter.isDone())
+	{
+		if (Job* job = findJob(ownDeque))
+			execute(job);
+		else
+			std::this_thread::yield();
+	}
+
+	// The last finish() may still hold it //
+	std::scoped_lock lock(counter._continuationsMutex);
+}
+
+void JobSystem::schedule(Job* job)
+{
+	if (_workers.empty())
+	{
+		execute(job);
+		return;
+	}
+
+	// Counted before it becomes visible, so a thief never takes it out of the count first //
+	_queuedJobs.fetch_add(1);
+
+	const std::size_t dequeIndex = getCurrentDequeIndex();
+	if (dequeIndex == NoDeque)
+	{
+		std::scoped_lock lock(_injectedMutex);
+		_injected.push_back(job);
+	}
+	else if (!_deques[dequeIndex]->push(job))
+	{
+		// The own deque is full, run it right away instead //
+		_queuedJobs.fetch_sub(1);
+		execute(job);
+		return;
+	}
+
+	if (_sleepingWorkers.load() > 0)
+	{
+		{ std::scoped_lock lock(_sleepMutex); }
+		_sleepCondition.notify_one();
+	}
+}
+
+void JobSystem::execute(Job* job)
+{
+	job->function();
+
+	JobCounter* counter = job->counter;
+	delete job;
+
+	if (counter != nullptr)
+		finish(*counter);
+}
+
+void JobSystem::finish(JobCounter& counter)
+{
+	std::uint32_t pending = counter._pending.load(std::memory_order_relaxed);
+	while (pending > 1)
+		if (counter._pending.compare_exchange_weak(pending, pending - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+			return;
+
+	// Possibly the last job: the count drops to zero under the lock, and wait() takes the lock before returning,
+	// so the counter cannot be released while it is still used here //
+	std::vector<Job*> continuations;
+	{
+		std::scoped_lock lock(counter._continuationsMutex);
+		if (counter._pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			std::swap(continuations, counter._continuations);
+	}
+
+	for (Job* job : continuations)
+		schedule(job);
+}
+
+Job* JobSystem::findJob(std::size_t ownDeque)
+{
+	Job* job = ownDeque != NoDeque ? _deques[ownDeque]->pop() : nullptr;
+
+	// Steal starting after the own deque, so thieves spread over the victims //
+	const std::size_t dequeCount = _deques.size();
+	const std::size_t first = ownDeque != NoDeque ? ownDeque + 1 : 0;
+	for (std::size_t i = 0; job == nullptr && i < dequeCount; ++i)
+	{
+		const std::size_t victim = (first + i) % dequeCount;
+		if (victim != ownDeque)
+			job = _deques[victim]->steal();
+	}
+
+	if (job == nullptr)
+	{
+		std::scoped_lock lock(_injectedMutex);
+		if (!_injected.empty())
+		{
+			job = _injected.front();
+			_injected.pop_front();
+		}
+	}
+
+	if (job != nullptr)
+		_queuedJobs.fetch_sub(1);
+
+	return job;
+}
+
+std::size_t JobSystem::getCurrentDequeIndex() const
+{
+	if (currentSystem == this)
+		return currentDeque;
+
+	return std::this_thread::get_id() == _mainThreadId ? 0 : NoDeque;
+}
+
+void JobSystem::workerLoop(std::size_t dequeIndex)
+{
+	currentSystem = this;
+	currentDeque = dequeIndex;
+
+	// Named on the first job, the global instance starts its workers before the profiler is constructed //
+	bool named = this != &Instance;
+
+	unsigned int spins = 0;
+	while (!_stop.load(std::memory_order_relaxed))
+	{
+		if (Job* job = findJob(dequeIndex))
+		{
+			if (!named)
+			{
+				Profiler::instance().setThreadName("Job worker " + std::to_string(dequeIndex));
+				named = true;
+			}
+
+			execute(job);
+			spins = 0;
+			continue;
+		}
+
+		if (++spins < SpinsBeforeSleep)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		// Pairs with the increment of _queuedJobs in schedule(), one of both sides sees the other //
+		std::unique_lock lock(_sleepMutex);
+		_sleepingWorkers.fetch_add(1);
+		_sleepCondition.wait(lock, [this]() { return _stop.load() || _queuedJobs.load() > 0; });
+		_sleepingWorkers.fetch_sub(1);
+		spins = 0;
+	}
+}
+
+std::size_t JobSystem::getDefaultWorkerCount()
+{
+#ifdef JOBS_ENABLED
+	return ThreadPool::getDefaultWorkerCount();
+#else
+	return 0;
+#endif
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+
+
+#if !defined(_DISABLE_JOBS)
+#define JOBS_ENABLED
+#endif
+
+
+class JobSystem;
+class JobCounter;
+
+
+struct Job
+{
+	std::function<void()> function;
+	JobCounter* counter = nullptr;
+};
+
+
+// Counts the jobs started with it that have not finished yet. Jobs may depend on a counter, they are held back
+// until it drops to zero. A counter must not be started again while jobs still depend on it //
+class JobCounter
+{
+public:
+	friend JobSystem;
+
+private:
+	std::atomic<std::uint32_t> _pending = 0;
+	std::mutex _continuationsMutex;
+	std::vector<Job*> _continuations;
+
+public:
+	JobCounter() = default;
+	JobCounter(const JobCounter&) = delete;
+	JobCounter(JobCounter&&) noexcept = delete;
+	~JobCounter() = default;
+
+	JobCounter& operator= (const JobCounter&) = delete;
+	JobCounter& operator= (JobCounter&&) noexcept = delete;
+
+public:
+	inline bool isDone() const { return _pending.load(std::memory_order_acquire) == 0; }
+	inline std::uint32_t getPendingCount() const { return _pending.load(std::memory_order_acquire); }
+};
+
+
+// Chase-Lev deque: the owner pushes and pops at the bottom, any other thread steals from the top //
+class WorkStealingDeque
+{
+public:
+	static constexpr std::int64_t Capacity = 4096;
+
+private:
+	static constexpr std::int64_t Mask = Capacity - 1;
+	static_assert((Capacity & Mask) == 0, "Capacity must be a power of two");
+
+private:
+	alignas(64) std::atomic<std::int64_t> _top = 0;
+	alignas(64) std::atomic<std::int64_t> _bottom = 0;
+	std::unique_ptr<std::atomic<Job*>[]> _jobs = std::make_unique<std::atomic<Job*>[]>(std::size_t(Capacity));
+
+public:
+	WorkStealingDeque() = default;
+	WorkStealingDeque(const WorkStealingDeque&) = delete;
+	WorkStealingDeque(WorkStealingDeque&&) noexcept = delete;
+	~WorkStealingDeque() = default;
+
+	WorkStealingDeque& operator= (const WorkStealingDeque&) = delete;
+	WorkStealingDeque& operator= (WorkStealingDeque&&) noexcept = delete;
+
+public:
+	// Owner only, fails when the deque is full //
+	bool push(Job* job);
+
+	// Owner only //
+	Job* pop();
+
+	// Any thread //
+	Job* steal();
+
+	inline bool empty() const { return _bottom.load(std::memory_order_relaxed) <= _top.load(std::memory_order_relaxed); }
+};
+
+
+/*
+	Work-stealing job system. Every worker and the main thread own a deque; idle threads steal from the others.
+	Threads that are neither go through a locked injection queue. wait() runs pending jobs instead of blocking,
+	so the main thread takes part in the work while it waits for its counters.
+*/
+class JobSystem
+{
+public:
+	using Function = std::function<void()>;
+
+private:
+	static constexpr std::size_t NoDeque = std::size_t(-1);
+	static constexpr unsigned int SpinsBeforeSleep = 64;
+
+private:
+	static JobSystem Instance;
+
+private:
+	std::vector<std::thread> _workers;
+	std::vector<std::unique_ptr<WorkStealingDeque>> _deques; // [0] belongs to the main thread, [i + 1] to worker i
+	std::thread::id _mainThreadId;
+
+	std::mutex _injectedMutex;
+	std::deque<Job*> _injected;
+
+	std::mutex _sleepMutex;
+	std::condition_variable _sleepCondition;
+	std::atomic<std::uint32_t> _queuedJobs = 0;
+	std::atomic<std::uint32_t> _sleepingWorkers = 0;
+	std::atomic<bool> _stop = false;
+
+public:
+	// The constructing thread becomes the main thread //
+	explicit JobSystem(std::size_t workerCount = getDefaultWorkerCount());
+	JobSystem(const JobSystem&) = delete;
+	JobSystem(JobSystem&&) noexcept = delete;
+	~JobSystem();
+
+	JobSystem& operator= (const JobSystem&) = delete;
+	JobSystem& operator= (JobSystem&&) noexcept = delete;
+
+public:
+	inline std::size_t getWorkerCount() const { return _workers.size(); }
+	inline std::size_t getThreadCount() const { return _workers.size() + 1; }
+
+	void run(JobCounter& counter, Function&& function);
+
+	// The job starts once dependency is done //
+	void run(JobCounter& counter, JobCounter& dependency, Function&& function);
+
+	// Runs pending jobs on the calling thread until counter is done. A counter may only be released after a wait on it //
+	void wait(JobCounter& counter);
+
+	// Splits [0, count) in ranges of at least grainSize elements and calls fn(begin, end) on each one, possibly
+	// from several threads at once. Returns once every range is done. May be nested inside jobs //
+	template <typename _Fn>
+	void parallelFor(std::size_t count, std::size_t grainSize, _Fn&& fn)
+	{
+		if (count == 0)
+			return;
+
+		// Enough ranges for stealing to balance the load, not so many that scheduling dominates //
+		const std::size_t minGrain = (count + getThreadCount() * 4 - 1) / (getThreadCount() * 4);
+		const std::size_t grain = std::max<std::size_t>({ grainSize, minGrain, 1 });
+		if (_workers.empty() || count <= grain)
+		{
+			fn(std::size_t(0), count);
+			return;
+		}
+
+		JobCounter counter;
+		for (std::size_t begin = grain; begin < count; begin += grain)
+			run(counter, [&fn, begin, end = std::min(begin + grain, count)]() { fn(begin, end); });
+
+		fn(std::size_t(0), grain);
+		wait(counter);
+	}
+
+public:
+	static constexpr JobSystem& instance() { return Instance; }
+
+	static std::size_t getDefaultWorkerCount();
+
+private:
+	void schedule(Job* job);
+	void execute(Job* job);
+	void finish(JobCounter& counter);
+
+	Job* findJob(std::size_t ownDeque);
+	std::size_t getCurrentDequeIndex() const;
+
+	void workerLoop(std::size_t dequeIndex);
+};
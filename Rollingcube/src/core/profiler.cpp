@@ -0,0 +1,365 @@
+#include "profiler.h"
+
+#include <algorithm>
+
+#include "trace_recorder.h"
+#include "frame_stats.h"
+
+
+Profiler Profiler::Instance;
+
+
+void Profiler::beginFrame()
+{
+	_frameOpen = true;
+	_frameBegin = now();
+
+	if (_gpuEnabled)
+	{
+		// The slot is only still pending if the GPU fell more than GpuFrameLatency frames behind //
+		auto& gpuFrame = _gpuFrames[_frameIndex % GpuFrameLatency];
+		if (gpuFrame.pending)
+			resolveGpuFrame(gpuFrame, true);
+
+		gpuFrame.frameIndex = _frameIndex;
+		gpuFrame.scopes.clear();
+		_gpuDepth = 0;
+	}
+}
+
+void Profiler::endFrame()
+{
+	if (!_frameOpen)
+		return;
+
+	_frameOpen = false;
+
+	_lastFrame.frameIndex = _frameIndex;
+	_lastFrame.begin = _frameBegin;
+	_lastFrame.end = now();
+	collect(_lastFrame);
+
+	auto& recorder = TraceRecorder::instance();
+	if (recorder.isRecording())
+		recorder.recordFrame(_lastFrame, getThreadEvents().index);
+
+	FrameStats::instance().endFrame(toMilliseconds(_lastFrame.getDuration()));
+
+	if (_gpuEnabled)
+	{
+		auto& gpuFrame = _gpuFrames[_frameIndex % GpuFrameLatency];
+		gpuFrame.pending = !gpuFrame.scopes.empty();
+		resolveGpuFrames(false);
+	}
+
+	++_frameIndex;
+}
+
+void Profiler::setThreadName(std::string_view name)
+{
+	auto& thread = getThreadEvents();
+
+	std::scoped_lock lock(_threadsMutex);
+	thread.name = name;
+}
+
+std::vector<std::string> Profiler::getThreadNames() const
+{
+	std::scoped_lock lock(_threadsMutex);
+
+	std::vector<std::string> names;
+	names.reserve(_threads.size());
+	for (const auto& thread : _threads)
+		names.push_back(thread->name);
+
+	return names;
+}
+
+std::string_view Profiler::intern(std::string_view name)
+{
+	{
+		std::shared_lock lock(_namesMutex);
+		auto it = _names.find(name);
+		if (it != _names.end())
+			return *it;
+	}
+
+	std::unique_lock lock(_namesMutex);
+	return *_names.emplace(name).first;
+}
+
+void Profiler::recordInstant(std::string_view name, ProfileCategory category)
+{
+	if (!isEnabled())
+		return;
+
+	auto& thread = getThreadEvents();
+	const ProfileTimestamp time = now();
+	record(thread, { name, time, time, thread.depth, category });
+}
+
+bool Profiler::setGpuTimingEnabled(bool enabled)
+{
+	if (enabled == _gpuEnabled)
+		return true;
+
+	if (enabled && !GLEW_VERSION_3_3 && !GLEW_ARB_timer_query)
+	{
+		logger::warn("GPU timer queries are not supported, GPU profiling stays disabled.");
+		return false;
+	}
+
+	if (!enabled)
+		releaseGpuResources();
+
+	_gpuEnabled = enabled;
+	return true;
+}
+
+void Profiler::releaseGpuResources()
+{
+	if (!_allQueries.empty())
+		glDeleteQueries(GLsizei(_allQueries.size()), _allQueries.data());
+
+	_allQueries.clear();
+	_freeQueries.clear();
+	for (auto& gpuFrame : _gpuFrames)
+	{
+		gpuFrame.scopes.clear();
+		gpuFrame.pending = false;
+	}
+
+	_lastGpuFrame = {};
+	_gpuEnabled = false;
+}
+
+Profiler::ThreadEvents& Profiler::getThreadEvents()
+{
+	// Buffers are owned by the profiler, so threads that exit never leave dangling pointers behind //
+	static thread_local ThreadEvents* threadEvents = nullptr;
+	if (!threadEvents)
+	{
+		std::scoped_lock lock(_threadsMutex);
+
+		auto& thread = _threads.emplace_back(std::make_unique<ThreadEvents>());
+		thread->index = std::uint32_t(_threads.size() - 1);
+		thread->name = "Thread " + std::to_string(thread->index);
+		threadEvents = thread.get();
+	}
+
+	return *threadEvents;
+}
+
+void Profiler::record(ThreadEvents& thread, const ProfileEvent& event)
+{
+	const std::uint32_t head = thread.head.load(std::memory_order_relaxed);
+	if (head - thread.tail.load(std::memory_order_acquire) >= ThreadEventsCapacity)
+	{
+		thread.dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	thread.events[head % ThreadEventsCapacity] = event;
+	thread.head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::collect(ProfileFrame& frame)
+{
+	frame.nodes.clear();
+	frame.droppedEvents = 0;
+
+	auto& recorder = TraceRecorder::instance();
+	const bool recording = recorder.isRecording();
+
+	std::scoped_lock lock(_threadsMutex);
+	for (const auto& thread : _threads)
+	{
+		const std::uint32_t tail = thread->tail.load(std::memory_order_relaxed);
+		const std::uint32_t head = thread->head.load(std::memory_order_acquire);
+		if (head == tail)
+			continue;
+
+		_collectBuffer.clear();
+		for (std::uint32_t i = tail; i != head; ++i)
+			_collectBuffer.push_back(thread->events[i % ThreadEventsCapacity]);
+		thread->tail.store(head, std::memory_order_release);
+
+		frame.droppedEvents += thread->dropped.exchange(0, std::memory_order_relaxed);
+		if (recording)
+			recorder.record(thread->index, _collectBuffer);
+		buildTree(thread->name, _collectBuffer, frame.nodes);
+	}
+}
+
+std::uint32_t Profiler::beginGpuScope(std::string_view name)
+{
+	auto& gpuFrame = _gpuFrames[_frameIndex % GpuFrameLatency];
+
+	GpuScopeQueries scope = { name, acquireQuery(), 0, _gpuDepth++ };
+	glQueryCounter(scope.beginQuery, GL_TIMESTAMP);
+
+	gpuFrame.scopes.push_back(scope);
+	return std::uint32_t(gpuFrame.scopes.size() - 1);
+}
+
+void Profiler::endGpuScope(std::uint32_t scopeIndex)
+{
+	auto& gpuFrame = _gpuFrames[_frameIndex % GpuFrameLatency];
+	if (!_frameOpen || scopeIndex >= gpuFrame.scopes.size())
+		return;
+
+	auto& scope = gpuFrame.scopes[scopeIndex];
+	scope.endQuery = acquireQuery();
+	glQueryCounter(scope.endQuery, GL_TIMESTAMP);
+
+	--_gpuDepth;
+}
+
+GLuint Profiler::acquireQuery()
+{
+	if (_freeQueries.empty())
+	{
+		static constexpr std::size_t QueryBatch = 32;
+
+		const std::size_t first = _allQueries.size();
+		_allQueries.resize(first + QueryBatch);
+		glGenQueries(GLsizei(QueryBatch), _allQueries.data() + first);
+		_freeQueries.assign(_allQueries.begin() + first, _allQueries.end());
+	}
+
+	GLuint query = _freeQueries.back();
+	_freeQueries.pop_back();
+	return query;
+}
+
+void Profiler::resolveGpuFrames(bool wait)
+{
+	// Oldest first, so _lastGpuFrame always ends up holding the most recent resolved frame //
+	for (std::size_t i = GpuFrameLatency; i > 0; --i)
+	{
+		if (_frameIndex + 1 < i)
+			continue;
+
+		auto& gpuFrame = _gpuFrames[(_frameIndex + 1 - i) % GpuFrameLatency];
+		if (gpuFrame.pending && !resolveGpuFrame(gpuFrame, wait))
+			break;
+	}
+}
+
+bool Profiler::resolveGpuFrame(GpuFrame& gpuFrame, bool wait)
+{
+	// Timestamps become available in submission order, the last query stands for the whole frame //
+	const auto& last = gpuFrame.scopes.back();
+	if (!wait)
+	{
+		GLint available = GL_FALSE;
+		glGetQueryObjectiv(last.endQuery ? last.endQuery : last.beginQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available == GL_FALSE)
+			return false;
+	}
+
+	_collectBuffer.clear();
+	ProfileTimestamp frameBegin = std::numeric_limits<ProfileTimestamp>::max();
+	ProfileTimestamp frameEnd = 0;
+	for (const auto& scope : gpuFrame.scopes)
+	{
+		GLuint64 begin = 0;
+		GLuint64 end = 0;
+		glGetQueryObjectui64v(scope.beginQuery, GL_QUERY_RESULT, &begin);
+		_freeQueries.push_back(scope.beginQuery);
+
+		// Scopes still open when the frame ended have no end query //
+		if (scope.endQuery)
+		{
+			glGetQueryObjectui64v(scope.endQuery, GL_QUERY_RESULT, &end);
+			_freeQueries.push_back(scope.endQuery);
+
+			_collectBuffer.push_back({ scope.name, begin, end, scope.depth });
+			frameBegin = std::min<ProfileTimestamp>(frameBegin, begin);
+			frameEnd = std::max<ProfileTimestamp>(frameEnd, end);
+		}
+	}
+
+	_lastGpuFrame.frameIndex = gpuFrame.frameIndex;
+	_lastGpuFrame.begin = frameEnd > 0 ? frameBegin : 0;
+	_lastGpuFrame.end = frameEnd;
+	_lastGpuFrame.droppedEvents = 0;
+	_lastGpuFrame.nodes.clear();
+	buildTree("GPU", _collectBuffer, _lastGpuFrame.nodes);
+
+	gpuFrame.scopes.clear();
+	gpuFrame.pending = false;
+	return true;
+}
+
+void Profiler::buildTree(std::string_view rootName, std::vector<ProfileEvent>& events, std::vector<ProfileNode>& nodes)
+{
+	struct BuildNode
+	{
+		ProfileNode node;
+		std::uint32_t firstChild = ProfileNode::NoParent;
+		std::uint32_t lastChild = ProfileNode::NoParent;
+		std::uint32_t nextSibling = ProfileNode::NoParent;
+	};
+
+	// Scopes are recorded when they close, so parents come after their children until sorted //
+	std::sort(events.begin(), events.end(), [](const ProfileEvent& left, const ProfileEvent& right) {
+		return left.begin != right.begin ? left.begin < right.begin : left.depth < right.depth;
+	});
+
+	std::vector<BuildNode> build;
+	build.push_back({ { rootName, 0, 0, 0, ProfileNode::NoParent } });
+
+	std::vector<std::uint32_t> open = { 0 };
+	for (const auto& event : events)
+	{
+		// Scopes opened before the previous collection have no parent here, they attach to the deepest open one //
+		while (open.size() > event.depth + 1)
+			open.pop_back();
+
+		const std::uint32_t parent = open.back();
+
+		std::uint32_t child = build[parent].firstChild;
+		while (child != ProfileNode::NoParent && build[child].node.name != event.name)
+			child = build[child].nextSibling;
+
+		if (child == ProfileNode::NoParent)
+		{
+			child = std::uint32_t(build.size());
+			build.push_back({ { event.name, 0, 0, build[parent].node.depth + 1, parent } });
+
+			if (build[parent].lastChild == ProfileNode::NoParent)
+				build[parent].firstChild = child;
+			else
+				build[build[parent].lastChild].nextSibling = child;
+			build[parent].lastChild = child;
+		}
+
+		build[child].node.time += event.end - event.begin;
+		build[child].node.calls++;
+		if (parent == 0)
+			build[0].node.time += event.end - event.begin;
+
+		open.push_back(child);
+	}
+	build[0].node.calls = 1;
+
+	// Flatten in pre-order so consumers can walk the tree without child lists //
+	std::vector<std::uint32_t> remap(build.size());
+	std::vector<std::uint32_t> pending = { 0 };
+	while (!pending.empty())
+	{
+		const std::uint32_t index = pending.back();
+		pending.pop_back();
+
+		remap[index] = std::uint32_t(nodes.size());
+		auto& node = nodes.emplace_back(build[index].node);
+		if (node.parent != ProfileNode::NoParent)
+			node.parent = remap[node.parent];
+
+		const std::size_t firstPending = pending.size();
+		for (std::uint32_t child = build[index].firstChild; child != ProfileNode::NoParent; child = build[child].nextSibling)
+			pending.push_back(child);
+		std::reverse(pending.begin() + firstPending, pending.end());
+	}
+}
@@ -0,0 +1,290 @@
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <array>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_set>
+#include <string>
+#include <string_view>
+#include <chrono>
+#include <limits>
+
+#include "gl.h"
+#include "time.h"
+
+
+#if !defined(_DISABLE_PROFILER)
+#define PROFILER_ENABLED
+#endif
+
+
+using ProfileTimestamp = Timestamp;
+
+enum class ProfileCategory : std::uint8_t
+{
+	Scope,
+	Frame,
+	Asset,
+	Lua,
+	LuaGc,
+	Wait
+};
+
+struct ProfileEvent
+{
+	std::string_view name; // Must outlive the frame: a literal, or a name returned by Profiler::intern
+	ProfileTimestamp begin = 0;
+	ProfileTimestamp end = 0;
+	std::uint32_t depth = 0;
+	ProfileCategory category = ProfileCategory::Scope;
+};
+
+struct ProfileNode
+{
+	static constexpr std::uint32_t NoParent = std::numeric_limits<std::uint32_t>::max();
+
+	std::string_view name;
+	ProfileTimestamp time = 0; // Inclusive time of every call merged in this node
+	std::uint32_t calls = 0;
+	std::uint32_t depth = 0; // Thread roots are at depth 0
+	std::uint32_t parent = NoParent;
+};
+
+struct ProfileFrame
+{
+	std::uint64_t frameIndex = 0;
+	ProfileTimestamp begin = 0;
+	ProfileTimestamp end = 0;
+	std::vector<ProfileNode> nodes; // Pre-order, same-named siblings are merged
+	std::uint32_t droppedEvents = 0;
+
+	constexpr ProfileTimestamp getDuration() const { return end - begin; }
+};
+
+
+class Profiler
+{
+public:
+	static constexpr std::size_t ThreadEventsCapacity = 8192;
+	static constexpr std::size_t GpuFrameLatency = 4; // GPU results are read back this many frames later at most
+
+public:
+	class Scope;
+	class GpuScope;
+
+private:
+	// Single producer (owning thread), single consumer (endFrame) ring //
+	struct ThreadEvents
+	{
+		std::vector<ProfileEvent> events = std::vector<ProfileEvent>(ThreadEventsCapacity);
+		std::atomic<std::uint32_t> head = 0;
+		std::atomic<std::uint32_t> tail = 0;
+		std::atomic<std::uint32_t> dropped = 0;
+		std::uint32_t depth = 0;
+		std::uint32_t index = 0;
+		std::string name;
+	};
+
+	struct GpuScopeQueries
+	{
+		std::string_view name;
+		GLuint beginQuery = 0;
+		GLuint endQuery = 0;
+		std::uint32_t depth = 0;
+	};
+
+	struct GpuFrame
+	{
+		std::uint64_t frameIndex = 0;
+		std::vector<GpuScopeQueries> scopes;
+		bool pending = false;
+	};
+
+	struct NameHash
+	{
+		using is_transparent = void;
+
+		inline std::size_t operator() (std::string_view name) const { return std::hash<std::string_view>()(name); }
+	};
+
+private:
+	static Profiler Instance;
+
+private:
+	std::atomic<bool> _enabled = true;
+
+	mutable std::mutex _threadsMutex;
+	std::vector<std::unique_ptr<ThreadEvents>> _threads;
+
+	// Never shrinks, recorded events and traces keep pointing into it //
+	mutable std::shared_mutex _namesMutex;
+	std::unordered_set<std::string, NameHash, std::equal_to<>> _names;
+
+	bool _frameOpen = false;
+	std::uint64_t _frameIndex = 0;
+	ProfileTimestamp _frameBegin = 0;
+	ProfileFrame _lastFrame;
+	std::vector<ProfileEvent> _collectBuffer;
+
+	bool _gpuEnabled = false;
+	std::uint32_t _gpuDepth = 0;
+	std::array<GpuFrame, GpuFrameLatency> _gpuFrames;
+	std::vector<GLuint> _freeQueries;
+	std::vector<GLuint> _allQueries;
+	ProfileFrame _lastGpuFrame;
+
+public:
+	Profiler(const Profiler&) = delete;
+	Profiler(Profiler&&) noexcept = delete;
+	~Profiler() = default;
+
+	Profiler& operator= (const Profiler&) = delete;
+	Profiler& operator= (Profiler&&) noexcept = delete;
+
+private:
+	Profiler() = default;
+
+public:
+	// Frames are begun, ended and read on the GL thread, scopes may be opened from any thread //
+	void beginFrame();
+	void endFrame();
+
+	void setThreadName(std::string_view name);
+	std::vector<std::string> getThreadNames() const;
+
+	// Zero length event on the calling thread, for things that cannot be wrapped in a scope //
+	void recordInstant(std::string_view name, ProfileCategory category);
+
+	// Any thread. A copy of name that lives as long as the profiler, for scopes named at runtime //
+	std::string_view intern(std::string_view name);
+
+	// Needs a current GL context, timer queries are core since 3.3 //
+	bool setGpuTimingEnabled(bool enabled);
+	void releaseGpuResources();
+
+public:
+	inline bool isEnabled() const { return _enabled.load(std::memory_order_relaxed); }
+	inline void setEnabled(bool enabled) { _enabled.store(enabled, std::memory_order_relaxed); }
+
+	constexpr bool isGpuTimingEnabled() const { return _gpuEnabled; }
+
+	constexpr std::uint64_t getFrameIndex() const { return _frameIndex; }
+
+	constexpr const ProfileFrame& getLastFrame() const { return _lastFrame; }
+	constexpr const ProfileFrame& getLastGpuFrame() const { return _lastGpuFrame; }
+
+public:
+	static inline ProfileTimestamp now() { return timestamp::now(); }
+
+	static constexpr double toMilliseconds(ProfileTimestamp time) { return timestamp::toMilliseconds(time); }
+
+	static constexpr Profiler& instance() { return Instance; }
+
+private:
+	ThreadEvents& getThreadEvents();
+	void record(ThreadEvents& thread, const ProfileEvent& event);
+	void collect(ProfileFrame& frame);
+
+	std::uint32_t beginGpuScope(std::string_view name);
+	void endGpuScope(std::uint32_t scopeIndex);
+	GLuint acquireQuery();
+	void resolveGpuFrames(bool wait);
+	bool resolveGpuFrame(GpuFrame& gpuFrame, bool wait);
+
+	static void buildTree(std::string_view rootName, std::vector<ProfileEvent>& events, std::vector<ProfileNode>& nodes);
+};
+
+
+class Profiler::Scope
+{
+private:
+	ThreadEvents* _thread = nullptr;
+	std::string_view _name;
+	ProfileTimestamp _begin = 0;
+	std::uint32_t _depth = 0;
+	ProfileCategory _category = ProfileCategory::Scope;
+
+public:
+	Scope(const Scope&) = delete;
+	Scope(Scope&&) noexcept = delete;
+
+	Scope& operator= (const Scope&) = delete;
+	Scope& operator= (Scope&&) noexcept = delete;
+
+public:
+	inline explicit Scope(std::string_view name, ProfileCategory category = ProfileCategory::Scope)
+	{
+		auto& profiler = Profiler::instance();
+		if (profiler.isEnabled())
+		{
+			_thread = &profiler.getThreadEvents();
+			_name = name;
+			_category = category;
+			_depth = _thread->depth++;
+			_begin = Profiler::now();
+		}
+	}
+
+	inline ~Scope()
+	{
+		if (_thread)
+		{
+			const ProfileTimestamp end = Profiler::now();
+			--_thread->depth;
+			Profiler::instance().record(*_thread, { _name, _begin, end, _depth, _category });
+		}
+	}
+};
+
+
+class Profiler::GpuScope
+{
+private:
+	static constexpr std::uint32_t NoScope = std::numeric_limits<std::uint32_t>::max();
+
+private:
+	std::uint32_t _scopeIndex = NoScope;
+
+public:
+	GpuScope(const GpuScope&) = delete;
+	GpuScope(GpuScope&&) noexcept = delete;
+
+	GpuScope& operator= (const GpuScope&) = delete;
+	GpuScope& operator= (GpuScope&&) noexcept = delete;
+
+public:
+	inline explicit GpuScope(std::string_view name)
+	{
+		auto& profiler = Profiler::instance();
+		if (profiler.isEnabled() && profiler._gpuEnabled && profiler._frameOpen)
+			_scopeIndex = profiler.beginGpuScope(name);
+	}
+
+	inline ~GpuScope()
+	{
+		if (_scopeIndex != NoScope)
+			Profiler::instance().endGpuScope(_scopeIndex);
+	}
+};
+
+
+#ifdef PROFILER_ENABLED
+
+#define PROFILER_CONCAT_IMPL(_Left, _Right) _Left##_Right
+#define PROFILER_CONCAT(_Left, _Right) PROFILER_CONCAT_IMPL(_Left, _Right)
+
+#define PROFILE_SCOPE(_Name) const Profiler::Scope PROFILER_CONCAT(__profileScope, __LINE__)(_Name)
+#define PROFILE_SCOPE_CATEGORY(_Name, _Category) const Profiler::Scope PROFILER_CONCAT(__profileScope, __LINE__)(_Name, _Category)
+#define PROFILE_GPU_SCOPE(_Name) const Profiler::GpuScope PROFILER_CONCAT(__profileGpuScope, __LINE__)(_Name)
+
+#else
+
+#define PROFILE_SCOPE(_Name) ((void) 0)
+#define PROFILE_SCOPE_CATEGORY(_Name, _Category) ((void) 0)
+#define PROFILE_GPU_SCOPE(_Name) ((void) 0)
+
+#endif
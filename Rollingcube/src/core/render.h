@@ -2,6 +2,7 @@
 
 #include "gl.h"
 #include "vertex_array.h"
+#include "frame_stats.h"
 
 
 namespace gl
@@ -14,7 +15,10 @@ namespace gl
 
 			const auto& attr = vao.getAttribute(vao.getVerticesAttributeId());
 			if (attr.getElementCount() > 0)
-				glDrawArrays(mode, first, attr.getElementCount());
+			{
+				backend().drawArrays(mode, first, attr.getElementCount());
+				FrameStats::instance().addDraw(mode, attr.getElementCount());
+			}
 		}
 	}
 
@@ -24,7 +28,8 @@ namespace gl
 		{
 			vao.bind();
 			ebo.bind();
-			glDrawElements(mode, ebo.getElementCount(), GL_UNSIGNED_INT, nullptr);
+			backend().drawElements(mode, ebo.getElementCount(), GL_UNSIGNED_INT, 0);
+			FrameStats::instance().addDraw(mode, ebo.getElementCount());
 		}
 	}
 }
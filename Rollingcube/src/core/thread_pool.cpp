@@ -0,0 +1,76 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+
+ThreadPool ThreadPool::Instance;
+
+
+ThreadPool::ThreadPool(std::size_t workerCount) :
+	_workers(),
+	_tasks(),
+	_mutex(),
+	_condition(),
+	_stop(false)
+{
+	_workers.reserve(workerCount);
+	for (std::size_t i = 0; i < workerCount; ++i)
+		_workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::scoped_lock lock(_mutex);
+		_stop = true;
+	}
+
+	_condition.notify_all();
+	for (auto& worker : _workers)
+		if (worker.joinable())
+			worker.join();
+}
+
+void ThreadPool::post(Task&& task)
+{
+	// Without workers the pool degrades to running everything on the caller thread //
+	if (_workers.empty())
+	{
+		task();
+		return;
+	}
+
+	{
+		std::scoped_lock lock(_mutex);
+		_tasks.push_back(std::move(task));
+	}
+	_condition.notify_one();
+}
+
+void ThreadPool::workerLoop()
+{
+	for (;;)
+	{
+		Task task;
+		{
+			std::unique_lock lock(_mutex);
+			_condition.wait(lock, [this]() { return _stop || !_tasks.empty(); });
+
+			if (_stop && _tasks.empty())
+				return;
+
+			task = std::move(_tasks.front());
+			_tasks.pop_front();
+		}
+
+		task();
+	}
+}
+
+std::size_t ThreadPool::getDefaultWorkerCount()
+{
+	const std::size_t hardware = std::size_t(std::thread::hardware_concurrency());
+
+	// Keep one core free for the main (GL) thread //
+	return hardware > 1 ? std::min<std::size_t>(hardware - 1, 8) : 1;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+#include <algorithm>
+
+
+class ThreadPool
+{
+public:
+	using Task = std::function<void()>;
+
+private:
+	static ThreadPool Instance;
+
+private:
+	std::vector<std::thread> _workers;
+	std::deque<Task> _tasks;
+	mutable std::mutex _mutex;
+	std::condition_variable _condition;
+	bool _stop = false;
+
+public:
+	explicit ThreadPool(std::size_t workerCount = getDefaultWorkerCount());
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool(ThreadPool&&) noexcept = delete;
+	~ThreadPool();
+
+	ThreadPool& operator= (const ThreadPool&) = delete;
+	ThreadPool& operator= (ThreadPool&&) noexcept = delete;
+
+public:
+	inline std::size_t getWorkerCount() const { return _workers.size(); }
+
+	void post(Task&& task);
+
+	template <typename _Fn, typename... _Args>
+	auto submit(_Fn&& fn, _Args&&... args) -> std::future<std::invoke_result_t<std::decay_t<_Fn>, std::decay_t<_Args>...>>
+	{
+		using ResultType = std::invoke_result_t<std::decay_t<_Fn>, std::decay_t<_Args>...>;
+
+		auto task = std::make_shared<std::packaged_task<ResultType()>>(
+			[fn = std::forward<_Fn>(fn), ...args = std::forward<_Args>(args)]() mutable -> ResultType {
+				return std::invoke(std::move(fn), std::move(args)...);
+			}
+		);
+
+		std::future<ResultType> result = task->get_future();
+		post([task = std::move(task)]() { (*task)(); });
+
+		return result;
+	}
+
+	// Splits [0, count) in contiguous ranges of at least minBatchSize elements and calls fn(begin, end) on each one.
+	// The caller thread takes the last range and waits for the others. Do not call it from a pool task //
+	template <typename _Fn>
+	void parallelFor(std::size_t count, std::size_t minBatchSize, _Fn&& fn)
+	{
+		const std::size_t maxBatches = _workers.size() + 1;
+		const std::size_t batches = std::min(maxBatches, std::max<std::size_t>(1, count / std::max<std::size_t>(1, minBatchSize)));
+		if (batches <= 1)
+		{
+			if (count > 0)
+				fn(std::size_t(0), count);
+			return;
+		}
+
+		const std::size_t batchSize = (count + batches - 1) / batches;
+
+		std::vector<std::future<void>> pending;
+		pending.reserve(batches - 1);
+		for (std::size_t begin = 0; begin + batchSize < count; begin += batchSize)
+			pending.push_back(submit([&fn, begin, end = begin + batchSize]() { fn(begin, end); }));
+
+		fn(pending.size() * batchSize, count);
+
+		for (auto& future : pending)
+			future.get();
+	}
+
+private:
+	void workerLoop();
+
+public:
+	static inline ThreadPool& instance() { return Instance; }
+
+	static std::size_t getDefaultWorkerCount();
+};
@@ -1,22 +1,62 @@
 #include "time.h"
 
+#include <cmath>
+#include <numeric>
+
+
+Time FrameTimeHistory::percentile(double p) const
+{
+	if (_size == 0)
+		return Time::zero();
+
+	if (!_sortedValid)
+	{
+		std::copy_n(_times.begin(), _size, _sorted.begin());
+		std::sort(_sorted.begin(), _sorted.begin() + _size);
+		_sortedValid = true;
+	}
+
+	const std::size_t rank = static_cast<std::size_t>(std::ceil(glm::clamp(p, 0.0, 1.0) * double(_size)));
+	return _sorted[std::clamp<std::size_t>(rank, 1, _size) - 1];
+}
+
+Time FrameTimeHistory::average() const
+{
+	if (_size == 0)
+		return Time::zero();
+
+	// Only the first _size slots were ever written while the ring is filling up //
+	return std::accumulate(_times.begin(), _times.begin() + _size, Time::zero()) / _size;
+}
+
+
+
+
 TimeController::TimeController() :
 	_frameClock(),
 	_secClock(),
 	_elapsedTime(),
 	_nbFrames(),
-	_fps()
+	_fps(),
+	_lowFps(),
+	_history()
 {}
 
 
 Time TimeController::update()
 {
-	Time currentTime = _secClock.getElapsedTime();
-	_elapsedTime = _frameClock.restart();
+	// One clock read per frame, both clocks are measured against it //
+	const Time now = Time::now();
+	const Time currentTime = now - _secClock.getStartTime();
+	_elapsedTime = _frameClock.restart(now);
+	_history.add(_elapsedTime);
 	_nbFrames++;
 	if (currentTime >= sec_mark)
 	{
-		_fps = static_cast<double>(static_cast<float>(_nbFrames) / currentTime.toSeconds());
+		_fps = double(_nbFrames) * 1000000000.0 / double(currentTime.toNanoseconds());
+
+		const Time slow = _history.percentile(low_percentile);
+		_lowFps = slow > Time::zero() ? 1000000000.0 / double(slow.toNanoseconds()) : 0.0;
 
 		_nbFrames = 0;
 		_secClock.restart(_secClock.getStartTime() + currentTime);
@@ -4,6 +4,8 @@
 #include <compare>
 #include <chrono>
 #include <concepts>
+#include <array>
+#include <algorithm>
 
 #include "gl.h"
 #include "math/glm.h"
@@ -11,13 +13,28 @@
 
 enum class TimeUnit
 {
-	seconds, milliseconds, microseconds,
+	seconds, milliseconds, microseconds, nanoseconds,
 
 	millis = milliseconds,
-	micros = microseconds
+	micros = microseconds,
+	nanos = nanoseconds
 };
 
 
+// Raw reading of the monotonic clock in nanoseconds, for code that only subtracts two of them, like the profiler //
+using Timestamp = std::uint64_t;
+
+namespace timestamp
+{
+	inline Timestamp now()
+	{
+		return static_cast<Timestamp>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+	constexpr double toMilliseconds(Timestamp time) { return static_cast<double>(time) / 1000000.0; }
+}
+
+
 class Time
 {
 public:
@@ -26,7 +43,7 @@ public:
 private:
 	using IntegerTimeUnit = std::int64_t;
 
-	IntegerTimeUnit _micros = 0;
+	IntegerTimeUnit _nanos = 0;
 
 public:
 	constexpr Time() noexcept = default;
@@ -41,9 +58,11 @@ public:
 	constexpr auto operator<=> (const Time&) const noexcept = default;
 
 
-	constexpr float toSeconds() const { return static_cast<float>(_micros) / 1000000.f; }
-	constexpr std::int64_t toMilliseconds() const { return _micros / 1000; }
-	constexpr std::int64_t toMicroseconds() const { return _micros; }
+	constexpr float toSeconds() const { return static_cast<float>(static_cast<double>(_nanos) / 1000000000.0); }
+	constexpr double toHighPrecisionSeconds() const { return static_cast<double>(_nanos) / 1000000000.0; }
+	constexpr std::int64_t toMilliseconds() const { return _nanos / 1000000; }
+	constexpr std::int64_t toMicroseconds() const { return _nanos / 1000; }
+	constexpr std::int64_t toNanoseconds() const { return _nanos; }
 
 	template <Unit _Unit>
 	constexpr auto to() const
@@ -52,34 +71,40 @@ public:
 			return toSeconds();
 		else if constexpr (_Unit == Unit::milliseconds)
 			return toMilliseconds();
-		else
+		else if constexpr (_Unit == Unit::microseconds)
 			return toMicroseconds();
+		else
+			return toNanoseconds();
 	}
 
 private:
-	constexpr explicit Time(IntegerTimeUnit micros) : _micros(micros) {}
+	constexpr explicit Time(IntegerTimeUnit nanos) : _nanos(nanos) {}
 
 public:
 	static constexpr Time zero() { return Time(); }
 
-	static inline Time now()
-	{
-		return Time(std::chrono::time_point_cast<std::chrono::microseconds>(std::chrono::system_clock::now()).time_since_epoch().count());
-	}
+	// Monotonic, only meaningful relative to another now() //
+	static inline Time now() { return Time(static_cast<IntegerTimeUnit>(timestamp::now())); }
+
+	static constexpr Time fromTimestamp(Timestamp time) { return Time(static_cast<IntegerTimeUnit>(time)); }
 
 	template <std::integral _Ty>
-	static constexpr Time seconds(_Ty amount) { return Time(static_cast<IntegerTimeUnit>(amount * 1000000LL)); }
+	static constexpr Time seconds(_Ty amount) { return Time(static_cast<IntegerTimeUnit>(amount * 1000000000LL)); }
 
 	template <std::floating_point _Ty>
-	static constexpr Time seconds(_Ty amount) { return Time(static_cast<IntegerTimeUnit>(amount * 1000000LL)); }
+	static constexpr Time seconds(_Ty amount) { return Time(static_cast<IntegerTimeUnit>(static_cast<double>(amount) * 1000000000.0)); }
 
 
 	template <std::integral _Ty>
-	static constexpr Time milliseconds(_Ty amount) { return Time(static_cast<IntegerTimeUnit>(amount * 1000LL)); }
+	static constexpr Time milliseconds(_Ty amount) { return Time(static_cast<IntegerTimeUnit>(amount * 1000000LL)); }
 
 
 	template <std::integral _Ty>
-	static constexpr Time microseconds(_Ty amount) { return Time(static_cast<IntegerTimeUnit>(amount)); }
+	static constexpr Time microseconds(_Ty amount) { return Time(static_cast<IntegerTimeUnit>(amount * 1000LL)); }
+
+
+	template <std::integral _Ty>
+	static constexpr Time nanoseconds(_Ty amount) { return Time(static_cast<IntegerTimeUnit>(amount)); }
 
 
 	template <Unit _Unit, std::integral _Ty>
@@ -89,8 +114,10 @@ public:
 			return seconds<_Ty>(amount);
 		else if constexpr (_Unit == Unit::milliseconds)
 			return milliseconds<_Ty>(amount);
-		else
+		else if constexpr (_Unit == Unit::microseconds)
 			return microseconds<_Ty>(amount);
+		else
+			return nanoseconds<_Ty>(amount);
 	}
 
 	template <Unit _Unit, std::floating_point _Ty>
@@ -100,41 +127,43 @@ public:
 			return seconds<_Ty>(amount);
 		else if constexpr (_Unit == Unit::milliseconds)
 			return milliseconds(static_cast<IntegerTimeUnit>(amount));
-		else
+		else if constexpr (_Unit == Unit::microseconds)
 			return microseconds(static_cast<IntegerTimeUnit>(amount));
+		else
+			return nanoseconds(static_cast<IntegerTimeUnit>(amount));
 	}
 
-	static constexpr Time max(Time left, Time right) { return Time(std::max(left._micros, right._micros)); }
-	static constexpr Time min(Time left, Time right) { return Time(std::min(left._micros, right._micros)); }
-	static constexpr Time clamp(Time value, Time min, Time max) { return Time(glm::clamp(value._micros, min._micros, max._micros)); }
+	static constexpr Time max(Time left, Time right) { return Time(std::max(left._nanos, right._nanos)); }
+	static constexpr Time min(Time left, Time right) { return Time(std::min(left._nanos, right._nanos)); }
+	static constexpr Time clamp(Time value, Time min, Time max) { return Time(glm::clamp(value._nanos, min._nanos, max._nanos)); }
 
 public:
-	friend constexpr Time operator+ (Time left, Time right) { return Time(left._micros + right._micros); }
-	friend constexpr Time& operator+= (Time& left, Time right) { return left._micros += right._micros, left; }
-
-	friend constexpr Time operator- (Time left, Time right) { return Time(left._micros - right._micros); }
-	friend constexpr Time& operator-= (Time& left, Time right) { return left._micros -= right._micros, left; }
-
-	template <std::floating_point _Ty> friend constexpr Time operator* (Time left, _Ty right) { return Time::seconds(static_cast<_Ty>(left.toSeconds()) * right); }
-	template <std::integral _Ty> friend constexpr Time operator* (Time left, _Ty right) { return Time(left._micros * static_cast<IntegerTimeUnit>(right)); }
-	template <std::floating_point _Ty> friend constexpr Time operator* (_Ty left, Time right) { return Time::seconds(static_cast<_Ty>(right.toSeconds()) * left); }
-	template <std::integral _Ty> friend constexpr Time operator* (_Ty left, Time right) { return Time(right._micros * static_cast<IntegerTimeUnit>(left)); }
-	friend constexpr Time operator* (Time left, Time right) { return Time(left._micros * right._micros); }
-	friend constexpr Time& operator*= (Time& left, Time right) { return left._micros *= right._micros, left; }
+	friend constexpr Time operator+ (Time left, Time right) { return Time(left._nanos + right._nanos); }
+	friend constexpr Time& operator+= (Time& left, Time right) { return left._nanos += right._nanos, left; }
+
+	friend constexpr Time operator- (Time left, Time right) { return Time(left._nanos - right._nanos); }
+	friend constexpr Time& operator-= (Time& left, Time right) { return left._nanos -= right._nanos, left; }
+
+	template <std::floating_point _Ty> friend constexpr Time operator* (Time left, _Ty right) { return Time::seconds(left.toHighPrecisionSeconds() * right); }
+	template <std::integral _Ty> friend constexpr Time operator* (Time left, _Ty right) { return Time(left._nanos * static_cast<IntegerTimeUnit>(right)); }
+	template <std::floating_point _Ty> friend constexpr Time operator* (_Ty left, Time right) { return Time::seconds(right.toHighPrecisionSeconds() * left); }
+	template <std::integral _Ty> friend constexpr Time operator* (_Ty left, Time right) { return Time(right._nanos * static_cast<IntegerTimeUnit>(left)); }
+	friend constexpr Time operator* (Time left, Time right) { return Time(left._nanos * right._nanos); }
+	friend constexpr Time& operator*= (Time& left, Time right) { return left._nanos *= right._nanos, left; }
 	template <std::floating_point _Ty> friend constexpr Time& operator*= (Time& left, _Ty right) { return left = left * right, left; }
 	template <std::integral _Ty> friend constexpr Time& operator*= (Time& left, _Ty right) { return left = left * right, left; }
 
-	template <std::floating_point _Ty> friend constexpr Time operator/ (Time left, _Ty right) { return Time::seconds(static_cast<_Ty>(left.toSeconds()) / right); }
-	template <std::integral _Ty> friend constexpr Time operator/ (Time left, _Ty right) { return Time(left._micros / static_cast<IntegerTimeUnit>(right)); }
-	template <std::floating_point _Ty> friend constexpr Time operator/ (_Ty left, Time right) { return Time::seconds(static_cast<_Ty>(right.toSeconds()) / left); }
-	template <std::integral _Ty> friend constexpr Time operator/ (_Ty left, Time right) { return Time(right._micros / static_cast<IntegerTimeUnit>(left)); }
-	friend constexpr Time operator/ (Time left, Time right) { return Time(left._micros / right._micros); }
-	friend constexpr Time& operator/= (Time& left, Time right) { return left._micros /= right._micros, left; }
+	template <std::floating_point _Ty> friend constexpr Time operator/ (Time left, _Ty right) { return Time::seconds(left.toHighPrecisionSeconds() / right); }
+	template <std::integral _Ty> friend constexpr Time operator/ (Time left, _Ty right) { return Time(left._nanos / static_cast<IntegerTimeUnit>(right)); }
+	template <std::floating_point _Ty> friend constexpr Time operator/ (_Ty left, Time right) { return Time::seconds(right.toHighPrecisionSeconds() / left); }
+	template <std::integral _Ty> friend constexpr Time operator/ (_Ty left, Time right) { return Time(right._nanos / static_cast<IntegerTimeUnit>(left)); }
+	friend constexpr Time operator/ (Time left, Time right) { return Time(left._nanos / right._nanos); }
+	friend constexpr Time& operator/= (Time& left, Time right) { return left._nanos /= right._nanos, left; }
 	template <std::floating_point _Ty> friend constexpr Time& operator/= (Time& left, _Ty right) { return left = left / right, left; }
 	template <std::integral _Ty> friend constexpr Time& operator/= (Time& left, _Ty right) { return left = left / right, left; }
 
-	friend constexpr Time operator% (Time left, Time right) { return Time(left._micros % right._micros); }
-	friend constexpr Time& operator%= (Time& left, Time right) { return left._micros %= right._micros, left; }
+	friend constexpr Time operator% (Time left, Time right) { return Time(left._nanos % right._nanos); }
+	friend constexpr Time& operator%= (Time& left, Time right) { return left._nanos %= right._nanos, left; }
 };
 
 
@@ -172,16 +201,74 @@ public:
 
 
 
+// Ring of the last frame times with order statistics over them //
+class FrameTimeHistory
+{
+public:
+	static constexpr std::size_t Capacity = 256;
+
+private:
+	std::array<Time, Capacity> _times = {};
+	std::size_t _next = 0;
+	std::size_t _size = 0;
+
+	mutable std::array<Time, Capacity> _sorted = {};
+	mutable bool _sortedValid = false;
+
+public:
+	FrameTimeHistory() = default;
+	FrameTimeHistory(const FrameTimeHistory&) = default;
+	FrameTimeHistory(FrameTimeHistory&&) noexcept = default;
+	~FrameTimeHistory() = default;
+
+	FrameTimeHistory& operator= (const FrameTimeHistory&) = default;
+	FrameTimeHistory& operator= (FrameTimeHistory&&) noexcept = default;
+
+public:
+	inline void add(Time frameTime)
+	{
+		_times[_next] = frameTime;
+		_next = (_next + 1) % Capacity;
+		_size = std::min(_size + 1, Capacity);
+		_sortedValid = false;
+	}
+
+	inline void clear()
+	{
+		_next = 0;
+		_size = 0;
+		_sortedValid = false;
+	}
+
+	constexpr std::size_t size() const { return _size; }
+	constexpr bool empty() const { return _size == 0; }
+
+	// Age 0 is the last frame added //
+	inline Time get(std::size_t age = 0) const { return age < _size ? _times[(_next + Capacity - 1 - age) % Capacity] : Time::zero(); }
+
+	// Nearest rank over the whole history, so the result is always a frame that happened. p in [0, 1] //
+	Time percentile(double p) const;
+
+	Time average() const;
+};
+
+
+
 class TimeController
 {
 private:
 	static constexpr Time sec_mark = Time::seconds(1);
 
+	// The slow frame the 1% low FPS is taken from //
+	static constexpr double low_percentile = 0.99;
+
 	Clock _frameClock;
 	Clock _secClock;
 	Time _elapsedTime;
 	unsigned int _nbFrames;
 	double _fps;
+	double _lowFps;
+	FrameTimeHistory _history;
 
 public:
 	TimeController(const TimeController&) = default;
@@ -201,4 +288,9 @@ public:
 	inline Time getElapsedTime() const { return _elapsedTime; }
 	inline double getHighPrecisionFPS() const { return _fps; }
 	inline unsigned int getFPS() const { return static_cast<unsigned int>(_fps + 0.5); }
+
+	// FPS of the slowest 1% of the recent frames, refreshed with the FPS once a second //
+	inline unsigned int getLowFPS() const { return static_cast<unsigned int>(_lowFps + 0.5); }
+
+	inline const FrameTimeHistory& getFrameTimeHistory() const { return _history; }
 };
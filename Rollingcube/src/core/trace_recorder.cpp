@@ -0,0 +1,297 @@
+#include "trace_recorder.h"
+
+#include <ctime>
+#include <fstream>
+#include <utility>
+#include <algorithm>
+#include <filesystem>
+
+#include "frame_stats.h"
+#include "engine/lua/module.h"
+#include "utils/lualib_constants.h"
+
+
+TraceRecorder TraceRecorder::Instance;
+
+
+namespace
+{
+	static constexpr std::string_view getCategoryName(ProfileCategory category)
+	{
+		switch (category)
+		{
+			case ProfileCategory::Scope: return "scope";
+			case ProfileCategory::Frame: return "frame";
+			case ProfileCategory::Asset: return "asset";
+			case ProfileCategory::Lua: return "lua";
+			case ProfileCategory::LuaGc: return "lua-gc";
+			case ProfileCategory::Wait: return "wait";
+
+			default: return "<unknown-category>";
+		}
+	}
+
+	static constexpr ProfileTimestamp toNanoseconds(double seconds) { return static_cast<ProfileTimestamp>(std::max(0.0, seconds) * 1000000000.0); }
+
+	static constexpr double toMicroseconds(ProfileTimestamp time) { return static_cast<double>(time) / 1000.0; }
+}
+
+
+void TraceRecorder::record(std::uint32_t thread, const std::vector<ProfileEvent>& events)
+{
+	for (const auto& event : events)
+		push({ event, thread });
+}
+
+void TraceRecorder::recordFrame(const ProfileFrame& frame, std::uint32_t thread)
+{
+	push({ { "Frame", frame.begin, frame.end, 0, ProfileCategory::Frame }, thread });
+
+	std::optional<double> seconds = std::exchange(_requestedDumpSeconds, std::nullopt);
+	if (!seconds && _hitchThreshold > 0 && frame.getDuration() > _hitchThreshold)
+	{
+		// Writing the trace is a hitch itself, so the next automatic dump waits for a whole new window //
+		if (_lastDumpTime == 0 || frame.end - _lastDumpTime > toNanoseconds(DefaultWindowSeconds))
+		{
+			logger::warn("Frame {} took {:.2f} ms, dumping the last {} seconds of trace.", frame.frameIndex, Profiler::toMilliseconds(frame.getDuration()), DefaultWindowSeconds);
+			seconds = DefaultWindowSeconds;
+		}
+	}
+
+	if (seconds)
+	{
+		dump(*seconds);
+		_lastDumpTime = Profiler::now();
+	}
+}
+
+void TraceRecorder::requestDump(double seconds)
+{
+	if (!_recording)
+	{
+		logger::warn("Trace recording was off, recording from now on. Request the dump again to write it.");
+		setRecording(true);
+		return;
+	}
+
+	_requestedDumpSeconds = seconds;
+}
+
+JsonValue TraceRecorder::toJson(double seconds) const
+{
+	JsonArray traceEvents;
+	traceEvents.reserve(_count + 8);
+
+	traceEvents.push_back({ { "name", "process_name" }, { "ph", "M" }, { "pid", 1 }, { "tid", 0 }, { "args", { { "name", "Rollingcube" } } } });
+
+	const auto threadNames = Profiler::instance().getThreadNames();
+	for (std::size_t i = 0; i < threadNames.size(); ++i)
+		traceEvents.push_back({ { "name", "thread_name" }, { "ph", "M" }, { "pid", 1 }, { "tid", i }, { "args", { { "name", threadNames[i] } } } });
+
+	const std::size_t first = _count > 0 ? (_next + _events.size() - _count) % _events.size() : 0;
+
+	ProfileTimestamp latest = 0;
+	for (std::size_t i = 0; i < _count; ++i)
+		latest = std::max(latest, _events[(first + i) % _events.size()].event.end);
+
+	const ProfileTimestamp window = toNanoseconds(seconds);
+	const ProfileTimestamp cutoff = latest > window ? latest - window : 0;
+
+	ProfileTimestamp origin = latest;
+	for (std::size_t i = 0; i < _count; ++i)
+	{
+		const auto& event = _events[(first + i) % _events.size()].event;
+		if (event.end >= cutoff)
+			origin = std::min(origin, event.begin);
+	}
+
+	for (std::size_t i = 0; i < _count; ++i)
+	{
+		const auto& trace = _events[(first + i) % _events.size()];
+		const auto& event = trace.event;
+		if (event.end < cutoff)
+			continue;
+
+		JsonValue json = {
+			{ "name", event.name },
+			{ "cat", getCategoryName(event.category) },
+			{ "pid", 1 },
+			{ "tid", trace.thread },
+			{ "ts", toMicroseconds(event.begin - origin) }
+		};
+
+		if (event.begin == event.end && event.category != ProfileCategory::Frame)
+		{
+			json["ph"] = "i";
+			json["s"] = "t";
+		}
+		else
+		{
+			json["ph"] = "X";
+			json["dur"] = toMicroseconds(event.end - event.begin);
+		}
+
+		traceEvents.push_back(std::move(json));
+	}
+
+	return {
+		{ "traceEvents", std::move(traceEvents) },
+		{ "displayTimeUnit", "ms" }
+	};
+}
+
+bool TraceRecorder::dump(double seconds)
+{
+	const auto filename = utils::str::format("trace_{}_{}.json", static_cast<std::int64_t>(std::time(nullptr)), Profiler::instance().getFrameIndex());
+	return dump(resources::traces / Path(filename), seconds);
+}
+
+bool TraceRecorder::dump(const Path& filepath, double seconds)
+{
+	PROFILE_SCOPE("TraceRecorder::dump");
+
+	std::error_code error;
+	std::filesystem::create_directories(Path(filepath).remove_filename(), error);
+
+	std::ofstream os(filepath);
+	if (!os)
+	{
+		logger::error("Cannot write trace file {}.", filepath.string());
+		return false;
+	}
+
+	json::write(os, toJson(seconds));
+	logger::warn("Trace written to {}.", filepath.string());
+	return true;
+}
+
+void TraceRecorder::setRecording(bool recording)
+{
+	if (recording && _events.empty())
+		_events.resize(DefaultCapacity);
+
+	_recording = recording;
+	if (!recording)
+	{
+		_requestedDumpSeconds.reset();
+		clear();
+	}
+}
+
+void TraceRecorder::setHitchThreshold(ProfileTimestamp threshold)
+{
+	_hitchThreshold = threshold;
+	if (threshold > 0)
+		setRecording(true);
+}
+
+void TraceRecorder::clear()
+{
+	_next = 0;
+	_count = 0;
+}
+
+void TraceRecorder::push(const TraceEvent& event)
+{
+	_events[_next] = event;
+	_next = (_next + 1) % _events.size();
+	_count = std::min(_count + 1, _events.size());
+}
+
+
+
+
+namespace
+{
+	static constexpr const char GcProbeMetatableName[] = "__TraceRecorderGcProbe";
+
+	// Constant initialized, so it stays readable while the Lua state is closed during static destruction //
+	static constinit bool gcProbeInstalled = false;
+
+	static int onGcProbeCollected(lua_State* state);
+
+	static void pushGcProbe(lua_State* state)
+	{
+		// Nothing references the probe, so the next finished cycle finalizes it //
+		lua_newuserdatauv(state, 1, 0);
+		luaL_setmetatable(state, GcProbeMetatableName);
+		lua_pop(state, 1);
+	}
+
+	static int onGcProbeCollected(lua_State* state)
+	{
+		if (gcProbeInstalled)
+		{
+			Profiler::instance().recordInstant("Lua GC cycle", ProfileCategory::LuaGc);
+			FrameStats::instance().add(FrameCounter::LuaGcCycles);
+			pushGcProbe(state);
+		}
+		return 0;
+	}
+}
+
+void TraceRecorder::installLuaGcProbe(lua_State* state)
+{
+	if (gcProbeInstalled)
+		return;
+
+	if (luaL_newmetatable(state, GcProbeMetatableName))
+	{
+		lua_pushcfunction(state, &onGcProbeCollected);
+		lua_setfield(state, -2, "__gc");
+	}
+	lua_pop(state, 1);
+
+	gcProbeInstalled = true;
+	pushGcProbe(state);
+}
+
+void TraceRecorder::uninstallLuaGcProbe()
+{
+	gcProbeInstalled = false;
+}
+
+
+
+
+namespace lua::lib
+{
+	namespace LUA_profiler { static defineLuaLibraryConstructor(registerToLua, root, state); }
+
+	void registerProfilerLibToLua()
+	{
+		LuaLibraryManager::instance().registerLibrary(
+			::lua::lib::names::profiler,
+			&LUA_profiler::registerToLua,
+			{}
+		);
+	}
+}
+
+namespace lua::lib::LUA_profiler
+{
+	static void dumpTrace(LuaRef seconds)
+	{
+		TraceRecorder::instance().requestDump(seconds.isNumber() ? seconds.cast<double>().value() : TraceRecorder::DefaultWindowSeconds);
+	}
+
+	static void setHitchThreshold(double milliseconds) { TraceRecorder::instance().setHitchThreshold(toNanoseconds(milliseconds / 1000.0)); }
+	static double getHitchThreshold() { return Profiler::toMilliseconds(TraceRecorder::instance().getHitchThreshold()); }
+
+	static void setTraceRecording(bool recording) { TraceRecorder::instance().setRecording(recording); }
+	static bool isTraceRecording() { return TraceRecorder::instance().isRecording(); }
+
+
+	static defineLuaLibraryConstructor(registerToLua, root, state)
+	{
+		root = root.beginNamespace("Profiler")
+				.addFunction("dumpTrace", &dumpTrace)
+				.addFunction("setHitchThreshold", &setHitchThreshold)
+				.addFunction("getHitchThreshold", &getHitchThreshold)
+				.addFunction("setTraceRecording", &setTraceRecording)
+				.addFunction("isTraceRecording", &isTraceRecording)
+			.endNamespace();
+
+		return true;
+	}
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <optional>
+
+#include "profiler.h"
+#include "utils/json.h"
+#include "utils/resources.h"
+
+
+struct lua_State;
+
+namespace lua::lib { void registerProfilerLibToLua(); }
+
+
+struct TraceEvent
+{
+	ProfileEvent event;
+	std::uint32_t thread = 0;
+};
+
+
+// Keeps the most recent profiler events in a ring and writes them as Chrome Trace Event JSON,
+// which loads in chrome://tracing and ui.perfetto.dev. Everything here runs on the GL thread.
+// Off by default, the ring is only allocated once recording is turned on or a hitch threshold is set //
+class TraceRecorder
+{
+public:
+	static constexpr std::size_t DefaultCapacity = 1 << 17;
+	static constexpr double DefaultWindowSeconds = 10.0;
+
+private:
+	static TraceRecorder Instance;
+
+private:
+	bool _recording = false;
+
+	std::vector<TraceEvent> _events;
+	std::size_t _next = 0;
+	std::size_t _count = 0;
+
+	ProfileTimestamp _hitchThreshold = 0;
+	ProfileTimestamp _lastDumpTime = 0;
+	std::optional<double> _requestedDumpSeconds;
+
+public:
+	TraceRecorder(const TraceRecorder&) = delete;
+	TraceRecorder(TraceRecorder&&) noexcept = delete;
+	~TraceRecorder() = default;
+
+	TraceRecorder& operator= (const TraceRecorder&) = delete;
+	TraceRecorder& operator= (TraceRecorder&&) noexcept = delete;
+
+private:
+	TraceRecorder() = default;
+
+public:
+	void record(std::uint32_t thread, const std::vector<ProfileEvent>& events);
+
+	// Frame boundaries go on the recording thread track, then pending and hitch triggered dumps are written //
+	void recordFrame(const ProfileFrame& frame, std::uint32_t thread);
+
+	// The dump is written at the end of the current frame, so the frame that asked for it is included.
+	// Without recording there is nothing to write, it starts recording for the next request instead //
+	void requestDump(double seconds = DefaultWindowSeconds);
+
+	JsonValue toJson(double seconds = DefaultWindowSeconds) const;
+	bool dump(double seconds = DefaultWindowSeconds);
+	bool dump(const Path& filepath, double seconds = DefaultWindowSeconds);
+
+	void clear();
+
+	// Emits an instant event each time the collector finishes a cycle on the given state //
+	void installLuaGcProbe(lua_State* state);
+	void uninstallLuaGcProbe();
+
+public:
+	constexpr bool isRecording() const { return _recording; }
+	void setRecording(bool recording);
+
+	// Frames longer than the threshold dump the last DefaultWindowSeconds automatically, zero disables it.
+	// A threshold turns recording on, disabling it leaves recording as it is //
+	void setHitchThreshold(ProfileTimestamp threshold);
+	constexpr ProfileTimestamp getHitchThreshold() const { return _hitchThreshold; }
+
+	constexpr std::size_t getEventCount() const { return _count; }
+
+public:
+	static constexpr TraceRecorder& instance() { return Instance; }
+
+private:
+	void push(const TraceEvent& event);
+};
@@ -0,0 +1,257 @@
+#include "upload_queue.h"
+
+#include <algorithm>
+
+#include "window.h"
+#include "profiler.h"
+
+
+namespace gl
+{
+	UploadQueue UploadQueue::Instance;
+
+
+	UploadQueue::MpscQueue::MpscQueue() :
+		_head(new Node()),
+		_tail(_head.load(std::memory_order_relaxed))
+	{}
+
+	UploadQueue::MpscQueue::~MpscQueue()
+	{
+		while (_tail != nullptr)
+		{
+			Node* next = _tail->next.load(std::memory_order_relaxed);
+			delete _tail;
+			_tail = next;
+		}
+	}
+
+	void UploadQueue::MpscQueue::push(Item&& item)
+	{
+		Node* node = new Node();
+		node->item = std::move(item);
+
+		Node* previous = _head.exchange(node, std::memory_order_acq_rel);
+		previous->next.store(node, std::memory_order_release);
+	}
+
+	bool UploadQueue::MpscQueue::pop(Item& item)
+	{
+		// Empty, or a producer swapped the head but has not linked its node yet //
+		Node* next = _tail->next.load(std::memory_order_acquire);
+		if (next == nullptr)
+			return false;
+
+		// The popped node becomes the new stub //
+		item = std::move(next->item);
+		next->item = {};
+		delete _tail;
+		_tail = next;
+		return true;
+	}
+
+
+
+
+	UploadQueue::~UploadQueue()
+	{
+		// gl::terminate stops it first, this only keeps a forgotten thread from terminating the process //
+		if (_uploadThread.joinable())
+		{
+			_stop.store(true);
+			_uploadSignal.release();
+			_uploadThread.join();
+		}
+	}
+
+	UploadQueue::TicketRef UploadQueue::push(Work&& work, Completion&& completion, UploadTarget target)
+	{
+		TicketRef ticket = std::make_shared<UploadTicket>();
+		Item item = { std::move(work), std::move(completion), ticket };
+
+		if (target == UploadTarget::Any && isUploadThreadRunning())
+		{
+			// Counted before it is visible, the upload thread takes a signal with no pending work as the stop //
+			_uploadPending.fetch_add(1, std::memory_order_acq_rel);
+			_uploadQueue.push(std::move(item));
+			_uploadSignal.release();
+		}
+		else
+			_renderQueue.push(std::move(item));
+
+		return ticket;
+	}
+
+	void UploadQueue::drain()
+	{
+		PROFILE_SCOPE("gl::UploadQueue::drain");
+
+		retireFences(false);
+
+		const Timestamp deadline = timestamp::now() + Timestamp(std::max<std::int64_t>(_budget.toNanoseconds(), 0));
+		Item item;
+		do
+		{
+			if (!popRenderItem(item))
+				break;
+
+			item.work();
+			complete(item);
+		} while (timestamp::now() < deadline);
+	}
+
+	void UploadQueue::flush()
+	{
+		PROFILE_SCOPE_CATEGORY("gl::UploadQueue::flush", ProfileCategory::Wait);
+
+		while (isUploadThreadRunning() && _uploadPending.load(std::memory_order_acquire) > 0)
+		{
+			retireFences(false);
+			std::this_thread::yield();
+		}
+		retireFences(true);
+
+		Item item;
+		while (popRenderItem(item))
+		{
+			item.work();
+			complete(item);
+		}
+	}
+
+	bool UploadQueue::startUploadThread()
+	{
+		if (isUploadThreadRunning())
+			return true;
+
+		GLFWwindow* mainWindow = window::getMainWindow();
+		if (mainWindow == nullptr)
+		{
+			logger::error("The GL upload thread needs the main window.");
+			return false;
+		}
+
+		// Same hints as the main window, so the contexts can share their objects //
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		_uploadWindow = glfwCreateWindow(1, 1, "Rollingcube upload", nullptr, mainWindow);
+		glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+
+		if (_uploadWindow == nullptr)
+		{
+			logger::warn("Cannot create the shared GL upload context, uploads stay on the render thread.");
+			return false;
+		}
+
+		_stop.store(false);
+		_uploadThread = std::thread(&UploadQueue::uploadLoop, this);
+		_uploadThreadRunning.store(true, std::memory_order_release);
+		return true;
+	}
+
+	void UploadQueue::stopUploadThread()
+	{
+		if (!_uploadThread.joinable())
+			return;
+
+		// It runs whatever is still queued before it leaves //
+		_stop.store(true);
+		_uploadSignal.release();
+		_uploadThread.join();
+
+		_uploadThreadRunning.store(false, std::memory_order_release);
+		retireFences(true);
+
+		glfwDestroyWindow(_uploadWindow);
+		_uploadWindow = nullptr;
+	}
+
+	void UploadQueue::uploadLoop()
+	{
+		glfwMakeContextCurrent(_uploadWindow);
+		Profiler::instance().setThreadName("GL upload");
+
+		Item item;
+		for (;;)
+		{
+			_uploadSignal.acquire();
+			if (_uploadPending.load(std::memory_order_acquire) == 0)
+			{
+				if (_stop.load())
+					break;
+				continue;
+			}
+
+			// Its signal may come before the link of an earlier producer, the node shows up shortly //
+			while (!_uploadQueue.pop(item))
+				std::this_thread::yield();
+
+			{
+				PROFILE_SCOPE("gl::UploadQueue::upload");
+				item.work();
+			}
+
+			// Flushed, otherwise the render thread could wait on a fence that never reaches the GPU //
+			item.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			glFlush();
+
+			item.ticket->_state.store(UploadState::Submitted, std::memory_order_release);
+			_fencedQueue.push(std::move(item));
+			item = {};
+			_uploadPending.fetch_sub(1, std::memory_order_acq_rel);
+		}
+
+		glfwMakeContextCurrent(nullptr);
+	}
+
+	void UploadQueue::retireFences(bool wait)
+	{
+		static constexpr GLuint64 WaitStepNanoseconds = 100'000'000;
+
+		Item item;
+		while (_fencedQueue.pop(item))
+			_inFlight.push_back(std::move(item));
+
+		// Fences of one context signal in order, the first one still pending holds back the rest //
+		while (!_inFlight.empty())
+		{
+			Item& front = _inFlight.front();
+
+			GLenum status = glClientWaitSync(front.fence, 0, wait ? WaitStepNanoseconds : 0);
+			while (wait && status == GL_TIMEOUT_EXPIRED)
+				status = glClientWaitSync(front.fence, 0, WaitStepNanoseconds);
+
+			if (status == GL_TIMEOUT_EXPIRED)
+				break;
+			if (status == GL_WAIT_FAILED)
+				logger::error("Wait on a GL upload fence failed, its upload is considered done.");
+
+			glDeleteSync(front.fence);
+			front.fence = nullptr;
+			complete(front);
+			_inFlight.pop_front();
+		}
+	}
+
+	bool UploadQueue::popRenderItem(Item& item)
+	{
+		if (_renderQueue.pop(item))
+			return true;
+
+		// Pushed while the upload thread was stopping, it is joined so this thread is the only consumer now //
+		if (!isUploadThreadRunning() && _uploadQueue.pop(item))
+		{
+			_uploadPending.fetch_sub(1, std::memory_order_acq_rel);
+			return true;
+		}
+
+		return false;
+	}
+
+	void UploadQueue::complete(Item& item)
+	{
+		item.ticket->_state.store(UploadState::Done, std::memory_order_release);
+		if (item.completion)
+			item.completion();
+		item = {};
+	}
+}
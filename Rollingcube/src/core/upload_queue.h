@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <deque>
+#include <thread>
+#include <semaphore>
+#include <functional>
+
+#include "gl.h"
+#include "time.h"
+
+
+namespace gl
+{
+	enum class UploadTarget : std::uint8_t
+	{
+		Any,			// The upload thread when it runs, the render thread otherwise
+		RenderThread	// Container objects (VAOs, framebuffers) are not shared between contexts
+	};
+
+	enum class UploadState : std::uint8_t
+	{
+		Queued,
+		Submitted,	// Issued on the upload context, waiting for its fence
+		Done
+	};
+
+
+	// Shared between the queue and whoever waits for an upload. Done means the objects it wrote are usable from
+	// the render thread //
+	class UploadTicket
+	{
+	public:
+		friend class UploadQueue;
+
+	private:
+		std::atomic<UploadState> _state = UploadState::Queued;
+
+	public:
+		UploadTicket() = default;
+		UploadTicket(const UploadTicket&) = delete;
+		UploadTicket(UploadTicket&&) noexcept = delete;
+		~UploadTicket() = default;
+
+		UploadTicket& operator= (const UploadTicket&) = delete;
+		UploadTicket& operator= (UploadTicket&&) noexcept = delete;
+
+	public:
+		inline UploadState getState() const { return _state.load(std::memory_order_acquire); }
+		inline bool isDone() const { return getState() == UploadState::Done; }
+	};
+
+
+	/*
+		GL work handed over from any thread. Items wait in lock-free MPSC queues: the render thread drains its own
+		with a time budget every frame, and an optional upload thread owns a hidden context shared with the main
+		window and drains the other one as it fills. Work done there is followed by a fence, the render thread
+		polls them in order and only then marks the ticket done and runs the completion, so callbacks that put the
+		result into a Manager always run on the render thread, after the data is visible to it.
+	*/
+	class UploadQueue
+	{
+	public:
+		using Work = std::function<void()>;
+		using Completion = std::function<void()>;
+		using TicketRef = std::shared_ptr<UploadTicket>;
+
+		static constexpr Time DefaultBudget = Time::milliseconds(2);
+
+	private:
+		struct Item
+		{
+			Work work;
+			Completion completion;
+			TicketRef ticket;
+			GLsync fence = nullptr;
+		};
+
+		struct Node
+		{
+			std::atomic<Node*> next = nullptr;
+			Item item;
+		};
+
+		// Vyukov's intrusive queue: producers swap the head, the single consumer follows next from a stub tail //
+		class MpscQueue
+		{
+		private:
+			alignas(64) std::atomic<Node*> _head;
+			alignas(64) Node* _tail;
+
+		public:
+			MpscQueue();
+			MpscQueue(const MpscQueue&) = delete;
+			MpscQueue(MpscQueue&&) noexcept = delete;
+			~MpscQueue();
+
+			MpscQueue& operator= (const MpscQueue&) = delete;
+			MpscQueue& operator= (MpscQueue&&) noexcept = delete;
+
+		public:
+			// Any thread //
+			void push(Item&& item);
+
+			// Consumer only //
+			bool pop(Item& item);
+		};
+
+	private:
+		static UploadQueue Instance;
+
+	private:
+		MpscQueue _renderQueue;
+		MpscQueue _uploadQueue;
+		MpscQueue _fencedQueue; // Done on the upload thread, waiting for their fence
+		std::deque<Item> _inFlight;
+
+		Time _budget = DefaultBudget;
+
+		GLFWwindow* _uploadWindow = nullptr;
+		std::thread _uploadThread;
+		std::counting_semaphore<> _uploadSignal{ 0 };
+		std::atomic<std::uint32_t> _uploadPending = 0;
+		std::atomic<bool> _uploadThreadRunning = false;
+		std::atomic<bool> _stop = false;
+
+	public:
+		UploadQueue(const UploadQueue&) = delete;
+		UploadQueue(UploadQueue&&) noexcept = delete;
+
+		UploadQueue& operator= (const UploadQueue&) = delete;
+		UploadQueue& operator= (UploadQueue&&) noexcept = delete;
+
+	private:
+		UploadQueue() = default;
+		~UploadQueue();
+
+	public:
+		// Any thread. The completion runs on the render thread once the work is visible there //
+		TicketRef push(Work&& work, Completion&& completion = {}, UploadTarget target = UploadTarget::Any);
+
+		// Render thread. Runs queued work until the budget is spent, at least one item so the queue always moves,
+		// and retires the upload thread fences that already signaled //
+		void drain();
+
+		// Render thread. Runs everything queued and waits for the upload thread to go idle //
+		void flush();
+
+		constexpr void setBudget(Time budget) { _budget = budget; }
+		constexpr Time getBudget() const { return _budget; }
+
+		// Main thread, after the main window exists //
+		bool startUploadThread();
+		void stopUploadThread();
+
+		inline bool isUploadThreadRunning() const { return _uploadThreadRunning.load(std::memory_order_acquire); }
+
+	public:
+		static constexpr UploadQueue& instance() { return Instance; }
+
+	private:
+		void uploadLoop();
+		void retireFences(bool wait);
+
+		// Render thread, also takes what was pushed for an upload thread that is gone //
+		bool popRenderItem(Item& item);
+
+		static void complete(Item& item);
+	};
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "vertex_buffers.h"
+#include "vertex_format.h"
 
 #include <unordered_map>
 
@@ -36,6 +37,7 @@ namespace gl
 		SizeType _stride = 0;
 		GLboolean _normalized = GL_FALSE;
 		bool _enabled = false;
+		SizeType _elementCount = 0;
 		VBO _vbo = {};
 
 	public:
@@ -52,7 +54,7 @@ namespace gl
 		constexpr DataType getDataType() const { return _type; }
 		constexpr SizeType getStride() const { return _stride; }
 		constexpr GLboolean isNormalized() const { return _normalized; }
-		constexpr SizeType getElementCount() const { return _vbo.getElementCount(); }
+		constexpr SizeType getElementCount() const { return _vbo.isCreated() ? _vbo.getElementCount() : _elementCount; }
 		constexpr const VBO& getVertexBufferObject() const { return _vbo; }
 
 		constexpr operator bool() const { return _enabled; }
@@ -66,6 +68,7 @@ namespace gl
 			_stride = 0;
 			_normalized = GL_FALSE;
 			_enabled = false;
+			_elementCount = 0;
 			_vbo.destroy();
 		}
 
@@ -76,6 +79,7 @@ namespace gl
 			_stride = stride;
 			_normalized = normalized;
 			_enabled = false;
+			_elementCount = 0;
 			_vbo = std::move(vbo);
 		}
 
@@ -95,6 +99,7 @@ namespace gl
 		Id _id = 0;
 		std::unordered_map<Attribute::Id, Attribute> _attributes;
 		Attribute::Id _verticesAttributeId = 0;
+		VBO _interleavedBuffer = {};
 
 	public:
 		VertexArrayObject() = default;
@@ -122,10 +127,14 @@ namespace gl
 
 		inline const Attribute& operator[] (Attribute::Id id) const { return _attributes.at(id); }
 
+		inline bool hasInterleavedBuffer() const { return _interleavedBuffer.isCreated(); }
+		inline VBO& getInterleavedBuffer() { return _interleavedBuffer; }
+		inline const VBO& getInterleavedBuffer() const { return _interleavedBuffer; }
+
 		inline bool create()
 		{
 			if (!isCreated())
-				glGenVertexArrays(1, &_id);
+				_id = backend().genVertexArray();
 
 			return isCreated();
 		}
@@ -133,21 +142,22 @@ namespace gl
 		inline void destroy()
 		{
 			if (isCreated())
-				glDeleteVertexArrays(1, &_id);
+				backend().deleteVertexArray(_id);
 
 			_id = 0;
 			_attributes.clear();
+			_interleavedBuffer.destroy();
 		}
 
-		inline void bind() const { glBindVertexArray(_id); }
-		inline void unbind() const { glBindVertexArray(0); }
+		inline void bind() const { backend().bindVertexArray(_id); }
+		inline void unbind() const { backend().bindVertexArray(0); }
 
 		inline void enableAttribute(Attribute::Id id)
 		{
 			if (isCreated() && hasAttribute(id))
 			{
 				bind();
-				glEnableVertexAttribArray(id);
+				backend().enableVertexAttribArray(id);
 				_attributes.at(id).enable();
 				unbind();
 			}
@@ -158,7 +168,7 @@ namespace gl
 			if (isCreated() && hasAttribute(id))
 			{
 				bind();
-				glDisableVertexAttribArray(id);
+				backend().disableVertexAttribArray(id);
 				_attributes.at(id).disable();
 				unbind();
 			}
@@ -185,10 +195,10 @@ namespace gl
 			attr.set(componentCount, attributeDataType, stride, normalized, std::move(vertexBufferObject));
 
 			attr._vbo.bind();
-			glVertexAttribPointer(attributeId, GLint(componentCount), GLenum(attributeDataType), normalized, stride, reinterpret_cast<void*>(offset));
+			backend().vertexAttribPointer(attributeId, GLint(componentCount), GLenum(attributeDataType), normalized, stride, offset);
 			if (enableOnCreate)
 			{
-				glEnableVertexAttribArray(attributeId);
+				backend().enableVertexAttribArray(attributeId);
 				attr.enable();
 			}
 			attr._vbo.unbind();
@@ -310,5 +320,61 @@ namespace gl
 				createIfNot
 			);
 		}
+
+		inline bool createInterleavedAttributes(
+			const VertexFormat& format,
+			VBO&& vertexBufferObject,
+			bool enableOnCreate = true,
+			bool createIfNot = true
+		) {
+			if ((!createIfNot && !isCreated()) || (createIfNot && !create()) || !vertexBufferObject.isCreated() || format.getStride() <= 0)
+				return false;
+
+			bind();
+
+			_interleavedBuffer = std::move(vertexBufferObject);
+			_interleavedBuffer.bind();
+
+			const Attribute::SizeType vertexCount = Attribute::SizeType(_interleavedBuffer.size() / format.getStride());
+			for (const auto& attrFormat : format.getAttributes())
+			{
+				Attribute& attr = _attributes[attrFormat.index];
+				attr.set(to_component_count(attrFormat.componentCount), attrFormat.type, format.getStride(), attrFormat.normalized, {});
+				attr._elementCount = vertexCount;
+
+				backend().vertexAttribPointer(
+					attrFormat.index,
+					attrFormat.componentCount,
+					GLenum(attrFormat.type),
+					attrFormat.normalized,
+					format.getStride(),
+					GLsizeiptr(attrFormat.offset)
+				);
+				if (enableOnCreate)
+				{
+					backend().enableVertexAttribArray(attrFormat.index);
+					attr.enable();
+				}
+			}
+
+			_interleavedBuffer.unbind();
+
+			unbind();
+
+			return true;
+		}
+
+		inline bool createInterleavedAttributes(
+			const VertexFormat& format,
+			const void* data,
+			std::size_t vertexCount,
+			VBO::Usage usage,
+			bool enableOnCreate = true,
+			bool createIfNot = true
+		) {
+			VBO vbo;
+			vbo.write(data, std::size_t(format.getStride()), vertexCount, usage, true, true);
+			return createInterleavedAttributes(format, std::move(vbo), enableOnCreate, createIfNot);
+		}
 	};
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "gl.h"
+#include "gl_backend.h"
+#include "frame_stats.h"
 
 #include <utility>
 #include <memory>
@@ -103,7 +105,7 @@ namespace gl
 		inline bool create()
 		{
 			if (!isCreated())
-				glGenBuffers(1, &_id);
+				_id = backend().genBuffer();
 
 			return isCreated();
 		}
@@ -111,14 +113,14 @@ namespace gl
 		inline void destroy()
 		{
 			if (isCreated())
-				glDeleteBuffers(1, &_id);
+				backend().deleteBuffer(_id);
 
 			_id = 0;
 			_size = 0;
 		}
 
-		inline void bind() const { glBindBuffer(static_cast<GLenum>(_Type), _id); }
-		inline void unbind() const { glBindBuffer(static_cast<GLenum>(_Type), 0); }
+		inline void bind() const { backend().bindBuffer(static_cast<GLenum>(_Type), _id); }
+		inline void unbind() const { backend().bindBuffer(static_cast<GLenum>(_Type), 0); }
 
 		inline bool write(const void* data, std::size_t dataTypeSize, std::size_t count, Usage usage, bool createIfNot = true, bool unbindOnEnd = true)
 		{
@@ -126,7 +128,8 @@ namespace gl
 				return false;
 
 			bind();
-			glBufferData(static_cast<GLenum>(_Type), SizeType(dataTypeSize * count), data, static_cast<GLenum>(usage));
+			backend().bufferData(static_cast<GLenum>(_Type), SizeType(dataTypeSize * count), data, static_cast<GLenum>(usage));
+			FrameStats::instance().add(FrameCounter::UploadedBytes, data != nullptr ? dataTypeSize * count : 0);
 			_size = SizeType(dataTypeSize * count);
 			_elementCount = GLsizei(count);
 			if (unbindOnEnd)
@@ -150,5 +153,18 @@ namespace gl
 		{
 			return write(data.data(), 1, data.size(), usage, createIfNot, unbindOnEnd);
 		}
+
+		inline bool update(const void* data, std::size_t offset, std::size_t size, bool unbindOnEnd = true)
+		{
+			if (!isCreated() || SizeType(offset + size) > _size)
+				return false;
+
+			bind();
+			backend().bufferSubData(static_cast<GLenum>(_Type), GLintptr(offset), SizeType(size), data);
+			FrameStats::instance().add(FrameCounter::UploadedBytes, size);
+			if (unbindOnEnd)
+				unbind();
+			return true;
+		}
 	};
 }
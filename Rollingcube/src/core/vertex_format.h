@@ -0,0 +1,102 @@
+#pragma once
+
+#include "gl.h"
+
+#include <vector>
+#include <algorithm>
+
+
+namespace gl
+{
+	constexpr GLsizei data_type_size(DataType type, GLint componentCount)
+	{
+		switch (type)
+		{
+			case DataType::Byte:
+			case DataType::UnsignedByte:
+				return GLsizei(componentCount);
+
+			case DataType::Short:
+			case DataType::UnsignedShort:
+			case DataType::HalfFloat:
+				return GLsizei(componentCount * 2);
+
+			case DataType::Int:
+			case DataType::UnsignedInt:
+			case DataType::Float:
+			case DataType::Fixed:
+				return GLsizei(componentCount * 4);
+
+			case DataType::Double:
+				return GLsizei(componentCount * 8);
+
+			case DataType::Int_2_10_10_10_rev:
+			case DataType::UnsignedInt_2_10_10_10_rev:
+			case DataType::UnsignedInt_10f_11f_11f_rev:
+				return 4;
+
+			default:
+				return 0;
+		}
+	}
+
+
+	struct VertexAttributeFormat
+	{
+		GLuint index = 0;
+		GLint componentCount = 0;
+		DataType type = DataType::Float;
+		GLboolean normalized = GL_FALSE;
+		GLsizei offset = 0;
+
+		constexpr GLsizei size() const { return data_type_size(type, componentCount); }
+
+		constexpr bool operator== (const VertexAttributeFormat&) const = default;
+	};
+
+
+	class VertexFormat
+	{
+	private:
+		std::vector<VertexAttributeFormat> _attributes;
+		GLsizei _stride = 0;
+
+	public:
+		VertexFormat() = default;
+		VertexFormat(const VertexFormat&) = default;
+		VertexFormat(VertexFormat&&) noexcept = default;
+		~VertexFormat() = default;
+
+		VertexFormat& operator= (const VertexFormat&) = default;
+		VertexFormat& operator= (VertexFormat&&) noexcept = default;
+
+		bool operator== (const VertexFormat&) const = default;
+
+	public:
+		inline bool empty() const { return _attributes.empty(); }
+		inline GLsizei getStride() const { return _stride; }
+		inline const std::vector<VertexAttributeFormat>& getAttributes() const { return _attributes; }
+
+		inline VertexFormat& add(GLuint index, GLint componentCount, DataType type, GLboolean normalized = GL_FALSE)
+		{
+			VertexAttributeFormat attr = { index, componentCount, type, normalized, _stride };
+			_attributes.push_back(attr);
+			_stride += attr.size();
+			return *this;
+		}
+
+		inline const VertexAttributeFormat* find(GLuint index) const
+		{
+			auto it = std::find_if(_attributes.begin(), _attributes.end(), [index](const VertexAttributeFormat& attr) { return attr.index == index; });
+			return it == _attributes.end() ? nullptr : std::addressof(*it);
+		}
+
+		inline bool has(GLuint index) const { return find(index) != nullptr; }
+
+		inline void clear()
+		{
+			_attributes.clear();
+			_stride = 0;
+		}
+	};
+}
@@ -1,18 +1,25 @@
 #include "window.h"
 
 #include <iostream>
-#include <sstream>
+#include <format>
+#include <string>
+
+#include "profiler.h"
+#include "upload_queue.h"
 
 
 namespace window
 {
 	static GLFWwindow* mainw = nullptr;
+	static FramePacer pacer;
 }
 
 namespace window
 {
 	GLFWwindow* getMainWindow() { return mainw; }
 
+	FramePacer& getFramePacer() { return pacer; }
+
 	Dimension getMainWindowSize()
 	{
 		Dimension dim;
@@ -44,9 +51,10 @@ namespace window
 
 			glEnable(GL_CULL_FACE);
 
-			//glfwSwapInterval(1);
-
 			glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+
+			Profiler::instance().setThreadName("Main");
+			Profiler::instance().setGpuTimingEnabled(true);
 		}
 
 		return true;
@@ -55,20 +63,42 @@ namespace window
 	void simpleLoop(bool terminateOnEnd, const std::function<void(Time)>& drawFunction, const std::function<void(const TimeController&)>& endDrawFunction)
 	{
 		TimeController timeController;
+		std::string title;
+		unsigned int titleFps = ~0u, titleLowFps = ~0u;
 		do
 		{
-			Time elapsedTime = timeController.update();
-			std::stringstream ss;
-			ss << "Rollingcube " << timeController.getFPS() << "fps";
-			glfwSetWindowTitle(getMainWindow(), ss.str().c_str());
+			Profiler::instance().beginFrame();
 
+			Time elapsedTime = pacer.smooth(timeController.update());
+
+			// The FPS only changes once a second, the title is left alone in between //
+			if (timeController.getFPS() != titleFps || timeController.getLowFPS() != titleLowFps)
+			{
+				titleFps = timeController.getFPS();
+				titleLowFps = timeController.getLowFPS();
+				title = std::format("Rollingcube {}fps (1% low {})", titleFps, titleLowFps);
+				glfwSetWindowTitle(getMainWindow(), title.c_str());
+			}
+
+			gl::UploadQueue::instance().drain();
 			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-			drawFunction(elapsedTime);
-			endDrawFunction(timeController);
+			{
+				PROFILE_SCOPE("Draw");
+				PROFILE_GPU_SCOPE("Draw");
+				drawFunction(elapsedTime);
+				endDrawFunction(timeController);
+			}
 
-			glfwSwapBuffers(mainw);
+			pacer.wait();
+			{
+				PROFILE_SCOPE_CATEGORY("SwapBuffers", ProfileCategory::Wait);
+				glfwSwapBuffers(mainw);
+			}
+			pacer.presented();
 			glfwPollEvents();
+
+			Profiler::instance().endFrame();
 		} while (glfwGetKey(mainw, GLFW_KEY_ESCAPE) != GLFW_PRESS && !glfwWindowShouldClose(mainw));
 
 		if (terminateOnEnd)
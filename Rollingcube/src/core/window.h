@@ -4,6 +4,7 @@
 
 #include "gl.h"
 #include "time.h"
+#include "frame_pacer.h"
 
 
 namespace window
@@ -24,6 +25,9 @@ namespace window
 
 	GLFWwindow* getMainWindow();
 
+	// Paces the swaps of the main window, the loops call it around glfwSwapBuffers //
+	FramePacer& getFramePacer();
+
 	Dimension getMainWindowSize();
 
 	bool createMainWindow(const Dimension& windowSize);
@@ -1,29 +1,71 @@
 #include "basics.h"
 
 
-const glm::mat4& Transformable::getModelMatrix() const
+void Transformable::updateMatrices() const
 {
-	if (_modelNeedUpdate)
-	{
-		glm::mat4 translate = glm::translate(_position);
-		glm::mat4 rotate = glm::toMat4(glm::quat(glm::radians(_rotation)));
-		glm::mat4 scale = glm::scale(_scale);
+	if (_modelVersion != _changeVersion)
+		updateModelMatrix();
+	if (_invertedModelVersion != _changeVersion)
+		updateInvertedModelMatrix();
+}
 
-		_modelMatrix = translate * rotate * scale;
+void Transformable::showPose(const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale)
+{
+	_position = position;
+	_rotation = glm::utils::normalizeRange(rotation, -360, 360);
+	_scale = glm::max(scale, { 0, 0, 0 });
 
-		_modelNeedUpdate = false;
-	}
+	updateModelMatrix();
+	updateInvertedModelMatrix();
+}
+
+void Transformable::restoreSnapshot(const Snapshot& snapshot)
+{
+	_position = snapshot.position;
+	_rotation = snapshot.rotation;
+	_scale = snapshot.scale;
 
-	return _modelMatrix;
+	// Matrices stamped before a change made in between are stale now and get rebuilt on use //
+	_modelMatrix = snapshot.modelMatrix;
+	_invertedModelMatrix = snapshot.invertedModelMatrix;
+	_normalMatrix = snapshot.normalMatrix;
+	_modelVersion = snapshot.modelVersion;
+	_invertedModelVersion = snapshot.invertedModelVersion;
 }
 
-const glm::mat4& Transformable::getInvertedModelMatrix() const
+void Transformable::updateModelMatrix() const
 {
-	if (_invertedModelNeedUpdate)
+	// translate * rotate * scale, without the two full matrix products //
+	const glm::mat3 rotation = glm::toMat3(glm::quat(glm::radians(_rotation)));
+
+	_modelMatrix[0] = glm::vec4(rotation[0] * _scale.x, 0);
+	_modelMatrix[1] = glm::vec4(rotation[1] * _scale.y, 0);
+	_modelMatrix[2] = glm::vec4(rotation[2] * _scale.z, 0);
+	_modelMatrix[3] = glm::vec4(_position, 1);
+
+	_modelVersion = _changeVersion;
+}
+
+void Transformable::updateInvertedModelMatrix() const
+{
+	const glm::mat4& model = getModelMatrix();
+	if (_scale.x == 0 || _scale.y == 0 || _scale.z == 0)
 	{
-		_invertedModelMatrix = glm::inverse(getModelMatrix());
-		_invertedModelNeedUpdate = false;
+		_invertedModelMatrix = glm::inverse(model);
+		_normalMatrix = glm::mat3(glm::transpose(_invertedModelMatrix));
+	}
+	else
+	{
+		// For T * R * S the inverse is S^-1 * R^T * T^-1, and the normal matrix is R * S^-1 //
+		const glm::vec3 inverseScale = 1.f / _scale;
+		_normalMatrix[0] = glm::vec3(model[0]) * (inverseScale.x * inverseScale.x);
+		_normalMatrix[1] = glm::vec3(model[1]) * (inverseScale.y * inverseScale.y);
+		_normalMatrix[2] = glm::vec3(model[2]) * (inverseScale.z * inverseScale.z);
+
+		const glm::mat3 inverseLinear = glm::transpose(_normalMatrix);
+		_invertedModelMatrix = glm::mat4(inverseLinear);
+		_invertedModelMatrix[3] = glm::vec4(-(inverseLinear * _position), 1);
 	}
 
-	return _invertedModelMatrix;
+	_invertedModelVersion = _changeVersion;
 }
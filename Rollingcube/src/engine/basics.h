@@ -160,16 +160,35 @@ protected:
 
 class Transformable : public Versionable
 {
+public:
+	// The pose with its cached matrices, as they were stamped //
+	struct Snapshot
+	{
+		glm::vec3 position;
+		glm::vec3 rotation;
+		glm::vec3 scale;
+		glm::mat4 modelMatrix;
+		glm::mat4 invertedModelMatrix;
+		glm::mat3 normalMatrix;
+		VersionFlag modelVersion;
+		VersionFlag invertedModelVersion;
+	};
+
 private:
 	glm::vec3 _position = { 0, 0, 0 };
 	glm::vec3 _rotation = { 0, 0, 0 };
 	glm::vec3 _scale = { 1, 1, 1 };
 
+	// Caches are valid while their version matches _changeVersion //
 	mutable glm::mat4 _modelMatrix = {};
-	mutable bool _modelNeedUpdate = true;
+	mutable VersionFlag _modelVersion = StaleVersion;
 
 	mutable glm::mat4 _invertedModelMatrix = {};
-	mutable bool _invertedModelNeedUpdate = true;
+	mutable glm::mat3 _normalMatrix = {};
+	mutable VersionFlag _invertedModelVersion = StaleVersion;
+
+private:
+	static constexpr VersionFlag StaleVersion = VersionFlag(~VersionFlag::IntegerType(0));
 
 public:
 	Transformable() = default;
@@ -181,15 +200,48 @@ public:
 	Transformable& operator= (Transformable&&) noexcept = default;
 
 public:
-	const glm::mat4& getModelMatrix() const;
-	const glm::mat4& getInvertedModelMatrix() const;
+	inline const glm::mat4& getModelMatrix() const
+	{
+		if (_modelVersion != _changeVersion)
+			updateModelMatrix();
+		return _modelMatrix;
+	}
+
+	inline const glm::mat4& getInvertedModelMatrix() const
+	{
+		if (_invertedModelVersion != _changeVersion)
+			updateInvertedModelMatrix();
+		return _invertedModelMatrix;
+	}
+
+	inline const glm::mat3& getNormalMatrix() const
+	{
+		if (_invertedModelVersion != _changeVersion)
+			updateInvertedModelMatrix();
+		return _normalMatrix;
+	}
+
+	// True while any cached matrix is older than the transform //
+	inline bool hasStaleMatrices() const { return _modelVersion != _changeVersion || _invertedModelVersion != _changeVersion; }
+
+	// Brings every cached matrix up to date, so the getters above become plain reads //
+	void updateMatrices() const;
+
+public:
+	inline Snapshot takeSnapshot() const
+	{
+		return { _position, _rotation, _scale, _modelMatrix, _invertedModelMatrix, _normalMatrix, _modelVersion, _invertedModelVersion };
+	}
+
+	// Shows a pose that does not count as a change: the version stays, the matrices are rebuilt for the pose under
+	// it. Anything else cached by version keeps what it had. Meant to be undone with restoreSnapshot //
+	void showPose(const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale);
+	void restoreSnapshot(const Snapshot& snapshot);
 
 public:
 	inline void setPosition(const glm::vec3& position)
 	{
 		_position = position;
-		_modelNeedUpdate = true;
-		_invertedModelNeedUpdate = true;
 		++_changeVersion;
 	}
 	inline const glm::vec3& getPosition() const { return _position; }
@@ -197,8 +249,6 @@ public:
 	inline void setRotation(const glm::vec3& rotation)
 	{
 		_rotation = glm::utils::normalizeRange(rotation, -360, 360);
-		_modelNeedUpdate = true;
-		_invertedModelNeedUpdate = true;
 		++_changeVersion;
 	}
 	inline const glm::vec3& getRotation() const { return _rotation; }
@@ -206,8 +256,6 @@ public:
 	inline void setScale(const glm::vec3& scale)
 	{
 		_scale = glm::max(scale, { 0, 0, 0 });
-		_modelNeedUpdate = true;
-		_invertedModelNeedUpdate = true;
 		++_changeVersion;
 	}
 	inline const glm::vec3& getScale() const { return _scale; }
@@ -225,8 +273,6 @@ public:
 	inline void scale(const glm::vec3& delta) { setScale(_scale * delta); }
 	inline void scale(float x, float y, float z) { scale({ x, y, z }); }
 
-	inline glm::mat3 getNormalMatrix() const { return glm::mat3(glm::transpose(getInvertedModelMatrix())); }
-
 	inline glm::vec3 getRight() const { return getModelMatrix()[0]; }
 	inline glm::vec3 getUp() const { return getModelMatrix()[1]; }
 	inline glm::vec3 getForward() const { return -getModelMatrix()[2]; }
@@ -258,4 +304,8 @@ public:
 	{
 		return left.multiplyTransformBy(right), left;
 	}
+
+private:
+	void updateModelMatrix() const;
+	void updateInvertedModelMatrix() const;
 };
@@ -2,6 +2,8 @@
 
 #include "utils/shader_constants.h"
 
+#include "render_snapshot.h"
+
 
 
 void ModelableEntity::update(Time elapsedTime)
@@ -24,6 +26,12 @@ void ModelableEntity::renderWithLightningShader(const Camera& cam)
 	auto model = internalGetModel();
 	if (model != nullptr)
 	{
+		if (RenderSnapshot* snapshot = RenderSnapshot::capturing())
+		{
+			snapshot->addDraw(cam, *this, internalGetMaterial(), hasStaticLightManagerLinked() ? std::addressof(getStaticLightContainer()) : nullptr, model);
+			return;
+		}
+
 		bindLightnigShaderRenderData(cam);
 		model->render();
 		unbindLightnigShaderRenderData();
@@ -46,9 +54,27 @@ void ModelableEntity::bindLightnigShaderRenderData(
 	Material::ConstRef material,
 	ConstReference<StaticLightContainer> staticLightContainer
 ) {
+	ShaderProgram::Ref shader = bindLightnigShaderRenderData(cam, transform, material);
+	if (shader != nullptr && staticLightContainer != nullptr)
+		shader->setUniformStaticLights(*staticLightContainer);
+}
+
+void ModelableEntity::bindLightnigShaderRenderData(
+	const Camera& cam,
+	const Transformable& transform,
+	Material::ConstRef material,
+	std::span<const Light> staticLights
+) {
+	ShaderProgram::Ref shader = bindLightnigShaderRenderData(cam, transform, material);
+	if (shader != nullptr)
+		shader->setUniformStaticLights(staticLights);
+}
+
+ShaderProgram::Ref ModelableEntity::bindLightnigShaderRenderData(const Camera& cam, const Transformable& transform, Material::ConstRef material)
+{
 	ShaderProgram::Ref shader = ShaderProgramManager::instance().getLightningShaderProgram();
 	if (shader == nullptr)
-		return;
+		return nullptr;
 
 	shader->use();
 
@@ -63,8 +89,7 @@ void ModelableEntity::bindLightnigShaderRenderData(
 
 	shader[constants::uniform::model_data::model()] = transform.getModelMatrix();
 	shader[constants::uniform::model_data::modelNormal()] = transform.getNormalMatrix();
-	if (staticLightContainer != nullptr)
-		shader->setUniformStaticLights(*staticLightContainer);
+	return shader;
 }
 
 void ModelableEntity::unbindLightnigShaderRenderData(Material::ConstRef material)
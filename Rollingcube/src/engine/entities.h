@@ -4,6 +4,7 @@
 #include <compare>
 #include <iostream>
 #include <map>
+#include <span>
 
 #include <math/glm.h>
 
@@ -283,7 +284,16 @@ public:
 		Material::ConstRef material,
 		ConstReference<StaticLightContainer> staticLightContainer
 	);
+	static void bindLightnigShaderRenderData(
+		const Camera& cam,
+		const Transformable& transform,
+		Material::ConstRef material,
+		std::span<const Light> staticLights
+	);
 	static void unbindLightnigShaderRenderData(Material::ConstRef material);
+
+private:
+	static ShaderProgram::Ref bindLightnigShaderRenderData(const Camera& cam, const Transformable& transform, Material::ConstRef material);
 };
 
 
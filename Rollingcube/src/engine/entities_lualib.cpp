@@ -353,7 +353,7 @@ namespace lua::lib::LUA_entities
 
 		static const glm::mat4& getModelMatrix(const Transformable* self) { return self->getModelMatrix(); }
 
-		static const glm::mat4& getNormalMatrix(const Transformable* self) { return self->getNormalMatrix(); }
+		static glm::mat4 getNormalMatrix(const Transformable* self) { return glm::mat4(self->getNormalMatrix()); }
 
 		static const glm::mat4& getInvertedModelMatrix(const Transformable* self) { return self->getInvertedModelMatrix(); }
 
@@ -0,0 +1,85 @@
+#include "frame_stats_overlay.h"
+
+#include <algorithm>
+#include <string_view>
+
+#include "core/window.h"
+
+
+void FrameStatsOverlay::render(Font& font, const Camera& cam, int x, int y) const
+{
+	const auto& stats = FrameStats::instance();
+	if (stats.getHistorySize() == 0)
+		return;
+
+	const glm::vec4 previousColor = font.getColor();
+	font.setColor(_color);
+
+	const int lineHeight = _pixelSize + _pixelSize / 4;
+	const auto nextLine = [&y, lineHeight]() {
+		const int line = y;
+		y -= lineHeight;
+		return line;
+	};
+
+	const FrameStatsSample& last = stats.getSample();
+	const FrameStatsSummary frameTime = stats.summarizeFrameTime(_historyFrames);
+
+	font.print(cam, x, nextLine(), _pixelSize, "frame {:>8.2f} ms   min {:.2f}  avg {:.2f}  max {:.2f}",
+		last.frameMilliseconds, frameTime.min, frameTime.average, frameTime.max);
+	font.print(cam, x, nextLine(), _pixelSize, "[{}]", buildFrameTimeGraph(frameTime.max));
+
+	const FrameStatsSummary latency = stats.summarizeLatency(_historyFrames);
+	font.print(cam, x, nextLine(), _pixelSize, "latency {:>6.2f} ms   min {:.2f}  avg {:.2f}  max {:.2f}",
+		last.latencyMilliseconds, latency.min, latency.average, latency.max);
+
+	const FramePacerStats& pacing = window::getFramePacer().getStats();
+	font.print(cam, x, nextLine(), _pixelSize, "present {:>6.2f} ms   smoothed {:.2f}  jitter {:.2f}  worst {:.2f}",
+		pacing.frameMilliseconds, pacing.smoothedMilliseconds, pacing.jitterMilliseconds, pacing.maxDeviationMilliseconds);
+
+	for (std::size_t i = 0; i < FrameStats::CounterCount; ++i)
+	{
+		const auto counter = static_cast<FrameCounter>(i);
+		const FrameStatsSummary summary = stats.summarize(counter, _historyFrames);
+		font.print(cam, x, nextLine(), _pixelSize, "{:<15} {:>10}   min {:.0f}  avg {:.1f}  max {:.0f}",
+			getFrameCounterName(counter), last.get(counter), summary.min, summary.average, summary.max);
+	}
+
+	font.print(cam, x, nextLine(), _pixelSize, "lua memory {:>10.1f} KiB", double(last.luaMemoryBytes) / 1024.0);
+
+	for (std::size_t i = 0; i < FrameStats::LuaHookCount; ++i)
+	{
+		const auto hook = static_cast<LuaHook>(i);
+		if (last.get(hook) > 0)
+			font.print(cam, x, nextLine(), _pixelSize, "  lua {:<20} {:>8}", getLuaHookName(hook), last.get(hook));
+	}
+
+	font.setColor(previousColor);
+}
+
+const std::string& FrameStatsOverlay::buildFrameTimeGraph(double maxMilliseconds) const
+{
+	static constexpr std::string_view Ramp = " .:-=+*#";
+
+	const auto& stats = FrameStats::instance();
+	const std::size_t frames = std::min(_historyFrames, stats.getHistorySize());
+	const std::size_t framesPerColumn = std::max<std::size_t>(1, (frames + GraphColumns - 1) / GraphColumns);
+
+	// Oldest frames on the left, each column shows the slowest frame it covers //
+	_graph.assign(GraphColumns, Ramp.front());
+	for (std::size_t column = 0; column < GraphColumns; ++column)
+	{
+		double worst = 0;
+		for (std::size_t i = 0; i < framesPerColumn; ++i)
+		{
+			const std::size_t age = (GraphColumns - 1 - column) * framesPerColumn + i;
+			if (age < frames)
+				worst = std::max(worst, stats.getSample(age).frameMilliseconds);
+		}
+
+		if (maxMilliseconds > 0)
+			_graph[column] = Ramp[std::min(Ramp.size() - 1, std::size_t(worst / maxMilliseconds * double(Ramp.size() - 1) + 0.5))];
+	}
+
+	return _graph;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+
+#include "core/frame_stats.h"
+#include "math/glm.h"
+
+#include "camera.h"
+#include "text.h"
+
+
+/*
+	Text overlay for FrameStats: the last frame of every counter next to its min/avg/max over the recent history,
+	Lua calls per hook and a frame time graph. Drawn through the given Font, so it is flushed with the rest of its text.
+*/
+class FrameStatsOverlay
+{
+public:
+	static constexpr int DefaultPixelSize = 14;
+	static constexpr std::size_t DefaultHistoryFrames = 120;
+	static constexpr std::size_t GraphColumns = 60;
+
+private:
+	int _pixelSize = DefaultPixelSize;
+	std::size_t _historyFrames = DefaultHistoryFrames;
+	glm::vec4 _color = { 1.f, 1.f, 0.6f, 1.f };
+
+	mutable std::string _graph;
+
+public:
+	FrameStatsOverlay() = default;
+	FrameStatsOverlay(const FrameStatsOverlay&) = default;
+	FrameStatsOverlay(FrameStatsOverlay&&) noexcept = default;
+	~FrameStatsOverlay() = default;
+
+	FrameStatsOverlay& operator= (const FrameStatsOverlay&) = default;
+	FrameStatsOverlay& operator= (FrameStatsOverlay&&) noexcept = default;
+
+public:
+	// (x, y) is the top left corner, lines go down from there //
+	void render(Font& font, const Camera& cam, int x, int y) const;
+
+public:
+	constexpr void setPixelSize(int pixelSize) { _pixelSize = pixelSize; }
+	constexpr int getPixelSize() const { return _pixelSize; }
+
+	constexpr void setHistoryFrames(std::size_t frames) { _historyFrames = frames; }
+	constexpr std::size_t getHistoryFrames() const { return _historyFrames; }
+
+	constexpr void setColor(const glm::vec4& color) { _color = color; }
+	constexpr const glm::vec4& getColor() const { return _color; }
+
+private:
+	const std::string& buildFrameTimeGraph(double maxMilliseconds) const;
+};
@@ -18,7 +18,7 @@ bool FrameBuffer::createWithColorAndDepth(SizeType width, SizeType height)
 		return false;
 	}
 
-	glGenFramebuffers(1, &_id);
+	_id = gl::backend().genFramebuffer();
 	if (_id == 0)
 	{
 		logger::error("Unable to create framebuffer!");
@@ -34,7 +34,7 @@ bool FrameBuffer::createWithColorAndDepth(SizeType width, SizeType height)
 		destroy();
 		return false;
 	}
-	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRenderBuffer->getId());
+	gl::backend().framebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRenderBuffer->getId());
 
 	// Create depth buffer and attach it to FBO //
 	auto depthRenderBuffer = std::make_unique<RenderBuffer>();
@@ -44,10 +44,10 @@ bool FrameBuffer::createWithColorAndDepth(SizeType width, SizeType height)
 		destroy();
 		return false;
 	}
-	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRenderBuffer->getId());
+	gl::backend().framebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRenderBuffer->getId());
 
 	// Check FBO status when all attachments have been attached //
-	const auto fboStatus = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	const auto fboStatus = gl::backend().checkFramebufferStatus(GL_FRAMEBUFFER);
 	if (fboStatus != GL_FRAMEBUFFER_COMPLETE)
 	{
 		destroy();
@@ -69,7 +69,7 @@ bool FrameBuffer::resize(SizeType newWidth, SizeType newHeight)
 
 	destroyOnlyFrameBuffer();
 
-	glGenFramebuffers(1, &_id);
+	_id = gl::backend().genFramebuffer();
 	if (_id == 0)
 	{
 		logger::error("Unable to create framebuffer during resizing!");
@@ -87,7 +87,7 @@ bool FrameBuffer::resize(SizeType newWidth, SizeType newHeight)
 			return false;
 		}
 
-		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, _colorRenderBuffer->getId());
+		gl::backend().framebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, _colorRenderBuffer->getId());
 	}
 
 	if (_depthRenderBuffer != nullptr)
@@ -99,7 +99,7 @@ bool FrameBuffer::resize(SizeType newWidth, SizeType newHeight)
 			return false;
 		}
 
-		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, _depthRenderBuffer->getId());
+		gl::backend().framebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, _depthRenderBuffer->getId());
 	}
 
 	if (_texture != nullptr)
@@ -111,10 +111,10 @@ bool FrameBuffer::resize(SizeType newWidth, SizeType newHeight)
 			return false;
 		}
 
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _texture->getId(), 0);
+		gl::backend().framebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _texture->getId(), 0);
 	}
 
-	const auto fboStatus = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	const auto fboStatus = gl::backend().checkFramebufferStatus(GL_FRAMEBUFFER);
 	if (fboStatus != GL_FRAMEBUFFER_COMPLETE)
 	{
 		destroy();
@@ -142,7 +142,7 @@ void FrameBuffer::copyColorToDefaultFrameBuffer() const
 
 	bindAsRead();
 	Default::bindAsDraw();
-	glBlitFramebuffer(0, 0, _width, _height, 0, 0, winSize.width, winSize.height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	gl::backend().blitFramebuffer(0, 0, _width, _height, 0, 0, winSize.width, winSize.height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
 }
 
 void FrameBuffer::copyDepthFromDefaultFrameBuffer() const
@@ -151,7 +151,7 @@ void FrameBuffer::copyDepthFromDefaultFrameBuffer() const
 
 	bindAsRead();
 	Default::bindAsDraw();
-	glBlitFramebuffer(0, 0, winSize.width, winSize.height, 0, 0, _width, _height, GL_STENCIL_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+	gl::backend().blitFramebuffer(0, 0, winSize.width, winSize.height, 0, 0, _width, _height, GL_STENCIL_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, GL_NEAREST);
 }
 
 GLint FrameBuffer::getDepthBits() const
@@ -160,8 +160,9 @@ GLint FrameBuffer::getDepthBits() const
 	{
 		bindAsRead();
 
-		glGetFramebufferAttachmentParameteriv(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_FRAMEBUFFER_ATTACHMENT_DEPTH_SIZE, &_depthBits);
-		const auto error = glGetError();
+		auto& backend = gl::backend();
+		_depthBits = backend.getFramebufferAttachmentParameteri(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_FRAMEBUFFER_ATTACHMENT_DEPTH_SIZE);
+		const auto error = backend.getError();
 		if (error != GL_NO_ERROR)
 			logger::error("Could not read number of depth bits for framebuffer #{}: {}. Probably it has no depth attachment!", _id, error);
 	}
@@ -174,8 +175,9 @@ GLint FrameBuffer::getStencilBits() const
 	{
 		bindAsRead();
 
-		glGetFramebufferAttachmentParameteriv(GL_READ_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_FRAMEBUFFER_ATTACHMENT_STENCIL_SIZE, &_stencilBits);
-		const auto error = glGetError();
+		auto& backend = gl::backend();
+		_stencilBits = backend.getFramebufferAttachmentParameteri(GL_READ_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_FRAMEBUFFER_ATTACHMENT_STENCIL_SIZE);
+		const auto error = backend.getError();
 		if (error != GL_NO_ERROR)
 			logger::error("Could not read number of depth bits for framebuffer #{}: {}. Probably it has no depth attachment!", _id, error);
 	}
@@ -184,7 +186,7 @@ GLint FrameBuffer::getStencilBits() const
 
 bool FrameBuffer::create(SizeType width, SizeType height, bool doBind)
 {
-	glGenFramebuffers(1, &_id);
+	_id = gl::backend().genFramebuffer();
 	if (_id == 0)
 	{
 		logger::error("Unable to create framebuffer!");
@@ -211,7 +213,7 @@ bool FrameBuffer::withColorAttachment(InternalFormat internalFormat)
 		return false;
 	}
 
-	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRenderBuffer->getId());
+	gl::backend().framebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRenderBuffer->getId());
 	_colorRenderBuffer = std::move(colorRenderBuffer);
 	return true;
 }
@@ -230,7 +232,7 @@ bool FrameBuffer::withDepthAttachment(InternalFormat internalFormat)
 		return false;
 	}
 
-	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRenderBuffer->getId());
+	gl::backend().framebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRenderBuffer->getId());
 	_depthRenderBuffer = std::move(depthRenderBuffer);
 	return true;
 }
@@ -244,7 +246,7 @@ bool FrameBuffer::withTextureColorAttachment(Texture::Format textureFormat)
 	_texture = std::make_unique<Texture>();
 	_texture->create(_width, _height, textureFormat, false);
 	_texture->bind();
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _texture->getId(), 0);
+	gl::backend().framebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _texture->getId(), 0);
 	return true;
 }
 
@@ -253,7 +255,7 @@ bool FrameBuffer::finishInitialization() const
 	if (!isCreated())
 		return false;
 
-	const auto fboStatus = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	const auto fboStatus = gl::backend().checkFramebufferStatus(GL_FRAMEBUFFER);
 	if (fboStatus != GL_FRAMEBUFFER_COMPLETE)
 		return false;
 
@@ -263,7 +265,7 @@ bool FrameBuffer::finishInitialization() const
 void FrameBuffer::destroyOnlyFrameBuffer()
 {
 	if (isCreated())
-		glDeleteFramebuffers(1, &_id);
+		gl::backend().deleteFramebuffer(_id);
 
 	_id = 0;
 	_width = 0;
@@ -275,7 +277,7 @@ void FrameBuffer::destroyOnlyFrameBuffer()
 std::vector<GLubyte> FrameBuffer::readColorValue(int x, int y)
 {
 	std::vector<GLubyte> result(4, 0);
-	glReadPixels(x, y, 1, 1, GL_RGB, GL_UNSIGNED_BYTE, result.data());
+	gl::backend().readPixels(x, y, 1, 1, GL_RGB, GL_UNSIGNED_BYTE, result.data());
 	return result;
 }
 
@@ -287,23 +289,19 @@ void FrameBuffer::Default::setFullViewport()
 {
 	window::Dimension winSize = window::getMainWindowSize();
 
-	glViewport(0, 0, winSize.width, winSize.height);
+	gl::backend().viewport(0, 0, winSize.width, winSize.height);
 }
 
 GLint FrameBuffer::Default::getDepthBits()
 {
-	GLint depthBits = -1;;
 	bindAsRead();
-	glGetFramebufferAttachmentParameteriv(GL_READ_FRAMEBUFFER, GL_DEPTH, GL_FRAMEBUFFER_ATTACHMENT_DEPTH_SIZE, &depthBits);
-	return depthBits;
+	return gl::backend().getFramebufferAttachmentParameteri(GL_READ_FRAMEBUFFER, GL_DEPTH, GL_FRAMEBUFFER_ATTACHMENT_DEPTH_SIZE);
 }
 
 GLint FrameBuffer::Default::getStencilBits()
 {
-	GLint stencilBits = -1;
 	bindAsRead();
-	glGetFramebufferAttachmentParameteriv(GL_READ_FRAMEBUFFER, GL_STENCIL, GL_FRAMEBUFFER_ATTACHMENT_STENCIL_SIZE, &stencilBits);
-	return stencilBits;
+	return gl::backend().getFramebufferAttachmentParameteri(GL_READ_FRAMEBUFFER, GL_STENCIL, GL_FRAMEBUFFER_ATTACHMENT_STENCIL_SIZE);
 }
 
 
@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "core/gl.h"
+#include "core/gl_backend.h"
 #include "renderbuffer.h"
 #include "texture.h"
 
@@ -44,11 +45,11 @@ public:
 
 	constexpr Texture::Ref getTexture() const { return _texture.get(); }
 
-	inline void bind() const { glBindFramebuffer(GL_FRAMEBUFFER, _id); }
-	inline void bindAsRead() const { glBindFramebuffer(GL_READ_FRAMEBUFFER, _id); }
-	inline void bindAsDraw() const { glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _id); }
+	inline void bind() const { gl::backend().bindFramebuffer(GL_FRAMEBUFFER, _id); }
+	inline void bindAsRead() const { gl::backend().bindFramebuffer(GL_READ_FRAMEBUFFER, _id); }
+	inline void bindAsDraw() const { gl::backend().bindFramebuffer(GL_DRAW_FRAMEBUFFER, _id); }
 
-	inline void setFullViewport() const { glViewport(0, 0, _width, _height); }
+	inline void setFullViewport() const { gl::backend().viewport(0, 0, _width, _height); }
 
 public:
 	bool createWithColorAndDepthWithDefaultScreenSize();
@@ -89,9 +90,9 @@ public:
 		Default& operator= (Default&&) noexcept = delete;
 
 	public:
-		static inline void bind() { glBindFramebuffer(GL_FRAMEBUFFER, 0); }
-		static inline void bindAsRead() { glBindFramebuffer(GL_READ_FRAMEBUFFER, 0); }
-		static inline void bindAsDraw() { glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0); }
+		static inline void bind() { gl::backend().bindFramebuffer(GL_FRAMEBUFFER, 0); }
+		static inline void bindAsRead() { gl::backend().bindFramebuffer(GL_READ_FRAMEBUFFER, 0); }
+		static inline void bindAsDraw() { gl::backend().bindFramebuffer(GL_DRAW_FRAMEBUFFER, 0); }
 
 	public:
 		static void setFullViewport();
@@ -72,9 +72,40 @@ public:
 inline const LuaEnvironment LuaEnvironment::Instance = {};
 
 
+// Makes lua::state() return another state on the current thread while it is alive, used by the worker states //
+class LuaStateScope
+{
+private:
+	static inline thread_local lua_State* Current = nullptr;
+
+private:
+	lua_State* _previous;
+
+public:
+	LuaStateScope(const LuaStateScope&) = delete;
+	LuaStateScope(LuaStateScope&&) noexcept = delete;
+
+	LuaStateScope& operator= (const LuaStateScope&) = delete;
+	LuaStateScope& operator= (LuaStateScope&&) noexcept = delete;
+
+public:
+	inline explicit LuaStateScope(lua_State* state) : _previous(Current) { Current = state; }
+	inline ~LuaStateScope() { Current = _previous; }
+
+public:
+	static inline lua_State* current() { return Current; }
+};
+
+
 namespace lua
 {
-	constexpr lua_State* state() { return LuaEnvironment::instance().getLuaState(); }
+	inline lua_State* state()
+	{
+		lua_State* scoped = LuaStateScope::current();
+		return scoped != nullptr ? scoped : LuaEnvironment::instance().getLuaState();
+	}
+
+	inline bool isMainState() { return state() == LuaEnvironment::instance().getLuaState(); }
 }
 
 namespace lua::utils
@@ -11,14 +11,21 @@
 using LuaLibraryConstructor = std::function<bool(luabridge::Namespace&, lua_State*)>;
 
 
+class LuaLibraryManager;
+
 class LuaLibrary
 {
+public:
+	friend LuaLibraryManager;
+
 private:
 	std::string _name;
 	LuaLibraryConstructor _constructor;
 	std::unordered_set<std::string> _dependences;
+	bool _workerSafe;
 
-	mutable bool _built = false;
+	// States the library namespace was already built into //
+	mutable std::unordered_set<lua_State*> _builtStates;
 
 public:
 	LuaLibrary() = delete;
@@ -33,10 +40,11 @@ public:
 	constexpr auto operator<=> (const LuaLibrary& other) const noexcept { return _name <=> other._name; }
 
 public:
-	inline LuaLibrary(const std::string name, const LuaLibraryConstructor& constructor, std::initializer_list<std::string> dependences) :
+	inline LuaLibrary(const std::string name, const LuaLibraryConstructor& constructor, std::initializer_list<std::string> dependences, bool workerSafe) :
 		_name(name),
 		_constructor(constructor),
-		_dependences(dependences)
+		_dependences(dependences),
+		_workerSafe(workerSafe)
 	{}
 
 public:
@@ -47,7 +55,19 @@ public:
 	inline bool hasDependences() const { return !_dependences.empty(); }
 	constexpr const std::unordered_set<std::string>& getDependences() const { return _dependences; }
 
+	// Worker safe libraries only touch what they are given, they are the only ones pool states get //
+	constexpr bool isWorkerSafe() const { return _workerSafe; }
+
+	// Builds the library namespace and its dependences into lua::state() once. Fails on any state but the main one
+	// when the library is not already there //
+	inline bool build() const { return build(false); }
+
 	bool openToEnv(const LuaRef& env) const;
+
+	inline void forgetState(lua_State* state) const { _builtStates.erase(state); }
+
+private:
+	bool build(bool intoWorkerState) const;
 };
 
 
@@ -90,21 +110,82 @@ public:
 		return it->second;
 	}
 
-	inline void registerLibrary(const std::string& name, const LuaLibraryConstructor& constructor, std::initializer_list<std::string> dependences = {})
+	// Called before a state is closed, so a new one at the same address builds everything again //
+	inline void forgetState(lua_State* state) const
+	{
+		for (const auto& lib : _libs)
+			lib.second->forgetState(state);
+	}
+
+	// Builds every worker safe library into lua::state(), a pool state no job thread holds yet. Once it is done
+	// nothing writes to the libraries for that state, so hooks on the job threads can open them concurrently //
+	inline bool buildWorkerLibraries() const
 	{
+		for (const auto& lib : _libs)
+		{
+			if (lib.second->isWorkerSafe() && !lib.second->build(true))
+				return false;
+		}
+		return true;
+	}
+
+	inline void registerLibrary(
+		const std::string& name,
+		const LuaLibraryConstructor& constructor,
+		std::initializer_list<std::string> dependences = {},
+		bool workerSafe = false
+	) {
 		if (_libs.contains(name))
 		{
 			logger::error("Lua Rollingcube library {} already registered.", name);
 			return;
 		}
 
-		_libs.insert({ name, std::make_shared<LuaLibrary>(name, constructor, dependences) });
+		_libs.insert({ name, std::make_shared<LuaLibrary>(name, constructor, dependences, workerSafe) });
 	}
 };
 
 inline LuaLibraryManager LuaLibraryManager::Instance = {};
 
 
+inline bool LuaLibrary::build(bool intoWorkerState) const
+{
+	lua_State* state = lua::state();
+	if (_builtStates.contains(state))
+		return true;
+
+	if (!lua::isMainState() && !(intoWorkerState && _workerSafe))
+	{
+		lua::utils::error("Lua library {} can only be opened on the main Lua state.", _name);
+		return false;
+	}
+
+	for (const auto& dep : _dependences)
+	{
+		auto depLib = LuaLibraryManager::instance().get(dep);
+		if (depLib == nullptr || !depLib->build(intoWorkerState))
+		{
+			lua::utils::error("Internal error with {} library on dependency build.", dep);
+			return false;
+		}
+	}
+
+	auto globalNamespace = lua::utils::getGlobalNamespace();
+	auto libraryNamespace = globalNamespace.beginNamespace(_name.c_str());
+
+	bool result = _constructor(libraryNamespace, state);
+	libraryNamespace.endNamespace();
+
+	if (!result)
+	{
+		lua::utils::error("Error when opening Lua library {}.", _name);
+		return false;
+	}
+
+	_builtStates.insert(state);
+	return true;
+}
+
 inline bool LuaLibrary::openToEnv(const LuaRef& env) const
 {
 	if (hasDependences())
@@ -121,22 +202,8 @@ inline bool LuaLibrary::openToEnv(const LuaRef& env) const
 		}
 	}
 
-	if (!_built)
-	{
-		auto globalNamespace = lua::utils::getGlobalNamespace();
-		auto libraryNamespace = globalNamespace.beginNamespace(_name.c_str());
-
-		bool result = _constructor(libraryNamespace, lua::state());
-		libraryNamespace.endNamespace();
-
-		if (!result)
-		{
-			lua::utils::error("Error when opening Lua library {}.", _name);
-			return false;
-		}
-
-		_built = true;
-	}
+	if (!build())
+		return false;
 
 	LuaRef libref = lua::utils::getGlobalValue(_name.c_str());
 	if (!libref.isTable())
@@ -1,5 +1,7 @@
 #include "module.h"
 
+#include "core/profiler.h"
+
 
 LuaCallStack LuaCallStack::Instance = {};
 
@@ -17,6 +19,8 @@ LuaModule::LuaModule(const Path& path, LuaModule* parent) :
 
 bool LuaModule::load()
 {
+	PROFILE_SCOPE_CATEGORY("LuaModule::load", ProfileCategory::Asset);
+
 	if (isLoaded())
 		return false;
 
@@ -184,13 +188,12 @@ void LuaModule::LUA_openlib(const std::string& name)
 
 void LuaModule::loadBuiltinElements()
 {
-	static constinit bool initiated = false;
-	if (!initiated)
+	// Once per state, worker states get them on their first module //
+	if (lua::utils::getGlobalValue(lua::constants::include).isNil())
 	{
 		lua::utils::getGlobalNamespace()
 			.addFunction("include", *LUA_include)
 			.addFunction("openlib", *LUA_openlib);
-		initiated = true;
 	}
 
 	setValueFromGlobal(lua::constants::include);
@@ -258,6 +261,15 @@ std::shared_ptr<LuaModule> LuaModuleManager::load(const Path& rawpath)
 	return mod;
 }
 
+std::shared_ptr<LuaModule> LuaModuleManager::loadDetached(const Path& path)
+{
+	std::shared_ptr<LuaModule> mod{ new LuaModule(path, nullptr) };
+	if (!mod->load())
+		return nullptr;
+
+	return mod;
+}
+
 std::shared_ptr<LuaModule> LuaModuleManager::get(const Path& path)
 {
 	auto it = _modules.find(LuaModule::normalize(path));
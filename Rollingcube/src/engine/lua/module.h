@@ -143,6 +143,9 @@ private:
 public:
 	std::shared_ptr<LuaModule> load(const Path& path);
 
+	// Loads a separate copy into lua::state() without registering it, the caller owns it //
+	std::shared_ptr<LuaModule> loadDetached(const Path& path);
+
 	std::shared_ptr<LuaModule> get(const Path& path);
 
 public:
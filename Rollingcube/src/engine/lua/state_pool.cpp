@@ -0,0 +1,35 @@
+#include "state_pool.h"
+
+#include "libs.h"
+
+
+LuaStatePool LuaStatePool::Instance;
+
+
+void LuaStatePool::reserve(std::size_t count)
+{
+	while (_states.size() < count)
+	{
+		lua_State* state = luaL_newstate();
+		luaL_openlibs(state);
+		_states.emplace_back(state, &lua_close);
+
+		// Outside of any Lua call, so library errors need a protected call //
+		LuaStateScope scope(state);
+		lua_pushcfunction(state, [](lua_State*) -> int {
+			LuaLibraryManager::instance().buildWorkerLibraries();
+			return 0;
+		});
+
+		if (!lua::utils::catchError(lua_pcall(state, 0, 0, 0)))
+			lua::utils::pop();
+	}
+}
+
+void LuaStatePool::clear()
+{
+	for (const auto& state : _states)
+		LuaLibraryManager::instance().forgetState(state.get());
+
+	_states.clear();
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+
+#include "environment.h"
+
+
+/*
+	Extra Lua states for scripts that run on job threads. Each one is a separate interpreter with the standard
+	libraries and the worker safe Rollingcube libraries opened when it is created, any other library fails to open in
+	it; modules are loaded into it through a LuaStateScope. A state
+	must only be used by one thread at a time. Holders keep the shared pointer, so a state outlives the references
+	created inside it.
+*/
+class LuaStatePool
+{
+public:
+	using StateRef = std::shared_ptr<lua_State>;
+
+private:
+	static LuaStatePool Instance;
+
+private:
+	std::vector<StateRef> _states;
+
+public:
+	LuaStatePool(const LuaStatePool&) = delete;
+	LuaStatePool(LuaStatePool&&) noexcept = delete;
+
+	LuaStatePool& operator= (const LuaStatePool&) = delete;
+	LuaStatePool& operator= (LuaStatePool&&) noexcept = delete;
+
+private:
+	LuaStatePool() = default;
+	~LuaStatePool() = default;
+
+public:
+	// Only grows, existing states are kept //
+	void reserve(std::size_t count);
+
+	// Drops the pool references, the states close once their last holder releases them //
+	void clear();
+
+	inline std::size_t size() const { return _states.size(); }
+	inline bool empty() const { return _states.empty(); }
+
+	inline const StateRef& get(std::size_t index) const { return _states[index]; }
+
+public:
+	static constexpr LuaStatePool& instance() { return Instance; }
+};
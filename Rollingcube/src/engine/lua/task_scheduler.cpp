@@ -0,0 +1,364 @@
+#include "task_scheduler.h"
+
+#include <algorithm>
+
+#include "core/profiler.h"
+#include "core/frame_stats.h"
+#include "utils/lualib_constants.h"
+
+#include "libs.h"
+
+
+LuaTaskScheduler LuaTaskScheduler::Instance;
+
+
+void LuaTaskScheduler::update(Time elapsedTime)
+{
+	_time += elapsedTime;
+	++_frame;
+
+	if (_tasks.empty())
+		return;
+
+	PROFILE_SCOPE_CATEGORY("LuaTaskScheduler::update", ProfileCategory::Lua);
+
+	_due.clear();
+	collectDue(_timers, std::uint64_t(std::max<std::int64_t>(_time.toNanoseconds(), 0)), WaitKind::Time);
+	collectDue(_frameWaits, _frame, WaitKind::Frames);
+
+	// Predicates may spawn tasks that wait as well, those land in the fresh list and are first polled next frame //
+	std::vector<Id> polled;
+	std::swap(polled, _polled);
+	for (Id id : polled)
+	{
+		auto it = _tasks.find(id);
+		if (it == _tasks.end() || it->second.wait != WaitKind::Until)
+			continue;
+
+		Task& task = it->second;
+		if (!task.cancelled && !isPredicateTrue(task))
+		{
+			_polled.push_back(id);
+			continue;
+		}
+
+		luaL_unref(lua::state(), LUA_REGISTRYINDEX, task.predicateRef);
+		task.predicateRef = LUA_NOREF;
+		_due.push_back(id);
+	}
+
+	for (Id id : _due)
+		resume(id, lua::state(), 0);
+}
+
+void LuaTaskScheduler::clear()
+{
+	for (auto it = _tasks.begin(); it != _tasks.end();)
+	{
+		// A task in the middle of a resume is still on the C stack, it goes away once it yields //
+		if (it->second.wait == WaitKind::None)
+		{
+			it->second.cancelled = true;
+			++it;
+			continue;
+		}
+
+		release(it->second);
+		it = _tasks.erase(it);
+	}
+
+	_timers = {};
+	_frameWaits = {};
+	_polled.clear();
+	_due.clear();
+}
+
+LuaTaskScheduler::Id LuaTaskScheduler::spawn(lua_State* state, int argumentCount)
+{
+	lua_State* thread = lua_newthread(state);
+	const int threadRef = luaL_ref(state, LUA_REGISTRYINDEX);
+	lua_xmove(state, thread, argumentCount + 1);
+
+	const Id id = _nextId++;
+	if (_nextId == InvalidId)
+		_nextId = 1;
+
+	_tasks.insert({ id, Task{ thread, threadRef, LUA_NOREF, _owner } });
+	resume(id, state, argumentCount);
+	return id;
+}
+
+bool LuaTaskScheduler::cancel(Id id)
+{
+	auto it = _tasks.find(id);
+	if (it == _tasks.end() || it->second.cancelled)
+		return false;
+
+	// Tasks that are running, or resumed another one that is, cannot be released from here //
+	if (it->second.wait == WaitKind::None)
+	{
+		it->second.cancelled = true;
+		return true;
+	}
+
+	release(it->second);
+	_tasks.erase(it);
+	return true;
+}
+
+std::size_t LuaTaskScheduler::cancelOwnedBy(Owner owner)
+{
+	if (owner == nullptr)
+		return 0;
+
+	std::size_t count = 0;
+	for (auto it = _tasks.begin(); it != _tasks.end();)
+	{
+		Task& task = it->second;
+		if (task.owner != owner || task.cancelled)
+		{
+			++it;
+			continue;
+		}
+
+		++count;
+		if (task.wait == WaitKind::None)
+		{
+			task.cancelled = true;
+			++it;
+			continue;
+		}
+
+		release(task);
+		it = _tasks.erase(it);
+	}
+
+	return count;
+}
+
+bool LuaTaskScheduler::sleep(lua_State* thread, Time time)
+{
+	Task* task = findRunning(thread);
+	if (task == nullptr)
+		return false;
+
+	task->wait = WaitKind::Time;
+	_timers.push({ std::uint64_t(std::max<std::int64_t>((_time + time).toNanoseconds(), 0)), _running });
+	return true;
+}
+
+bool LuaTaskScheduler::sleepFrames(lua_State* thread, std::uint64_t frames)
+{
+	Task* task = findRunning(thread);
+	if (task == nullptr)
+		return false;
+
+	task->wait = WaitKind::Frames;
+	_frameWaits.push({ _frame + std::max<std::uint64_t>(frames, 1), _running });
+	return true;
+}
+
+bool LuaTaskScheduler::sleepUntil(lua_State* thread, int predicateIndex)
+{
+	Task* task = findRunning(thread);
+	if (task == nullptr)
+		return false;
+
+	lua_pushvalue(thread, predicateIndex);
+	task->predicateRef = luaL_ref(thread, LUA_REGISTRYINDEX);
+	task->wait = WaitKind::Until;
+	_polled.push_back(_running);
+	return true;
+}
+
+LuaTaskScheduler::Task* LuaTaskScheduler::findRunning(lua_State* thread)
+{
+	if (_running == InvalidId)
+		return nullptr;
+
+	// Only the task body itself may wait, a coroutine created inside it would yield to its own resumer //
+	auto it = _tasks.find(_running);
+	return it != _tasks.end() && it->second.thread == thread ? std::addressof(it->second) : nullptr;
+}
+
+void LuaTaskScheduler::resume(Id id, lua_State* from, int argumentCount)
+{
+	auto it = _tasks.find(id);
+	if (it == _tasks.end())
+		return;
+
+	if (it->second.cancelled)
+	{
+		release(it->second);
+		_tasks.erase(it);
+		return;
+	}
+
+	// Nodes keep their address while other tasks are spawned during the resume //
+	Task& task = it->second;
+	task.wait = WaitKind::None;
+	FrameStats::instance().addLuaCall(LuaHook::Task);
+
+	// Whatever the task spawns belongs to its owner as well //
+	const Id previous = _running;
+	const Owner previousOwner = _owner;
+	_running = id;
+	_owner = task.owner;
+	int results = 0;
+	const int status = lua_resume(task.thread, from, argumentCount, &results);
+	_running = previous;
+	_owner = previousOwner;
+
+	if (status == LUA_YIELD && !task.cancelled)
+	{
+		lua_pop(task.thread, results);
+
+		// A plain coroutine.yield waits for the next frame //
+		if (task.wait == WaitKind::None)
+		{
+			task.wait = WaitKind::Frames;
+			_frameWaits.push({ _frame + 1, id });
+		}
+		return;
+	}
+
+	if (status != LUA_OK && status != LUA_YIELD)
+	{
+		const char* message = lua_tostring(task.thread, -1);
+		luaL_traceback(task.thread, task.thread, message != nullptr ? message : "(error object is not a string)", 0);
+		logger::error("Lua task {} error: {}", id, lua_tostring(task.thread, -1));
+	}
+
+	release(task);
+	_tasks.erase(id);
+}
+
+void LuaTaskScheduler::release(Task& task)
+{
+	lua_State* state = lua::state();
+	luaL_unref(state, LUA_REGISTRYINDEX, task.predicateRef);
+	luaL_unref(state, LUA_REGISTRYINDEX, task.threadRef);
+	task.predicateRef = LUA_NOREF;
+	task.threadRef = LUA_NOREF;
+	task.thread = nullptr;
+}
+
+bool LuaTaskScheduler::isPredicateTrue(Task& task)
+{
+	lua_State* state = lua::state();
+	FrameStats::instance().addLuaCall(LuaHook::Task);
+
+	// Marked busy like a running task, so a cancel from inside the predicate cannot release it under us //
+	task.wait = WaitKind::None;
+	const Owner previousOwner = _owner;
+	_owner = task.owner;
+	lua_rawgeti(state, LUA_REGISTRYINDEX, task.predicateRef);
+	const int status = lua_pcall(state, 0, 1, 0);
+	_owner = previousOwner;
+	task.wait = WaitKind::Until;
+
+	if (status != LUA_OK)
+	{
+		// Would fail again every frame, the task is dropped instead //
+		const char* message = lua_tostring(state, -1);
+		logger::error("Lua task waitUntil error: {}", message != nullptr ? message : "(error object is not a string)");
+		lua_pop(state, 1);
+		task.cancelled = true;
+		return false;
+	}
+
+	const bool result = lua_toboolean(state, -1);
+	lua_pop(state, 1);
+	return result;
+}
+
+void LuaTaskScheduler::collectDue(WakeupHeap& heap, std::uint64_t now, WaitKind kind)
+{
+	while (!heap.empty() && heap.top().when <= now)
+	{
+		const Id id = heap.top().id;
+		heap.pop();
+
+		// Cancelled or cleared tasks leave their entries behind //
+		auto it = _tasks.find(id);
+		if (it != _tasks.end() && it->second.wait == kind)
+			_due.push_back(id);
+	}
+}
+
+
+
+
+namespace lua::lib
+{
+	namespace LUA_tasks { static defineLuaLibraryConstructor(registerToLua, root, state); }
+
+	void registerTasksLibToLua()
+	{
+		LuaLibraryManager::instance().registerLibrary(
+			::lua::lib::names::tasks,
+			&LUA_tasks::registerToLua,
+			{}
+		);
+	}
+}
+
+namespace lua::lib::LUA_tasks
+{
+	static int spawn(lua_State* state)
+	{
+		luaL_checktype(state, 1, LUA_TFUNCTION);
+		if (!lua::isMainState())
+			return luaL_error(state, "Tasks can only be spawned on the main Lua state.");
+
+		const auto id = LuaTaskScheduler::instance().spawn(state, lua_gettop(state) - 1);
+		lua_pushinteger(state, lua_Integer(id));
+		return 1;
+	}
+
+	static int wait(lua_State* state)
+	{
+		const double seconds = luaL_checknumber(state, 1);
+		if (!LuaTaskScheduler::instance().sleep(state, Time::seconds(std::max(seconds, 0.0))))
+			return luaL_error(state, "'wait' can only be called from the body of a task.");
+		return lua_yield(state, 0);
+	}
+
+	static int waitFrames(lua_State* state)
+	{
+		const lua_Integer frames = luaL_optinteger(state, 1, 1);
+		if (!LuaTaskScheduler::instance().sleepFrames(state, std::uint64_t(std::max<lua_Integer>(frames, 1))))
+			return luaL_error(state, "'waitFrames' can only be called from the body of a task.");
+		return lua_yield(state, 0);
+	}
+
+	static int waitUntil(lua_State* state)
+	{
+		luaL_checktype(state, 1, LUA_TFUNCTION);
+		if (!LuaTaskScheduler::instance().sleepUntil(state, 1))
+			return luaL_error(state, "'waitUntil' can only be called from the body of a task.");
+		return lua_yield(state, 0);
+	}
+
+	static bool cancel(lua_Integer id) { return LuaTaskScheduler::instance().cancel(LuaTaskScheduler::Id(id)); }
+	static bool isAlive(lua_Integer id) { return LuaTaskScheduler::instance().isAlive(LuaTaskScheduler::Id(id)); }
+	static lua_Integer getCount() { return lua_Integer(LuaTaskScheduler::instance().getCount()); }
+	static double getTime() { return LuaTaskScheduler::instance().getTime().toSeconds(); }
+
+
+	static defineLuaLibraryConstructor(registerToLua, root, state)
+	{
+		root = root.beginNamespace("Tasks")
+				.addFunction("spawn", &spawn)
+				.addFunction("cancel", &cancel)
+				.addFunction("isAlive", &isAlive)
+				.addFunction("getCount", &getCount)
+				.addFunction("getTime", &getTime)
+			.endNamespace()
+			.addFunction("wait", &wait)
+			.addFunction("waitFrames", &waitFrames)
+			.addFunction("waitUntil", &waitUntil);
+
+		return true;
+	}
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <queue>
+#include <unordered_map>
+#include <functional>
+
+#include "core/time.h"
+
+#include "environment.h"
+
+
+namespace lua::lib { void registerTasksLibToLua(); }
+
+
+/*
+	Runs Lua functions as coroutines that sleep between their steps. wait, waitFrames and waitUntil yield the running
+	task; timed and frame sleeps sit in min-heaps and only the tasks that are due get resumed, so an idle animation
+	costs nothing until it wakes. waitUntil predicates are the exception, they are polled once per frame. A frame is
+	one simulation tick. Tasks only exist on the main state and hold registry references, so they stay alive until
+	they finish, fail or are cancelled. A task spawned while an owner is set (a block hook, or a task of that owner)
+	belongs to it, and cancelOwnedBy drops them before the owner is destroyed.
+*/
+class LuaTaskScheduler
+{
+public:
+	using Id = std::uint32_t;
+	using Owner = const void*;
+
+	static constexpr Id InvalidId = 0;
+
+public:
+	class OwnerScope;
+
+private:
+	enum class WaitKind : std::uint8_t
+	{
+		None,
+		Time,
+		Frames,
+		Until
+	};
+
+	struct Task
+	{
+		lua_State* thread = nullptr;
+		int threadRef = LUA_NOREF;
+		int predicateRef = LUA_NOREF;
+		Owner owner = nullptr;
+		WaitKind wait = WaitKind::None;
+		bool cancelled = false;
+	};
+
+	struct Wakeup
+	{
+		std::uint64_t when; // Nanoseconds of scheduler time or frame number
+		Id id;
+
+		friend constexpr bool operator> (const Wakeup& left, const Wakeup& right) { return left.when > right.when; }
+	};
+
+	using WakeupHeap = std::priority_queue<Wakeup, std::vector<Wakeup>, std::greater<Wakeup>>;
+
+private:
+	static LuaTaskScheduler Instance;
+
+private:
+	std::unordered_map<Id, Task> _tasks;
+	WakeupHeap _timers;
+	WakeupHeap _frameWaits;
+	std::vector<Id> _polled;
+	std::vector<Id> _due;
+
+	Time _time = {};
+	std::uint64_t _frame = 0;
+	Id _nextId = 1;
+	Id _running = InvalidId;
+	Owner _owner = nullptr;
+
+public:
+	LuaTaskScheduler(const LuaTaskScheduler&) = delete;
+	LuaTaskScheduler(LuaTaskScheduler&&) noexcept = delete;
+
+	LuaTaskScheduler& operator= (const LuaTaskScheduler&) = delete;
+	LuaTaskScheduler& operator= (LuaTaskScheduler&&) noexcept = delete;
+
+private:
+	LuaTaskScheduler() = default;
+	~LuaTaskScheduler() = default;
+
+public:
+	// Advances the scheduler clock by one frame and resumes the tasks that are due //
+	void update(Time elapsedTime);
+
+	// Drops every task, anything they captured from the level must not be touched after it is gone //
+	void clear();
+
+	// Starts the function below its arguments on top of the stack of state as a new task and runs it up to its
+	// first wait. Pops the function and the arguments //
+	Id spawn(lua_State* state, int argumentCount);
+
+	// A running task stops at its next wait //
+	bool cancel(Id id);
+
+	// Cancels every task of owner, returns how many //
+	std::size_t cancelOwnedBy(Owner owner);
+
+	inline bool isAlive(Id id) const
+	{
+		auto it = _tasks.find(id);
+		return it != _tasks.end() && !it->second.cancelled;
+	}
+
+	inline std::size_t getCount() const { return _tasks.size(); }
+
+	constexpr Time getTime() const { return _time; }
+	constexpr std::uint64_t getFrame() const { return _frame; }
+
+	// Called by the wait functions before they yield, fail when thread is not the running task //
+	bool sleep(lua_State* thread, Time time);
+	bool sleepFrames(lua_State* thread, std::uint64_t frames);
+	bool sleepUntil(lua_State* thread, int predicateIndex);
+
+public:
+	static constexpr LuaTaskScheduler& instance() { return Instance; }
+
+private:
+	Task* findRunning(lua_State* thread);
+
+	void resume(Id id, lua_State* from, int argumentCount);
+	void release(Task& task);
+
+	bool isPredicateTrue(Task& task);
+
+	void collectDue(WakeupHeap& heap, std::uint64_t now, WaitKind kind);
+};
+
+
+// Main thread only. Tasks spawned inside the scope belong to owner //
+class LuaTaskScheduler::OwnerScope
+{
+private:
+	Owner _previous;
+
+public:
+	OwnerScope(const OwnerScope&) = delete;
+	OwnerScope(OwnerScope&&) noexcept = delete;
+
+	OwnerScope& operator= (const OwnerScope&) = delete;
+	OwnerScope& operator= (OwnerScope&&) noexcept = delete;
+
+public:
+	inline explicit OwnerScope(Owner owner) : _previous(LuaTaskScheduler::instance()._owner)
+	{
+		LuaTaskScheduler::instance()._owner = owner;
+	}
+
+	inline ~OwnerScope() { LuaTaskScheduler::instance()._owner = _previous; }
+};
@@ -0,0 +1,345 @@
+#include "mesh_cache.h"
+
+#include <cstring>
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <filesystem>
+
+#include "utils/io_utils.h"
+#include "utils/mapped_file.h"
+#include "utils/logger.h"
+
+
+namespace mesh_cache
+{
+	namespace
+	{
+		struct FileHeader
+		{
+			static constexpr std::uint32_t Magic = 0x4d534352; // "RCSM" //
+			static constexpr std::uint32_t CurrentVersion = 3;
+
+			std::uint32_t magic = Magic;
+			std::uint32_t version = CurrentVersion;
+			std::uint32_t flags = 0;
+			std::uint32_t meshCount = 0;
+			std::uint64_t sourceSize = 0;
+			std::int64_t sourceTime = 0;
+			std::uint64_t sourceHash = 0;
+		};
+
+		struct MeshHeader
+		{
+			std::uint32_t nameLength = 0;
+			std::uint32_t attributeCount = 0;
+			std::uint32_t stride = 0;
+			std::uint32_t vertexCount = 0;
+			std::uint32_t indexCount = 0;
+			float minimums[3] = {};
+			float maximums[3] = {};
+		};
+
+		struct AttributeHeader
+		{
+			std::uint32_t index = 0;
+			std::uint32_t componentCount = 0;
+			std::uint32_t type = 0;
+			std::uint32_t normalized = 0;
+			std::uint32_t offset = 0;
+		};
+
+		enum FileFlags : std::uint32_t
+		{
+			TangentBasis = 0x1
+		};
+
+		static constexpr std::size_t align4(std::size_t size) { return (size + 3) & ~std::size_t(3); }
+
+
+		static std::uint64_t hashBytes(const std::uint8_t* data, std::size_t size)
+		{
+			// FNV-1a //
+			std::uint64_t hash = 0xcbf29ce484222325ull;
+			for (std::size_t i = 0; i < size; ++i)
+			{
+				hash ^= data[i];
+				hash *= 0x100000001b3ull;
+			}
+			return hash;
+		}
+
+		static bool readSourceStamp(std::string_view sourceFilename, std::uint64_t& size, std::int64_t& time)
+		{
+			namespace fs = std::filesystem;
+
+			std::error_code ec;
+			const Path path = Path(sourceFilename);
+
+			size = std::uint64_t(fs::file_size(path, ec));
+			if (ec)
+				return false;
+
+			time = std::int64_t(fs::last_write_time(path, ec).time_since_epoch().count());
+			return !ec;
+		}
+
+		static bool hashSource(std::string_view sourceFilename, std::uint64_t& hash)
+		{
+			MappedFile file;
+			if (!file.open(sourceFilename))
+				return false;
+
+			hash = hashBytes(file.data(), file.size());
+			return true;
+		}
+
+
+		class Reader
+		{
+		private:
+			const std::uint8_t* _data;
+			std::size_t _size;
+			std::size_t _offset = 0;
+
+		public:
+			inline Reader(const MappedFile& file) : _data(file.data()), _size(file.size()) {}
+
+			template <typename _Ty>
+			inline bool read(_Ty& value)
+			{
+				if (_offset + sizeof(_Ty) > _size)
+					return false;
+
+				std::memcpy(&value, _data + _offset, sizeof(_Ty));
+				_offset += sizeof(_Ty);
+				return true;
+			}
+
+			inline const std::uint8_t* skip(std::size_t size)
+			{
+				if (_offset + size > _size)
+					return nullptr;
+
+				const std::uint8_t* ptr = _data + _offset;
+				_offset += align4(size);
+				return ptr;
+			}
+		};
+
+		// Only the stamp changes, the meshes stay where they are //
+		static void rewriteHeader(const Path& cachePath, const FileHeader& header)
+		{
+			std::fstream os(cachePath, std::ios::in | std::ios::out | std::ios::binary);
+			if (!os)
+				return;
+
+			os.seekp(0);
+			io::write_obj(os, &header);
+		}
+
+
+		struct MeshView
+		{
+			std::string_view name;
+			gl::VertexFormat format;
+			const std::uint8_t* vertices = nullptr;
+			const GLuint* indices = nullptr;
+			MeshHeader header;
+		};
+	}
+
+
+	Path getCachePath(std::string_view sourceFilename, bool computeTangentBasis)
+	{
+		const Path source = resources::absolute(Path(sourceFilename));
+		const std::string key = source.generic_string();
+		const std::uint64_t hash = hashBytes(reinterpret_cast<const std::uint8_t*>(key.data()), key.size());
+
+		std::string filename = source.stem().string();
+		filename += std::format("-{:016x}{}", hash, computeTangentBasis ? "-t" : "");
+		filename += FileExtension;
+
+		return resources::cache / Path(filename);
+	}
+
+	bool load(Model& model, std::string_view sourceFilename, bool computeTangentBasis)
+	{
+		const Path cachePath = getCachePath(sourceFilename, computeTangentBasis);
+
+		MappedFile file;
+		if (!file.open(cachePath.string()))
+			return false;
+
+		Reader reader = Reader(file);
+
+		FileHeader header;
+		if (!reader.read(header) || header.magic != FileHeader::Magic || header.version != FileHeader::CurrentVersion)
+		{
+			logger::warn("Ignoring invalid mesh cache file {}.", cachePath.string());
+			return false;
+		}
+
+		if (((header.flags & FileFlags::TangentBasis) != 0) != computeTangentBasis)
+			return false;
+
+		std::uint64_t sourceSize;
+		std::int64_t sourceTime;
+		if (!readSourceStamp(sourceFilename, sourceSize, sourceTime))
+			return false;
+
+		// A touched but unchanged source (a checkout, a copy) gets its new stamp written back after the load, so only
+		// this load pays for the hash //
+		bool staleStamp = false;
+		if (sourceSize != header.sourceSize || sourceTime != header.sourceTime)
+		{
+			std::uint64_t sourceHash;
+			if (!hashSource(sourceFilename, sourceHash) || sourceHash != header.sourceHash)
+				return false;
+
+			staleStamp = true;
+		}
+
+		// Validate the whole file before touching the model, so a truncated cache falls back to the OBJ //
+		std::vector<MeshView> views;
+		views.resize(header.meshCount);
+		for (auto& view : views)
+		{
+			if (!reader.read(view.header))
+				return false;
+
+			const auto* name = reader.skip(view.header.nameLength);
+			if (name == nullptr)
+				return false;
+			view.name = std::string_view(reinterpret_cast<const char*>(name), view.header.nameLength);
+
+			for (std::uint32_t i = 0; i < view.header.attributeCount; ++i)
+			{
+				AttributeHeader attr;
+				if (!reader.read(attr))
+					return false;
+
+				view.format.add(GLuint(attr.index), GLint(attr.componentCount), gl::DataType(attr.type), GLboolean(attr.normalized));
+				if (view.format.getAttributes().back().offset != GLsizei(attr.offset))
+					return false;
+			}
+
+			if (view.format.getStride() != GLsizei(view.header.stride))
+				return false;
+
+			view.vertices = reader.skip(std::size_t(view.header.stride) * view.header.vertexCount);
+			view.indices = reinterpret_cast<const GLuint*>(reader.skip(sizeof(GLuint) * view.header.indexCount));
+			if (view.vertices == nullptr || view.indices == nullptr)
+				return false;
+
+			// A corrupt index would make the draw read past the vertex buffer //
+			const GLuint vertexCount = GLuint(view.header.vertexCount);
+			if (std::any_of(view.indices, view.indices + view.header.indexCount, [vertexCount](GLuint index) { return index >= vertexCount; }))
+			{
+				logger::warn("Ignoring mesh cache file {} with out of range indices.", cachePath.string());
+				return false;
+			}
+		}
+
+		if (model.isLocked())
+			return false;
+
+		model.clear();
+		for (const auto& view : views)
+		{
+			auto omesh = model.createMesh(view.name);
+			if (!omesh)
+				continue;
+
+			auto& mesh = *omesh;
+			mesh.setName(view.name);
+			mesh.setInterleavedVertices(view.format, view.vertices, view.header.vertexCount);
+			mesh.setElements(view.indices, view.header.indexCount);
+			mesh.setBounds(
+				{ view.header.minimums[0], view.header.minimums[1], view.header.minimums[2] },
+				{ view.header.maximums[0], view.header.maximums[1], view.header.maximums[2] }
+			);
+		}
+
+		if (staleStamp)
+		{
+			// The mapping keeps the file locked on Windows //
+			file.close();
+
+			header.sourceSize = sourceSize;
+			header.sourceTime = sourceTime;
+			rewriteHeader(cachePath, header);
+		}
+
+		return true;
+	}
+
+	bool store(const std::vector<MeshData>& meshes, std::string_view sourceFilename, bool computeTangentBasis)
+	{
+		namespace fs = std::filesystem;
+
+		FileHeader header;
+		header.flags = computeTangentBasis ? FileFlags::TangentBasis : 0;
+		header.meshCount = std::uint32_t(meshes.size());
+		if (!readSourceStamp(sourceFilename, header.sourceSize, header.sourceTime) || !hashSource(sourceFilename, header.sourceHash))
+			return false;
+
+		const Path cachePath = getCachePath(sourceFilename, computeTangentBasis);
+
+		std::error_code ec;
+		fs::create_directories(cachePath.parent_path(), ec);
+
+		std::ofstream os(cachePath, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!os)
+			return false;
+
+		static constexpr std::uint8_t padding[4] = {};
+		const auto writePadded = [&os](const void* data, std::size_t size) {
+			io::write_bin(os, data, size);
+			io::write_bin(os, padding, align4(size) - size);
+		};
+
+		io::write_obj(os, &header);
+		for (const auto& mesh : meshes)
+		{
+			MeshHeader meshHeader;
+			meshHeader.nameLength = std::uint32_t(mesh.name.size());
+			meshHeader.attributeCount = std::uint32_t(mesh.format.getAttributes().size());
+			meshHeader.stride = std::uint32_t(mesh.format.getStride());
+			meshHeader.vertexCount = std::uint32_t(mesh.getVertexCount());
+			meshHeader.indexCount = std::uint32_t(mesh.indices.size());
+			for (int i = 0; i < 3; ++i)
+			{
+				meshHeader.minimums[i] = mesh.minimums[i];
+				meshHeader.maximums[i] = mesh.maximums[i];
+			}
+
+			io::write_obj(os, &meshHeader);
+			writePadded(mesh.name.data(), mesh.name.size());
+
+			for (const auto& attrFormat : mesh.format.getAttributes())
+			{
+				AttributeHeader attr = {
+					std::uint32_t(attrFormat.index),
+					std::uint32_t(attrFormat.componentCount),
+					std::uint32_t(attrFormat.type),
+					std::uint32_t(attrFormat.normalized),
+					std::uint32_t(attrFormat.offset)
+				};
+				io::write_obj(os, &attr);
+			}
+
+			writePadded(mesh.vertices.data(), mesh.vertices.size());
+			writePadded(mesh.indices.data(), mesh.indices.size() * sizeof(GLuint));
+		}
+
+		if (!os)
+		{
+			os.close();
+			fs::remove(cachePath, ec);
+			return false;
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include "utils/resources.h"
+
+#include "model.h"
+
+
+namespace mesh_cache
+{
+	static constexpr std::string_view FileExtension = ".rcmesh";
+
+	Path getCachePath(std::string_view sourceFilename, bool computeTangentBasis);
+
+	bool load(Model& model, std::string_view sourceFilename, bool computeTangentBasis);
+
+	bool store(const std::vector<MeshData>& meshes, std::string_view sourceFilename, bool computeTangentBasis);
+}
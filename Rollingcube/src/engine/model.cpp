@@ -1,6 +1,7 @@
 #include "model.h"
 
 #include <cassert>
+#include <cstring>
 
 #pragma warning(push)
 #pragma warning(disable: 26451)
@@ -9,6 +10,11 @@
 
 #include "utils/io_utils.h"
 #include "utils/tangent_space.h"
+#include "utils/mesh_optimizer.h"
+#include "core/profiler.h"
+
+#include "mesh_cache.h"
+#include "obj_parser.h"
 
 
 Mesh::Mesh(Mesh&& other) noexcept :
@@ -60,6 +66,37 @@ void Mesh::setColors(const std::vector<Color>& colors)
 	setColors(vcolors);
 }
 
+void Mesh::setInterleavedVertices(const gl::VertexFormat& format, const void* data, std::size_t vertexCount)
+{
+	if (!checkLocked())
+		return;
+
+	_vao.createInterleavedAttributes(format, data, vertexCount, gl::VBO::Usage::StaticDraw);
+
+	_verticesCache.clear();
+	_vertexHintsReload = true;
+
+	const auto* position = format.find(constants::attributes::vertices_array_attrib_index);
+	if (position == nullptr || position->type != gl::DataType::Float || position->componentCount != 3)
+		return;
+
+	const auto* bytes = static_cast<const std::uint8_t*>(data);
+	_verticesCache.resize(vertexCount);
+	for (std::size_t i = 0; i < vertexCount; ++i)
+		std::memcpy(&_verticesCache[i], bytes + (i * format.getStride()) + position->offset, sizeof(glm::vec3));
+}
+
+void Mesh::setBounds(const glm::vec3& minimums, const glm::vec3& maximums)
+{
+	if (!checkLocked())
+		return;
+
+	_vertexMins = minimums;
+	_vertexMaxs = maximums;
+	_size = glm::abs(maximums - minimums);
+	_vertexHintsReload = false;
+}
+
 
 
 
@@ -136,76 +173,210 @@ void Model::render(const std::function<void(const Mesh&)>& preMeshRenderCallback
 
 
 
-using loader_vertex_index_t = decltype(std::declval<objl::Mesh>().Indices)::value_type;
-static bool loader_newMesh(
-	Model& model,
-	const std::string& name,
-	const std::vector<objl::Vertex>& vertices,
-	const std::vector<loader_vertex_index_t>& indices,
-	bool computeTangentBasis)
+bool Model::loadFromData(const std::vector<MeshData>& meshes)
 {
-	auto omesh = model.createMesh(name);
-	if (!omesh)
+	if (!checkLocked())
 		return false;
 
-	auto& mesh = *omesh;
+	for (const auto& data : meshes)
+	{
+		auto omesh = createMesh(data.name);
+		if (!omesh)
+		{
+			logger::error("Cannot create {} mesh.", data.name);
+			continue;
+		}
+
+		auto& mesh = *omesh;
+		mesh.setName(data.name);
+		mesh.setInterleavedVertices(data.format, data.vertices.data(), data.getVertexCount());
+		mesh.setElements(data.indices);
+		mesh.setBounds(data.minimums, data.maximums);
+	}
+
+	_vertexHintsReload = true;
+
+	return true;
+}
+
+
+
+template <typename _Ty>
+static inline void loader_writeVertexComponent(std::uint8_t*& dst, const _Ty& value)
+{
+	std::memcpy(dst, &value, sizeof(_Ty));
+	dst += sizeof(_Ty);
+}
+
+static inline std::uint32_t loader_packNormal(const glm::vec3& normal)
+{
+	// objl falls back to raw face cross products, packing would clamp their components instead of scaling them //
+	const float length = glm::length(normal);
+	const glm::vec3 unit = length > 1e-8f ? normal / length : glm::vec3(0.f);
+	return glm::packSnorm3x10_1x2(glm::vec4(unit, 0.f));
+}
+
+static MeshData loader_newMeshData(const obj::Mesh& mesh, bool computeTangentBasis)
+{
+	namespace attributes = constants::attributes;
+
+	MeshData data;
+	data.name = mesh.name;
+
+
+	// WELD PART //
+	// Corners sharing position, UV and normal are merged first, so the tangents get accumulated over the shared vertices //
+	struct FloatVertex
+	{
+		glm::vec3 position;
+		glm::vec2 uv;
+		glm::vec3 normal;
+	};
+
+	std::vector<std::uint8_t> floatVertices;
+	floatVertices.resize(sizeof(FloatVertex) * mesh.positions.size());
+	for (std::size_t i = 0; i < mesh.positions.size(); ++i)
+	{
+		const FloatVertex vertex = { mesh.positions[i], mesh.uvs[i], mesh.normals[i] };
+		std::memcpy(floatVertices.data() + (i * sizeof(FloatVertex)), &vertex, sizeof(FloatVertex));
+	}
+
+	data.indices.assign(mesh.indices.begin(), mesh.indices.end());
+	const std::size_t count = mesh_optimizer::weldVertices(floatVertices, sizeof(FloatVertex), data.indices);
 
 
 	// VERTEX PART //
 	std::vector<glm::vec3> gl_vertices;
 	std::vector<glm::vec2> gl_uvs;
 	std::vector<glm::vec3> gl_normals;
-	gl_vertices.resize(vertices.size());
-	gl_uvs.resize(vertices.size());
-	gl_normals.resize(vertices.size());
+	gl_vertices.resize(count);
+	gl_uvs.resize(count);
+	gl_normals.resize(count);
 
-	for (std::size_t i = 0; i < vertices.size(); ++i)
+	bool snormUVs = true;
+	for (std::size_t i = 0; i < count; ++i)
 	{
-		const auto& vertex = vertices[i];
-		gl_vertices[i] = { vertex.Position.X, vertex.Position.Y, vertex.Position.Z };
-		gl_uvs[i] = { vertex.TextureCoordinate.X, vertex.TextureCoordinate.Y };
-		gl_normals[i] = { vertex.Normal.X, vertex.Normal.Y, vertex.Normal.Z };
+		FloatVertex vertex;
+		std::memcpy(&vertex, floatVertices.data() + (i * sizeof(FloatVertex)), sizeof(FloatVertex));
+
+		gl_vertices[i] = vertex.position;
+		gl_uvs[i] = vertex.uv;
+		gl_normals[i] = vertex.normal;
+
+		snormUVs = snormUVs && glm::all(glm::lessThanEqual(glm::abs(vertex.uv), glm::vec2(1.f)));
 	}
 
-	mesh.setVertices(gl_vertices);
-	mesh.setUVs(gl_uvs);
-	mesh.setNormals(gl_normals);
+	// UVs are packed as normalized shorts when they fit in [-1, 1], otherwise as half floats (tiling UVs) //
+	data.format
+		.add(attributes::vertices_array_attrib_index, 3, gl::DataType::Float)
+		.add(attributes::uvs_array_attrib_index, 2, snormUVs ? gl::DataType::Short : gl::DataType::HalfFloat, snormUVs ? GL_TRUE : GL_FALSE)
+		.add(attributes::normals_array_attrib_index, 4, gl::DataType::Int_2_10_10_10_rev, GL_TRUE);
 
 
 	// TANGENT PART //
+	std::vector<glm::vec4> gl_tangents;
 	if (computeTangentBasis)
 	{
-		std::vector<glm::vec3> gl_tangents;
-		std::vector<glm::vec3> gl_bitangents;
+		tangents::computeTangentBasis(gl_vertices, gl_uvs, gl_normals, data.indices, gl_tangents);
+
+		// The bitangent is rebuilt in the shader from the normal, the tangent and the handedness stored in tangent.w //
+		data.format.add(attributes::tangents_array_attrib_index, 4, gl::DataType::Int_2_10_10_10_rev, GL_TRUE);
+	}
+
 
-		tangents::computeTangentBasis(gl_vertices, gl_uvs, gl_normals, gl_tangents, gl_bitangents);
+	// INTERLEAVE PART //
+	const std::size_t stride = std::size_t(data.format.getStride());
+	data.vertices.resize(stride * count);
 
-		mesh.setTangents(gl_tangents);
-		mesh.setBitangents(gl_bitangents);
+	std::uint8_t* dst = data.vertices.data();
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		loader_writeVertexComponent(dst, gl_vertices[i]);
+		loader_writeVertexComponent(dst, snormUVs ? glm::packSnorm2x16(gl_uvs[i]) : glm::packHalf2x16(gl_uvs[i]));
+		loader_writeVertexComponent(dst, loader_packNormal(gl_normals[i]));
+		if (computeTangentBasis)
+			loader_writeVertexComponent(dst, glm::packSnorm3x10_1x2(gl_tangents[i]));
 	}
 
 
-	// INDEX PART //
-	std::vector<GLuint> gl_indices;
-	if constexpr (std::same_as<GLuint, loader_vertex_index_t>)
-		mesh.setElements(indices);
-	else
+	// OPTIMIZATION PART //
+	const std::size_t vertexCount = mesh_optimizer::weldVertices(data.vertices, stride, data.indices);
+	mesh_optimizer::optimizeVertexCache(data.indices, vertexCount);
+
+	std::vector<glm::vec3> positions;
+	positions.resize(vertexCount);
+	for (std::size_t i = 0; i < vertexCount; ++i)
+		std::memcpy(&positions[i], data.vertices.data() + (i * stride), sizeof(glm::vec3));
+
+	mesh_optimizer::optimizeOverdraw(data.indices, positions);
+	mesh_optimizer::optimizeVertexFetch(data.vertices, stride, data.indices);
+
+
+	// BOUNDS PART //
+	data.minimums = positions.empty() ? glm::vec3() : positions.front();
+	data.maximums = data.minimums;
+	for (const auto& position : positions)
 	{
-		std::vector<GLuint> gl_indices;
-		gl_indices.resize(indices.size());
+		data.minimums = glm::min(data.minimums, position);
+		data.maximums = glm::max(data.maximums, position);
+	}
 
-		for (std::size_t i = 0; i < indices.size(); ++i)
-		{
-			const auto& index = indices[i];
-			gl_indices[i] = GLuint(indices[i]);
-		}
-		mesh.setElements(gl_indices);
+	return data;
+}
+
+bool Model::load(const std::string_view& filename, bool computeTangentBasis, bool storeCache)
+{
+	PROFILE_SCOPE_CATEGORY("Model::load", ProfileCategory::Asset);
+
+	if (!checkLocked())
+		return false;
+
+	internalClear();
+
+	std::vector<obj::Mesh> objMeshes;
+	if (!obj::parse(filename, objMeshes))
+	{
+		logger::error("Loading OBJ error in file: {}", filename);
+		return false;
 	}
 
+	if (objMeshes.empty())
+		return true;
+
+	std::vector<MeshData> meshes;
+	meshes.reserve(objMeshes.size());
+	for (const auto& mesh : objMeshes)
+		meshes.push_back(loader_newMeshData(mesh, computeTangentBasis));
+
+	if (!loadFromData(meshes))
+		return false;
+
+	if (storeCache && !mesh_cache::store(meshes, filename, computeTangentBasis))
+		logger::warn("Cannot store mesh cache for model {}.", filename);
+
 	return true;
 }
 
-bool Model::load(const std::string_view& filename, bool computeTangentBasis)
+static obj::Mesh loader_fromObjl(const std::string& name, const std::vector<objl::Vertex>& vertices, const std::vector<unsigned int>& indices)
+{
+	obj::Mesh mesh;
+	mesh.name = name;
+	mesh.positions.reserve(vertices.size());
+	mesh.uvs.reserve(vertices.size());
+	mesh.normals.reserve(vertices.size());
+
+	for (const auto& vertex : vertices)
+	{
+		mesh.positions.push_back({ vertex.Position.X, vertex.Position.Y, vertex.Position.Z });
+		mesh.uvs.push_back({ vertex.TextureCoordinate.X, vertex.TextureCoordinate.Y });
+		mesh.normals.push_back({ vertex.Normal.X, vertex.Normal.Y, vertex.Normal.Z });
+	}
+
+	mesh.indices.assign(indices.begin(), indices.end());
+	return mesh;
+}
+
+bool Model::loadWithReferenceLoader(const std::string_view& filename, bool computeTangentBasis)
 {
 	if (!checkLocked())
 		return false;
@@ -219,21 +390,22 @@ bool Model::load(const std::string_view& filename, bool computeTangentBasis)
 		return false;
 	}
 
+	std::vector<MeshData> meshes;
 	if (loader.LoadedMeshes.empty())
 	{
-		if (!loader.LoadedVertices.empty())
-			return loader_newMesh(*this, "default", loader.LoadedVertices, loader.LoadedIndices, computeTangentBasis);
+		if (loader.LoadedVertices.empty())
+			return true;
+
+		meshes.push_back(loader_newMeshData(loader_fromObjl("default", loader.LoadedVertices, loader.LoadedIndices), computeTangentBasis));
 	}
 	else
 	{
+		meshes.reserve(loader.LoadedMeshes.size());
 		for (const auto& mesh : loader.LoadedMeshes)
-		{
-			if (!loader_newMesh(*this, mesh.MeshName, mesh.Vertices, mesh.Indices, computeTangentBasis))
-				std::cerr << "Loading OBJ error. Cannot load " << mesh.MeshName << " mesh. File: " << filename << std::endl;
-		}
+			meshes.push_back(loader_newMeshData(loader_fromObjl(mesh.MeshName, mesh.Vertices, mesh.Indices), computeTangentBasis));
 	}
 
-	return true;
+	return loadFromData(meshes);
 }
 
 
@@ -253,9 +425,9 @@ ModelManager::Reference ModelManager::loadFromFile(const IdType& key, std::strin
 	if (!ref)
 		return nullptr;
 
-	if (!ref->load(filename, computeTangentBasis))
+	if (!mesh_cache::load(*ref, filename, computeTangentBasis) && !ref->load(filename, computeTangentBasis, true))
 	{
-		destroy(filename.data());
+		destroy(key);
 		return nullptr;
 	}
 
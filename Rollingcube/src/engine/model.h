@@ -10,6 +10,7 @@
 
 #include "core/gl.h"
 #include "core/render.h"
+#include "core/vertex_format.h"
 #include "math/glm.h"
 #include "math/color.h"
 #include "utils/optref.h"
@@ -25,6 +26,19 @@ class Model;
 class ModelManager;
 
 
+struct MeshData
+{
+	std::string name;
+	gl::VertexFormat format;
+	std::vector<std::uint8_t> vertices;
+	std::vector<GLuint> indices;
+	glm::vec3 minimums = {};
+	glm::vec3 maximums = {};
+
+	inline std::size_t getVertexCount() const { return format.getStride() > 0 ? vertices.size() / std::size_t(format.getStride()) : 0; }
+};
+
+
 class Mesh
 {
 private:
@@ -117,6 +131,19 @@ public:
 		}
 	}
 
+	inline void setElements(const vertex_index_type* elements, std::size_t count)
+	{
+		if (checkLocked())
+		{
+			_ebo.write(elements, count, gl::EBO::Usage::StaticDraw);
+			_elementCount = GLsizei(count);
+		}
+	}
+
+	void setInterleavedVertices(const gl::VertexFormat& format, const void* data, std::size_t vertexCount);
+
+	void setBounds(const glm::vec3& minimums, const glm::vec3& maximums);
+
 	inline void setName(const std::string_view& name) { if (checkLocked()) _name = name; }
 	inline const std::string& getName() const { return _name; }
 
@@ -243,7 +270,12 @@ public:
 	void render(GLenum mode = GL_TRIANGLES) const;
 	void render(const std::function<void(const Mesh&)>& preMeshRenderCallback, GLenum mode = GL_TRIANGLES) const;
 
-	bool load(const std::string_view& filename, bool computeTangentBasis);
+	bool load(const std::string_view& filename, bool computeTangentBasis, bool storeCache = false);
+
+	// Loads through the vendored objl loader, kept as a reference to validate the OBJ parser against //
+	bool loadWithReferenceLoader(const std::string_view& filename, bool computeTangentBasis);
+
+	bool loadFromData(const std::vector<MeshData>& meshes);
 
 	inline void clear()
 	{
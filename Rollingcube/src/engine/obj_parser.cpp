@@ -0,0 +1,602 @@
+#include "obj_parser.h"
+
+#include <limits>
+#include <future>
+#include <charconv>
+#include <algorithm>
+
+#pragma warning(push)
+#pragma warning(disable: 26451)
+#include <Bly7/OBJ_loader.hpp>
+#pragma warning(pop)
+
+#include "core/thread_pool.h"
+#include "utils/mapped_file.h"
+#include "utils/logger.h"
+
+
+namespace obj
+{
+	namespace
+	{
+		static constexpr std::int32_t NoIndex = std::numeric_limits<std::int32_t>::min();
+		static constexpr std::size_t MinChunkSize = 256 * 1024;
+
+		enum RelativeIndexFlags : std::uint8_t
+		{
+			RelativePosition = 0x1,
+			RelativeUV = 0x2,
+			RelativeNormal = 0x4
+		};
+
+		struct Corner
+		{
+			std::int32_t position = NoIndex;
+			std::int32_t uv = NoIndex;
+			std::int32_t normal = NoIndex;
+			std::uint8_t relative = 0;
+		};
+
+		enum class SegmentEvent
+		{
+			None,
+			Group,
+			UnnamedGroup,
+			Material
+		};
+
+		struct Segment
+		{
+			SegmentEvent event = SegmentEvent::None;
+			std::string name;
+			std::vector<Corner> corners;
+			std::vector<std::uint32_t> faceSizes;
+
+			Mesh geometry;
+		};
+
+		struct Chunk
+		{
+			std::string_view text;
+
+			std::vector<glm::vec3> positions;
+			std::vector<glm::vec2> uvs;
+			std::vector<glm::vec3> normals;
+			std::vector<Segment> segments;
+
+			std::size_t positionBase = 0;
+			std::size_t uvBase = 0;
+			std::size_t normalBase = 0;
+
+			bool valid = true;
+		};
+
+		struct Attributes
+		{
+			std::vector<glm::vec3> positions;
+			std::vector<glm::vec2> uvs;
+			std::vector<glm::vec3> normals;
+		};
+
+
+
+		static constexpr std::string_view Blanks = " \t";
+
+		static inline std::string_view trim(std::string_view sv)
+		{
+			const std::size_t start = sv.find_first_not_of(Blanks);
+			if (start == std::string_view::npos)
+				return {};
+
+			const std::size_t end = sv.find_last_not_of(Blanks);
+			return sv.substr(start, end - start + 1);
+		}
+
+		static inline std::string_view nextToken(std::string_view& sv)
+		{
+			const std::size_t start = sv.find_first_not_of(Blanks);
+			if (start == std::string_view::npos)
+			{
+				sv = {};
+				return {};
+			}
+
+			const std::size_t end = sv.find_first_of(Blanks, start);
+			const std::string_view token = sv.substr(start, end - start);
+			sv = end == std::string_view::npos ? std::string_view() : sv.substr(end);
+			return token;
+		}
+
+		static inline bool parseFloat(std::string_view token, float& value)
+		{
+			if (!token.empty() && token.front() == '+')
+				token.remove_prefix(1);
+
+			const auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+			return result.ec == std::errc();
+		}
+
+		template <std::size_t _Count>
+		static inline bool parseFloats(std::string_view sv, float (&values)[_Count])
+		{
+			for (std::size_t i = 0; i < _Count; ++i)
+				if (!parseFloat(nextToken(sv), values[i]))
+					return false;
+			return true;
+		}
+
+		static inline bool parseIndex(std::string_view token, std::size_t currentCount, std::int32_t& index, bool& relative)
+		{
+			std::int32_t value = 0;
+			const auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+			if (result.ec != std::errc() || value == 0)
+				return false;
+
+			relative = value < 0;
+			index = relative ? std::int32_t(currentCount) + value : value - 1;
+			return true;
+		}
+
+		static bool parseCorner(Chunk& chunk, std::string_view token, Corner& corner)
+		{
+			std::string_view parts[3];
+			std::size_t count = 0;
+			for (;;)
+			{
+				const std::size_t slash = token.find('/');
+				if (count == 2 || slash == std::string_view::npos)
+				{
+					parts[count++] = token;
+					break;
+				}
+				parts[count++] = token.substr(0, slash);
+				token.remove_prefix(slash + 1);
+			}
+
+			bool relative = false;
+			if (!parseIndex(parts[0], chunk.positions.size(), corner.position, relative))
+				return false;
+			if (relative)
+				corner.relative |= RelativePosition;
+
+			if (count >= 2 && !parts[1].empty())
+			{
+				if (!parseIndex(parts[1], chunk.uvs.size(), corner.uv, relative))
+					return false;
+				if (relative)
+					corner.relative |= RelativeUV;
+			}
+
+			if (count == 3)
+			{
+				if (!parseIndex(parts[2], chunk.normals.size(), corner.normal, relative))
+					return false;
+				if (relative)
+					corner.relative |= RelativeNormal;
+			}
+
+			return true;
+		}
+
+		static void parseLine(Chunk& chunk, std::string_view line)
+		{
+			if (!line.empty() && line.back() == '\r')
+				line.remove_suffix(1);
+
+			std::string_view rest = line;
+			const std::string_view token = nextToken(rest);
+			if (token.empty())
+				return;
+
+			// Same grouping rule as objl, including its "line starts with g" quirk //
+			if (token == "o" || token == "g" || line.front() == 'g')
+			{
+				Segment& segment = chunk.segments.emplace_back();
+				segment.event = token == "o" || token == "g" ? SegmentEvent::Group : SegmentEvent::UnnamedGroup;
+				segment.name = std::string(trim(rest));
+				return;
+			}
+
+			if (token == "v")
+			{
+				float values[3];
+				if (!parseFloats(rest, values))
+				{
+					chunk.valid = false;
+					return;
+				}
+				chunk.positions.push_back({ values[0], values[1], values[2] });
+			}
+			else if (token == "vt")
+			{
+				float values[2];
+				if (!parseFloats(rest, values))
+				{
+					chunk.valid = false;
+					return;
+				}
+				chunk.uvs.push_back({ values[0], values[1] });
+			}
+			else if (token == "vn")
+			{
+				float values[3];
+				if (!parseFloats(rest, values))
+				{
+					chunk.valid = false;
+					return;
+				}
+				chunk.normals.push_back({ values[0], values[1], values[2] });
+			}
+			else if (token == "f")
+			{
+				Segment& segment = chunk.segments.back();
+
+				std::uint32_t size = 0;
+				for (std::string_view cornerToken = nextToken(rest); !cornerToken.empty(); cornerToken = nextToken(rest))
+				{
+					Corner corner;
+					if (!parseCorner(chunk, cornerToken, corner))
+					{
+						chunk.valid = false;
+						return;
+					}
+
+					segment.corners.push_back(corner);
+					++size;
+				}
+				segment.faceSizes.push_back(size);
+			}
+			else if (token == "usemtl")
+			{
+				Segment& segment = chunk.segments.emplace_back();
+				segment.event = SegmentEvent::Material;
+				segment.name = std::string(trim(rest));
+			}
+		}
+
+		static void parseChunk(Chunk& chunk)
+		{
+			chunk.segments.emplace_back();
+
+			std::string_view text = chunk.text;
+			while (!text.empty() && chunk.valid)
+			{
+				const std::size_t end = text.find('\n');
+				parseLine(chunk, text.substr(0, end));
+				text = end == std::string_view::npos ? std::string_view() : text.substr(end + 1);
+			}
+		}
+
+
+
+		static inline objl::Vector3 toObjl(const glm::vec3& v) { return objl::Vector3(v.x, v.y, v.z); }
+
+		// Port of objl::Loader::VertexTriangluation working on positions, so the produced indices are the same //
+		static void triangulate(std::vector<std::uint32_t>& out, std::uint32_t base, const glm::vec3* positions, std::size_t count)
+		{
+			if (count < 3)
+				return;
+
+			if (count == 3)
+			{
+				out.push_back(base);
+				out.push_back(base + 1);
+				out.push_back(base + 2);
+				return;
+			}
+
+			const std::size_t outStart = out.size();
+			const auto emit = [&out, base, positions](std::size_t checkCount, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+				for (std::size_t j = 0; j < checkCount; ++j)
+				{
+					if (positions[j] == a)
+						out.push_back(base + std::uint32_t(j));
+					if (positions[j] == b)
+						out.push_back(base + std::uint32_t(j));
+					if (positions[j] == c)
+						out.push_back(base + std::uint32_t(j));
+				}
+			};
+
+			std::vector<glm::vec3> tVerts = std::vector<glm::vec3>(positions, positions + count);
+
+			for (;;)
+			{
+				bool clipped = false;
+				for (int i = 0; i < int(tVerts.size()); i++)
+				{
+					const glm::vec3 prev = i == 0 ? tVerts.back() : tVerts[i - 1];
+					const glm::vec3 cur = tVerts[i];
+					const glm::vec3 next = i == int(tVerts.size()) - 1 ? tVerts.front() : tVerts[i + 1];
+
+					if (tVerts.size() == 3)
+					{
+						emit(3, cur, prev, next);
+						tVerts.clear();
+						break;
+					}
+
+					if (tVerts.size() == 4)
+					{
+						emit(count, cur, prev, next);
+
+						glm::vec3 last = {};
+						for (const auto& v : tVerts)
+						{
+							if (v != cur && v != prev && v != next)
+							{
+								last = v;
+								break;
+							}
+						}
+
+						emit(count, prev, next, last);
+						tVerts.clear();
+						break;
+					}
+
+					bool inTriangle = false;
+					for (std::size_t j = 0; j < count; ++j)
+					{
+						if (objl::algorithm::inTriangle(toObjl(positions[j]), toObjl(prev), toObjl(cur), toObjl(next))
+							&& positions[j] != prev
+							&& positions[j] != cur
+							&& positions[j] != next)
+						{
+							inTriangle = true;
+							break;
+						}
+					}
+					if (inTriangle)
+						continue;
+
+					emit(count, cur, prev, next);
+					clipped = true;
+
+					auto it = std::find(tVerts.begin(), tVerts.end(), cur);
+					if (it != tVerts.end())
+						tVerts.erase(it);
+
+					i = -1;
+				}
+
+				// objl spins forever on polygons without a clippable ear, stop instead //
+				if (out.size() == outStart || tVerts.empty() || !clipped)
+					break;
+			}
+		}
+
+		static void buildChunk(Chunk& chunk, const Attributes& attributes)
+		{
+			for (auto& segment : chunk.segments)
+			{
+				Mesh& geometry = segment.geometry;
+				geometry.positions.reserve(segment.corners.size());
+				geometry.uvs.reserve(segment.corners.size());
+				geometry.normals.reserve(segment.corners.size());
+				geometry.indices.reserve(segment.corners.size() * 3 / 2);
+
+				std::size_t cursor = 0;
+				for (const auto faceSize : segment.faceSizes)
+				{
+					const std::uint32_t base = std::uint32_t(geometry.positions.size());
+					bool noNormal = false;
+
+					for (std::size_t k = 0; k < faceSize; ++k)
+					{
+						const Corner& corner = segment.corners[cursor + k];
+
+						const std::int64_t position = std::int64_t(corner.position) + ((corner.relative & RelativePosition) ? std::int64_t(chunk.positionBase) : 0);
+						if (position < 0 || position >= std::int64_t(attributes.positions.size()))
+						{
+							chunk.valid = false;
+							return;
+						}
+						geometry.positions.push_back(attributes.positions[std::size_t(position)]);
+
+						if (corner.uv == NoIndex)
+							geometry.uvs.push_back({ 0, 0 });
+						else
+						{
+							const std::int64_t uv = std::int64_t(corner.uv) + ((corner.relative & RelativeUV) ? std::int64_t(chunk.uvBase) : 0);
+							if (uv < 0 || uv >= std::int64_t(attributes.uvs.size()))
+							{
+								chunk.valid = false;
+								return;
+							}
+							geometry.uvs.push_back(attributes.uvs[std::size_t(uv)]);
+						}
+
+						if (corner.normal == NoIndex)
+						{
+							geometry.normals.push_back({ 0, 0, 0 });
+							noNormal = true;
+						}
+						else
+						{
+							const std::int64_t normal = std::int64_t(corner.normal) + ((corner.relative & RelativeNormal) ? std::int64_t(chunk.normalBase) : 0);
+							if (normal < 0 || normal >= std::int64_t(attributes.normals.size()))
+							{
+								chunk.valid = false;
+								return;
+							}
+							geometry.normals.push_back(attributes.normals[std::size_t(normal)]);
+						}
+					}
+
+					// Same flat (unnormalized) fallback normal as objl //
+					if (noNormal && faceSize >= 3)
+					{
+						const glm::vec3 normal = glm::cross(geometry.positions[base] - geometry.positions[base + 1], geometry.positions[base + 2] - geometry.positions[base + 1]);
+						for (std::size_t k = 0; k < faceSize; ++k)
+							geometry.normals[base + k] = normal;
+					}
+
+					triangulate(geometry.indices, base, geometry.positions.data() + base, faceSize);
+					cursor += faceSize;
+				}
+			}
+		}
+
+		static void appendGeometry(Mesh& dst, const Mesh& src)
+		{
+			const std::uint32_t base = std::uint32_t(dst.positions.size());
+
+			dst.positions.insert(dst.positions.end(), src.positions.begin(), src.positions.end());
+			dst.uvs.insert(dst.uvs.end(), src.uvs.begin(), src.uvs.end());
+			dst.normals.insert(dst.normals.end(), src.normals.begin(), src.normals.end());
+
+			dst.indices.reserve(dst.indices.size() + src.indices.size());
+			for (const auto index : src.indices)
+				dst.indices.push_back(base + index);
+		}
+	}
+
+
+
+	bool parse(std::string_view filename, std::vector<Mesh>& meshes)
+	{
+		meshes.clear();
+
+		MappedFile file;
+		if (!file.open(filename))
+		{
+			logger::error("Cannot open OBJ file {}.", filename);
+			return false;
+		}
+
+		const std::string_view text = std::string_view(reinterpret_cast<const char*>(file.data()), file.size());
+
+		// SPLIT PASS //
+		ThreadPool& pool = ThreadPool::instance();
+		const std::size_t maxChunks = std::max<std::size_t>(1, pool.getWorkerCount());
+		const std::size_t chunkCount = std::clamp<std::size_t>(text.size() / MinChunkSize, 1, maxChunks);
+
+		std::vector<Chunk> chunks;
+		chunks.reserve(chunkCount);
+		for (std::size_t offset = 0; offset < text.size();)
+		{
+			std::size_t end = chunks.size() + 1 == chunkCount ? text.size() : std::min(text.size(), offset + (text.size() / chunkCount));
+			end = end >= text.size() ? text.size() : text.find('\n', end);
+			end = end == std::string_view::npos ? text.size() : end + 1;
+
+			chunks.emplace_back().text = text.substr(offset, end - offset);
+			offset = end;
+		}
+
+		const auto runOnChunks = [&pool, &chunks](const auto& function) {
+			std::vector<std::future<void>> pending;
+			pending.reserve(chunks.size());
+			for (std::size_t i = 1; i < chunks.size(); ++i)
+				pending.push_back(pool.submit([&function, &chunk = chunks[i]]() { function(chunk); }));
+
+			if (!chunks.empty())
+				function(chunks.front());
+
+			for (auto& future : pending)
+				future.get();
+		};
+
+
+		// PARSE PASS //
+		runOnChunks([](Chunk& chunk) { parseChunk(chunk); });
+
+		Attributes attributes;
+		{
+			std::size_t positions = 0, uvs = 0, normals = 0;
+			for (auto& chunk : chunks)
+			{
+				if (!chunk.valid)
+				{
+					logger::error("Ill-formed OBJ file {}.", filename);
+					return false;
+				}
+
+				chunk.positionBase = positions;
+				chunk.uvBase = uvs;
+				chunk.normalBase = normals;
+				positions += chunk.positions.size();
+				uvs += chunk.uvs.size();
+				normals += chunk.normals.size();
+			}
+
+			attributes.positions.reserve(positions);
+			attributes.uvs.reserve(uvs);
+			attributes.normals.reserve(normals);
+			for (auto& chunk : chunks)
+			{
+				attributes.positions.insert(attributes.positions.end(), chunk.positions.begin(), chunk.positions.end());
+				attributes.uvs.insert(attributes.uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+				attributes.normals.insert(attributes.normals.end(), chunk.normals.begin(), chunk.normals.end());
+			}
+		}
+
+
+		// BUILD PASS //
+		runOnChunks([&attributes](Chunk& chunk) { buildChunk(chunk, attributes); });
+
+
+		// MERGE PASS (objl mesh splitting rules) //
+		bool listening = false;
+		std::string meshName;
+		Mesh current;
+
+		const auto pushCurrent = [&meshes, &current](std::string name) {
+			current.name = std::move(name);
+			meshes.push_back(std::move(current));
+			current = {};
+		};
+
+		for (auto& chunk : chunks)
+		{
+			if (!chunk.valid)
+			{
+				logger::error("OBJ file {} references missing vertex data.", filename);
+				meshes.clear();
+				return false;
+			}
+
+			for (auto& segment : chunk.segments)
+			{
+				const bool hasGeometry = !current.indices.empty() && !current.positions.empty();
+
+				switch (segment.event)
+				{
+					case SegmentEvent::Group:
+					case SegmentEvent::UnnamedGroup:
+						if (!listening)
+						{
+							listening = true;
+							meshName = segment.event == SegmentEvent::Group ? segment.name : "unnamed";
+						}
+						else if (hasGeometry)
+						{
+							pushCurrent(meshName);
+							meshName = segment.name;
+						}
+						else
+							meshName = segment.event == SegmentEvent::Group ? segment.name : "unnamed";
+						break;
+
+					case SegmentEvent::Material:
+						if (hasGeometry)
+							pushCurrent(meshName + "_2");
+						break;
+
+					default:
+						break;
+				}
+
+				if (current.positions.empty())
+					current = std::move(segment.geometry);
+				else
+					appendGeometry(current, segment.geometry);
+			}
+		}
+
+		if (!current.indices.empty() && !current.positions.empty())
+			pushCurrent(meshName);
+
+		return true;
+	}
+}
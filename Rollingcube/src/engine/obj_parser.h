@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "math/glm.h"
+
+
+namespace obj
+{
+	struct Mesh
+	{
+		std::string name;
+		std::vector<glm::vec3> positions;
+		std::vector<glm::vec2> uvs;
+		std::vector<glm::vec3> normals;
+		std::vector<std::uint32_t> indices;
+	};
+
+	/*
+		Parses the v/vt/vn/f/o/g/usemtl subset of OBJ used by the models, splitting the file in line aligned ranges
+		parsed concurrently on the ThreadPool. The output mirrors the vendored objl loader: same mesh splitting and
+		naming rules, one vertex per face corner, same polygon triangulation and the same generated flat normals.
+	*/
+	bool parse(std::string_view filename, std::vector<Mesh>& meshes);
+}
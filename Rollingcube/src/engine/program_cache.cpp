@@ -0,0 +1,148 @@
+#include "program_cache.h"
+
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <filesystem>
+#include <vector>
+
+#include "utils/io_utils.h"
+#include "utils/mapped_file.h"
+#include "utils/logger.h"
+
+
+namespace program_cache
+{
+	namespace
+	{
+		struct FileHeader
+		{
+			static constexpr std::uint32_t Magic = 0x50534352; // "RCSP" //
+			static constexpr std::uint32_t CurrentVersion = 1;
+
+			std::uint32_t magic = Magic;
+			std::uint32_t version = CurrentVersion;
+			std::uint32_t format = 0;
+			std::uint32_t length = 0;
+			std::uint64_t sourceHash = 0;
+			std::uint64_t driverHash = 0;
+		};
+
+
+		static std::uint64_t hashBytes(const std::uint8_t* data, std::size_t size, std::uint64_t hash = 0xcbf29ce484222325ull)
+		{
+			// FNV-1a //
+			for (std::size_t i = 0; i < size; ++i)
+			{
+				hash ^= data[i];
+				hash *= 0x100000001b3ull;
+			}
+			return hash;
+		}
+
+		static inline std::uint64_t hashString(std::string_view str, std::uint64_t hash = 0xcbf29ce484222325ull)
+		{
+			// The terminator keeps "ab" + "c" apart from "a" + "bc" //
+			hash = hashBytes(reinterpret_cast<const std::uint8_t*>(str.data()), str.size(), hash);
+			return hashBytes(reinterpret_cast<const std::uint8_t*>(""), 1, hash);
+		}
+
+		static std::uint64_t hashDriver()
+		{
+			// A driver update may change the binary format without changing its id, its version string covers that //
+			auto& backend = gl::backend();
+			std::uint64_t hash = hashString(backend.getString(GL_VENDOR));
+			hash = hashString(backend.getString(GL_RENDERER), hash);
+			return hashString(backend.getString(GL_VERSION), hash);
+		}
+	}
+
+
+	bool isSupported()
+	{
+		if (!GLEW_VERSION_4_1 && !GLEW_ARB_get_program_binary)
+			return false;
+
+		return gl::backend().getInteger(GL_NUM_PROGRAM_BINARY_FORMATS) > 0;
+	}
+
+	std::uint64_t hashSources(std::initializer_list<std::string_view> sources)
+	{
+		std::uint64_t hash = 0xcbf29ce484222325ull;
+		for (std::string_view source : sources)
+			hash = hashString(source, hash);
+		return hash;
+	}
+
+	Path getCachePath(std::string_view programId)
+	{
+		const std::uint64_t hash = hashString(programId);
+		return resources::cache / Path(std::format("program-{:016x}{}", hash, FileExtension));
+	}
+
+	bool load(ShaderProgram& program, std::string_view programId, std::uint64_t sourceHash)
+	{
+		const Path cachePath = getCachePath(programId);
+
+		MappedFile file;
+		if (!file.open(cachePath.string()))
+			return false;
+
+		FileHeader header;
+		if (file.size() < sizeof(FileHeader))
+			return false;
+		std::memcpy(&header, file.data(), sizeof(FileHeader));
+
+		if (header.magic != FileHeader::Magic || header.version != FileHeader::CurrentVersion)
+		{
+			logger::warn("Ignoring invalid shader program cache file {}.", cachePath.string());
+			return false;
+		}
+
+		if (header.sourceHash != sourceHash || header.driverHash != hashDriver())
+			return false;
+
+		if (file.size() - sizeof(FileHeader) < header.length)
+			return false;
+
+		return program.loadBinary(GLenum(header.format), file.data() + sizeof(FileHeader), GLsizei(header.length));
+	}
+
+	bool store(const ShaderProgram& program, std::string_view programId, std::uint64_t sourceHash)
+	{
+		namespace fs = std::filesystem;
+
+		if (!program.isLinked())
+			return false;
+
+		std::vector<std::uint8_t> binary;
+		FileHeader header;
+		header.format = std::uint32_t(program.getBinary(binary));
+		header.length = std::uint32_t(binary.size());
+		header.sourceHash = sourceHash;
+		header.driverHash = hashDriver();
+		if (binary.empty())
+			return false;
+
+		const Path cachePath = getCachePath(programId);
+
+		std::error_code ec;
+		fs::create_directories(cachePath.parent_path(), ec);
+
+		std::ofstream os(cachePath, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!os)
+			return false;
+
+		io::write_obj(os, &header);
+		io::write_bin(os, binary.data(), binary.size());
+
+		if (!os)
+		{
+			os.close();
+			fs::remove(cachePath, ec);
+			return false;
+		}
+
+		return true;
+	}
+}
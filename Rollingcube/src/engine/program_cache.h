@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <initializer_list>
+
+#include "utils/resources.h"
+
+#include "shader.h"
+
+
+namespace program_cache
+{
+	static constexpr std::string_view FileExtension = ".rcprog";
+
+	// Needs program binaries and at least one binary format, some drivers expose the extension with none //
+	bool isSupported();
+
+	std::uint64_t hashSources(std::initializer_list<std::string_view> sources);
+
+	Path getCachePath(std::string_view programId);
+
+	// Fails when the file was written for other sources or another driver, or the driver rejects the binary //
+	bool load(ShaderProgram& program, std::string_view programId, std::uint64_t sourceHash);
+
+	bool store(const ShaderProgram& program, std::string_view programId, std::uint64_t sourceHash);
+}
@@ -0,0 +1,110 @@
+#include "render_snapshot.h"
+
+#include <algorithm>
+
+#include "core/profiler.h"
+
+#include "entities.h"
+
+
+RenderSnapshot::RenderSnapshot() :
+	_arena(),
+	_cameras(&_arena),
+	_materials(&_arena),
+	_lights(&_arena),
+	_items(&_arena)
+{}
+
+void RenderSnapshot::reset()
+{
+	const std::size_t cameras = _cameras.size();
+	const std::size_t materials = _materials.size();
+	const std::size_t lights = _lights.size();
+	const std::size_t items = _items.size();
+
+	// The old storage belongs to the arena, it has to be let go before the arena is rewound //
+	_cameras = decltype(_cameras)(&_arena);
+	_materials = decltype(_materials)(&_arena);
+	_lights = decltype(_lights)(&_arena);
+	_items = decltype(_items)(&_arena);
+	_arena.reset();
+
+	_cameras.reserve(cameras);
+	_materials.reserve(materials);
+	_lights.reserve(lights);
+	_items.reserve(items);
+}
+
+void RenderSnapshot::addDraw(
+	const Camera& cam,
+	const Transformable& transform,
+	Material::ConstRef material,
+	ConstReference<StaticLightContainer> staticLightContainer,
+	Model::Ref model,
+	const Mesh* mesh
+) {
+	if (model == nullptr && mesh == nullptr)
+		return;
+
+	Item& item = _items.emplace_back();
+	item.transform = transform;
+	item.transform.updateMatrices();
+	item.model = model;
+	item.mesh = mesh;
+	item.camera = addCamera(cam);
+
+	if (material != nullptr)
+		item.material = addMaterial(*material);
+
+	if (staticLightContainer != nullptr)
+	{
+		item.staticLights = true;
+		item.firstLight = std::uint32_t(_lights.size());
+		item.lightCount = std::uint32_t(std::min(staticLightContainer->size(), StaticLightContainer::maxStaticLights));
+		for (std::size_t i = 0; i < item.lightCount; ++i)
+			_lights.push_back(staticLightContainer->at(i));
+	}
+}
+
+void RenderSnapshot::render() const
+{
+	PROFILE_SCOPE("RenderSnapshot::render");
+
+	for (const Item& item : _items)
+	{
+		const Camera& cam = _cameras[item.camera];
+		const Material::ConstRef material = item.material != Item::NoIndex ? std::addressof(_materials[item.material]) : nullptr;
+
+		if (item.staticLights)
+			ModelableEntity::bindLightnigShaderRenderData(cam, item.transform, material, std::span<const Light>(_lights.data() + item.firstLight, item.lightCount));
+		else
+			ModelableEntity::bindLightnigShaderRenderData(cam, item.transform, material, nullptr);
+
+		if (item.mesh != nullptr)
+			item.mesh->render();
+		else
+			item.model->render();
+
+		ModelableEntity::unbindLightnigShaderRenderData(material);
+	}
+}
+
+std::uint32_t RenderSnapshot::addCamera(const Camera& cam)
+{
+	// Every draw of a frame usually shares one camera //
+	if (!_cameras.empty() && _cameras.back().getViewprojectionMatrix() == cam.getViewprojectionMatrix() && _cameras.back().getPosition() == cam.getPosition())
+		return std::uint32_t(_cameras.size() - 1);
+
+	_cameras.push_back(cam);
+	return std::uint32_t(_cameras.size() - 1);
+}
+
+std::uint32_t RenderSnapshot::addMaterial(const Material& material)
+{
+	// Sides of one block are captured one after the other and mostly share their material //
+	if (!_materials.empty() && _materials.back() == material)
+		return std::uint32_t(_materials.size() - 1);
+
+	_materials.push_back(material);
+	return std::uint32_t(_materials.size() - 1);
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#include "core/frame_arena.h"
+
+#include "basics.h"
+#include "camera.h"
+#include "light.h"
+#include "material.h"
+#include "model.h"
+
+
+struct RenderSnapshotItem
+{
+	static constexpr std::uint32_t NoIndex = std::uint32_t(-1);
+
+	Transformable transform; // Copied with its matrices up to date, the GL thread only reads them
+	Model::Ref model = nullptr;
+	const Mesh* mesh = nullptr; // One mesh of model, the whole model when null
+
+	std::uint32_t camera = 0;
+	std::uint32_t material = NoIndex;
+	std::uint32_t firstLight = 0;
+	std::uint32_t lightCount = 0;
+	bool staticLights = false;
+};
+
+
+/*
+	Immutable copy of everything one frame draws: cameras, transforms, materials and static lights by value, models by
+	reference. Filled on the simulation thread while a RenderCaptureScope is alive, the draw calls made through
+	ModelableEntity and Tile are recorded instead of issued; render() replays them on the GL thread.
+	All its storage comes from a FrameArena that is rewound by reset().
+*/
+class RenderSnapshot
+{
+public:
+	using Item = RenderSnapshotItem;
+
+private:
+	FrameArena _arena;
+	std::pmr::vector<Camera> _cameras;
+	std::pmr::vector<Material> _materials;
+	std::pmr::vector<Light> _lights;
+	std::pmr::vector<Item> _items;
+
+public:
+	RenderSnapshot();
+	RenderSnapshot(const RenderSnapshot&) = delete;
+	RenderSnapshot(RenderSnapshot&&) noexcept = delete;
+	~RenderSnapshot() = default;
+
+	RenderSnapshot& operator= (const RenderSnapshot&) = delete;
+	RenderSnapshot& operator= (RenderSnapshot&&) noexcept = delete;
+
+public:
+	// Drops the previous frame, the vectors keep its sizes so the new one fills them without growing //
+	void reset();
+
+	void addDraw(
+		const Camera& cam,
+		const Transformable& transform,
+		Material::ConstRef material,
+		ConstReference<StaticLightContainer> staticLightContainer,
+		Model::Ref model,
+		const Mesh* mesh = nullptr
+	);
+
+	// GL thread only //
+	void render() const;
+
+public:
+	inline bool empty() const { return _items.empty(); }
+	inline std::size_t size() const { return _items.size(); }
+
+	inline const FrameArena& getArena() const { return _arena; }
+
+public:
+	// Snapshot the draw calls of the current thread go to, null when they are issued directly //
+	static RenderSnapshot* capturing();
+
+private:
+	std::uint32_t addCamera(const Camera& cam);
+	std::uint32_t addMaterial(const Material& material);
+};
+
+
+// Records the draw calls made on the current thread into a snapshot while it is alive //
+class RenderCaptureScope
+{
+private:
+	static inline thread_local RenderSnapshot* Current = nullptr;
+
+private:
+	RenderSnapshot* _previous;
+
+public:
+	RenderCaptureScope(const RenderCaptureScope&) = delete;
+	RenderCaptureScope(RenderCaptureScope&&) noexcept = delete;
+
+	RenderCaptureScope& operator= (const RenderCaptureScope&) = delete;
+	RenderCaptureScope& operator= (RenderCaptureScope&&) noexcept = delete;
+
+public:
+	inline explicit RenderCaptureScope(RenderSnapshot& snapshot) : _previous(Current) { Current = std::addressof(snapshot); }
+	inline ~RenderCaptureScope() { Current = _previous; }
+
+public:
+	static inline RenderSnapshot* current() { return Current; }
+};
+
+inline RenderSnapshot* RenderSnapshot::capturing() { return RenderCaptureScope::current(); }
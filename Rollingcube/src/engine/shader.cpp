@@ -1,67 +1,98 @@
 #include "shader.h"
 
+#include <array>
+#include <fstream>
+
 #include "utils/logger.h"
 #include "utils/shader_constants.h"
 
 #include "lua/module.h"
 #include "utils/lualib_constants.h"
+#include "core/profiler.h"
+
+#include "program_cache.h"
 
 
 bool Shader::loadFromFile(std::string_view filename, Type type)
+{
+	PROFILE_SCOPE_CATEGORY("Shader::loadFromFile", ProfileCategory::Asset);
+
+	std::string source;
+	if (!readSource(filename, source))
+		return false;
+
+	return compile(source, type) && finishCompile(filename);
+}
+
+bool Shader::compile(const std::string& source, Type type)
 {
 	destroy();
 
-	std::ifstream sfile = std::ifstream(std::string(filename));
-	if (!sfile)
-	{
-		logger::error("Cannot read shader file {}.", filename);
+	auto& backend = gl::backend();
+	_id = backend.createShader(static_cast<GLenum>(type));
+	if (!isCreated())
 		return false;
-	}
 
-	std::stringstream ss;
-	ss << sfile.rdbuf();
-	std::string scode = ss.str();
-	sfile.close();
-	auto code = scode.c_str();
+	backend.shaderSource(_id, source.c_str());
+	backend.compileShader(_id);
+
+	_type = type;
+	_compilePending = true;
+	return true;
+}
 
+bool Shader::finishCompile(std::string_view name)
+{
+	if (!_compilePending)
+		return _compiled;
 
-	_id = glCreateShader(static_cast<GLenum>(type));
-	glShaderSource(_id, 1, &code, nullptr);
-	glCompileShader(_id);
+	auto& backend = gl::backend();
+	_compilePending = false;
+	_compiled = backend.getShaderi(_id, GL_COMPILE_STATUS) == GL_TRUE;
 
-	GLint compilationStatus;
-	glGetShaderiv(_id, GL_COMPILE_STATUS, &compilationStatus);
-	if (compilationStatus == GL_FALSE)
+	if (!_compiled)
 	{
-		logger::error("Error! Shader file {} wasn't compiled!", filename);
-
-		GLint logLen;
-		glGetShaderiv(_id, GL_INFO_LOG_LENGTH, &logLen);
-		if (logLen > 0)
-		{
-			GLchar* logMessage = new GLchar[logLen];
-			glGetShaderInfoLog(_id, logLen, nullptr, logMessage);
-			logger::error("The compiler returned: {}", logMessage);
-			delete[] logMessage;
-		}
+		logger::error("Error! Shader file {} wasn't compiled!", name);
 
-		return false;
+		const std::string log = backend.getShaderInfoLog(_id);
+		if (!log.empty())
+			logger::error("The compiler returned: {}", log);
 	}
 
-	_type = type;
-	_compiled = true;
-
-	return true;
+	return _compiled;
 }
 
 void Shader::destroy()
 {
 	if (isCreated())
-		glDeleteShader(_id);
+		gl::backend().deleteShader(_id);
 
 	_id = 0;
 	_type = Type(0);
 	_compiled = false;
+	_compilePending = false;
+}
+
+bool Shader::readSource(std::string_view filename, std::string& source)
+{
+	// Sized from the file and read in one go, sources are small and read on every start //
+	std::ifstream sfile = std::ifstream(std::string(filename), std::ios::in | std::ios::binary | std::ios::ate);
+	if (!sfile)
+	{
+		logger::error("Cannot read shader file {}.", filename);
+		return false;
+	}
+
+	const std::streamoff size = sfile.tellg();
+	source.resize(std::size_t(std::max<std::streamoff>(size, 0)));
+	sfile.seekg(0, std::ios::beg);
+	if (!source.empty() && !sfile.read(source.data(), std::streamsize(source.size())))
+	{
+		logger::error("Cannot read shader file {}.", filename);
+		return false;
+	}
+
+	return true;
 }
 
 
@@ -77,40 +108,75 @@ DedicatedShaderManager<Shader::Type::Geometry> ShaderManager::GeometryShaderMana
 
 bool ShaderProgram::link()
 {
-	if (!isCreated() || isLinked())
+	return beginLink() && finishLink();
+}
+
+bool ShaderProgram::beginLink(bool retrievableBinary)
+{
+	if (!isCreated() || isLinked() || isLinkPending())
 		return false;
 
-	glLinkProgram(_id);
+	auto& backend = gl::backend();
+	if (retrievableBinary)
+		backend.programParameteri(_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+	backend.linkProgram(_id);
+	_linkPending = true;
+	return true;
+}
+
+bool ShaderProgram::finishLink()
+{
+	if (!isLinkPending())
+		return _linked;
 
-	GLint status;
-	glGetProgramiv(_id, GL_LINK_STATUS, &status);
-	_linked = status == GL_TRUE;
+	auto& backend = gl::backend();
+	_linkPending = false;
+	_linked = backend.getProgrami(_id, GL_LINK_STATUS) == GL_TRUE;
 
 	if (!isLinked())
 	{
 		logger::error("Error! Shader program wasn't linked!");
 
-		GLint logLen;
-		glGetProgramiv(_id, GL_INFO_LOG_LENGTH, &logLen);
-		if (logLen > 0)
-		{
-			GLchar* logMessage = new GLchar[logLen];
-			glGetProgramInfoLog(_id, logLen, nullptr, logMessage);
-			logger::error("The linker returned: {}", logMessage);
-			delete[] logMessage;
-		}
+		const std::string log = backend.getProgramInfoLog(_id);
+		if (!log.empty())
+			logger::error("The linker returned: {}", log);
 	}
 
 	return _linked;
 }
 
+bool ShaderProgram::loadBinary(GLenum format, const void* binary, GLsizei length)
+{
+	if (!isCreated() || isLinked() || isLinkPending())
+		return false;
+
+	// A rejected binary is expected after a driver update and leaves the program unlinked, not logged //
+	auto& backend = gl::backend();
+	backend.programBinary(_id, format, binary, length);
+	_linked = backend.getProgrami(_id, GL_LINK_STATUS) == GL_TRUE;
+	return _linked;
+}
+
+GLenum ShaderProgram::getBinary(std::vector<std::uint8_t>& binary) const
+{
+	if (!isLinked())
+	{
+		binary.clear();
+		return 0;
+	}
+
+	return gl::backend().getProgramBinary(_id, binary);
+}
+
 void ShaderProgram::destroy()
 {
 	if (isCreated())
-		glDeleteProgram(_id);
+		gl::backend().deleteProgram(_id);
 
 	_id = 0;
 	_linked = false;
+	_linkPending = false;
 	_uniforms.clear();
 }
 
@@ -130,35 +196,167 @@ ShaderProgramManager::Reference ShaderProgramManager::load(
 	std::string_view fragmentShaderPath,
 	std::string_view geometryShaderPath
 ) {
-	Reference program = get(id);
-	if (program)
-		return program;
+	const constants::shader::internals::ShaderFiles files = { id, vertexShaderPath, fragmentShaderPath, geometryShaderPath };
+	return load(files);
+}
+
+std::vector<ShaderProgramManager::Reference> ShaderProgramManager::load(std::span<const constants::shader::internals::ShaderFiles> programs)
+{
+	struct PendingProgram
+	{
+		IdType id;
+		Reference program;
+		Shader::Ref shaders[3];
+		std::string_view filenames[3];
+		std::uint64_t sourceHash = 0;
+	};
+
+	std::vector<Reference> results;
+	results.resize(programs.size());
+
+	std::vector<std::size_t> pending;
+	std::vector<PendingProgram> jobs;
+	jobs.resize(programs.size());
+
+	for (std::size_t i = 0; i < programs.size(); ++i)
+	{
+		jobs[i].id = IdType(programs[i].id);
+		results[i] = get(jobs[i].id);
+		if (!results[i])
+			pending.push_back(i);
+	}
+
+	if (pending.empty())
+		return results;
+
+	PROFILE_SCOPE_CATEGORY("ShaderProgramManager::load", ProfileCategory::Asset);
+
+	auto& backend = gl::backend();
+	const bool useCache = program_cache::isSupported();
+
+	static constinit bool parallelCompileSet = false;
+	if (!parallelCompileSet && (GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile))
+	{
+		// Lets the driver pick its own thread count //
+		parallelCompileSet = true;
+		backend.maxShaderCompilerThreads(0xFFFFFFFF);
+	}
 
-	Shader::Ref vertex = ShaderManager::vertex().load(vertexShaderPath);
-	Shader::Ref fragment = ShaderManager::fragment().load(fragmentShaderPath);
-	Shader::Ref geometry = geometryShaderPath.empty() ? Shader::Ref() : ShaderManager::geometry().load(geometryShaderPath);
+	// Vertex shaders are shared between programs, each file is read once //
+	std::unordered_map<std::string, std::string> sources;
+	const auto readSource = [&sources](std::string_view filename) -> const std::string* {
+		const std::string key = Shader::getFileKey(filename);
+		auto it = sources.find(key);
+		if (it == sources.end())
+		{
+			std::string source;
+			if (!Shader::readSource(key, source))
+				return nullptr;
+			it = sources.emplace(key, std::move(source)).first;
+		}
+		return std::addressof(it->second);
+	};
+
+	// Sources are read and hashed first, programs found in the cache are done here //
+	std::vector<std::size_t> compiling;
+	std::vector<std::array<const std::string*, 3>> programSources;
+	programSources.resize(programs.size());
+	for (std::size_t i : pending)
+	{
+		const auto& files = programs[i];
+		auto& job = jobs[i];
+		job.filenames[0] = files.vertex;
+		job.filenames[1] = files.fragment;
+		job.filenames[2] = files.geometry;
+
+		auto& src = programSources[i];
+		src[0] = readSource(files.vertex);
+		src[1] = readSource(files.fragment);
+		src[2] = files.geometry.empty() ? nullptr : readSource(files.geometry);
+		if (src[0] == nullptr || src[1] == nullptr || (!files.geometry.empty() && src[2] == nullptr))
+			continue;
+
+		job.program = emplace(job.id);
+		if (!job.program)
+			continue;
+
+		job.program->create();
+
+		if (useCache)
+		{
+			job.sourceHash = program_cache::hashSources({ *src[0], *src[1], src[2] != nullptr ? std::string_view(*src[2]) : std::string_view() });
+			if (program_cache::load(*job.program, job.id, job.sourceHash))
+			{
+				results[i] = job.program;
+				continue;
+			}
+		}
 
-	if (!vertex || !fragment)
-		return nullptr;
+		compiling.push_back(i);
+	}
 
-	program = emplace(id);
-	if (!program)
-		return nullptr;
+	// Every compile goes out before any link, a link waits for the compiles of its own shaders only //
+	for (std::size_t i : compiling)
+	{
+		auto& job = jobs[i];
+		const auto& src = programSources[i];
+		job.shaders[0] = ShaderManager::vertex().compile(job.filenames[0], *src[0]);
+		job.shaders[1] = ShaderManager::fragment().compile(job.filenames[1], *src[1]);
+		if (src[2] != nullptr)
+			job.shaders[2] = ShaderManager::geometry().compile(job.filenames[2], *src[2]);
+	}
 
-	program->create();
+	for (std::size_t i : compiling)
+	{
+		auto& job = jobs[i];
+		for (const auto& shader : job.shaders)
+			if (shader)
+				job.program->addShader(shader);
 
-	program->addShader(vertex);
-	program->addShader(fragment);
-	if (geometry)
-		program->addShader(geometry);
+		job.program->beginLink(useCache);
+	}
 
-	if (!program->link())
+	// Statuses are only queried now, by then most of the work overlapped //
+	std::vector<std::pair<std::size_t, std::string_view>> failedShaders;
+	for (std::size_t i : compiling)
 	{
-		destroy(id);
-		return nullptr;
+		auto& job = jobs[i];
+
+		bool compiled = job.shaders[0] && job.shaders[1] && (programSources[i][2] == nullptr || job.shaders[2]);
+		for (std::size_t s = 0; s < 3; ++s)
+		{
+			if (job.shaders[s] && !job.shaders[s]->finishCompile(job.filenames[s]))
+			{
+				compiled = false;
+				failedShaders.push_back({ s, job.filenames[s] });
+			}
+		}
+
+		if (!job.program->finishLink() || !compiled)
+			continue;
+
+		results[i] = job.program;
+		if (useCache && !program_cache::store(*job.program, job.id, job.sourceHash))
+			logger::warn("Cannot store shader program cache for {}.", job.id);
+	}
+
+	// Failed ones go only after the loop, jobs that share their shaders still hold references to them //
+	for (std::size_t i : pending)
+		if (!results[i] && jobs[i].program)
+			destroy(jobs[i].id);
+
+	for (const auto& [stage, filename] : failedShaders)
+	{
+		const std::string key = Shader::getFileKey(filename);
+		switch (stage)
+		{
+			case 0: ShaderManager::vertex().destroy(key); break;
+			case 1: ShaderManager::fragment().destroy(key); break;
+			default: ShaderManager::geometry().destroy(key); break;
+		}
 	}
 
-	return program;
+	return results;
 }
 
 void ShaderProgramManager::loadInternalShaders()
@@ -169,8 +367,7 @@ void ShaderProgramManager::loadInternalShaders()
 	if (!init)
 	{
 		init = true;
-		for (std::size_t i = 0; i < count; ++i)
-			load(shaders[i]);
+		load(std::span<const ShaderFiles>(shaders));
 	}
 }
 
@@ -203,13 +400,18 @@ ShaderProgramManager::Reference ShaderProgramManager::getLinesShaderProgram()
 	GET_INTERNAL_SHADER(lines);
 }
 
+ShaderProgramManager::Reference ShaderProgramManager::getFreetypeFontSdfShaderProgram()
+{
+	GET_INTERNAL_SHADER(freetype_font_sdf);
+}
+
 #undef GET_INTERNAL_SHADER
 
 
 ShaderProgramUniform::ShaderProgramUniform(std::string_view name, ShaderProgram& shaderProgram) :
 	_name(name),
 	_program(std::addressof(shaderProgram)),
-	_location(glGetUniformLocation(shaderProgram.getId(), name.data()))
+	_location(gl::backend().getUniformLocation(shaderProgram.getId(), name.data()))
 {
 	if (_location == -1)
 		logger::warn("Uniform with name {} does not exist, setting it will fail!", name);
@@ -409,6 +611,7 @@ namespace lua::lib::LUA_shader
 	static ShaderProgram* getFreetypeFontShaderProgram(const DefaultShadersPool*) { return &ShaderProgramManager::instance().getFreetypeFontShaderProgram(); }
 	static ShaderProgram* getSkyShaderProgram(const DefaultShadersPool*) { return &ShaderProgramManager::instance().getSkyShaderProgram(); }
 	static ShaderProgram* getLinesShaderProgram(const DefaultShadersPool*) { return &ShaderProgramManager::instance().getLinesShaderProgram(); }
+	static ShaderProgram* getFreetypeFontSdfShaderProgram(const DefaultShadersPool*) { return &ShaderProgramManager::instance().getFreetypeFontSdfShaderProgram(); }
 
 
 
@@ -422,6 +625,7 @@ namespace lua::lib::LUA_shader
 			.addProperty("freetypeFont", &getFreetypeFontShaderProgram)
 			.addProperty("sky", &getSkyShaderProgram)
 			.addProperty("lines", &getLinesShaderProgram)
+			.addProperty("freetypeFontSdf", &getFreetypeFontSdfShaderProgram)
 			.endClass();
 
 		auto clss = root.beginClass<ShaderProgram>("ShaderProgram");
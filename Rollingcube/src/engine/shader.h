@@ -4,8 +4,12 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <span>
+#include <algorithm>
 
 #include "core/gl.h"
+#include "core/gl_backend.h"
+#include "core/frame_stats.h"
 #include "math/glm.h"
 #include "utils/manager.h"
 #include "utils/resources.h"
@@ -35,6 +39,7 @@ private:
 	Id _id = 0;
 	Type _type = Type(0);
 	bool _compiled = false;
+	bool _compilePending = false;
 
 public:
 	Shader() = default;
@@ -49,10 +54,24 @@ public:
 	constexpr Id getId() const { return _id; }
 	constexpr Type getType() const { return _type; }
 	constexpr bool isCompiled() const { return _compiled; }
+	constexpr bool isCompilePending() const { return _compilePending; }
 
 	bool loadFromFile(std::string_view filename, Type type);
 
+	// Only issues the compile, the driver may run it in the background until finishCompile asks for the status //
+	bool compile(const std::string& source, Type type);
+	bool finishCompile(std::string_view name);
+
 	void destroy();
+
+public:
+	static bool readSource(std::string_view filename, std::string& source);
+
+	// Absolute path of a file under the shaders folder, shader managers are keyed by it //
+	static inline std::string getFileKey(std::string_view filename)
+	{
+		return std::filesystem::absolute(resources::shaders / filename).string();
+	}
 };
 
 
@@ -66,7 +85,7 @@ public:
 
 	inline Reference load(const std::string_view& filename)
 	{
-		Path path = std::filesystem::absolute(resources::shaders / filename);
+		Path path = Shader::getFileKey(filename);
 		Reference ref = get(path.string());
 		if (ref)
 			return ref;
@@ -84,6 +103,27 @@ public:
 		return ref;
 	}
 
+	// Compiled shaders are shared, only a new one gets its compile issued //
+	inline Reference compile(const std::string_view& filename, const std::string& source)
+	{
+		const std::string key = Shader::getFileKey(filename);
+		Reference ref = get(key);
+		if (ref)
+			return ref;
+
+		ref = emplace(key);
+		if (!ref)
+			return nullptr;
+
+		if (!ref->compile(source, _Type))
+		{
+			destroy(key);
+			return nullptr;
+		}
+
+		return ref;
+	}
+
 private:
 	inline explicit DedicatedShaderManager() : Manager(nullptr) {}
 };
@@ -119,6 +159,7 @@ public:
 private:
 	Id _id = 0;
 	bool _linked = false;
+	bool _linkPending = false;
 	std::unordered_map<std::string, Uniform> _uniforms = {};
 
 public:
@@ -133,6 +174,7 @@ public:
 	constexpr bool isCreated() const { return _id != 0; }
 	constexpr Id getId() const { return _id; }
 	constexpr bool isLinked() const { return _linked; }
+	constexpr bool isLinkPending() const { return _linkPending; }
 
 	Uniform& getUniform(std::string_view name);
 	inline const Uniform& getUniform(std::string_view name) const { return _uniforms.at(std::string(name)); }
@@ -141,21 +183,35 @@ public:
 
 	inline bool addShader(Shader::Ref shader) const
 	{
-		if (!shader->isCompiled())
+		if (!shader->isCompiled() && !shader->isCompilePending())
 			return false;
 
-		glAttachShader(_id, shader->getId());
+		gl::backend().attachShader(_id, shader->getId());
 		return true;
 	}
 
-	inline void use() { if (isLinked()) glUseProgram(_id); }
+	inline void use()
+	{
+		if (isLinked())
+		{
+			gl::backend().useProgram(_id);
+			FrameStats::instance().add(FrameCounter::ShaderBinds);
+		}
+	}
 
-	inline void notUse() { glUseProgram(0); }
+	inline void notUse() { gl::backend().useProgram(0); }
 
-	void create() { _id = glCreateProgram(); }
+	void create() { _id = gl::backend().createProgram(); }
 
 	bool link();
 
+	// Split like Shader::compile. A retrievable binary can be handed to the program cache once linked //
+	bool beginLink(bool retrievableBinary = false);
+	bool finishLink();
+
+	bool loadBinary(GLenum format, const void* binary, GLsizei length);
+	GLenum getBinary(std::vector<std::uint8_t>& binary) const;
+
 	void destroy();
 
 public:
@@ -177,6 +233,15 @@ public:
 		for (GLint i = 0; i < len; ++i)
 			setUniformStaticLight(lights[i], i);
 	}
+
+	inline void setUniformStaticLights(std::span<const Light> lights)
+	{
+		const GLint len = GLint(std::min(lights.size(), StaticLightContainer::maxStaticLights));
+		setUniformStaticLightsCount(len);
+
+		for (GLint i = 0; i < len; ++i)
+			setUniformStaticLight(lights[i], i);
+	}
 };
 
 
@@ -190,6 +255,10 @@ private:
 public:
 	Reference load(const IdType& id, const std::string_view vertexShaderPath, std::string_view fragmentShaderPath, std::string_view geometryShaderPath = "");
 
+	// Issues every compile and link before the first status query, so the driver can work on them in parallel.
+	// Programs found in the program cache skip both. The references follow the order of programs //
+	std::vector<Reference> load(std::span<const constants::shader::internals::ShaderFiles> programs);
+
 	void loadInternalShaders();
 
 	static inline ShaderProgramManager& instance() { return Instance; }
@@ -204,12 +273,7 @@ public:
 
 	inline Reference load(const constants::shader::internals::ShaderFiles& internalShaderId)
 	{
-		return load(
-			std::string(internalShaderId.id),
-			internalShaderId.vertex,
-			internalShaderId.fragment,
-			internalShaderId.geometry
-		);
+		return load(std::span<const constants::shader::internals::ShaderFiles>(&internalShaderId, 1)).front();
 	}
 
 public:
@@ -217,6 +281,7 @@ public:
 	Reference getFreetypeFontShaderProgram();
 	Reference getSkyShaderProgram();
 	Reference getLinesShaderProgram();
+	Reference getFreetypeFontSdfShaderProgram();
 
 private:
 	explicit ShaderProgramManager();
@@ -245,98 +310,104 @@ public:
 
 	ShaderProgramUniform(std::string_view name, ShaderProgram& shaderProgram);
 
+	inline void upload(gl::UniformType type, GLsizei count, const void* values) const
+	{
+		gl::backend().uniform(_location, type, count, values);
+		FrameStats::instance().add(FrameCounter::UniformUploads);
+	}
+
 public:
-	inline void set(GLfloat value) const { glUniform1f(_location, value); }
-	inline void set(const GLfloat* values, GLsizei count) const { glUniform1fv(_location, count, values); }
-	inline void set(const std::vector<GLfloat>& v) const { glUniform1fv(_location, GLsizei(v.size()), v.data()); }
+	inline void set(GLfloat value) const { upload(gl::UniformType::Float, 1, &value); }
+	inline void set(const GLfloat* values, GLsizei count) const { upload(gl::UniformType::Float, count, values); }
+	inline void set(const std::vector<GLfloat>& v) const { upload(gl::UniformType::Float, GLsizei(v.size()), v.data()); }
 	inline const ShaderProgramUniform& operator= (GLfloat value) const { return set(value), *this; }
 	inline const ShaderProgramUniform& operator= (const std::vector<GLfloat>& value) const { return set(value), *this; }
 
-	inline void set(GLint value) const { glUniform1i(_location, value); }
-	inline void set(const GLint* values, GLsizei count) const { glUniform1iv(_location, count, values); }
-	inline void set(const std::vector<GLint>& v) const { glUniform1iv(_location, GLsizei(v.size()), v.data()); }
+	inline void set(GLint value) const { upload(gl::UniformType::Int, 1, &value); }
+	inline void set(const GLint* values, GLsizei count) const { upload(gl::UniformType::Int, count, values); }
+	inline void set(const std::vector<GLint>& v) const { upload(gl::UniformType::Int, GLsizei(v.size()), v.data()); }
 	inline const ShaderProgramUniform& operator= (GLint value) const { return set(value), *this; }
 	inline const ShaderProgramUniform& operator= (const std::vector<GLint>& value) const { return set(value), *this; }
 
-	inline void set(GLuint value) const { glUniform1ui(_location, value); }
-	inline void set(const GLuint* values, GLsizei count) const { glUniform1uiv(_location, count, values); }
-	inline void set(const std::vector<GLuint>& v) const { glUniform1uiv(_location, GLsizei(v.size()), v.data()); }
+	inline void set(GLuint value) const { upload(gl::UniformType::UnsignedInt, 1, &value); }
+	inline void set(const GLuint* values, GLsizei count) const { upload(gl::UniformType::UnsignedInt, count, values); }
+	inline void set(const std::vector<GLuint>& v) const { upload(gl::UniformType::UnsignedInt, GLsizei(v.size()), v.data()); }
 	inline const ShaderProgramUniform& operator= (GLuint value) const { return set(value), *this; }
 	inline const ShaderProgramUniform& operator= (const std::vector<GLuint>& value) const { return set(value), *this; }
 
 
-	inline void set(const glm::vec2& value) const { glUniform2f(_location, value.x, value.y); }
-	inline void set(const glm::vec2* values, GLsizei count) const { glUniform2fv(_location, count, reinterpret_cast<const GLfloat*>(values)); }
-	inline void set(const std::vector<glm::vec2>& v) const { glUniform2fv(_location, GLsizei(v.size()), reinterpret_cast<const GLfloat*>(v.data())); }
+	inline void set(const glm::vec2& value) const { upload(gl::UniformType::Float2, 1, std::addressof(value)); }
+	inline void set(const glm::vec2* values, GLsizei count) const { upload(gl::UniformType::Float2, count, values); }
+	inline void set(const std::vector<glm::vec2>& v) const { upload(gl::UniformType::Float2, GLsizei(v.size()), v.data()); }
 	inline const ShaderProgramUniform& operator= (const glm::vec2& value) const { return set(value), *this; }
 	inline const ShaderProgramUniform& operator= (const std::vector<glm::vec2>& value) const { return set(value), *this; }
 
-	inline void set(const glm::ivec2& value) const { glUniform2i(_location, value.x, value.y); }
-	inline void set(const glm::ivec2* values, GLsizei count) const { glUniform2iv(_location, count, reinterpret_cast<const GLint*>(values)); }
-	inline void set(const std::vector<glm::ivec2>& v) const { glUniform2iv(_location, GLsizei(v.size()), reinterpret_cast<const GLint*>(v.data())); }
+	inline void set(const glm::ivec2& value) const { upload(gl::UniformType::Int2, 1, std::addressof(value)); }
+	inline void set(const glm::ivec2* values, GLsizei count) const { upload(gl::UniformType::Int2, count, values); }
+	inline void set(const std::vector<glm::ivec2>& v) const { upload(gl::UniformType::Int2, GLsizei(v.size()), v.data()); }
 	inline const ShaderProgramUniform& operator= (const glm::ivec2& value) const { return set(value), *this; }
 	inline const ShaderProgramUniform& operator= (const std::vector<glm::ivec2>& value) const { return set(value), *this; }
 
-	inline void set(const glm::uvec2& value) const { glUniform2ui(_location, value.x, value.y); }
-	inline void set(const glm::uvec2* values, GLsizei count) const { glUniform2uiv(_location, count, reinterpret_cast<const GLuint*>(values)); }
-	inline void set(const std::vector<glm::uvec2>& v) const { glUniform2uiv(_location, GLsizei(v.size()), reinterpret_cast<const GLuint*>(v.data())); }
+	inline void set(const glm::uvec2& value) const { upload(gl::UniformType::UnsignedInt2, 1, std::addressof(value)); }
+	inline void set(const glm::uvec2* values, GLsizei count) const { upload(gl::UniformType::UnsignedInt2, count, values); }
+	inline void set(const std::vector<glm::uvec2>& v) const { upload(gl::UniformType::UnsignedInt2, GLsizei(v.size()), v.data()); }
 	inline const ShaderProgramUniform& operator= (const glm::uvec2& value) const { return set(value), *this; }
 	inline const ShaderProgramUniform& operator= (const std::vector<glm::uvec2>& value) const { return set(value), *this; }
 
 
-	inline void set(const glm::vec3& value) const { glUniform3f(_location, value.x, value.y, value.z); }
-	inline void set(const glm::vec3* values, GLsizei count) const { glUniform3fv(_location, count, reinterpret_cast<const GLfloat*>(values)); }
-	inline void set(const std::vector<glm::vec3>& v) const { glUniform3fv(_location, GLsizei(v.size()), reinterpret_cast<const GLfloat*>(v.data())); }
+	inline void set(const glm::vec3& value) const { upload(gl::UniformType::Float3, 1, std::addressof(value)); }
+	inline void set(const glm::vec3* values, GLsizei count) const { upload(gl::UniformType::Float3, count, values); }
+	inline void set(const std::vector<glm::vec3>& v) const { upload(gl::UniformType::Float3, GLsizei(v.size()), v.data()); }
 	inline const ShaderProgramUniform& operator= (const glm::vec3& value) const { return set(value), *this; }
 	inline const ShaderProgramUniform& operator= (const std::vector<glm::vec3>& value) const { return set(value), *this; }
 
-	inline void set(const glm::ivec3& value) const { glUniform3i(_location, value.x, value.y, value.z); }
-	inline void set(const glm::ivec3* values, GLsizei count) const { glUniform3iv(_location, count, reinterpret_cast<const GLint*>(values)); }
-	inline void set(const std::vector<glm::ivec3>& v) const { glUniform3iv(_location, GLsizei(v.size()), reinterpret_cast<const GLint*>(v.data())); }
+	inline void set(const glm::ivec3& value) const { upload(gl::UniformType::Int3, 1, std::addressof(value)); }
+	inline void set(const glm::ivec3* values, GLsizei count) const { upload(gl::UniformType::Int3, count, values); }
+	inline void set(const std::vector<glm::ivec3>& v) const { upload(gl::UniformType::Int3, GLsizei(v.size()), v.data()); }
 	inline const ShaderProgramUniform& operator= (const glm::ivec3& value) const { return set(value), *this; }
 	inline const ShaderProgramUniform& operator= (const std::vector<glm::ivec3>& value) const { return set(value), *this; }
 
-	inline void set(const glm::uvec3& value) const { glUniform3ui(_location, value.x, value.y, value.z); }
-	inline void set(const glm::uvec3* values, GLsizei count) const { glUniform3uiv(_location, count, reinterpret_cast<const GLuint*>(values)); }
-	inline void set(const std::vector<glm::uvec3>& v) const { glUniform3uiv(_location, GLsizei(v.size()), reinterpret_cast<const GLuint*>(v.data())); }
+	inline void set(const glm::uvec3& value) const { upload(gl::UniformType::UnsignedInt3, 1, std::addressof(value)); }
+	inline void set(const glm::uvec3* values, GLsizei count) const { upload(gl::UniformType::UnsignedInt3, count, values); }
+	inline void set(const std::vector<glm::uvec3>& v) const { upload(gl::UniformType::UnsignedInt3, GLsizei(v.size()), v.data()); }
 	inline const ShaderProgramUniform& operator= (const glm::uvec3& value) const { return set(value), *this; }
 	inline const ShaderProgramUniform& operator= (const std::vector<glm::uvec3>& value) const { return set(value), *this; }
 
 
-	inline void set(const glm::vec4& value) const { glUniform4f(_location, value.x, value.y, value.z, value.w); }
-	inline void set(const glm::vec4* values, GLsizei count) const { glUniform4fv(_location, count, reinterpret_cast<const GLfloat*>(values)); }
-	inline void set(const std::vector<glm::vec4>& v) const { glUniform4fv(_location, GLsizei(v.size()), reinterpret_cast<const GLfloat*>(v.data())); }
+	inline void set(const glm::vec4& value) const { upload(gl::UniformType::Float4, 1, std::addressof(value)); }
+	inline void set(const glm::vec4* values, GLsizei count) const { upload(gl::UniformType::Float4, count, values); }
+	inline void set(const std::vector<glm::vec4>& v) const { upload(gl::UniformType::Float4, GLsizei(v.size()), v.data()); }
 	inline const ShaderProgramUniform& operator= (const glm::vec4& value) const { return set(value), *this; }
 	inline const ShaderProgramUniform& operator= (const std::vector<glm::vec4>& value) const { return set(value), *this; }
 
-	inline void set(const glm::ivec4& value) const { glUniform4i(_location, value.x, value.y, value.z, value.w); }
-	inline void set(const glm::ivec4* values, GLsizei count) const { glUniform4iv(_location, count, reinterpret_cast<const GLint*>(values)); }
-	inline void set(const std::vector<glm::ivec4>& v) const { glUniform4iv(_location, GLsizei(v.size()), reinterpret_cast<const GLint*>(v.data())); }
+	inline void set(const glm::ivec4& value) const { upload(gl::UniformType::Int4, 1, std::addressof(value)); }
+	inline void set(const glm::ivec4* values, GLsizei count) const { upload(gl::UniformType::Int4, count, values); }
+	inline void set(const std::vector<glm::ivec4>& v) const { upload(gl::UniformType::Int4, GLsizei(v.size()), v.data()); }
 	inline const ShaderProgramUniform& operator= (const glm::ivec4& value) const { return set(value), *this; }
 	inline const ShaderProgramUniform& operator= (const std::vector<glm::ivec4>& value) const { return set(value), *this; }
 
-	inline void set(const glm::uvec4& value) const { glUniform4ui(_location, value.x, value.y, value.z, value.w); }
-	inline void set(const glm::uvec4* values, GLsizei count) const { glUniform4uiv(_location, count, reinterpret_cast<const GLuint*>(values)); }
-	inline void set(const std::vector<glm::uvec4>& v) const { glUniform4uiv(_location, GLsizei(v.size()), reinterpret_cast<const GLuint*>(v.data())); }
+	inline void set(const glm::uvec4& value) const { upload(gl::UniformType::UnsignedInt4, 1, std::addressof(value)); }
+	inline void set(const glm::uvec4* values, GLsizei count) const { upload(gl::UniformType::UnsignedInt4, count, values); }
+	inline void set(const std::vector<glm::uvec4>& v) const { upload(gl::UniformType::UnsignedInt4, GLsizei(v.size()), v.data()); }
 	inline const ShaderProgramUniform& operator= (const glm::uvec4& value) const { return set(value), *this; }
 	inline const ShaderProgramUniform& operator= (const std::vector<glm::uvec4>& value) const { return set(value), *this; }
 
 
-	inline void set(const glm::mat3& value) const { glUniformMatrix3fv(_location, 1, false, reinterpret_cast<const GLfloat*>(std::addressof(value))); }
-	inline void set(const glm::mat3* values, GLsizei count) const { glUniformMatrix3fv(_location, count, false, reinterpret_cast<const GLfloat*>(std::addressof(values))); }
-	inline void set(const std::vector<glm::mat3>& v) const { glUniformMatrix3fv(_location, GLsizei(v.size()), false, reinterpret_cast<const GLfloat*>(v.data())); }
+	inline void set(const glm::mat3& value) const { upload(gl::UniformType::Matrix3, 1, std::addressof(value)); }
+	inline void set(const glm::mat3* values, GLsizei count) const { upload(gl::UniformType::Matrix3, count, values); }
+	inline void set(const std::vector<glm::mat3>& v) const { upload(gl::UniformType::Matrix3, GLsizei(v.size()), v.data()); }
 	inline const ShaderProgramUniform& operator= (const glm::mat3& value) const { return set(value), *this; }
 	inline const ShaderProgramUniform& operator= (const std::vector<glm::mat3>& value) const { return set(value), *this; }
 
 
-	inline void set(const glm::mat4& value) const { glUniformMatrix4fv(_location, 1, false, reinterpret_cast<const GLfloat*>(std::addressof(value))); }
-	inline void set(const glm::mat4* values, GLsizei count) const { glUniformMatrix4fv(_location, count, false, reinterpret_cast<const GLfloat*>(std::addressof(values))); }
-	inline void set(const std::vector<glm::mat4>& v) const { glUniformMatrix4fv(_location, GLsizei(v.size()), false, reinterpret_cast<const GLfloat*>(v.data())); }
+	inline void set(const glm::mat4& value) const { upload(gl::UniformType::Matrix4, 1, std::addressof(value)); }
+	inline void set(const glm::mat4* values, GLsizei count) const { upload(gl::UniformType::Matrix4, count, values); }
+	inline void set(const std::vector<glm::mat4>& v) const { upload(gl::UniformType::Matrix4, GLsizei(v.size()), v.data()); }
 	inline const ShaderProgramUniform& operator= (const glm::mat4& value) const { return set(value), *this; }
 	inline const ShaderProgramUniform& operator= (const std::vector<glm::mat4>& value) const { return set(value), *this; }
 
 
-	inline void set(bool value) const { glUniform1i(_location, static_cast<GLint>(value)); }
+	inline void set(bool value) const { set(static_cast<GLint>(value)); }
 	inline const ShaderProgramUniform& operator= (bool value) const { return set(value), *this; }
 };
 
@@ -1,4 +1,5 @@
 #include "text.h"
+#include "text_layout.h"
 
 #include <algorithm>
 #include <mutex>
@@ -8,10 +9,16 @@
 #include FT_FREETYPE_H
 
 #include "core/gl.h"
+#include "core/gl_backend.h"
+#include "core/frame_stats.h"
+#include "core/vertex_format.h"
 #include "math/glm.h"
 #include "utils/shader_constants.h"
 #include "utils/logger.h"
 #include "utils/resources.h"
+#include "utils/distance_field.h"
+#include "core/thread_pool.h"
+#include "core/profiler.h"
 
 
 Font::Font()
@@ -21,188 +28,418 @@ Font::Font()
 	static std::once_flag prepareOnceFlag;
 	std::call_once(prepareOnceFlag, []() {
 		ShaderProgramManager::instance().load(internals::shaderFiles(freetype_font));
+		ShaderProgramManager::instance().load(internals::shaderFiles(freetype_font_sdf));
 	});
 
 	addCharacterRange(32, 127); // ASCII characters //
 }
 
-bool Font::load(std::string_view filepath, int pixelSize)
+bool Font::load(std::string_view filepath, int pixelSize, FontRenderMode renderMode)
 {
+    PROFILE_SCOPE_CATEGORY("Font::load", ProfileCategory::Asset);
+
+    destroy();
+
     if (pixelSize < 1 || pixelSize > CharactersTextureSize)
     {
         logger::warn("Invalid texture size '{}' in Font. Clamped between [{},{}]", pixelSize, 1, CharactersTextureSize);
         pixelSize = glm::clamp(pixelSize, 1, CharactersTextureSize);
     }
 
-    FT_Library freeTypeLibrary;
-    FT_Face freeTypeFace;
-
-    auto ftError = FT_Init_FreeType(&freeTypeLibrary);
+    auto ftError = FT_Init_FreeType(&_freeTypeLibrary);
     if (ftError)
         return false;
 
     Path fontFilePath = resources::absolute(resources::fonts / filepath);
 
-    ftError = FT_New_Face(freeTypeLibrary, fontFilePath.string().c_str(), 0, &freeTypeFace);
+    ftError = FT_New_Face(_freeTypeLibrary, fontFilePath.string().c_str(), 0, &_freeTypeFace);
     if (ftError)
+    {
+        destroy();
         return false;
+    }
 
-    FT_Set_Pixel_Sizes(freeTypeFace, 0, pixelSize);
+    // Distance fields are rendered once at a fixed size and scaled to any pixel size //
+    _renderMode = renderMode;
     _pixelSize = pixelSize;
+    _rasterPixelSize = renderMode == FontRenderMode::SignedDistanceField ? SdfRasterPixelSize : pixelSize;
+    _glyphPadding = renderMode == FontRenderMode::SignedDistanceField ? SdfSpread : 0;
+    FT_Set_Pixel_Sizes(_freeTypeFace, 0, _rasterPixelSize);
+    ++_loadGeneration;
+
+    // Single atlas for every glyph, so a string never switches textures //
+    const std::vector<unsigned char> emptyAtlas(AtlasTextureSize * AtlasTextureSize, 0);
+    _atlas.createFromData(emptyAtlas.data(), AtlasTextureSize, AtlasTextureSize, Texture::Format::red, false);
+    _atlas.bind();
+    _atlas.setFilter(Texture::MagnificationFilter::Bilinear);
+    _atlas.setFilter(renderMode == FontRenderMode::SignedDistanceField ? Texture::MinificationFilter::Bilinear : Texture::MinificationFilter::Nearest);
+    _atlas.unbind();
+    _atlasPacker.reset(AtlasTextureSize, AtlasTextureSize);
+
+    gl::VertexFormat format;
+    format
+        .add(0, 2, gl::DataType::Float)
+        .add(1, 2, gl::DataType::Float)
+        .add(2, 4, gl::DataType::UnsignedByte, GL_TRUE);
+
+    _batchCapacity = InitialBatchCapacity;
+    _batch.reserve(_batchCapacity);
+    _vao.createInterleavedAttributes(format, nullptr, _batchCapacity, gl::VBO::Usage::StreamDraw);
+
+    _loaded = true;
+
+    preloadCharacterRanges();
 
-    std::vector<unsigned char> textureData(CharactersTextureSize * CharactersTextureSize, 0);
-    int currentPixelPositionRow = 0;
-    int currentPixelPositionCol = 0;
-    int rowHeight = 0;
-    int currentRenderIndex = 0;
-    std::unique_ptr<Texture> texture = std::make_unique<Texture>();
+    return true;
+}
 
-    std::vector<glm::vec2> vertData;
-    std::vector<glm::vec2> texCoordData;
+Font::CharacterProperties* Font::getCharacter(char32_t code) const
+{
+    if (!_freeTypeFace)
+        return nullptr;
 
-    auto finalizeTexture = [this, &texture, &textureData](bool createNext)
+    auto& props = code < DirectCharactersCount ? _directCharacters[code] : _sparseCharacters[code];
+    if (!props.loaded)
     {
-        texture->createFromData(textureData.data(), CharactersTextureSize, CharactersTextureSize, Texture::Format::depth_component, true);
-        texture->bind();
-        texture->setFilter(Texture::MagnificationFilter::Bilinear);
-        texture->setFilter(Texture::MinificationFilter::Nearest);
-        texture->unbind();
-        _textures.push_back(std::move(texture));
-        if (createNext)
+        props.loaded = true;
+
+        const auto glyphIndex = FT_Get_Char_Index(_freeTypeFace, FT_ULong(code));
+        props.valid = glyphIndex != 0 && !FT_Load_Glyph(_freeTypeFace, glyphIndex, FT_LOAD_DEFAULT);
+        if (props.valid)
         {
-            texture = std::make_unique<Texture>();
-            memset(textureData.data(), 0, textureData.size());
+            props.width = _freeTypeFace->glyph->metrics.width >> 6;
+            props.bearingX = _freeTypeFace->glyph->metrics.horiBearingX >> 6;
+            props.advanceX = _freeTypeFace->glyph->metrics.horiAdvance >> 6;
+            props.height = _freeTypeFace->glyph->metrics.height >> 6;
+            props.bearingY = _freeTypeFace->glyph->metrics.horiBearingY >> 6;
         }
-    };
+    }
 
-    for (const auto& characterRange : _characterRanges)
+    return props.valid ? &props : nullptr;
+}
+
+bool Font::makeResident(char32_t code, CharacterProperties& props) const
+{
+    if (props.resident)
+        return true;
+
+    // If character is not renderable, e.g. space, then don't prepare rendering data for it
+    if (props.width <= 0 || props.height <= 0)
+        return false;
+
+    GlyphBitmap bitmap;
+    if (!renderGlyph(code, bitmap))
+        return false;
+
+    if (_renderMode == FontRenderMode::SignedDistanceField)
+        toDistanceField(bitmap, true);
+
+    return uploadGlyph(code, props, bitmap);
+}
+
+bool Font::renderGlyph(char32_t code, GlyphBitmap& bitmap) const
+{
+    FT_Load_Glyph(_freeTypeFace, FT_Get_Char_Index(_freeTypeFace, FT_ULong(code)), FT_LOAD_DEFAULT);
+    FT_Render_Glyph(_freeTypeFace->glyph, FT_RENDER_MODE_NORMAL);
+
+    const auto* ptrBitmap = &_freeTypeFace->glyph->bitmap;
+    bitmap.width = ptrBitmap->width;
+    bitmap.height = ptrBitmap->rows;
+    if (bitmap.width == 0 || bitmap.height == 0)
+        return false;
+
+    bitmap.pixels.resize(std::size_t(bitmap.width) * std::size_t(bitmap.height));
+    for (auto i = 0; i < bitmap.height; i++)
+        memcpy(bitmap.pixels.data() + i * bitmap.width, ptrBitmap->buffer + i * ptrBitmap->pitch, bitmap.width);
+
+    return true;
+}
+
+void Font::toDistanceField(GlyphBitmap& bitmap, bool parallel)
+{
+    bitmap.pixels = distance_field::fromCoverage(bitmap.pixels.data(), bitmap.width, bitmap.height, bitmap.width, SdfSpread, parallel);
+    bitmap.width += 2 * SdfSpread;
+    bitmap.height += 2 * SdfSpread;
+}
+
+bool Font::uploadGlyph(char32_t code, CharacterProperties& props, const GlyphBitmap& bitmap) const
+{
+    const int bmpWidth = bitmap.width;
+    const int bmpHeight = bitmap.height;
+
+    // One pixel of padding on the right and top keeps bilinear filtering from bleeding neighbours in
+    std::optional<ShelfPacker::Rect> rect;
+    while (!(rect = _atlasPacker.allocate(bmpWidth + 1, bmpHeight + 1)))
     {
-        for (auto c = characterRange.characterCodeFrom; c <= characterRange.characterCodeTo;)
+        // Glyphs waiting in the batch cannot be evicted, drawing them first frees them up //
+        if (!evictLeastRecentlyUsed() && (_batch.empty() || (flush(), !evictLeastRecentlyUsed())))
         {
-            FT_Load_Glyph(freeTypeFace, FT_Get_Char_Index(freeTypeFace, c), FT_LOAD_DEFAULT);
-            FT_Render_Glyph(freeTypeFace->glyph, FT_RENDER_MODE_NORMAL);
+            logger::warn("Font atlas is full, cannot rasterize character U+{:04X}.", static_cast<std::uint32_t>(code));
+            return false;
+        }
+    }
 
-            const auto* ptrBitmap = &freeTypeFace->glyph->bitmap;
-            const int bmpWidth = ptrBitmap->width;
-            const int bmpHeight = ptrBitmap->rows;
-            const auto rowsLeft = CharactersTextureSize - currentPixelPositionRow;
-            const auto colsLeft = CharactersTextureSize - currentPixelPositionCol;
+    writeGlyph(code, props, bitmap, *rect);
+    return true;
+}
 
-            rowHeight = std::max(rowHeight, static_cast<int>(bmpHeight));
+void Font::writeGlyph(char32_t code, CharacterProperties& props, const GlyphBitmap& bitmap, const ShelfPacker::Rect& rect) const
+{
+    const int bmpWidth = bitmap.width;
+    const int bmpHeight = bitmap.height;
 
-            if (colsLeft < bmpWidth)
-            {
-                currentPixelPositionCol = 0;
-                currentPixelPositionRow += rowHeight + 1;
-                rowHeight = 0;
-                continue;
-            }
+    std::vector<unsigned char> glyphData((bmpWidth + 1) * (bmpHeight + 1), 0);
+    for (auto i = 0; i < bmpHeight; i++)
+    {
+        int reversedRow = bmpHeight - i - 1;
+        memcpy(glyphData.data() + i * (bmpWidth + 1), bitmap.pixels.data() + reversedRow * bmpWidth, bmpWidth);
+    }
 
-            if (rowsLeft < bmpHeight)
-            {
-                finalizeTexture(true);
-                currentPixelPositionCol = 0;
-                currentPixelPositionRow = 0;
-                rowHeight = 0;
+    gl::backend().pixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    _atlas.updateData(glyphData.data(), rect.x, rect.y, rect.width, rect.height);
+    gl::backend().pixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    props.resident = true;
+    props.atlasRect = rect;
+    _residentCharacters.push_back(code);
+    ++_atlasGeneration;
+}
+
+void Font::preloadCharacterRanges() const
+{
+    struct PendingGlyph
+    {
+        char32_t code;
+        CharacterProperties* props;
+        GlyphBitmap bitmap;
+        ShelfPacker::Rect rect;
+    };
+
+    // FreeType faces are not thread safe, so glyphs are rendered here and only the distance fields run in parallel.
+    // Atlas space is reserved as each glyph is rendered, nothing is rasterized past a full atlas //
+    const int spread = _renderMode == FontRenderMode::SignedDistanceField ? 2 * SdfSpread : 0;
+    std::vector<PendingGlyph> pending;
+    bool atlasFull = false;
+    for (const auto& characterRange : _characterRanges)
+    {
+        for (auto c = characterRange.characterCodeFrom; c <= characterRange.characterCodeTo; c++)
+        {
+            auto* props = getCharacter(c);
+            if (!props || props->resident || props->width <= 0 || props->height <= 0)
                 continue;
-            }
 
-            auto& charProps = _characterProperties[c]; // This also creates entry, if it does not exist
-            charProps.characterCode = c;
-            charProps.width = freeTypeFace->glyph->metrics.width >> 6;
-            charProps.bearingX = freeTypeFace->glyph->metrics.horiBearingX >> 6;
-            charProps.advanceX = freeTypeFace->glyph->metrics.horiAdvance >> 6;
-            charProps.height = freeTypeFace->glyph->metrics.height >> 6;
-            charProps.bearingY = freeTypeFace->glyph->metrics.horiBearingY >> 6;
-
-            // If character is not renderable, e.g. space, then don't prepare rendering data for it
-            if (bmpWidth == 0 && bmpHeight == 0) {
-                charProps.renderIndex = -1;
-                charProps.textureIndex = -1;
-                c++;
+            PendingGlyph glyph = { c, props, {}, {} };
+            if (!renderGlyph(c, glyph.bitmap))
                 continue;
-            }
 
-            for (auto i = 0; i < bmpHeight; i++)
+            // Same padding as uploadGlyph, preloading never evicts //
+            auto rect = _atlasPacker.allocate(glyph.bitmap.width + spread + 1, glyph.bitmap.height + spread + 1);
+            if (!rect)
             {
-                int globalRow = currentPixelPositionRow + i;
-                int reversedRow = bmpHeight - i - 1;
-                memcpy(textureData.data() + globalRow * CharactersTextureSize + currentPixelPositionCol, ptrBitmap->buffer + reversedRow * bmpWidth, bmpWidth);
+                logger::warn("Font atlas is full after preloading {} characters, the rest from U+{:04X} is rasterized on first use.",
+                    pending.size(), static_cast<std::uint32_t>(c));
+                atlasFull = true;
+                break;
             }
 
-            // Setup vertices according to FreeType glyph metrics
-            // You can find it here: https://www.freetype.org/freetype2/docs/glyphs/glyphs-3.html
-            glm::vec2 vertices[] =
-            {
-                glm::vec2(static_cast<float>(charProps.bearingX), static_cast<float>(charProps.bearingY)),
-                glm::vec2(static_cast<float>(charProps.bearingX), static_cast<float>(charProps.bearingY - charProps.height)),
-                glm::vec2(static_cast<float>(bmpWidth + charProps.bearingX), static_cast<float>(charProps.bearingY)),
-                glm::vec2(static_cast<float>(bmpWidth + charProps.bearingX), static_cast<float>(charProps.bearingY - charProps.height))
-            };
+            glyph.rect = *rect;
+            pending.push_back(std::move(glyph));
+        }
 
-            glm::vec2 textureCoordinates[] =
-            {
-                glm::vec2(static_cast<float>(currentPixelPositionCol) / static_cast<float>(CharactersTextureSize), static_cast<float>(currentPixelPositionRow + bmpHeight) / static_cast<float>(CharactersTextureSize)),
-                glm::vec2(static_cast<float>(currentPixelPositionCol) / static_cast<float>(CharactersTextureSize), static_cast<float>(currentPixelPositionRow) / static_cast<float>(CharactersTextureSize)),
-                glm::vec2(static_cast<float>(currentPixelPositionCol + bmpWidth) / static_cast<float>(CharactersTextureSize), static_cast<float>(currentPixelPositionRow + bmpHeight) / static_cast<float>(CharactersTextureSize)),
-                glm::vec2(static_cast<float>(currentPixelPositionCol + bmpWidth) / static_cast<float>(CharactersTextureSize), static_cast<float>(currentPixelPositionRow) / static_cast<float>(CharactersTextureSize))
-            };
+        if (atlasFull)
+            break;
+    }
 
-            for (int i = 0; i < 4; i++)
-            {
-                vertData.push_back(vertices[i]);
-                texCoordData.push_back(textureCoordinates[i]);
-            }
+    if (_renderMode == FontRenderMode::SignedDistanceField)
+    {
+        ThreadPool::instance().parallelFor(pending.size(), 1, [&pending](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i)
+                toDistanceField(pending[i].bitmap, false);
+        });
+    }
+
+    for (auto& glyph : pending)
+        writeGlyph(glyph.code, *glyph.props, glyph.bitmap, glyph.rect);
+}
+
+bool Font::evictLeastRecentlyUsed() const
+{
+    // Glyphs used since the last flush are never evicted //
+    std::size_t oldestIndex = _residentCharacters.size();
+    CharacterProperties* oldest = nullptr;
+    for (std::size_t i = 0; i < _residentCharacters.size(); ++i)
+    {
+        const auto code = _residentCharacters[i];
+        auto& props = code < DirectCharactersCount ? _directCharacters[code] : _sparseCharacters[code];
+        if (props.lastUse >= _useClock)
+            continue;
 
-            charProps.renderIndex = currentRenderIndex;
-            charProps.textureIndex = static_cast<int>(_textures.size());
-            currentPixelPositionCol += bmpWidth + 1;
-            currentRenderIndex += 4;
-            c++;
+        if (!oldest || props.lastUse < oldest->lastUse)
+        {
+            oldest = &props;
+            oldestIndex = i;
         }
     }
 
-    // If there is a leftover texture after preparing the characters, add it to the list of textures
-    if (currentPixelPositionRow > 0 || currentPixelPositionCol > 0) {
-        finalizeTexture(false);
-    }
+    if (!oldest)
+        return false;
 
-    _vao.createAttribute(
-        0,
-        gl::VAO::Attribute::ComponentCount::Two,
-        gl::DataType::Float,
-        GL_FALSE,
-        0,
-        vertData,
-        gl::VBO::Usage::StaticDraw
-    );
-
-    _vao.createAttribute(
-        1,
-        gl::VAO::Attribute::ComponentCount::Two,
-        gl::DataType::Float,
-        GL_FALSE,
-        0,
-        texCoordData,
-        gl::VBO::Usage::StaticDraw
-    );
-
-    // Now we're done with loading, release FreeType structures
-    FT_Done_Face(freeTypeFace);
-    FT_Done_FreeType(freeTypeLibrary);
+    _atlasPacker.release(oldest->atlasRect);
+    ++_atlasGeneration;
+    oldest->resident = false;
+    oldest->atlasRect = {};
+
+    _residentCharacters[oldestIndex] = _residentCharacters.back();
+    _residentCharacters.pop_back();
 
-    _loaded = true;
     return true;
 }
 
+void Font::beginBatch(const Camera& cam) const
+{
+    // Glyphs are queued in screen space, a projection change ends the current batch //
+    const auto& projection = cam.getProjectionMatrix();
+    if (!_batch.empty() && projection != _batchProjection)
+        flush();
+    _batchProjection = projection;
+}
+
+int Font::getKerning(char32_t left, char32_t right) const
+{
+    if (!_freeTypeFace || !FT_HAS_KERNING(_freeTypeFace))
+        return 0;
+
+    FT_Vector kerning;
+    if (FT_Get_Kerning(_freeTypeFace, FT_Get_Char_Index(_freeTypeFace, FT_ULong(left)), FT_Get_Char_Index(_freeTypeFace, FT_ULong(right)), FT_KERNING_DEFAULT, &kerning))
+        return 0;
+
+    return static_cast<int>(kerning.x >> 6);
+}
+
+void Font::appendGlyph(const CharacterProperties& props, const glm::vec2& position, float scale, std::uint32_t color, std::vector<BatchVertex>& vertices) const
+{
+    // Setup vertices according to FreeType glyph metrics
+    // You can find it here: https://www.freetype.org/freetype2/docs/glyphs/glyphs-3.html
+    // Distance field glyphs carry _glyphPadding extra pixels on each side
+    const int bmpWidth = props.atlasRect.width - 1;
+    const int bmpHeight = props.atlasRect.height - 1;
+
+    const float left = position.x + static_cast<float>(props.bearingX - _glyphPadding) * scale;
+    const float right = left + static_cast<float>(bmpWidth) * scale;
+    const float top = position.y + static_cast<float>(props.bearingY + _glyphPadding) * scale;
+    const float bottom = position.y + static_cast<float>(props.bearingY - props.height - _glyphPadding) * scale;
+
+    constexpr float texelSize = 1.f / static_cast<float>(AtlasTextureSize);
+    const float u0 = static_cast<float>(props.atlasRect.x) * texelSize;
+    const float u1 = static_cast<float>(props.atlasRect.x + bmpWidth) * texelSize;
+    const float v0 = static_cast<float>(props.atlasRect.y) * texelSize;
+    const float v1 = static_cast<float>(props.atlasRect.y + bmpHeight) * texelSize;
+
+    const BatchVertex topLeft = { { left, top }, { u0, v1 }, color };
+    const BatchVertex bottomLeft = { { left, bottom }, { u0, v0 }, color };
+    const BatchVertex topRight = { { right, top }, { u1, v1 }, color };
+    const BatchVertex bottomRight = { { right, bottom }, { u1, v0 }, color };
+
+    vertices.push_back(topLeft);
+    vertices.push_back(bottomLeft);
+    vertices.push_back(topRight);
+    vertices.push_back(topRight);
+    vertices.push_back(bottomLeft);
+    vertices.push_back(bottomRight);
+}
+
+void Font::print(const Camera& cam, int x, int y, TextLayout& layout) const
+{
+    if (!_loaded)
+        return;
+
+    layout.setFont(*this);
+    layout.refresh();
+
+    beginBatch(cam);
+
+    // Touch every glyph for the LRU, making missing ones resident again //
+    for (const auto& segment : layout._segments)
+    {
+        for (const auto& glyph : segment.glyphs)
+        {
+            auto* props = getCharacter(glyph.code);
+            if (props && makeResident(glyph.code, *props))
+                props->lastUse = _useClock;
+        }
+    }
+
+    const auto color = glm::packUnorm4x8(_color);
+    if (layout._verticesDirty || layout._verticesAtlasGeneration != _atlasGeneration || layout._verticesColor != color)
+    {
+        const float scale = layout.getScale();
+
+        layout._vertices.clear();
+        for (const auto& segment : layout._segments)
+        {
+            for (const auto& glyph : segment.glyphs)
+            {
+                const auto* props = getCharacter(glyph.code);
+                if (props && props->resident)
+                    appendGlyph(*props, (segment.origin + glm::vec2(glyph.x, 0.f)) * scale, scale, color, layout._vertices);
+            }
+        }
+
+        layout._verticesAtlasGeneration = _atlasGeneration;
+        layout._verticesColor = color;
+        layout._verticesDirty = false;
+    }
+
+    const glm::vec2 offset = { static_cast<float>(x), static_cast<float>(y) };
+    _batch.reserve(_batch.size() + layout._vertices.size());
+    for (const auto& vertex : layout._vertices)
+        _batch.push_back({ vertex.position + offset, vertex.uv, vertex.color });
+}
+
+void Font::flush() const
+{
+    if (!_loaded || _batch.empty())
+        return;
+
+    auto& buffer = _vao.getInterleavedBuffer();
+    if (_batch.size() > _batchCapacity)
+        _batchCapacity = std::max(_batch.size(), _batchCapacity * 2);
+
+    // Orphan the previous storage so the driver does not stall on draws still reading it //
+    buffer.write(nullptr, sizeof(BatchVertex), _batchCapacity, gl::VBO::Usage::StreamDraw, false, false);
+    buffer.update(_batch.data(), 0, _batch.size() * sizeof(BatchVertex));
+
+    glDisable(GL_DEPTH_TEST);
+    glDepthMask(0);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    auto shaderProgram = getFreetypeFontShader();
+    shaderProgram->use();
+    shaderProgram["projection"] = _batchProjection;
+
+    _atlas.activate();
+
+    _vao.bind();
+    gl::backend().drawArrays(GL_TRIANGLES, 0, GLsizei(_batch.size()));
+    FrameStats::instance().addDraw(GL_TRIANGLES, GLsizei(_batch.size()));
+    _vao.unbind();
+
+    glDisable(GL_BLEND);
+    glDepthMask(1);
+    glEnable(GL_DEPTH_TEST);
+
+    _batch.clear();
+    ++_useClock;
+}
+
 int Font::getTextWidth(std::string_view text, int pixelSize) const
 {
     float result = 0.0f;
     float rowWidth = 0.0f;
     const auto usedPixelSize = pixelSize == -1 ? _pixelSize : pixelSize;
-    const auto scale = static_cast<float>(usedPixelSize) / static_cast<float>(_pixelSize);
+    const auto scale = static_cast<float>(usedPixelSize) / static_cast<float>(_rasterPixelSize);
 
-    // TODO: would be nice to handle invalid characters here as well
     for (int i = 0; i < static_cast<int>(text.length()); i++)
     {
         if (text[i] == '\n' || text[i] == '\r') {
@@ -210,15 +447,17 @@ int Font::getTextWidth(std::string_view text, int pixelSize) const
         }
 
         bool lastCharacterInRow = i == text.length() - 1 || text[i + 1] == '\n' || text[i + 1] == '\r';
-        const auto& props = _characterProperties.at(text[i]);
+        const auto* props = getCharacter(toCharacterCode(text[i]));
         if (!lastCharacterInRow)
         {
-            rowWidth += props.advanceX * scale;
+            if (props)
+                rowWidth += props->advanceX * scale;
             continue;
         }
 
         // Handle last character in a row in a special way + update the result
-        rowWidth += (props.bearingX + props.width) * scale;
+        if (props)
+            rowWidth += (props->bearingX + props->width) * scale;
         result = std::max(result, rowWidth);
         rowWidth = 0.0f;
     }
@@ -229,6 +468,7 @@ int Font::getTextWidth(std::string_view text, int pixelSize) const
 
 int Font::getTextHeight(std::string_view text, int pixelSize) const
 {
+    // Glyph metrics are in raster pixels, this one is not: the raster size is an atlas detail and stays out of it
     const auto usedPixelSize = pixelSize == -1 ? _pixelSize : pixelSize;
     const auto scale = static_cast<float>(usedPixelSize) / static_cast<float>(_pixelSize);
 
@@ -238,8 +478,24 @@ int Font::getTextHeight(std::string_view text, int pixelSize) const
 void Font::destroy()
 {
     _loaded = false;
-    _textures.clear();
-    _characterProperties.clear();
-    _characterRanges.clear();
+    _atlas.destroy();
+    _atlasPacker.clear();
+    _directCharacters = {};
+    _sparseCharacters.clear();
+    _residentCharacters.clear();
+    _useClock = 0;
+    ++_atlasGeneration;
+    _batch.clear();
+    _batchCapacity = 0;
     _vao.destroy();
+    _shaderCache = {};
+
+    // Now we're done with rendering, release FreeType structures
+    if (_freeTypeFace)
+        FT_Done_Face(_freeTypeFace);
+    if (_freeTypeLibrary)
+        FT_Done_FreeType(_freeTypeLibrary);
+
+    _freeTypeFace = nullptr;
+    _freeTypeLibrary = nullptr;
 }
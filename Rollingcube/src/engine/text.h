@@ -4,12 +4,16 @@
 #include <string>
 #include <unordered_map>
 #include <memory>
+#include <array>
+#include <cstdint>
+#include <type_traits>
 
 #include "core/gl.h"
 #include "core/render.h"
 
 #include "utils/string_utils.h"
 #include "utils/unicode.h"
+#include "utils/shelf_packer.h"
 
 #include "texture.h"
 #include "shader.h"
@@ -19,28 +23,61 @@
 
 
 
+struct FT_LibraryRec_;
+struct FT_FaceRec_;
+
+class TextLayout;
+
+enum class FontRenderMode
+{
+    Bitmap, // Coverage bitmaps rasterized at the font pixel size, crisp only at that size
+    SignedDistanceField // Distance fields rasterized once at SdfRasterPixelSize, scale to any size
+};
+
 class Font
 {
 public:
     static constexpr int CharactersTextureSize = 512;
+    static constexpr int AtlasTextureSize = 2048;
+    static constexpr char32_t DirectCharactersCount = 256; // ASCII + Latin-1 //
+    static constexpr std::size_t FormatBufferSize = 512;
+    static constexpr std::size_t InitialBatchCapacity = 6 * 1024;
+    static constexpr int SdfRasterPixelSize = 64;
+    static constexpr int SdfSpread = 8; // Distance in raster pixels mapped to the full 0..255 range
 
 private:
 	struct CharacterProperties
 	{
-        int characterCode; // What character code these properties belong to
+        bool loaded = false; // Metrics have been queried from FreeType
+        bool valid = false; // The face has a glyph for this character code
 
         // Following properties come from FreeType directly
-        int width;
-        int height;
-        int advanceX;
-        int bearingX;
-        int bearingY;
+        int width = 0;
+        int height = 0;
+        int advanceX = 0;
+        int bearingX = 0;
+        int bearingY = 0;
 
         // These are our properties used for rendering
-        int renderIndex;
-        int textureIndex;
+        bool resident = false; // The glyph bitmap is in the atlas
+        ShelfPacker::Rect atlasRect = {}; // Includes one pixel of padding on the right and top
+        std::uint64_t lastUse = 0;
 	};
 
+    struct BatchVertex
+    {
+        glm::vec2 position;
+        glm::vec2 uv;
+        std::uint32_t color;
+    };
+
+    struct GlyphBitmap
+    {
+        std::vector<std::uint8_t> pixels; // Top-down rows, tightly packed
+        int width = 0;
+        int height = 0;
+    };
+
     struct CharacterRange
     {
         unsigned int characterCodeFrom; // Start of unicode range
@@ -49,13 +86,31 @@ private:
 
 private:
 	bool _loaded = false;
-    std::vector<CharacterRange> _characterRanges;
-    int _pixelSize = 0;
+    std::uint64_t _loadGeneration = 0; // Advanced on each load, invalidates cached layouts
+    std::vector<CharacterRange> _characterRanges; // Rasterized upfront, everything else is rasterized on first use
+    int _pixelSize = 0; // Default print size
+    int _rasterPixelSize = 0; // Size the glyphs are rasterized at, glyph metrics are in this size
+    int _glyphPadding = 0; // Extra pixels around each atlas glyph
+    FontRenderMode _renderMode = FontRenderMode::Bitmap;
     glm::vec4 _color = { 1, 1, 1, 1 };
 
-    std::vector<std::unique_ptr<Texture>> _textures;
-    std::unordered_map<int, CharacterProperties> _characterProperties;
-    gl::VAO _vao;
+    FT_LibraryRec_* _freeTypeLibrary = nullptr;
+    FT_FaceRec_* _freeTypeFace = nullptr;
+
+    mutable Texture _atlas;
+    mutable ShelfPacker _atlasPacker;
+    mutable std::array<CharacterProperties, DirectCharactersCount> _directCharacters;
+    mutable std::unordered_map<char32_t, CharacterProperties> _sparseCharacters;
+    mutable std::vector<char32_t> _residentCharacters;
+    mutable std::uint64_t _useClock = 0; // Advanced on each flush, glyphs used since the last flush stay resident
+    mutable std::uint64_t _atlasGeneration = 0; // Advanced on each eviction, invalidates cached glyph quads
+
+    mutable std::vector<BatchVertex> _batch;
+    mutable glm::mat4 _batchProjection = glm::mat4(1.f);
+    mutable std::size_t _batchCapacity = 0;
+    mutable gl::VAO _vao;
+
+    mutable std::array<char, FormatBufferSize> _formatBuffer = {};
 
     mutable ShaderProgram::Ref _shaderCache = {};
 
@@ -68,15 +123,22 @@ public:
 public:
     Font();
 
-    bool load(std::string_view filepath, int pixelSize);
+    bool load(std::string_view filepath, int pixelSize, FontRenderMode renderMode = FontRenderMode::Bitmap);
 
     int getTextWidth(std::string_view text, int pixelSize = -1) const;
     int getTextHeight(std::string_view text, int pixelSize = -1) const;
 
+    // Queues a cached layout, only glyphs evicted from the atlas since its last print get rebuilt //
+    void print(const Camera& cam, int x, int y, TextLayout& layout) const;
+
+    // Draws every glyph queued by print since the last flush, in a single draw call //
+    void flush() const;
+
     void destroy();
 
 public:
     constexpr bool isLoaded() const { return _loaded; }
+    constexpr FontRenderMode getRenderMode() const { return _renderMode; }
 
     constexpr void addCharacterRange(unsigned int from, unsigned int to) { _characterRanges.push_back({ from, to }); }
 
@@ -87,13 +149,13 @@ public:
     template <typename... _ArgsTys>
     inline void print(const Camera& cam, int x, int y, std::string_view text, _ArgsTys&&... args) const
     {
-        _print<std::string_view::value_type>(cam, x, y, utils::str::format(text, std::forward<_ArgsTys>(args)...), -1);
+        _print<std::string_view::value_type>(cam, x, y, utils::str::format_to(_formatBuffer, text, std::forward<_ArgsTys>(args)...), -1);
     }
 
     template <typename... _ArgsTys>
     inline void print(const Camera& cam, int x, int y, int pixelSize, std::string_view text, _ArgsTys&&... args) const
     {
-        _print<std::string_view::value_type>(cam, x, y, utils::str::format(text, std::forward<_ArgsTys>(args)...), pixelSize);
+        _print<std::string_view::value_type>(cam, x, y, utils::str::format_to(_formatBuffer, text, std::forward<_ArgsTys>(args)...), pixelSize);
     }
 
     inline void print(const Camera& cam, int x, int y, const UnicodeString& text)
@@ -110,13 +172,37 @@ private:
     template <UtfChar _CharTy>
     void _print(const Camera& cam, int x, int y, std::basic_string_view<_CharTy> text, int pixelSize) const;
 
+    void appendGlyph(const CharacterProperties& props, const glm::vec2& position, float scale, std::uint32_t color, std::vector<BatchVertex>& vertices) const;
+    int getKerning(char32_t left, char32_t right) const;
+    void beginBatch(const Camera& cam) const;
+
+    CharacterProperties* getCharacter(char32_t code) const;
+    bool makeResident(char32_t code, CharacterProperties& props) const;
+    bool renderGlyph(char32_t code, GlyphBitmap& bitmap) const;
+    bool uploadGlyph(char32_t code, CharacterProperties& props, const GlyphBitmap& bitmap) const;
+    void writeGlyph(char32_t code, CharacterProperties& props, const GlyphBitmap& bitmap, const ShelfPacker::Rect& rect) const;
+    void preloadCharacterRanges() const;
+    bool evictLeastRecentlyUsed() const;
+
 private:
+    template <UtfChar _CharTy>
+    static constexpr char32_t toCharacterCode(_CharTy c) { return static_cast<char32_t>(static_cast<std::make_unsigned_t<_CharTy>>(c)); }
+
+    static void toDistanceField(GlyphBitmap& bitmap, bool parallel);
+
     inline ShaderProgram::Ref getFreetypeFontShader() const
     {
         if (!_shaderCache)
-            _shaderCache = ShaderProgramManager::instance().getFreetypeFontShaderProgram();
+        {
+            _shaderCache = _renderMode == FontRenderMode::SignedDistanceField
+                ? ShaderProgramManager::instance().getFreetypeFontSdfShaderProgram()
+                : ShaderProgramManager::instance().getFreetypeFontShaderProgram();
+        }
         return _shaderCache;
     }
+
+public:
+    friend TextLayout;
 };
 
 
@@ -129,22 +215,13 @@ void Font::_print(const Camera& cam, int x, int y, std::basic_string_view<_CharT
     if (!_loaded)
         return;
 
-    glDisable(GL_DEPTH_TEST);
-    glDepthMask(0);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-    auto shaderProgram = getFreetypeFontShader();
-    shaderProgram->use();
-    shaderProgram["projection"] = cam.getProjectionMatrix();
-    shaderProgram["color"] = _color;
+    beginBatch(cam);
 
     glm::vec2 currentPos(x, y);
     const auto usedPixelSize = pixelSize == -1 ? _pixelSize : pixelSize;
-    auto lastBoundTextureIndex = -1;
-    const auto scale = static_cast<float>(usedPixelSize) / static_cast<float>(_pixelSize);
+    const auto scale = static_cast<float>(usedPixelSize) / static_cast<float>(_rasterPixelSize);
+    const auto color = glm::packUnorm4x8(_color);
 
-    _vao.bind();
     for (const auto& c : text)
     {
         if (c == '\n' || c == '\r')
@@ -155,30 +232,18 @@ void Font::_print(const Camera& cam, int x, int y, std::basic_string_view<_CharT
         }
 
         // If we somehow stumble upon unknown character, ignore it
-        if (_characterProperties.count(c) == 0) {
+        const auto code = toCharacterCode(c);
+        auto* props = getCharacter(code);
+        if (!props) {
             continue;
         }
 
-        const auto& props = _characterProperties.at(c);
-        if (props.renderIndex != -1)
+        if (makeResident(code, *props))
         {
-            if (lastBoundTextureIndex != props.textureIndex)
-            {
-                lastBoundTextureIndex = props.textureIndex;
-                _textures.at(props.textureIndex)->activate();
-            }
-
-            glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(currentPos.x, currentPos.y, 0.0f));
-            model = glm::scale(model, glm::vec3(scale, scale, 1.0f));
-            shaderProgram["model"] = model;
-            glDrawArrays(GL_TRIANGLE_STRIP, props.renderIndex, 4);
+            props->lastUse = _useClock;
+            appendGlyph(*props, currentPos, scale, color, _batch);
         }
 
-        currentPos.x += props.advanceX * scale;
+        currentPos.x += props->advanceX * scale;
     }
-    _vao.unbind();
-
-    glDisable(GL_BLEND);
-    glDepthMask(1);
-    glEnable(GL_DEPTH_TEST);
 }
@@ -0,0 +1,226 @@
+#include "text_layout.h"
+
+#include <limits>
+#include <algorithm>
+
+#include "utils/unicode.h"
+#include "utils/logger.h"
+
+
+TextLayout::TextLayout(const Font& font, std::string_view text, int pixelSize) :
+	_font(std::addressof(font)),
+	_pixelSize(pixelSize)
+{
+	setText(text);
+}
+
+void TextLayout::setFont(const Font& font)
+{
+	if (_font == std::addressof(font))
+		return;
+
+	_font = std::addressof(font);
+	_shapeDirty = true;
+}
+
+void TextLayout::setText(std::string_view text)
+{
+	if (!_segments.empty() && _text == text)
+		return;
+
+	_text = std::string(text);
+	parse();
+}
+
+void TextLayout::setPixelSize(int pixelSize)
+{
+	if (_pixelSize == pixelSize)
+		return;
+
+	// Positions are kept in font units, only the quads need rebuilding //
+	_pixelSize = pixelSize;
+	_verticesDirty = true;
+}
+
+void TextLayout::setField(std::size_t index, std::string_view value)
+{
+	if (index >= _fields.size())
+	{
+		logger::warn("Invalid field index {} in text layout '{}'.", index, _text);
+		return;
+	}
+
+	Segment& segment = _segments[_fields[index]];
+
+	// ASCII values (numbers mostly) are widened in place, without a temporary UTF-32 string //
+	bool ascii = true;
+	for (const char c : value)
+		ascii = ascii && static_cast<unsigned char>(c) < 0x80;
+
+	if (ascii)
+	{
+		if (segment.text.size() == value.size() && std::equal(value.begin(), value.end(), segment.text.begin()))
+			return;
+
+		segment.text.resize(value.size());
+		for (std::size_t i = 0; i < value.size(); ++i)
+			segment.text[i] = static_cast<char32_t>(value[i]);
+	}
+	else
+	{
+		UnicodeString unicode = UnicodeString(value);
+		if (segment.text == std::u32string_view(unicode))
+			return;
+
+		segment.text.assign(unicode.begin(), unicode.end());
+	}
+
+	// Fields are single line //
+	std::erase_if(segment.text, [](char32_t c) { return c == U'\n' || c == U'\r'; });
+
+	if (!_shapeDirty && _font)
+		shapeSegment(segment);
+
+	_positionsDirty = true;
+	_verticesDirty = true;
+}
+
+glm::vec2 TextLayout::getSize()
+{
+	refresh();
+	if (_boundsMax.x < _boundsMin.x)
+		return {};
+
+	return (_boundsMax - _boundsMin) * getScale();
+}
+
+void TextLayout::parse()
+{
+	_segments.clear();
+	_fields.clear();
+
+	const UnicodeString text = UnicodeString(std::string_view(_text));
+
+	Segment* current = &_segments.emplace_back();
+	for (std::size_t i = 0; i < text.size(); ++i)
+	{
+		const char32_t c = text[i];
+		if (c == U'\n' || c == U'\r')
+		{
+			current = &_segments.emplace_back();
+			current->lineStart = true;
+			continue;
+		}
+
+		if (std::u32string_view(text).substr(i, FieldPlaceholder.size()) == FieldPlaceholder)
+		{
+			_fields.push_back(_segments.size());
+			_segments.emplace_back().field = true;
+			current = &_segments.emplace_back();
+			i += FieldPlaceholder.size() - 1;
+			continue;
+		}
+
+		current->text.push_back(c);
+	}
+
+	_shapeDirty = true;
+	_positionsDirty = true;
+	_verticesDirty = true;
+}
+
+void TextLayout::refresh()
+{
+	if (!_font || !_font->isLoaded())
+		return;
+
+	if (_fontGeneration != _font->_loadGeneration)
+	{
+		_fontGeneration = _font->_loadGeneration;
+		_shapeDirty = true;
+	}
+
+	if (_shapeDirty)
+	{
+		for (auto& segment : _segments)
+			shapeSegment(segment);
+
+		_shapeDirty = false;
+		_positionsDirty = true;
+		_verticesDirty = true;
+	}
+
+	if (_positionsDirty)
+		updatePositions();
+}
+
+void TextLayout::shapeSegment(Segment& segment)
+{
+	segment.glyphs.clear();
+	segment.glyphs.reserve(segment.text.size());
+
+	float pen = 0.f;
+	char32_t previous = 0;
+	for (const char32_t code : segment.text)
+	{
+		const auto* props = _font->getCharacter(code);
+		if (!props)
+			continue;
+
+		if (previous != 0)
+			pen += static_cast<float>(_font->getKerning(previous, code));
+
+		segment.glyphs.push_back({ code, pen });
+		pen += static_cast<float>(props->advanceX);
+		previous = code;
+	}
+
+	segment.advance = pen;
+}
+
+void TextLayout::updatePositions()
+{
+	const float lineHeight = static_cast<float>(_font->_rasterPixelSize);
+
+	_boundsMin = glm::vec2(std::numeric_limits<float>::max());
+	_boundsMax = glm::vec2(std::numeric_limits<float>::lowest());
+
+	glm::vec2 pen = {};
+	for (auto& segment : _segments)
+	{
+		if (segment.lineStart)
+		{
+			pen.x = 0.f;
+			pen.y -= lineHeight;
+		}
+
+		segment.origin = pen;
+		pen.x += segment.advance;
+
+		for (const auto& glyph : segment.glyphs)
+		{
+			const auto* props = _font->getCharacter(glyph.code);
+			if (!props || props->width <= 0 || props->height <= 0)
+				continue;
+
+			const glm::vec2 topLeft = { segment.origin.x + glyph.x + static_cast<float>(props->bearingX), segment.origin.y + static_cast<float>(props->bearingY) };
+			const glm::vec2 bottomRight = { topLeft.x + static_cast<float>(props->width), topLeft.y - static_cast<float>(props->height) };
+
+			_boundsMin = glm::min(_boundsMin, glm::min(topLeft, bottomRight));
+			_boundsMax = glm::max(_boundsMax, glm::max(topLeft, bottomRight));
+		}
+	}
+
+	_positionsDirty = false;
+	_verticesDirty = true;
+}
+
+float TextLayout::getScale() const
+{
+	if (!_font || _font->_rasterPixelSize <= 0)
+		return 1.f;
+
+	// Glyph metrics are in raster units, which differ from the default size for distance field fonts //
+	const int usedPixelSize = _pixelSize == -1 ? _font->_pixelSize : _pixelSize;
+	return static_cast<float>(usedPixelSize) / static_cast<float>(_font->_rasterPixelSize);
+}
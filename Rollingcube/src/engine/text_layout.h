@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "math/glm.h"
+#include "utils/string_utils.h"
+
+#include "text.h"
+
+
+/*
+	Text shaped once (glyph positions, kerning and line breaks) and kept as a cached vertex range for Font::print.
+	Each "{}" in the text is a field whose value can be replaced with setField. Changing a field only reshapes that
+	field and shifts what follows it on the same line.
+*/
+class TextLayout
+{
+public:
+	static constexpr std::u32string_view FieldPlaceholder = U"{}";
+	static constexpr std::size_t FieldBufferSize = 128;
+
+private:
+	struct Glyph
+	{
+		char32_t code;
+		float x; // Pen position relative to the segment origin
+	};
+
+	struct Segment
+	{
+		std::u32string text;
+		std::vector<Glyph> glyphs;
+		float advance = 0.f;
+		glm::vec2 origin = {};
+		bool lineStart = false;
+		bool field = false;
+	};
+
+private:
+	const Font* _font = nullptr;
+	std::string _text;
+	int _pixelSize = -1;
+
+	std::vector<Segment> _segments;
+	std::vector<std::size_t> _fields;
+	std::array<char, FieldBufferSize> _fieldBuffer = {};
+
+	std::uint64_t _fontGeneration = 0;
+	bool _shapeDirty = true;
+	bool _positionsDirty = true;
+	glm::vec2 _boundsMin = {};
+	glm::vec2 _boundsMax = {};
+
+	// Quads in layout space, with the origin at (0, 0) //
+	std::vector<Font::BatchVertex> _vertices;
+	std::uint64_t _verticesAtlasGeneration = 0;
+	std::uint32_t _verticesColor = 0;
+	bool _verticesDirty = true;
+
+public:
+	TextLayout() = default;
+	TextLayout(const TextLayout&) = default;
+	TextLayout(TextLayout&&) noexcept = default;
+	~TextLayout() = default;
+
+	TextLayout& operator= (const TextLayout&) = default;
+	TextLayout& operator= (TextLayout&&) noexcept = default;
+
+	TextLayout(const Font& font, std::string_view text, int pixelSize = -1);
+
+public:
+	inline const Font* getFont() const { return _font; }
+	inline std::string_view getText() const { return _text; }
+	inline int getPixelSize() const { return _pixelSize; }
+	inline std::size_t getFieldCount() const { return _fields.size(); }
+
+	void setFont(const Font& font);
+	void setText(std::string_view text);
+	void setPixelSize(int pixelSize);
+
+	void setField(std::size_t index, std::string_view value);
+
+	template <typename... _ArgsTys>
+	inline void setField(std::size_t index, std::string_view fmt, _ArgsTys&&... args)
+	{
+		setField(index, utils::str::format_to(_fieldBuffer, fmt, std::forward<_ArgsTys>(args)...));
+	}
+
+	// Size of the glyph quads, in pixels at the layout pixel size //
+	glm::vec2 getSize();
+	inline int getWidth() { return static_cast<int>(std::ceil(getSize().x)); }
+	inline int getHeight() { return static_cast<int>(std::ceil(getSize().y)); }
+
+private:
+	void parse();
+	void refresh();
+	void shapeSegment(Segment& segment);
+	void updatePositions();
+	float getScale() const;
+
+public:
+	friend Font;
+};
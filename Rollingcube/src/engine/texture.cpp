@@ -1,7 +1,13 @@
 #include "texture.h"
 
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+
 #include "utils/logger.h"
 #include "utils/exception_utils.h"
+#include "utils/io_utils.h"
+#include "core/profiler.h"
 
 
 bool Texture::createFromData(const unsigned char* data, SizeType width, SizeType height, Format format, bool generateMipmaps)
@@ -13,18 +19,54 @@ bool Texture::createFromData(const unsigned char* data, SizeType width, SizeType
 	_height = height;
 	_format = format;
 
-	glGenTextures(1, &_id);
+	_id = gl::backend().genTexture();
 	bind();
-	glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(_format), _width, _height, 0, static_cast<GLenum>(_format), GL_UNSIGNED_BYTE, data);
+	gl::backend().texImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(_format), _width, _height, static_cast<GLenum>(_format), GL_UNSIGNED_BYTE, data);
+	if (data != nullptr)
+		FrameStats::instance().add(FrameCounter::UploadedBytes, gl::getImageSize(_width, _height, static_cast<GLenum>(_format), GL_UNSIGNED_BYTE));
 
 	if (generateMipmaps)
-		glGenerateMipmap(GL_TEXTURE_2D);
+		gl::backend().generateMipmap(GL_TEXTURE_2D);
+
+	return true;
+}
+
+bool Texture::updateData(const unsigned char* data, SizeType x, SizeType y, SizeType width, SizeType height)
+{
+	if (!checkIsCreated())
+		return false;
+
+	if (x < 0 || y < 0 || x + width > _width || y + height > _height)
+		return false;
+
+	bind();
+	gl::backend().texSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, static_cast<GLenum>(_format), GL_UNSIGNED_BYTE, data);
+	FrameStats::instance().add(FrameCounter::UploadedBytes, gl::getImageSize(width, height, static_cast<GLenum>(_format), GL_UNSIGNED_BYTE));
 
 	return true;
 }
 
+bool Texture::createFromImage(const Image& img, bool generateMipmaps)
+{
+	if (!img.isValid())
+		return false;
+
+	if (img.hasInvertedPixelRows())
+	{
+		Image temp = img;
+		temp.invertRows();
+		return createFromImage(temp, generateMipmaps);
+	}
+
+	Format fmt = img.hasAlpha() ? Format::rgba : Format::rgb;
+
+	return createFromData(img.data(), SizeType(img.width()), SizeType(img.height()), fmt, generateMipmaps);
+}
+
 bool Texture::loadFromImage(std::string_view name, bool generateMipmaps)
 {
+	PROFILE_SCOPE_CATEGORY("Texture::loadFromImage", ProfileCategory::Asset);
+
 	if (isCreated())
 		return false;
 
@@ -35,12 +77,7 @@ bool Texture::loadFromImage(std::string_view name, bool generateMipmaps)
 		return false;
 	}
 
-	if (img.hasInvertedPixelRows())
-		img.invertRows();
-
-	Format fmt = img.hasAlpha() ? Format::rgba : Format::rgb;
-
-	if (!createFromData(img.data(), SizeType(img.width()), SizeType(img.height()), fmt, generateMipmaps))
+	if (!createFromImage(img, generateMipmaps))
 		return false;
 
 	_file = name;
@@ -62,7 +99,7 @@ bool Texture::resize(SizeType width, SizeType height, bool generateMipmaps)
 void Texture::destroy()
 {
 	if (isCreated())
-		glDeleteTextures(1, &_id);
+		gl::backend().deleteTexture(_id);
 
 	_id = 0;
 	_width = 0;
@@ -74,7 +111,7 @@ GLint Texture::getNumTextureImageUnits()
 {
 	static GLint max_texture_units = 0;
 	if (max_texture_units == 0)
-		glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &max_texture_units);
+		max_texture_units = gl::backend().getInteger(GL_MAX_TEXTURE_IMAGE_UNITS);
 
 	return max_texture_units;
 }
@@ -84,59 +121,307 @@ GLint Texture::getNumTextureImageUnits()
 
 TextureManager TextureManager::Root = TextureManager(nullptr);
 
+std::vector<TextureManager::Reference> TextureManager::loadFromImages(const std::vector<std::pair<IdType, std::string>>& files, bool generateMipmaps)
+{
+	std::vector<std::future<Image>> pending;
+	pending.reserve(files.size());
+
+	for (const auto& file : files)
+		pending.push_back(Image::loadAsync(file.second));
 
+	std::vector<Reference> refs;
+	refs.reserve(files.size());
 
+	for (std::size_t i = 0; i < files.size(); ++i)
+	{
+		Image img = pending[i].get();
+		if (!img.isValid())
+		{
+			logger::error("Cannot load texture because it's image cannot be read. Image filename: {}", files[i].second);
+			refs.push_back(nullptr);
+			continue;
+		}
+
+		Reference ref = create(files[i].first);
+		if (!ref || !ref->createFromImage(img, generateMipmaps))
+		{
+			if (ref)
+				destroy(files[i].first);
+			refs.push_back(nullptr);
+			continue;
+		}
+
+		ref->_file = files[i].second;
+		refs.push_back(ref);
+	}
+
+	return refs;
+}
 
 
 
 
-bool CubeMapTexture::loadFromImage(const FacesFiles& filenames)
+
+
+
+namespace
+{
+	struct CompiledCubeMapHeader
+	{
+		static constexpr std::uint32_t Magic = 0x4d435243; // "RCCM" //
+		static constexpr std::uint32_t CurrentVersion = 1;
+
+		std::uint32_t magic = Magic;
+		std::uint32_t version = CurrentVersion;
+		std::uint32_t width = 0;
+		std::uint32_t height = 0;
+		std::uint32_t format = 0;
+		std::uint32_t levels = 0;
+	};
+
+	inline std::size_t getCubeMapLevelSize(GLsizei width, GLsizei height, TextureFormat format, GLint level)
+	{
+		const std::size_t w = std::max<std::size_t>(1, std::size_t(width) >> level);
+		const std::size_t h = std::max<std::size_t>(1, std::size_t(height) >> level);
+		return w * h * (format == TextureFormat::rgba ? 4 : 3);
+	}
+}
+
+bool CubeMapTexture::loadFromImage(const FacesFiles& filenames, bool generateMipmaps)
 {
+	PROFILE_SCOPE_CATEGORY("CubeMapTexture::loadFromImage", ProfileCategory::Asset);
+
 	if (isCreated())
 		return false;
 
-	glGenTextures(1, &_id);
+	std::future<Image> faces[FacesCount];
+	for (std::size_t i = 0; i < FacesCount; i++)
+		if (!filenames[i].empty())
+			faces[i] = Image::loadAsync(filenames[i]);
+
+	_id = gl::backend().genTexture();
 	bind();
+	gl::backend().pixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
+	std::size_t loadedFaces = 0;
+	bool matchingFaces = true;
 	for (std::size_t i = 0; i < FacesCount; i++)
 	{
-		const std::string& filename = filenames[i];
-		if (!filename.empty())
+		if (!faces[i].valid())
+			continue;
+
+		Image img = faces[i].get();
+		if (!img.isValid())
 		{
-			Image img;
-			if (!img.load(filename))
-			{
-				logger::error("Cannot load cubemap face texture because it's image cannot be read. Image filanem: {}", filename);
-				continue;
-			}
+			logger::error("Cannot load cubemap face texture because it's image cannot be read. Image filanem: {}", filenames[i]);
+			continue;
+		}
+
+		if (img.hasInvertedPixelRows())
+			img.invertRows();
+
+		Format fmt = img.hasAlpha() ? Format::rgba : Format::rgb;
+
+		gl::backend().texImage2D(
+			static_cast<GLenum>(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i),
+			0,
+			static_cast<GLint>(fmt),
+			static_cast<GLsizei>(img.width()),
+			static_cast<GLsizei>(img.height()),
+			static_cast<GLenum>(fmt),
+			GL_UNSIGNED_BYTE,
+			img.data()
+		);
+		FrameStats::instance().add(FrameCounter::UploadedBytes, gl::getImageSize(GLsizei(img.width()), GLsizei(img.height()), static_cast<GLenum>(fmt), GL_UNSIGNED_BYTE));
+
+		if (loadedFaces > 0)
+			matchingFaces = matchingFaces && _width == static_cast<SizeType>(img.width()) && _height == static_cast<SizeType>(img.height()) && _format == fmt;
+
+		_width = static_cast<SizeType>(img.width());
+		_height = static_cast<SizeType>(img.height());
+		_format = fmt;
+		++loadedFaces;
+	}
+	gl::backend().pixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
-			if (img.hasInvertedPixelRows())
-				img.invertRows();
+	_complete = loadedFaces == FacesCount && matchingFaces && _width == _height;
+
+	if (generateMipmaps)
+		gl::backend().generateMipmap(GL_TEXTURE_CUBE_MAP);
 
-			Format fmt = img.hasAlpha() ? Format::rgba : Format::rgb;
+	setFilters(generateMipmaps);
+	_files = filenames;
 
-			glTexImage2D(
+	return true;
+}
+
+bool CubeMapTexture::loadFromCompiledFile(std::string_view path)
+{
+	PROFILE_SCOPE_CATEGORY("CubeMapTexture::loadFromCompiledFile", ProfileCategory::Asset);
+
+	if (isCreated())
+		return false;
+
+	std::ifstream file(std::string(path), std::ios::in | std::ios::binary);
+	if (!file)
+	{
+		logger::error("Cannot open compiled cubemap texture file {}.", path);
+		return false;
+	}
+
+	CompiledCubeMapHeader header;
+	io::read_obj(file, &header);
+	if (!file || header.magic != CompiledCubeMapHeader::Magic || header.version != CompiledCubeMapHeader::CurrentVersion || header.levels == 0)
+	{
+		logger::error("Invalid compiled cubemap texture file {}.", path);
+		return false;
+	}
+
+	const Format fmt = Format(header.format);
+	if (fmt != Format::rgb && fmt != Format::rgba)
+	{
+		logger::error("Unsupported compiled cubemap texture format in file {}.", path);
+		return false;
+	}
+
+	// Nothing in the header is trusted before it is allocated or uploaded. Without a reported limit (null backend)
+	// the cap still keeps the size sums below from overflowing //
+	static constexpr std::uint32_t FallbackMaxSize = 1u << 16;
+	const GLint maxSizeLimit = gl::backend().getInteger(GL_MAX_CUBE_MAP_TEXTURE_SIZE);
+	const std::uint32_t maxSize = maxSizeLimit > 0 ? std::min(std::uint32_t(maxSizeLimit), FallbackMaxSize) : FallbackMaxSize;
+	std::uint32_t maxLevels = 0;
+	while (std::max(header.width, header.height) >> maxLevels)
+		++maxLevels;
+
+	if (header.width == 0 || header.height == 0 || header.width != header.height || header.width > maxSize || header.levels > maxLevels)
+	{
+		logger::error("Invalid compiled cubemap texture size {}x{} with {} levels in file {}.", header.width, header.height, header.levels, path);
+		return false;
+	}
+
+	std::uint64_t expectedSize = sizeof(CompiledCubeMapHeader);
+	for (GLint level = 0; level < GLint(header.levels); ++level)
+		expectedSize += std::uint64_t(FacesCount) * getCubeMapLevelSize(GLsizei(header.width), GLsizei(header.height), fmt, level);
+
+	std::error_code ec;
+	const auto fileSize = std::filesystem::file_size(Path(path), ec);
+	if (ec || std::uint64_t(fileSize) != expectedSize)
+	{
+		logger::error("Compiled cubemap texture file {} does not match its header.", path);
+		return false;
+	}
+
+	_id = gl::backend().genTexture();
+	bind();
+	gl::backend().pixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	std::vector<std::uint8_t> buffer;
+	for (GLint level = 0; level < GLint(header.levels); ++level)
+	{
+		const std::size_t size = getCubeMapLevelSize(GLsizei(header.width), GLsizei(header.height), fmt, level);
+		buffer.resize(size);
+
+		for (std::size_t i = 0; i < FacesCount; ++i)
+		{
+			if (!io::read_bin(file, buffer.data(), size))
+			{
+				logger::error("Unexpected end of compiled cubemap texture file {}.", path);
+				gl::backend().pixelStorei(GL_UNPACK_ALIGNMENT, 4);
+				destroy();
+				return false;
+			}
+
+			gl::backend().texImage2D(
 				static_cast<GLenum>(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i),
-				0,
+				level,
 				static_cast<GLint>(fmt),
-				static_cast<GLsizei>(img.width()),
-				static_cast<GLsizei>(img.height()),
-				0,
+				std::max<GLsizei>(1, GLsizei(header.width) >> level),
+				std::max<GLsizei>(1, GLsizei(header.height) >> level),
 				static_cast<GLenum>(fmt),
 				GL_UNSIGNED_BYTE,
-				img.data()
+				buffer.data()
 			);
+			FrameStats::instance().add(FrameCounter::UploadedBytes, size);
 		}
 	}
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	gl::backend().pixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	gl::backend().texParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, GLint(header.levels - 1));
+
+	_width = SizeType(header.width);
+	_height = SizeType(header.height);
+	_format = fmt;
+	_complete = true;
+	setFilters(header.levels > 1);
 
 	return true;
 }
 
+bool CubeMapTexture::saveToCompiledFile(std::string_view path)
+{
+	if (!checkIsCreated())
+		return false;
+
+	if (_format != Format::rgb && _format != Format::rgba)
+	{
+		logger::error("Cannot compile cubemap texture with unsupported format.");
+		return false;
+	}
+
+	// Faces that were never uploaded would be read back as undefined data //
+	if (!_complete)
+	{
+		logger::error("Cannot compile cubemap texture with missing or mismatched faces.");
+		return false;
+	}
+
+	bind();
+
+	const GLint maxLevel = gl::backend().getTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL);
+	const GLint minFilter = gl::backend().getTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER);
+
+	CompiledCubeMapHeader header;
+	header.width = std::uint32_t(_width);
+	header.height = std::uint32_t(_height);
+	header.format = std::uint32_t(_format);
+	header.levels = 1;
+
+	// Only store the mip chain when the texture actually samples from it //
+	if (minFilter != GL_LINEAR && minFilter != GL_NEAREST)
+	{
+		const GLsizei maxSize = std::max(_width, _height);
+		while ((maxSize >> header.levels) > 0 && GLint(header.levels) <= maxLevel)
+			++header.levels;
+	}
+
+	std::ofstream file(std::string(path), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		logger::error("Cannot write compiled cubemap texture file {}.", path);
+		return false;
+	}
+
+	io::write_obj(file, &header);
+
+	gl::backend().pixelStorei(GL_PACK_ALIGNMENT, 1);
+
+	std::vector<std::uint8_t> buffer;
+	for (GLint level = 0; level < GLint(header.levels); ++level)
+	{
+		buffer.resize(getCubeMapLevelSize(_width, _height, _format, level));
+
+		for (std::size_t i = 0; i < FacesCount; ++i)
+		{
+			gl::backend().getTexImage(static_cast<GLenum>(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i), level, static_cast<GLenum>(_format), GL_UNSIGNED_BYTE, buffer.data());
+			io::write_bin(file, buffer.data(), buffer.size());
+		}
+	}
+
+	gl::backend().pixelStorei(GL_PACK_ALIGNMENT, 4);
+
+	return bool(file);
+}
+
 bool CubeMapTexture::loadFromJson(std::string_view path, std::string_view directoryPath)
 {
 	try
@@ -162,14 +447,31 @@ bool CubeMapTexture::loadFromJson(const JsonValue& json, std::string_view direct
 	try
 	{
 		const auto directory = Path(directoryPath);
-		return loadFromImage({
+		const FacesFiles files = {
 			extractPathFromJson(json, "front", directory),
 			extractPathFromJson(json, "back", directory),
 			extractPathFromJson(json, "left", directory),
 			extractPathFromJson(json, "right", directory),
 			extractPathFromJson(json, "top", directory),
 			extractPathFromJson(json, "bottom", directory)
-		});
+		};
+
+		const bool mipmaps = json.contains("mipmaps") && json.at("mipmaps").is_boolean() && json.at("mipmaps").get<bool>();
+
+		if (!json.contains("compiled"))
+			return loadFromImage(files, mipmaps);
+
+		const Path compiledPath = Path(extractPathFromJson(json, "compiled", directory));
+		if (isCompiledFileUpToDate(compiledPath, files) && loadFromCompiledFile(compiledPath.string()))
+			return true;
+
+		if (!loadFromImage(files, mipmaps))
+			return false;
+
+		if (!saveToCompiledFile(compiledPath.string()))
+			logger::warn("Cannot store compiled cubemap texture on {}.", compiledPath.string());
+
+		return true;
 	}
 	catch (const std::exception& ex)
 	{
@@ -181,13 +483,23 @@ bool CubeMapTexture::loadFromJson(const JsonValue& json, std::string_view direct
 void CubeMapTexture::destroy()
 {
 	if (isCreated())
-		glDeleteTextures(1, &_id);
+		gl::backend().deleteTexture(_id);
 
 	_id = 0;
 	_width = 0;
 	_height = 0;
 	_format = Format(0);
 	_files = {};
+	_complete = false;
+}
+
+void CubeMapTexture::setFilters(bool mipmaps)
+{
+	gl::backend().texParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+	gl::backend().texParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	gl::backend().texParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	gl::backend().texParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	gl::backend().texParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 }
 
 std::string CubeMapTexture::extractPathFromJson(const JsonValue& json, const std::string& filename, const Path& directory)
@@ -204,6 +516,32 @@ std::string CubeMapTexture::extractPathFromJson(const JsonValue& json, const std
 }
 
 
+bool CubeMapTexture::isCompiledFileUpToDate(const Path& compiledPath, const FacesFiles& filenames)
+{
+	namespace fs = std::filesystem;
+
+	std::error_code ec;
+	if (!fs::is_regular_file(compiledPath, ec))
+		return false;
+
+	const auto compiledTime = fs::last_write_time(compiledPath, ec);
+	if (ec)
+		return false;
+
+	for (std::size_t i = 0; i < FacesCount; ++i)
+	{
+		if (filenames[i].empty())
+			continue;
+
+		const auto faceTime = fs::last_write_time(Path(filenames[i]), ec);
+		if (ec || faceTime > compiledTime)
+			return false;
+	}
+
+	return true;
+}
+
+
 
 
 CubeMapTextureManager CubeMapTextureManager::Root = CubeMapTextureManager(nullptr);
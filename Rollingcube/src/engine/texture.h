@@ -2,8 +2,11 @@
 
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "core/gl.h"
+#include "core/gl_backend.h"
+#include "core/frame_stats.h"
 #include "utils/image.h"
 #include "utils/manager.h"
 #include "utils/json.h"
@@ -25,6 +28,8 @@ enum class TextureFormat : GLenum
 	depth_component = GL_DEPTH_COMPONENT
 };
 
+class TextureManager;
+
 class Texture
 {
 public:
@@ -72,21 +77,21 @@ public:
 	constexpr bool hasFile() const { return !_file.empty(); }
 	constexpr std::string_view getFilePath() const { return _file; }
 
-	inline void bind() { glBindTexture(GL_TEXTURE_2D, _id); }
-	inline void unbind() { glBindTexture(GL_TEXTURE_2D, 0); }
+	inline void bind() { gl::backend().bindTexture(GL_TEXTURE_2D, _id); FrameStats::instance().add(FrameCounter::TextureBinds); }
+	inline void unbind() { gl::backend().bindTexture(GL_TEXTURE_2D, 0); }
 
-	inline void activate(GLint textureUnit = 0) { if(checkIsCreated()) glActiveTexture(GL_TEXTURE0 + textureUnit), bind(); }
+	inline void activate(GLint textureUnit = 0) { if(checkIsCreated()) gl::backend().activeTexture(GL_TEXTURE0 + textureUnit), bind(); }
 
-	inline void setFilter(MagnificationFilter filter) { if (checkIsCreated()) glTextureParameteri(_id, GL_TEXTURE_MAG_FILTER, GLint(filter)); }
-	inline void setFilter(MinificationFilter filter) { if (checkIsCreated()) glTextureParameteri(_id, GL_TEXTURE_MIN_FILTER, GLint(filter)); }
+	inline void setFilter(MagnificationFilter filter) { if (checkIsCreated()) gl::backend().textureParameteri(_id, GL_TEXTURE_MAG_FILTER, GLint(filter)); }
+	inline void setFilter(MinificationFilter filter) { if (checkIsCreated()) gl::backend().textureParameteri(_id, GL_TEXTURE_MIN_FILTER, GLint(filter)); }
 
 	inline void setRepeat(bool repeat)
 	{
 		if (checkIsCreated())
 		{
 			GLint param = repeat ? GL_REPEAT : GL_CLAMP_TO_EDGE;
-			glTextureParameteri(_id, GL_TEXTURE_WRAP_S, param);
-			glTextureParameteri(_id, GL_TEXTURE_WRAP_T, param);
+			gl::backend().textureParameteri(_id, GL_TEXTURE_WRAP_S, param);
+			gl::backend().textureParameteri(_id, GL_TEXTURE_WRAP_T, param);
 		}
 	}
 
@@ -97,6 +102,10 @@ public:
 
 	bool createFromData(const unsigned char* data, SizeType width, SizeType height, Format format, bool generateMipmaps = false);
 
+	bool createFromImage(const Image& image, bool generateMipmaps = true);
+
+	bool updateData(const unsigned char* data, SizeType x, SizeType y, SizeType width, SizeType height);
+
 	bool loadFromImage(std::string_view filename, bool generateMipmaps = true);
 
 	bool resize(SizeType width, SizeType height, bool generateMipmaps = false);
@@ -106,7 +115,7 @@ public:
 public:
 	static GLint getNumTextureImageUnits();
 
-	static inline void deactivate(GLint textureUnit = 0) { glActiveTexture(GL_TEXTURE0 + textureUnit), glBindTexture(GL_TEXTURE_2D, 0); }
+	static inline void deactivate(GLint textureUnit = 0) { gl::backend().activeTexture(GL_TEXTURE0 + textureUnit), gl::backend().bindTexture(GL_TEXTURE_2D, 0); }
 
 private:
 	inline bool checkIsCreated()
@@ -118,6 +127,9 @@ private:
 		}
 		return true;
 	}
+
+public:
+	friend TextureManager;
 };
 
 
@@ -169,6 +181,8 @@ public:
 		return ref;
 	}
 
+	std::vector<Reference> loadFromImages(const std::vector<std::pair<IdType, std::string>>& files, bool generateMipmaps = true);
+
 private:
 	inline explicit TextureManager(Manager<Texture>* parent) :
 		Manager(parent)
@@ -285,6 +299,7 @@ private:
 	SizeType _height = 0;
 	Format _format = Format(0);
 	FacesFiles _files;
+	bool _complete = false; // Every face loaded, with the same size and format
 
 public:
 	CubeMapTexture() = default;
@@ -292,12 +307,14 @@ public:
 	CubeMapTexture& operator= (const CubeMapTexture&) = delete;
 
 	inline CubeMapTexture(CubeMapTexture&& right) noexcept :
-		_id(right._id), _width(right._width), _height(right._height), _format(right._format), _files(std::move(right._files))
+		_id(right._id), _width(right._width), _height(right._height), _format(right._format), _files(std::move(right._files)),
+		_complete(right._complete)
 	{
 		right._id = 0;
 		right._width = 0;
 		right._height = 0;
 		right._format = Format(0);
+		right._complete = false;
 	}
 
 	CubeMapTexture& operator= (CubeMapTexture&& right) noexcept
@@ -313,38 +330,42 @@ public:
 	constexpr Id getId() const { return _id; }
 	constexpr SizeType getWidth() const { return _width; }
 	constexpr SizeType getHeight() const { return _height; }
+	constexpr bool isComplete() const { return _complete; }
 	constexpr bool hasFile(std::size_t faceIdx) const { return !_files[faceIdx].empty(); }
 	constexpr std::string_view getFilePath(std::size_t faceIdx) const { return _files[faceIdx]; }
 
-	inline void bind() { glBindTexture(GL_TEXTURE_CUBE_MAP, _id); }
-	inline void unbind() { glBindTexture(GL_TEXTURE_CUBE_MAP, 0); }
+	inline void bind() { gl::backend().bindTexture(GL_TEXTURE_CUBE_MAP, _id); FrameStats::instance().add(FrameCounter::TextureBinds); }
+	inline void unbind() { gl::backend().bindTexture(GL_TEXTURE_CUBE_MAP, 0); }
 
-	inline void activate(GLint textureUnit = 0) { if (checkIsCreated()) glActiveTexture(GL_TEXTURE0 + textureUnit), bind(); }
+	inline void activate(GLint textureUnit = 0) { if (checkIsCreated()) gl::backend().activeTexture(GL_TEXTURE0 + textureUnit), bind(); }
 
-	inline void setFilter(MagnificationFilter filter) { if (checkIsCreated()) glTextureParameteri(_id, GL_TEXTURE_MAG_FILTER, GLint(filter)); }
-	inline void setFilter(MinificationFilter filter) { if (checkIsCreated()) glTextureParameteri(_id, GL_TEXTURE_MIN_FILTER, GLint(filter)); }
+	inline void setFilter(MagnificationFilter filter) { if (checkIsCreated()) gl::backend().textureParameteri(_id, GL_TEXTURE_MAG_FILTER, GLint(filter)); }
+	inline void setFilter(MinificationFilter filter) { if (checkIsCreated()) gl::backend().textureParameteri(_id, GL_TEXTURE_MIN_FILTER, GLint(filter)); }
 
 	inline void setRepeat(bool repeat)
 	{
 		if (checkIsCreated())
 		{
 			GLint param = repeat ? GL_REPEAT : GL_CLAMP_TO_EDGE;
-			glTextureParameteri(_id, GL_TEXTURE_WRAP_S, param);
-			glTextureParameteri(_id, GL_TEXTURE_WRAP_T, param);
-			glTextureParameteri(_id, GL_TEXTURE_WRAP_R, param);
+			gl::backend().textureParameteri(_id, GL_TEXTURE_WRAP_S, param);
+			gl::backend().textureParameteri(_id, GL_TEXTURE_WRAP_T, param);
+			gl::backend().textureParameteri(_id, GL_TEXTURE_WRAP_R, param);
 		}
 	}
 
 public:
-	bool loadFromImage(const FacesFiles& filenames);
+	bool loadFromImage(const FacesFiles& filenames, bool generateMipmaps = false);
 
 	bool loadFromJson(std::string_view path, std::string_view directoryPath = "");
 	bool loadFromJson(const JsonValue& json, std::string_view directoryPath = "");
 
+	bool loadFromCompiledFile(std::string_view path);
+	bool saveToCompiledFile(std::string_view path);
+
 	void destroy();
 
 public:
-	static inline void deactivate(GLint textureUnit = 0) { glActiveTexture(GL_TEXTURE0 + textureUnit), glBindTexture(GL_TEXTURE_2D, 0); }
+	static inline void deactivate(GLint textureUnit = 0) { gl::backend().activeTexture(GL_TEXTURE0 + textureUnit), gl::backend().bindTexture(GL_TEXTURE_2D, 0); }
 
 private:
 	inline bool checkIsCreated()
@@ -357,7 +378,11 @@ private:
 		return true;
 	}
 
+	void setFilters(bool mipmaps);
+
 	static std::string extractPathFromJson(const JsonValue& json, const std::string& filename, const Path& directory);
+
+	static bool isCompiledFileUpToDate(const Path& compiledPath, const FacesFiles& filenames);
 };
 
 
@@ -374,13 +399,13 @@ public:
 
 	inline Reference create(const IdType& id) { return emplace(id); }
 
-	inline Reference loadFromImage(const IdType& id, const CubeMapTexture::FacesFiles& filenames)
+	inline Reference loadFromImage(const IdType& id, const CubeMapTexture::FacesFiles& filenames, bool generateMipmaps = false)
 	{
 		Reference ref = create(id);
 		if (!ref)
 			return nullptr;
 
-		if (!ref->loadFromImage(filenames))
+		if (!ref->loadFromImage(filenames, generateMipmaps))
 			return destroy(id), nullptr;
 
 		return ref;
@@ -428,6 +453,18 @@ public:
 		return ref;
 	}
 
+	inline Reference loadFromCompiledFile(const IdType& id, std::string_view filepath)
+	{
+		Reference ref = create(id);
+		if (!ref)
+			return nullptr;
+
+		if (!ref->loadFromCompiledFile(filepath))
+			return destroy(id), nullptr;
+
+		return ref;
+	}
+
 private:
 	inline explicit CubeMapTextureManager(Manager<CubeMapTexture>* parent) :
 		Manager(parent)
@@ -0,0 +1,83 @@
+#include "transform_interpolator.h"
+
+#include "core/job_system.h"
+#include "core/profiler.h"
+
+
+namespace
+{
+	// Euler angles are kept in (-360, 360), so a turn over the range limit must not spin backwards //
+	static glm::vec3 lerpAngles(const glm::vec3& from, const glm::vec3& to, float alpha)
+	{
+		const glm::vec3 delta = glm::mod(to - from + 180.f, 360.f) - 180.f;
+		return from + delta * alpha;
+	}
+}
+
+bool TransformTickState::apply(Transformable& transform, float alpha)
+{
+	if (_version == Unrecorded || transform.getChangeVersion() == _version)
+		return false;
+
+	_current = transform.takeSnapshot();
+	_applied = true;
+
+	transform.showPose(
+		glm::mix(_position, _current.position, alpha),
+		lerpAngles(_rotation, _current.rotation, alpha),
+		glm::mix(_scale, _current.scale, alpha)
+	);
+	return true;
+}
+
+void TransformTickState::restore(Transformable& transform)
+{
+	if (!_applied)
+		return;
+
+	transform.restoreSnapshot(_current);
+	_applied = false;
+}
+
+
+
+
+void TransformInterpolator::record()
+{
+	PROFILE_SCOPE("TransformInterpolator::record");
+
+	JobSystem::instance().parallelFor(_entries.size(), BatchSize, [this](std::size_t begin, std::size_t end) {
+		for (std::size_t i = begin; i < end; ++i)
+			_entries[i].state->record(*_entries[i].transform);
+	});
+
+	_entries.clear();
+}
+
+void TransformInterpolator::apply(float alpha)
+{
+	PROFILE_SCOPE("TransformInterpolator::apply");
+
+	JobSystem::instance().parallelFor(_entries.size(), BatchSize, [this, alpha](std::size_t begin, std::size_t end) {
+		for (std::size_t i = begin; i < end; ++i)
+			_entries[i].state->apply(*_entries[i].transform, alpha);
+	});
+
+	_applied = true;
+}
+
+void TransformInterpolator::restore()
+{
+	PROFILE_SCOPE("TransformInterpolator::restore");
+
+	if (_applied)
+	{
+		JobSystem::instance().parallelFor(_entries.size(), BatchSize, [this](std::size_t begin, std::size_t end) {
+			for (std::size_t i = begin; i < end; ++i)
+				_entries[i].state->restore(*_entries[i].transform);
+		});
+	}
+
+	_applied = false;
+	_entries.clear();
+}
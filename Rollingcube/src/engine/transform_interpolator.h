@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vector>
+
+#include "basics.h"
+
+
+// The transform an entity started the last simulation tick with, kept next to the entity itself //
+class TransformTickState
+{
+private:
+	static constexpr VersionFlag Unrecorded = VersionFlag(~VersionFlag::IntegerType(0));
+
+private:
+	glm::vec3 _position = { 0, 0, 0 };
+	glm::vec3 _rotation = { 0, 0, 0 };
+	glm::vec3 _scale = { 1, 1, 1 };
+	VersionFlag _version = Unrecorded;
+
+	// Current transform while an interpolated one is shown //
+	Transformable::Snapshot _current = {};
+	bool _applied = false;
+
+public:
+	TransformTickState() = default;
+	TransformTickState(const TransformTickState&) = default;
+	TransformTickState(TransformTickState&&) noexcept = default;
+	~TransformTickState() = default;
+
+	TransformTickState& operator= (const TransformTickState&) = default;
+	TransformTickState& operator= (TransformTickState&&) noexcept = default;
+
+public:
+	inline void record(const Transformable& transform)
+	{
+		// Unchanged since the last record, the stored values are still the same //
+		if (transform.getChangeVersion() == _version)
+			return;
+
+		_position = transform.getPosition();
+		_rotation = transform.getRotation();
+		_scale = transform.getScale();
+		_version = transform.getChangeVersion();
+	}
+
+	// Shows the transform alpha of the way from the recorded state to its current one, without counting as a
+	// change. False if it did not move, or if it was created during the last tick and has nothing to start from //
+	bool apply(Transformable& transform, float alpha);
+
+	void restore(Transformable& transform);
+};
+
+
+/*
+	Render interpolation for fixed step simulation. record() is called before every tick, apply() before rendering
+	places every transform that moved during the last tick between both ticks, and restore() puts the simulated
+	transforms back afterwards. Neither changes the transform versions, so entities that keep still between ticks
+	do not get their matrices and derived state rebuilt every frame; derived transforms that cache by their
+	parent version (block sides) are gathered with their own state. Transforms are gathered each time, like
+	TransformUpdater does, since ticks may create and remove entities.
+*/
+class TransformInterpolator
+{
+public:
+	static constexpr std::size_t BatchSize = 256;
+
+private:
+	struct Entry
+	{
+		Transformable* transform;
+		TransformTickState* state;
+	};
+
+private:
+	std::vector<Entry> _entries;
+	bool _applied = false;
+
+public:
+	TransformInterpolator() = default;
+	TransformInterpolator(const TransformInterpolator&) = delete;
+	TransformInterpolator(TransformInterpolator&&) noexcept = default;
+	~TransformInterpolator() = default;
+
+	TransformInterpolator& operator= (const TransformInterpolator&) = delete;
+	TransformInterpolator& operator= (TransformInterpolator&&) noexcept = default;
+
+public:
+	// Both must stay alive until the queue is consumed //
+	inline void add(Transformable& transform, TransformTickState& state) { _entries.push_back({ &transform, &state }); }
+
+	// Consumes the queue //
+	void record();
+
+	// Keeps the queue for restore(). The moved transforms get their matrices rebuilt, as TransformUpdater would //
+	void apply(float alpha);
+
+	// Consumes the queue //
+	void restore();
+};
@@ -0,0 +1,20 @@
+#include "transform_updater.h"
+
+#include "core/job_system.h"
+#include "core/profiler.h"
+#include "core/frame_stats.h"
+
+
+void TransformUpdater::update()
+{
+	PROFILE_SCOPE("TransformUpdater::update");
+
+	FrameStats::instance().add(FrameCounter::UpdatedTransforms, _stale.size());
+
+	JobSystem::instance().parallelFor(_stale.size(), BatchSize, [this](std::size_t begin, std::size_t end) {
+		for (std::size_t i = begin; i < end; ++i)
+			_stale[i]->updateMatrices();
+	});
+
+	_stale.clear();
+}
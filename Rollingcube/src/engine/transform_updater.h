@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+
+#include "basics.h"
+
+
+/*
+	Explicit transform update phase. Transformables whose cached matrices are older than their change version are
+	gathered on the main thread, then update() rebuilds the model, inverted model and normal matrices of all of them
+	in parallel batches. Afterwards the matrix getters only read, so render and culling jobs can share them.
+*/
+class TransformUpdater
+{
+public:
+	static constexpr std::size_t BatchSize = 256;
+
+private:
+	std::vector<const Transformable*> _stale;
+
+public:
+	TransformUpdater() = default;
+	TransformUpdater(const TransformUpdater&) = delete;
+	TransformUpdater(TransformUpdater&&) noexcept = default;
+	~TransformUpdater() = default;
+
+	TransformUpdater& operator= (const TransformUpdater&) = delete;
+	TransformUpdater& operator= (TransformUpdater&&) noexcept = default;
+
+public:
+	// Only queued when stale, must stay alive until update() //
+	inline void add(const Transformable& transform)
+	{
+		if (transform.hasStaleMatrices())
+			_stale.push_back(&transform);
+	}
+
+	inline std::size_t getPendingCount() const { return _stale.size(); }
+
+	// Rebuilds every queued transform and clears the queue //
+	void update();
+};
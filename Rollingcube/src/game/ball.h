@@ -24,11 +24,11 @@ public:
 	using ConstRef = ConstReference<BallTemplate>;
 
 public:
-	static constexpr std::string_view FunctionOnConstruct = "OnConstruct";
-	static constexpr std::string_view FunctionOnRender = "OnRender";
-	static constexpr std::string_view FunctionOnUpdate = "OnUpdate";
-	static constexpr std::string_view FunctionOnLevelPostUpdate = "OnLevelPostUpdate";
-	static constexpr std::string_view FunctionOnCollide = "OnCollide";
+	static constexpr LuaHookFunction FunctionOnConstruct = { "OnConstruct", LuaHook::OnConstruct };
+	static constexpr LuaHookFunction FunctionOnRender = { "OnRender", LuaHook::OnRender };
+	static constexpr LuaHookFunction FunctionOnUpdate = { "OnUpdate", LuaHook::OnUpdate };
+	static constexpr LuaHookFunction FunctionOnLevelPostUpdate = { "OnLevelPostUpdate", LuaHook::OnLevelPostUpdate };
+	static constexpr LuaHookFunction FunctionOnCollide = { "OnCollide", LuaHook::OnCollide };
 //	static constexpr std::string_view FunctionGetIsLandingOnSide = "GetIsLandingOnSide";
 
 public:
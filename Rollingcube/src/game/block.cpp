@@ -1,6 +1,9 @@
 #include "block.h"
 
-#include "core/parallel.h"
+#include "core/job_system.h"
+#include "engine/lua/state_pool.h"
+#include "core/profiler.h"
+#include "core/frame_stats.h"
 #include "engine/lua/module.h"
 #include "utils/lualib_constants.h"
 
@@ -101,14 +104,35 @@ void Block::defaultRender(const Camera& cam)
 }
 
 void Block::update(Time elapsedTime)
+{
+	updateScripts(elapsedTime);
+	updateTransforms(elapsedTime);
+}
+
+void Block::updateScripts(Time elapsedTime)
 {
 	if (_template)
-		_template->onUpdate(*this, elapsedTime);
+	{
+		if (_template->isParallelSafe())
+		{
+			// Outside of the container pass there is nowhere to defer to //
+			BlockCommandBuffer commands;
+			BlockUpdateContext context(*this, commands);
+			_template->onParallelUpdate(BlockTemplate::MainState, context, elapsedTime);
+			if (!commands.empty())
+				logger::warn("Dropped {} commands of block {}, it is not updated through its container.", commands.size(), _blockId);
+		}
+		else
+			_template->onUpdate(*this, elapsedTime);
+	}
 
+	updateSideScripts(elapsedTime);
+}
+
+void Block::updateSideScripts(Time elapsedTime)
+{
 	for (int i = 0; i < _sides.size(); ++i)
 		_sides[i].update(elapsedTime);
-
-	ModelableEntity::update(elapsedTime);
 }
 
 
@@ -237,6 +261,9 @@ bool BlockContainer::removeBlock(const Slot& slot)
 	block->_nextBlock.reset();
 	block->_prevBlock.reset();
 
+	// Its tasks would resume on a freed block otherwise //
+	LuaTaskScheduler::instance().cancelOwnedBy(block.get());
+
 	Block::Id id = block->getBlockId();
 	if (id != 0)
 	{
@@ -271,49 +298,215 @@ Reference<Block::Side> BlockContainer::getBlockSideBySideId(Block::Side::Id side
 
 void BlockContainer::render(const Camera& cam)
 {
-	const bool enabledTransparentList = _transparentRenderList != nullptr;
+	static constexpr std::size_t CullingGrainSize = 128;
+
+	PROFILE_SCOPE("BlockContainer::render");
+
+	_jobBlocks.clear();
 	for (std::shared_ptr<Block> block = _first; block != nullptr; block = block->_nextBlock)
+		_jobBlocks.push_back(block.get());
+
+	// The frustum is built lazily, so before the jobs share the camera //
+	cam.getFrustum();
+
+	_jobVisibility.resize(_jobBlocks.size());
+	{
+		PROFILE_SCOPE("BlockContainer::render::culling");
+		JobSystem::instance().parallelFor(_jobBlocks.size(), CullingGrainSize, [this, &cam](std::size_t begin, std::size_t end) {
+			for (std::size_t i = begin; i < end; ++i)
+				_jobVisibility[i] = _jobBlocks[i]->isVisibleInCamera(cam) ? 1 : 0;
+		});
+	}
+
+	const bool enabledTransparentList = _transparentRenderList != nullptr;
+	std::uint64_t visible = 0, culled = 0;
+	for (std::size_t i = 0; i < _jobBlocks.size(); ++i)
 	{
-		if (block->isVisibleInCamera(cam))
+		Block* block = _jobBlocks[i];
+		if (_jobVisibility[i] != 0)
 		{
+			++visible;
 			if (!block->hasTransparency() || !enabledTransparentList)
 				block->render(cam);
 			else
 				_transparentRenderList->addEntity(block, cam.getDistanceTo(block->getPosition()));
 		}
+		else
+			++culled;
 	}
+
+	auto& stats = FrameStats::instance();
+	stats.add(FrameCounter::VisibleBlocks, visible);
+	stats.add(FrameCounter::CulledBlocks, culled);
 }
 
 void BlockContainer::update(Time elapsedTime)
 {
-/*#ifdef PARALLEL_ENABLED
-	std::shared_ptr<Block> currentBlock = _first;
-	std::shared_ptr<Block> block = nullptr;
-	bool end = false;
+	static constexpr std::size_t UpdateGrainSize = 64;
+
+	PROFILE_SCOPE("BlockContainer::update");
 
-	#pragma omp parallel firstprivate(block, elapsedTime, end) shared(currentBlock)
-	while (!end)
+	const std::size_t workerCount = LuaStatePool::instance().size();
+	_workerBlocks.resize(workerCount);
+	_workerCommands.resize(workerCount);
+	for (auto& blocks : _workerBlocks)
+		blocks.clear();
+
+	// Serial scripts first, in list order on this thread //
+	for (std::shared_ptr<Block> block = _first; block != nullptr; block = block->_nextBlock)
 	{
-		#pragma omp critical
+		auto templ = block->getTemplate();
+		if (templ && templ->isParallelSafe())
 		{
-			if (currentBlock == nullptr)
-				end;
+			if (templ->getWorkerCount() > 0)
+				_workerBlocks[block->getBlockId() % templ->getWorkerCount()].push_back(block.get());
 			else
 			{
-				block = currentBlock;
-				currentBlock = currentBlock->_nextBlock;
+				BlockUpdateContext context(*block, _mainCommands);
+				templ->onParallelUpdate(BlockTemplate::MainState, context, elapsedTime);
 			}
+
+			block->updateSideScripts(elapsedTime);
 		}
+		else
+			block->updateScripts(elapsedTime);
+	}
 
-		if(!end)
-			block->update(elapsedTime);
+	{
+		PROFILE_SCOPE("BlockContainer::update::parallelScripts");
+		JobSystem::instance().parallelFor(workerCount, 1, [this, elapsedTime](std::size_t begin, std::size_t end) {
+			for (std::size_t worker = begin; worker < end; ++worker)
+			{
+				if (_workerBlocks[worker].empty())
+					continue;
+
+				LuaStateScope scope(LuaStatePool::instance().get(worker).get());
+				for (Block* block : _workerBlocks[worker])
+				{
+					BlockUpdateContext context(*block, _workerCommands[worker]);
+					block->getTemplate()->onParallelUpdate(worker, context, elapsedTime);
+				}
+			}
+		});
 	}
 
-#else*/
+	// Structural changes, in worker order so the result does not depend on the scheduling //
+	_mainCommands.apply(*this);
+	for (auto& commands : _workerCommands)
+		commands.apply(*this);
+
+	_jobBlocks.clear();
 	for (std::shared_ptr<Block> block = _first; block != nullptr; block = block->_nextBlock)
-		block->update(elapsedTime);
-//#endif
-}				
+		_jobBlocks.push_back(block.get());
+
+	PROFILE_SCOPE("BlockContainer::update::transforms");
+	JobSystem::instance().parallelFor(_jobBlocks.size(), UpdateGrainSize, [this, elapsedTime](std::size_t begin, std::size_t end) {
+		for (std::size_t i = begin; i < end; ++i)
+			_jobBlocks[i]->updateTransforms(elapsedTime);
+	});
+}
+
+void BlockTemplate::prepareWorkerState()
+{
+	// Outside of any Lua call, so library errors need a protected call //
+	lua_State* state = lua::state();
+	lua_pushcfunction(state, [](lua_State*) -> int {
+		LuaLibraryManager::instance().get(::lua::lib::names::blockUpdate)->build();
+		return 0;
+	});
+
+	if (!lua::utils::catchError(lua_pcall(state, 0, 0, 0)))
+		lua::utils::pop();
+}
+
+
+
+
+void BlockCommandBuffer::apply(BlockContainer& container)
+{
+	for (const Command& command : _commands)
+	{
+		switch (command.type)
+		{
+			case Type::CreateBlock:
+				if (container.createBlock(command.slot, command.name) == nullptr)
+					logger::warn("Deferred creation of block {} at ({}, {}, {}) failed.", command.name, command.slot.x, command.slot.y, command.slot.z);
+				break;
+
+			case Type::RemoveBlock:
+				container.removeBlock(command.slot);
+				break;
+
+			case Type::SetLocalValue:
+				if (auto block = container.getBlockById(command.blockId))
+					block->setLocalValue(command.name, toLuaRef(command.value));
+				break;
+
+			case Type::CallOnMain:
+				if (auto block = container.getBlockById(command.blockId); block != nullptr && block->getTemplate())
+				{
+					if (!block->getTemplate()->onCommand(*block, command.name, toLuaRef(command.value)))
+						logger::warn("callOnMain: block template {} has no function {}.", block->getTemplate()->getName(), command.name);
+				}
+				break;
+		}
+	}
+
+	_commands.clear();
+}
+
+BlockCommandBuffer::Value BlockCommandBuffer::toValue(const LuaRef& ref)
+{
+	if (ref.isBool())
+		return ref.cast<bool>().value();
+	if (ref.isNumber())
+		return ref.cast<double>().value();
+	if (ref.isString())
+		return ref.cast<std::string>().value();
+
+	if (!ref.isNil())
+		lua::utils::error("Only nil, booleans, numbers and strings can leave a parallel hook.");
+	return {};
+}
+
+LuaRef BlockCommandBuffer::toLuaRef(const Value& value)
+{
+	return std::visit([](const auto& v) -> LuaRef {
+		if constexpr (std::same_as<std::decay_t<decltype(v)>, std::monostate>)
+			return LuaRef(lua::state());
+		else
+			return LuaRef(lua::state(), v);
+	}, value);
+}
+
+
+
+
+void BlockContainer::gatherTransforms(TransformUpdater& updater) const
+{
+	for (std::shared_ptr<Block> block = _first; block != nullptr; block = block->_nextBlock)
+	{
+		updater.add(*block);
+		for (const auto& side : block->_sides)
+			updater.add(side.getTransform());
+	}
+}
+
+void BlockContainer::gatherTransforms(TransformInterpolator& interpolator)
+{
+	for (std::shared_ptr<Block> block = _first; block != nullptr; block = block->_nextBlock)
+	{
+		interpolator.add(*block, block->_tickState);
+
+		// Sides follow the parent version, which interpolation leaves alone, so they are interpolated themselves.
+		// getTransform brings them up to the simulated parent first //
+		for (auto& side : block->_sides)
+		{
+			side.getTransform();
+			interpolator.add(side._transform, side._tickState);
+		}
+	}
+}
 
 
 
@@ -338,12 +531,22 @@ namespace lua::lib
 {
 	namespace LUA_blocks { static defineLuaLibraryConstructor(registerToLua, root, state); }
 
+	namespace LUA_blocks::LUA_blockUpdateContext { static defineLuaLibraryConstructor(registerToLua, root, state); }
+
 	void registerBlocksLibToLua()
 	{
+		// Parallel hooks only get the update context, the rest of the blocks library stays on the main state //
+		LuaLibraryManager::instance().registerLibrary(
+			::lua::lib::names::blockUpdate,
+			&LUA_blocks::LUA_blockUpdateContext::registerToLua,
+			{ ::lua::lib::names::geometry },
+			true
+		);
+
 		LuaLibraryManager::instance().registerLibrary(
 			::lua::lib::names::blocks,
 			&LUA_blocks::registerToLua,
-			{::lua::lib::names::themes }
+			{::lua::lib::names::themes, ::lua::lib::names::blockUpdate }
 		);
 	}
 }
@@ -430,6 +633,84 @@ namespace lua::lib::LUA_blocks
 
 
 
+	namespace LUA_blockUpdateContext
+	{
+		static unsigned int checkSideId(unsigned int sideId)
+		{
+			if (sideId >= cubes::side::count)
+			{
+				lua::utils::error("Invalid block side id {}.", sideId);
+				return 0;
+			}
+			return sideId;
+		}
+
+		static Block::Slot toSlot(int x, int y, int z) { return { x, y, z }; }
+
+
+		static Block::Id getBlockId(const BlockUpdateContext* self) { return self->getBlockId(); }
+
+		static glm::vec3 getSlot(const BlockUpdateContext* self) { return self->getSlot(); }
+
+		static const glm::vec3& getPosition(const BlockUpdateContext* self) { return self->getPosition(); }
+		static void setPosition(BlockUpdateContext* self, const glm::vec3& position) { self->setPosition(position); }
+
+		static const glm::vec3& getRotation(const BlockUpdateContext* self) { return self->getRotation(); }
+		static void setRotation(BlockUpdateContext* self, const glm::vec3& rotation) { self->setRotation(rotation); }
+
+		static const glm::vec3& getScale(const BlockUpdateContext* self) { return self->getScale(); }
+		static void setScale(BlockUpdateContext* self, const glm::vec3& scale) { self->setScale(scale); }
+
+
+		static glm::vec3 getSidePosition(const BlockUpdateContext* self, unsigned int sideId) { return self->getSidePosition(checkSideId(sideId)); }
+
+		static glm::vec3 getSideNormal(const BlockUpdateContext* self, unsigned int sideId) { return self->getSideNormal(checkSideId(sideId)); }
+
+		static void createBlock(BlockUpdateContext* self, int x, int y, int z, const std::string& templateName)
+		{
+			self->getCommands().createBlock(toSlot(x, y, z), templateName);
+		}
+
+		static void removeBlock(BlockUpdateContext* self) { self->getCommands().removeBlock(self->getBlock().getBlockSlot()); }
+
+		static void removeBlockAt(BlockUpdateContext* self, int x, int y, int z) { self->getCommands().removeBlock(toSlot(x, y, z)); }
+
+		static void setLocalValue(BlockUpdateContext* self, const std::string& name, LuaRef value)
+		{
+			self->getCommands().setLocalValue(self->getBlockId(), name, BlockCommandBuffer::toValue(value));
+		}
+
+		static void callOnMain(BlockUpdateContext* self, const std::string& function, LuaRef value)
+		{
+			self->getCommands().callOnMain(self->getBlockId(), function, BlockCommandBuffer::toValue(value));
+		}
+
+
+		static defineLuaLibraryConstructor(registerToLua, root, state)
+		{
+			root = root.beginClass<BlockUpdateContext>("BlockUpdateContext")
+				// Fields //
+				.addProperty("blockId", &getBlockId)
+				.addProperty("slot", &getSlot)
+				.addProperty("position", &getPosition, &setPosition)
+				.addProperty("rotationAngles", &getRotation, &setRotation)
+				.addProperty("scalation", &getScale, &setScale)
+				// Methods //
+				.addFunction("getSidePosition", &getSidePosition)
+				.addFunction("getSideNormal", &getSideNormal)
+				.addFunction("createBlock", &createBlock)
+				.addFunction("removeBlock", &removeBlock)
+				.addFunction("removeBlockAt", &removeBlockAt)
+				.addFunction("setLocalValue", &setLocalValue)
+				.addFunction("callOnMain", &callOnMain)
+			.endClass();
+
+			return true;
+		}
+	}
+
+
+
 	static defineLuaLibraryConstructor(registerToLua, root, state)
 	{
 		if (!LUA_blockSide::registerToLua(root, state))
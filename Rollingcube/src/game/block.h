@@ -2,8 +2,12 @@
 
 #include <array>
 #include <queue>
+#include <variant>
 
 #include "engine/entities.h"
+#include "engine/transform_updater.h"
+#include "engine/transform_interpolator.h"
+#include "engine/lua/task_scheduler.h"
 
 #include "cube_model.h"
 #include "luadefs.h"
@@ -41,6 +45,7 @@ class Block;
 class BlockSide;
 class BlocksNet;
 class BlockContainer;
+class BlockUpdateContext;
 class BlockContainerIterator;
 class ConstBlockContainerIterator;
 
@@ -51,13 +56,13 @@ public:
 	using ConstRef = ConstReference<BlockTemplate>;
 
 public:
-	static constexpr std::string_view FunctionOnRender = "OnRender";
-	static constexpr std::string_view FunctionOnRenderSide = "OnRenderSide";
-	static constexpr std::string_view FunctionOnUpdate = "OnUpdate";
-	static constexpr std::string_view FunctionOnUpdateSide = "OnUpdateSide";
+	static constexpr LuaHookFunction FunctionOnRender = { "OnRender", LuaHook::OnRender };
+	static constexpr LuaHookFunction FunctionOnRenderSide = { "OnRenderSide", LuaHook::OnRenderSide };
+	static constexpr LuaHookFunction FunctionOnUpdate = { "OnUpdate", LuaHook::OnUpdate };
+	static constexpr LuaHookFunction FunctionOnUpdateSide = { "OnUpdateSide", LuaHook::OnUpdateSide };
 
-	static constexpr std::string_view FunctionOnBlockConstruct = "OnBlockConstruct";
-	static constexpr std::string_view FunctionOnBlockSideConstruct = "OnBlockSideConstruct";
+	static constexpr LuaHookFunction FunctionOnBlockConstruct = { "OnBlockConstruct", LuaHook::OnBlockConstruct };
+	static constexpr LuaHookFunction FunctionOnBlockSideConstruct = { "OnBlockSideConstruct", LuaHook::OnBlockSideConstruct };
 
 public:
 	BlockTemplate() = default;
@@ -78,6 +83,15 @@ public:
 
 	void onBlockConstruct(Block& block);
 	void onBlockSideConstruct(BlockSide& side);
+
+	// Parallel safe templates only, OnUpdate receives a BlockUpdateContext on the given pool state //
+	void onParallelUpdate(std::size_t worker, BlockUpdateContext& context, Time elapsedTime);
+
+	// Deferred main state call recorded by a parallel hook. Fails when function is not a function of the template //
+	bool onCommand(Block& block, std::string_view function, const LuaRef& value);
+
+protected:
+	void prepareWorkerState() override;
 };
 
 
@@ -103,6 +117,7 @@ class BlockSide : public LocalValuesContainer, public Renderable, public Updatab
 {
 public:
 	friend Block;
+	friend BlockContainer;
 
 public:
 	using SideId = cubes::side::Id;
@@ -115,6 +130,7 @@ private:
 
 	mutable VersionFlag _updateVersion = {};
 	mutable Transformable _transform = {};
+	TransformTickState _tickState = {};
 
 public:
 	~BlockSide() = default;
@@ -283,6 +299,8 @@ private:
 	std::shared_ptr<Block> _nextBlock = nullptr;
 	std::shared_ptr<Block> _prevBlock = nullptr;
 
+	TransformTickState _tickState = {};
+
 public:
 	Block(const Block&) = delete;
 	Block(Block&&) noexcept = default;
@@ -301,6 +319,12 @@ public:
 
 	void update(Time elapsedTime) override;
 
+private:
+	// update() in two halves: the Lua hooks must run on the main thread, the rest only touches this block //
+	void updateScripts(Time elapsedTime);
+	void updateSideScripts(Time elapsedTime);
+	inline void updateTransforms(Time elapsedTime) { ModelableEntity::update(elapsedTime); }
+
 public:
 	constexpr Id getBlockId() const { return _blockId; }
 
@@ -346,16 +370,179 @@ inline BlockSide::Id BlockSide::getId() const { return (_parent->getBlockId() -
 
 inline BlockTemplate::Ref BlockSide::getTemplate() const { return _template ? _template : _parent->_template; }
 
-inline void BlockTemplate::onRender(Block& block, const Camera& cam) { vcall(FunctionOnRender, std::addressof(block), std::addressof(cam)); }
-inline void BlockTemplate::onRenderSide(BlockSide& side, const Camera& cam) { vcall(FunctionOnRenderSide, std::addressof(side), std::addressof(cam)); }
-inline void BlockTemplate::onUpdate(Block& block, Time elapsedTime) { vcall(FunctionOnUpdate, std::addressof(block), elapsedTime.toSeconds()); }
-inline void BlockTemplate::onUpdateSide(BlockSide& side, Time elapsedTime) { vcall(FunctionOnUpdateSide, std::addressof(side), elapsedTime.toSeconds()); }
+// Hooks get the raw block, so the tasks they spawn are owned by it and cancelled when it is removed //
+inline void BlockTemplate::onRender(Block& block, const Camera& cam)
+{
+	const LuaTaskScheduler::OwnerScope owner(std::addressof(block));
+	vcall(FunctionOnRender, std::addressof(block), std::addressof(cam));
+}
+
+inline void BlockTemplate::onRenderSide(BlockSide& side, const Camera& cam)
+{
+	const LuaTaskScheduler::OwnerScope owner(std::addressof(side.getParent()));
+	vcall(FunctionOnRenderSide, std::addressof(side), std::addressof(cam));
+}
+
+inline void BlockTemplate::onUpdate(Block& block, Time elapsedTime)
+{
+	const LuaTaskScheduler::OwnerScope owner(std::addressof(block));
+	vcall(FunctionOnUpdate, std::addressof(block), elapsedTime.toSeconds());
+}
+
+inline void BlockTemplate::onUpdateSide(BlockSide& side, Time elapsedTime)
+{
+	const LuaTaskScheduler::OwnerScope owner(std::addressof(side.getParent()));
+	vcall(FunctionOnUpdateSide, std::addressof(side), elapsedTime.toSeconds());
+}
+
+inline void BlockTemplate::onBlockConstruct(Block& block)
+{
+	const LuaTaskScheduler::OwnerScope owner(std::addressof(block));
+	vcall(FunctionOnBlockConstruct, std::addressof(block));
+}
+
+inline void BlockTemplate::onBlockSideConstruct(BlockSide& side)
+{
+	const LuaTaskScheduler::OwnerScope owner(std::addressof(side.getParent()));
+	vcall(FunctionOnBlockSideConstruct, std::addressof(side));
+}
+
+inline void BlockTemplate::onParallelUpdate(std::size_t worker, BlockUpdateContext& context, Time elapsedTime)
+{
+	vcallOnWorker(worker, FunctionOnUpdate, std::addressof(context), elapsedTime.toSeconds());
+}
+
+inline bool BlockTemplate::onCommand(Block& block, std::string_view function, const LuaRef& value)
+{
+	// The name comes from a script at runtime, only the template's own functions reach the profiler name table //
+	auto fn = findLuaObject(function);
+	if (fn == nullptr || !fn->isFunction())
+		return false;
+
+	const LuaTaskScheduler::OwnerScope owner(std::addressof(block));
+	vcall(LuaHookFunction{ Profiler::instance().intern(function), LuaHook::Other }, std::addressof(block), value);
+	return true;
+}
+
+
+
+
+
+
+
+/*
+	Side effects recorded by parallel safe block hooks. Worker states cannot touch the container, the main state or
+	another block, so structural changes and main state calls are queued here and applied on the main thread once the
+	parallel phase is over. Blocks are referenced by id, a block removed by an earlier command is skipped.
+*/
+class BlockCommandBuffer
+{
+public:
+	// The values that can cross from a worker state into the main state //
+	using Value = std::variant<std::monostate, bool, double, std::string>;
+
+	enum class Type
+	{
+		CreateBlock,
+		RemoveBlock,
+		SetLocalValue,
+		CallOnMain
+	};
+
+	struct Command
+	{
+		Type type;
+		Block::Id blockId = 0;
+		Block::Slot slot = {};
+		std::string name = {};
+		Value value = {};
+	};
+
+private:
+	std::vector<Command> _commands;
+
+public:
+	BlockCommandBuffer() = default;
+	BlockCommandBuffer(const BlockCommandBuffer&) = delete;
+	BlockCommandBuffer(BlockCommandBuffer&&) noexcept = default;
+	~BlockCommandBuffer() = default;
+
+	BlockCommandBuffer& operator= (const BlockCommandBuffer&) = delete;
+	BlockCommandBuffer& operator= (BlockCommandBuffer&&) noexcept = default;
+
+public:
+	inline void createBlock(const Block::Slot& slot, const std::string& templateName) { _commands.push_back({ Type::CreateBlock, 0, slot, templateName }); }
+	inline void removeBlock(const Block::Slot& slot) { _commands.push_back({ Type::RemoveBlock, 0, slot }); }
+
+	inline void setLocalValue(Block::Id blockId, const std::string& name, Value&& value)
+	{
+		_commands.push_back({ Type::SetLocalValue, blockId, {}, name, std::move(value) });
+	}
+
+	// Calls the template function name of the block on the main state, as name(block, value) //
+	inline void callOnMain(Block::Id blockId, const std::string& name, Value&& value)
+	{
+		_commands.push_back({ Type::CallOnMain, blockId, {}, name, std::move(value) });
+	}
+
+	inline bool empty() const { return _commands.empty(); }
+	inline std::size_t size() const { return _commands.size(); }
+
+	inline void clear() { _commands.clear(); }
+
+	// Main thread only, in recording order. Leaves the buffer empty //
+	void apply(BlockContainer& container);
+
+public:
+	// Converts a worker state value, errors on the Lua side for tables, functions and userdata //
+	static Value toValue(const LuaRef& ref);
+
+	// Into the main state //
+	static LuaRef toLuaRef(const Value& value);
+};
 
-inline void BlockTemplate::onBlockConstruct(Block& block) { vcall(FunctionOnBlockConstruct, std::addressof(block)); }
-inline void BlockTemplate::onBlockSideConstruct(BlockSide& side) { vcall(FunctionOnBlockSideConstruct, std::addressof(side)); }
 
 
 
+/*
+	What a parallel safe OnUpdate hook receives instead of the block: read and write access to the transform of its own
+	block, read access to its sides and the command buffer for everything else.
+*/
+class BlockUpdateContext
+{
+private:
+	Block& _block;
+	BlockCommandBuffer& _commands;
+
+public:
+	inline BlockUpdateContext(Block& block, BlockCommandBuffer& commands) : _block(block), _commands(commands) {}
+	BlockUpdateContext(const BlockUpdateContext&) = delete;
+	BlockUpdateContext(BlockUpdateContext&&) noexcept = delete;
+	~BlockUpdateContext() = default;
+
+	BlockUpdateContext& operator= (const BlockUpdateContext&) = delete;
+	BlockUpdateContext& operator= (BlockUpdateContext&&) noexcept = delete;
+
+public:
+	inline Block::Id getBlockId() const { return _block.getBlockId(); }
+
+	inline glm::vec3 getSlot() const { return { _block.getBlockSlot().x, _block.getBlockSlot().y, _block.getBlockSlot().z }; }
+
+	inline const glm::vec3& getPosition() const { return _block.getPosition(); }
+	inline void setPosition(const glm::vec3& position) { _block.setPosition(position); }
+
+	inline const glm::vec3& getRotation() const { return _block.getRotation(); }
+	inline void setRotation(const glm::vec3& rotation) { _block.setRotation(rotation); }
+
+	inline const glm::vec3& getScale() const { return _block.getScale(); }
+	inline void setScale(const glm::vec3& scale) { _block.setScale(scale); }
+
+	inline const glm::vec3& getSidePosition(unsigned int sideId) const { return _block.getSide(cubes::side::intToId(sideId)).getPosition(); }
+	inline const glm::vec3& getSideNormal(unsigned int sideId) const { return _block.getSide(cubes::side::intToId(sideId)).getNormal(); }
+
+	inline BlockCommandBuffer& getCommands() { return _commands; }
+	inline Block& getBlock() { return _block; }
+};
 
 
 
@@ -445,6 +632,13 @@ private:
 	std::shared_ptr<Block> _last = nullptr;
 	std::shared_ptr<TransparentRenderList> _transparentRenderList = nullptr;
 
+	// Per frame scratch for the parallel passes, kept to avoid reallocating //
+	std::vector<Block*> _jobBlocks = {};
+	std::vector<std::uint8_t> _jobVisibility = {};
+	std::vector<std::vector<Block*>> _workerBlocks = {};
+	std::vector<BlockCommandBuffer> _workerCommands = {};
+	BlockCommandBuffer _mainCommands = {};
+
 public:
 	BlockContainer() = default;
 	BlockContainer(const BlockContainer&) = delete;
@@ -466,8 +660,17 @@ public:
 	Reference<Block::Side> getBlockSideBySideId(Block::Side::Id sideId) const;
 
 	void render(const Camera& cam);
+
+	// Serial hooks first, then the hooks of parallel safe templates on the pool states, bucketed by block id so a
+	// block keeps its state, then their deferred commands and at last the transform work in parallel //
 	void update(Time elapsedTime);
 
+	// Queues every block and block side transform with stale matrices //
+	void gatherTransforms(TransformUpdater& updater) const;
+
+	// Queues every block, the sides follow their block //
+	void gatherTransforms(TransformInterpolator& interpolator);
+
 public:
 	inline bool empty() const { return _first == nullptr; }
 	inline std::size_t size() const { return _net.size(); }
@@ -1,9 +1,17 @@
 #include "game_controller.h"
 
+#include "core/profiler.h"
+#include "core/trace_recorder.h"
+#include "core/frame_stats.h"
+#include "core/upload_queue.h"
+
+#include "engine/lua/task_scheduler.h"
+
 
 GameController GameController::Instance = GameController();
 
-GameController::GameController()
+GameController::GameController() :
+	_pipeline([this](std::size_t slot) { simulate(slot); }, [this](std::size_t slot) { render(slot); })
 {
 
 }
@@ -29,8 +37,16 @@ void GameController::start(const std::function<bool()>& initiatingFunction, cons
 bool GameController::init(const std::function<bool()>& initiatingFunction)
 {
 	window::createMainWindow({ int(_props->windowWidth), int(_props->windowHeight) });
+	_props->applyFramePacing();
+	_props->applyUploadQueue();
+
+	if (!initiatingFunction())
+		return false;
 
-	return initiatingFunction();
+	_timestep.setTickRate(_props->simulationTickRate);
+	_timestep.setMaxSubsteps(_props->simulationMaxSubsteps);
+	setPipelined(_props->pipelinedRendering);
+	return true;
 }
 
 void GameController::loop()
@@ -40,42 +56,116 @@ void GameController::loop()
 		_state = State::Running;
 		while (_state == State::Running)
 		{
-			update();
-			render();
+			Profiler::instance().beginFrame();
+
+			// Returns with the simulation idle, so events and the frame stats see a quiet Lua state //
+			_pipeline.frame();
 			dispatchEvents();
 
+			FrameStats::instance().setLatency(Profiler::toMilliseconds(_pipeline.getTimes().latency));
+			Profiler::instance().endFrame();
+
 			if (glfwWindowShouldClose(window::getMainWindow()))
 				stop();
 		}
 	}
 }
 
-void GameController::render()
+void GameController::render(std::size_t slot)
 {
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	PROFILE_SCOPE("GameController::render");
+	{
+		PROFILE_GPU_SCOPE("GameController::render");
 
-	_level.render(_mainCamera);
+		gl::UploadQueue::instance().drain();
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		if (_pipeline.isPipelined())
+			_snapshots[slot].render();
+		else
+			renderLevel();
+	}
 
-	glfwSwapBuffers(window::getMainWindow());
+	auto& pacer = window::getFramePacer();
+	pacer.wait();
+	{
+		PROFILE_SCOPE_CATEGORY("SwapBuffers", ProfileCategory::Wait);
+		glfwSwapBuffers(window::getMainWindow());
+	}
+	pacer.presented();
 }
 
 void GameController::update()
 {
+	PROFILE_SCOPE("GameController::update");
+
 	_prevElapsedTime = _elapsedTime;
-	_elapsedTime = _time.update();
+	_elapsedTime = window::getFramePacer().smooth(_time.update());
 
+	// The camera follows the input every frame, only the level runs in ticks //
 	_freecam.update(_elapsedTime);
-	_level.update(_elapsedTime);
+
+	const unsigned int ticks = _timestep.advance(_elapsedTime);
+	for (unsigned int i = 0; i < ticks; ++i)
+	{
+		_level.gatherTransforms(_transformInterpolator);
+		_transformInterpolator.record();
+
+		_level.update(_timestep.getTickTime());
+		LuaTaskScheduler::instance().update(_timestep.getTickTime());
+	}
+
+	// Last step of the update, render only reads the matrices from here on //
+	_level.gatherTransforms(_transformUpdater);
+	_transformUpdater.update();
+}
+
+void GameController::renderLevel()
+{
+	// Shows the level between its last two ticks, the simulated transforms are back once render is done //
+	const bool interpolate = _timestep.isFixed();
+	if (interpolate)
+	{
+		_level.gatherTransforms(_transformInterpolator);
+		_transformInterpolator.apply(_timestep.getAlpha());
+	}
+
+	_level.render(_mainCamera);
+
+	if (interpolate)
+		_transformInterpolator.restore();
+}
+
+void GameController::simulate(std::size_t slot)
+{
+	update();
+
+	// Render hooks run here in pipelined mode, their draws land in the snapshot instead of the GL thread //
+	if (_pipeline.isPipelined())
+	{
+		PROFILE_SCOPE("GameController::captureSnapshot");
+
+		RenderSnapshot& snapshot = _snapshots[slot];
+		snapshot.reset();
+
+		RenderCaptureScope capture(snapshot);
+		renderLevel();
+	}
 }
 
 void GameController::dispatchEvents()
 {
+	PROFILE_SCOPE("GameController::dispatchEvents");
+
 	InputManager::dispatchEvents([this](const InputEvent& event) {
 		_freecam.dispatchEvent(event);
 		_level.dispatchEvent(event);
 
 		if (_stopOnEscape && event.type == InputEvent::Type::KeyPressed && event.key.key == Key::Escape)
 			stop();
+
+		if (event.type == InputEvent::Type::KeyPressed && event.key.key == Key::F12)
+			TraceRecorder::instance().requestDump();
 	});
 	Mouse::setPositionToCenter();
 }
@@ -84,6 +174,8 @@ void GameController::finalize(const std::function<void()>& finalizingFunction)
 {
 	if (_state == State::Finalizing)
 	{
+		setPipelined(false);
+		LuaTaskScheduler::instance().clear();
 		finalizingFunction();
 		gl::terminate();
 		_state = State::Stop;
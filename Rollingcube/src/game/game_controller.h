@@ -2,13 +2,17 @@
 
 #include <memory>
 #include <vector>
+#include <array>
 #include <unordered_map>
 #include <functional>
 
 #include "core/gl.h"
 #include "core/window.h"
+#include "core/frame_pipeline.h"
+#include "core/fixed_timestep.h"
 
 #include "engine/entities.h"
+#include "engine/render_snapshot.h"
 
 #include "level.h"
 #include "freecam.h"
@@ -43,6 +47,13 @@ private:
 	FreecamController _freecam = {};
 	Level _level = {};
 
+	FixedTimestep _timestep = {};
+	TransformUpdater _transformUpdater = {};
+	TransformInterpolator _transformInterpolator = {};
+
+	FramePipeline _pipeline;
+	std::array<RenderSnapshot, FramePipeline::SlotCount> _snapshots;
+
 	bool _stopOnEscape = false;
 
 	const Reference<Properties> _props = Properties::referenceInstance();
@@ -65,8 +76,10 @@ private:
 	bool init(const std::function<bool()>& initiatingFunction);
 
 	void loop();
-	void render();
+	void simulate(std::size_t slot);
+	void render(std::size_t slot);
 	void update();
+	void renderLevel();
 	void dispatchEvents();
 
 	void finalize(const std::function<void()>& finalizingFunction);
@@ -75,6 +88,7 @@ public:
 	constexpr bool isRunning() const { return _state == State::Running; }
 
 	constexpr Time getElapsedTime() const { return _elapsedTime; }
+	constexpr Time getTickTime() const { return _timestep.getTickTime(); }
 	constexpr Time getPrevElapsedTime() const { return _prevElapsedTime; }
 
 	constexpr Camera& getMainCamera() { return _mainCamera; }
@@ -88,6 +102,18 @@ public:
 
 	constexpr void setStopOnEscape() { _stopOnEscape = true; }
 
+	// Pipelined mode simulates the next frame on its own thread while this one renders the last snapshot //
+	inline void setPipelined(bool pipelined) { _pipeline.setMode(pipelined ? FramePipeline::Mode::Pipelined : FramePipeline::Mode::Serial); }
+	constexpr bool isPipelined() const { return _pipeline.isPipelined(); }
+	constexpr const FramePipeline::Times& getFrameTimes() const { return _pipeline.getTimes(); }
+
+	// The level is simulated in ticks of 1 / tickRate seconds, 0 goes back to one tick per frame //
+	inline void setTickRate(unsigned int tickRate) { _timestep.setTickRate(tickRate); }
+	constexpr unsigned int getTickRate() const { return _timestep.getTickRate(); }
+
+	constexpr void setMaxSubsteps(unsigned int maxSubsteps) { _timestep.setMaxSubsteps(maxSubsteps); }
+	constexpr unsigned int getMaxSubsteps() const { return _timestep.getMaxSubsteps(); }
+
 	inline void stop()
 	{
 		if (_state == State::Running)
@@ -2,6 +2,8 @@
 
 #include <limits>
 
+#include "engine/lua/task_scheduler.h"
+
 
 void Level::render(const Camera& cam)
 {
@@ -20,6 +22,9 @@ void Level::dispatchEvent(const InputEvent& event)
 
 void Level::clear()
 {
+	// Tasks started by the templates may still hold blocks of this level //
+	LuaTaskScheduler::instance().clear();
+
 	_blocks.clear();
 	_limits.center = { 0, 0, 0 };
 	_limits.extents = { 0, 0, 0 };
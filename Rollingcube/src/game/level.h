@@ -24,6 +24,9 @@ public:
 	void update(Time elapsedTime);
 	void dispatchEvent(const InputEvent& event);
 
+	inline void gatherTransforms(TransformUpdater& updater) const { _blocks.gatherTransforms(updater); }
+	inline void gatherTransforms(TransformInterpolator& interpolator) { _blocks.gatherTransforms(interpolator); }
+
 	void clear();
 
 	void computeLimits();
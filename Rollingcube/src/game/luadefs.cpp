@@ -3,6 +3,10 @@
 #include "math/glm.h"
 #include "utils/logger.h"
 #include "utils/luadebuglib.h"
+#include "core/trace_recorder.h"
+#include "core/frame_stats.h"
+#include "core/job_system.h"
+#include "engine/lua/task_scheduler.h"
 
 #include "theme.h"
 
@@ -25,6 +29,11 @@ void lua::initGameLibs()
 		lua::lib::registerModelsLibToLua();
 		lua::lib::registerBallsLibToLua();
 		lua::lib::registerSkyboxessLibToLua();
+		lua::lib::registerProfilerLibToLua();
+		lua::lib::registerStatsLibToLua();
+		lua::lib::registerTasksLibToLua();
+
+		TraceRecorder::instance().installLuaGcProbe(lua::state());
 
 		initiatedFlag = true;
 	}
@@ -50,13 +59,33 @@ Reference<LuaRef> LuaTemplate::findLuaObject(std::string_view name) const
 	return ref;
 }
 
+Reference<LuaRef> LuaTemplate::findWorkerLuaObject(std::size_t worker, std::string_view name)
+{
+	auto& cache = _workers[worker].luaCache;
+	auto it = cache.find(name.data());
+	if (it != cache.end())
+		return it->second.get();
+
+	auto obj = std::make_unique<LuaRef>(_workers[worker].module->getValue<LuaRef>(name));
+	if (obj->isNil())
+		return nullptr;
+
+	Reference<LuaRef> ref = obj.get();
+	cache.insert({ name.data(), std::move(obj) });
+
+	return ref;
+}
+
 LuaTemplate::~LuaTemplate()
 {
 	clear();
+	releaseWorkers();
 }
 
 bool LuaTemplate::load()
 {
+	PROFILE_SCOPE_CATEGORY("LuaTemplate::load", ProfileCategory::Asset);
+
 	if (isLoaded())
 	{
 		logger::warn("Attempt to load already loaded LuaModel {}/{}.lua", getTemplateTypeName(getType()), _name);
@@ -83,6 +112,7 @@ bool LuaTemplate::load()
 	_luaCache.clear();
 
 	init();
+	loadWorkers();
 
 	return true;
 }
@@ -92,9 +122,11 @@ void LuaTemplate::reload()
 	if (isLoaded())
 	{
 		clear();
+		releaseWorkers();
 		_luaCache.clear();
 		_module->reload();
 		init();
+		loadWorkers();
 	}
 }
 
@@ -108,6 +140,48 @@ void LuaTemplate::init()
 	vcall(FunctionOnInit);
 }
 
+void LuaTemplate::loadWorkers()
+{
+	const LuaRef flag = _module->getValue<LuaRef>(ValueParallelSafe);
+	_parallelSafe = flag.isBool() && flag.cast<bool>().value();
+	if (!_parallelSafe)
+		return;
+
+	// The main state runs the same hooks when there are no workers //
+	prepareWorkerState();
+	if (JobSystem::instance().getWorkerCount() == 0)
+		return;
+
+	auto filePathOpt = findModelFile();
+	if (!filePathOpt.has_value())
+		return;
+
+	auto& pool = LuaStatePool::instance();
+	pool.reserve(JobSystem::instance().getThreadCount());
+
+	_workers.reserve(pool.size());
+	for (std::size_t i = 0; i < pool.size(); ++i)
+	{
+		LuaStateScope scope(pool.get(i).get());
+		auto mod = LuaModuleManager::instance().loadDetached(filePathOpt.value());
+		if (mod == nullptr)
+		{
+			// All or nothing, hooks fall back to the main state //
+			logger::error("Cannot load parallel safe LuaModel {} into worker state {}.", _name, i);
+			releaseWorkers();
+			return;
+		}
+
+		prepareWorkerState();
+		_workers.push_back({ pool.get(i), std::move(mod), {} });
+	}
+}
+
+void LuaTemplate::releaseWorkers()
+{
+	_workers.clear();
+}
+
 std::optional<Path> LuaTemplate::findModelFile() const
 {
 	if (_name.empty())
@@ -1,12 +1,17 @@
 #pragma once
 
 #include <memory>
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 #include <optional>
 #include <concepts>
 
+#include "core/profiler.h"
+#include "core/frame_stats.h"
 #include "engine/lua/module.h"
+#include "engine/lua/state_pool.h"
 #include "utils/resources.h"
 #include "utils/reference.h"
 #include "utils/manager.h"
@@ -42,6 +47,16 @@ namespace std
 
 
 
+// A template hook, with the FrameStats counter its calls go to //
+struct LuaHookFunction
+{
+	std::string_view name; // Reaches the profiler as is: a literal, or a name returned by Profiler::intern
+	LuaHook hook = LuaHook::Other;
+};
+
+
+
+
 class LuaTemplate
 {
 public:
@@ -70,17 +85,38 @@ public:
 	using Id = unsigned int;
 
 protected:
-	static constexpr std::string_view FunctionOnInit = "OnInit";
-	static constexpr std::string_view FunctionOnDestroy = "OnDestroy";
+	static constexpr LuaHookFunction FunctionOnInit = { "OnInit", LuaHook::OnInit };
+	static constexpr LuaHookFunction FunctionOnDestroy = { "OnDestroy", LuaHook::OnDestroy };
+
+	// Set to true by templates whose hooks may run on job threads, see loadWorkers() //
+	static constexpr std::string_view ValueParallelSafe = "ParallelSafe";
+
+public:
+	// Worker index that always calls into the main state //
+	static constexpr std::size_t MainState = std::size_t(-1);
 
 protected:
 	Id _id = 0;
 	std::string _name = {};
 	std::shared_ptr<LuaModule> _module = nullptr;
 
+private:
+	static inline std::atomic<std::uint64_t> CallCount = 0;
+
+	// Copy of the template loaded into a pool state. Members are released in reverse order, the state last //
+	struct WorkerModule
+	{
+		LuaStatePool::StateRef state;
+		std::shared_ptr<LuaModule> module;
+		std::unordered_map<std::string, std::unique_ptr<LuaRef>> luaCache;
+	};
+
 private:
 	mutable std::unordered_map<std::string, std::unique_ptr<LuaRef>> _luaCache;
 
+	bool _parallelSafe = false;
+	std::vector<WorkerModule> _workers;
+
 public:
 	LuaTemplate() = default;
 	LuaTemplate(const LuaTemplate&) = delete;
@@ -100,8 +136,17 @@ public:
 
 	inline bool isLoaded() const { return _module != nullptr; }
 
+	constexpr bool isParallelSafe() const { return _parallelSafe; }
+
+	// Pool states the template is loaded into, 0 when it only runs on the main state //
+	inline std::size_t getWorkerCount() const { return _workers.size(); }
+
 	virtual Type getType() const = 0;
 
+public:
+	// Lua functions called through any template since startup //
+	static inline std::uint64_t getCallCount() { return CallCount.load(std::memory_order_relaxed); }
+
 public:
 	virtual ~LuaTemplate();
 
@@ -112,37 +157,69 @@ public:
 protected:
 	virtual void clear();
 
+	// Runs on the main state and under the scope of every pool state a parallel safe template is loaded into,
+	// for the bindings its hooks receive //
+	virtual void prepareWorkerState() {}
+
 	std::optional<Path> findModelFile() const;
 
 private:
 	void init();
 
+	// Parallel safe templates get a copy in every pool state, only the module chunk runs there, not OnInit //
+	void loadWorkers();
+	void releaseWorkers();
+
+	template <typename... _ArgsTys>
+	static inline void invoke(const LuaRef& fn, const LuaHookFunction& function, _ArgsTys&&... args)
+	{
+		PROFILE_SCOPE_CATEGORY(function.name, ProfileCategory::Lua);
+		CallCount.fetch_add(1, std::memory_order_relaxed);
+		FrameStats::instance().addLuaCall(function.hook);
+		try
+		{
+			fn(std::forward<_ArgsTys>(args)...);
+		}
+		catch (const LuaException& ex)
+		{
+			logger::error("Lua function {} call error: {}", function.name, ex.what());
+		}
+	}
+
 protected:
 	Reference<LuaRef> findLuaObject(std::string_view name) const;
+	Reference<LuaRef> findWorkerLuaObject(std::size_t worker, std::string_view name);
 
 	template <typename... _ArgsTys>
-	inline void vcall(std::string_view name, _ArgsTys&&... args)
+	inline void vcall(const LuaHookFunction& function, _ArgsTys&&... args)
 	{
-		auto fn = findLuaObject(name);
+		auto fn = findLuaObject(function.name);
 		if (fn != nullptr)
-		{
-			try
-			{
-				(*fn)(std::forward<_ArgsTys>(args)...);
-			}
-			catch (const LuaException& ex)
-			{
-				logger::error("Lua function {} call error: {}", name, ex.what());
-			}
-		}
+			invoke(*fn, function, std::forward<_ArgsTys>(args)...);
+	}
+
+	// Calls into the copy in pool state worker, or into the main state when there is none. The calling thread must
+	// hold a LuaStateScope on that state, so references created during the call live in it //
+	template <typename... _ArgsTys>
+	inline void vcallOnWorker(std::size_t worker, const LuaHookFunction& function, _ArgsTys&&... args)
+	{
+		if (worker >= _workers.size())
+			return vcall(function, std::forward<_ArgsTys>(args)...);
+
+		auto fn = findWorkerLuaObject(worker, function.name);
+		if (fn != nullptr)
+			invoke(*fn, function, std::forward<_ArgsTys>(args)...);
 	}
 
 	template <typename _RetTy, typename... _ArgsTys>
-	inline _RetTy call(std::string_view name, _ArgsTys&&... args)
+	inline _RetTy call(const LuaHookFunction& function, _ArgsTys&&... args)
 	{
-		auto fn = findLuaObject(name);
+		auto fn = findLuaObject(function.name);
 		if (fn != nullptr)
 		{
+			PROFILE_SCOPE_CATEGORY(function.name, ProfileCategory::Lua);
+			CallCount.fetch_add(1, std::memory_order_relaxed);
+			FrameStats::instance().addLuaCall(function.hook);
 			try
 			{
 				if constexpr (std::same_as<LuaRef, _RetTy>)
@@ -152,7 +229,7 @@ protected:
 			}
 			catch (const LuaException& ex)
 			{
-				logger::error("Lua function {} call error: {}", name, ex.what());
+				logger::error("Lua function {} call error: {}", function.name, ex.what());
 			}
 		}
 		else
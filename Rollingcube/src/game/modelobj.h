@@ -25,8 +25,8 @@ public:
 	using ConstRef = ConstReference<ModelObjectTemplate>;
 
 public:
-	static constexpr std::string_view FunctionOnRender = "OnRender";
-	static constexpr std::string_view FunctionOnRenderMesh = "OnRenderMesh";
+	static constexpr LuaHookFunction FunctionOnRender = { "OnRender", LuaHook::OnRender };
+	static constexpr LuaHookFunction FunctionOnRenderMesh = { "OnRenderMesh", LuaHook::OnRenderMesh };
 
 public:
 	ModelObjectTemplate() = default;
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <optional>
+#include <algorithm>
 
 #include "core/window.h"
+#include "core/fixed_timestep.h"
+#include "core/upload_queue.h"
 
 #include "utils/resources.h"
 #include "utils/optref.h"
@@ -137,21 +140,64 @@ public:
 		resources::user.writeJson(FileName, obj);
 	}
 
+public:
+	// Needs the main window //
+	void applyFramePacing() const
+	{
+		auto& pacer = window::getFramePacer();
+		pacer.setVSync(static_cast<VSyncMode>(vsync));
+		pacer.setTargetFps(targetFps);
+		pacer.setSmoothingEnabled(frameSmoothing);
+	}
+
+	// Needs the main window //
+	void applyUploadQueue() const
+	{
+		auto& uploads = gl::UploadQueue::instance();
+		uploads.setBudget(Time::seconds(std::max(uploadBudgetMilliseconds, 0.0) / 1000.0));
+		if (uploadThread)
+			uploads.startUploadThread();
+	}
+
 public:
 	unsigned int windowWidth = window::default_width;
 	unsigned int windowHeight = window::default_height;
+	bool pipelinedRendering = false;
+	int vsync = static_cast<int>(VSyncMode::Adaptive); // Same values as glfwSwapInterval: 0 off, 1 on, -1 adaptive
+	double targetFps = 0;
+	bool frameSmoothing = false;
+	double uploadBudgetMilliseconds = gl::UploadQueue::DefaultBudget.toMilliseconds();
+	bool uploadThread = false;
+	unsigned int simulationTickRate = FixedTimestep::DefaultTickRate;
+	unsigned int simulationMaxSubsteps = FixedTimestep::DefaultMaxSubsteps;
 
 private:
 	void load(const utils::PropsJson json)
 	{
 		windowWidth = json.get<unsigned int>("window.width", window::default_width);
 		windowHeight = json.get<unsigned int>("window.height", window::default_height);
+		pipelinedRendering = json.get<bool>("render.pipelined", false);
+		vsync = std::clamp(json.get<int>("window.vsync", static_cast<int>(VSyncMode::Adaptive)), -1, 1);
+		targetFps = json.get<double>("window.targetFps", 0.0);
+		frameSmoothing = json.get<bool>("window.frameSmoothing", false);
+		uploadBudgetMilliseconds = json.get<double>("render.uploadBudgetMs", double(gl::UploadQueue::DefaultBudget.toMilliseconds()));
+		uploadThread = json.get<bool>("render.uploadThread", false);
+		simulationTickRate = json.get<unsigned int>("simulation.tickRate", FixedTimestep::DefaultTickRate);
+		simulationMaxSubsteps = json.get<unsigned int>("simulation.maxSubsteps", FixedTimestep::DefaultMaxSubsteps);
 	}
 
 	void save(utils::PropsJson json)
 	{
 		json.set("window.width", windowWidth);
 		json.set("window.height", windowHeight);
+		json.set("render.pipelined", pipelinedRendering);
+		json.set("window.vsync", vsync);
+		json.set("window.targetFps", targetFps);
+		json.set("window.frameSmoothing", frameSmoothing);
+		json.set("render.uploadBudgetMs", uploadBudgetMilliseconds);
+		json.set("render.uploadThread", uploadThread);
+		json.set("simulation.tickRate", simulationTickRate);
+		json.set("simulation.maxSubsteps", simulationMaxSubsteps);
 	}
 };
 
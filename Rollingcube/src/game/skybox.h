@@ -19,9 +19,9 @@ public:
 	using ConstRef = ConstReference<SkyboxTemplate>;
 
 public:
-	static constexpr std::string_view FunctionOnConstruct = "OnConstruct";
-	static constexpr std::string_view FunctionOnRender = "OnRender";
-	static constexpr std::string_view FunctionOnUpdate = "OnUpdate";
+	static constexpr LuaHookFunction FunctionOnConstruct = { "OnConstruct", LuaHook::OnConstruct };
+	static constexpr LuaHookFunction FunctionOnRender = { "OnRender", LuaHook::OnRender };
+	static constexpr LuaHookFunction FunctionOnUpdate = { "OnUpdate", LuaHook::OnUpdate };
 
 public:
 	SkyboxTemplate() = default;
@@ -2,6 +2,8 @@
 
 #include <unordered_set>
 
+#include <LuaBridge/Vector.h>
+
 #include "utils/resources.h"
 
 #include "engine/lua/module.h"
@@ -170,6 +172,38 @@ Texture::Ref Theme::getTexture(const std::string& name) const
 	return _textureManager.loadFromImage(name, opath.value().string());
 }
 
+std::size_t Theme::preloadTextures(const std::vector<std::string>& names) const
+{
+	static const std::initializer_list<std::string_view> textureExtensions = { ".jpg", ".png", ".bmp" };
+
+	std::vector<std::pair<std::string, std::string>> files;
+	files.reserve(names.size());
+
+	for (const auto& name : names)
+	{
+		if (_textureManager.get(name) != nullptr)
+			continue;
+
+		std::string relativeFilePath = prepareElementName(name);
+
+		auto opath = resources::findFirstValidPath(resources::textures.path(), relativeFilePath, textureExtensions);
+		if (!opath.has_value())
+		{
+			logger::error("Texture on path {} not found.", (resources::textures.path() / relativeFilePath).string());
+			continue;
+		}
+
+		files.push_back({ name, opath.value().string() });
+	}
+
+	std::size_t count = 0;
+	for (const auto& ref : _textureManager.loadFromImages(files))
+		if (ref != nullptr)
+			++count;
+
+	return count;
+}
+
 CubeMapTexture::Ref Theme::getCubeMapTexture(const std::string& name) const
 {
 	auto ref = _cubeMapTextureManager.get(name);
@@ -178,7 +212,7 @@ CubeMapTexture::Ref Theme::getCubeMapTexture(const std::string& name) const
 
 	std::string relativeFilePath = prepareElementName(name);
 
-	static const std::initializer_list<std::string_view> textureExtensions = { ".json" };
+	static const std::initializer_list<std::string_view> textureExtensions = { ".json", ".rccube" };
 
 	auto opath = resources::findFirstValidPath(resources::textures.path(), relativeFilePath, textureExtensions);
 	if (!opath.has_value())
@@ -187,6 +221,9 @@ CubeMapTexture::Ref Theme::getCubeMapTexture(const std::string& name) const
 		return nullptr;
 	}
 
+	if (opath.value().extension() == ".rccube")
+		return _cubeMapTextureManager.loadFromCompiledFile(name, opath.value().string());
+
 	return _cubeMapTextureManager.loadFromJson(name, std::string_view(opath.value().string()), resources::cubemapTextures.string());
 }
 
@@ -246,6 +283,7 @@ namespace lua::lib::LUA_theme
 	static bool change(const std::string& name) { return Theme::getCurrentTheme().changeCurrentTheme(name); }
 
 	static Texture* getTexture(const std::string& name) { return &Theme::getCurrentTheme().getTexture(name); }
+	static std::size_t preloadTextures(const std::vector<std::string>& names) { return Theme::getCurrentTheme().preloadTextures(names); }
 	static CubeMapTexture* getCubeMapTexture(const std::string& name) { return &Theme::getCurrentTheme().getCubeMapTexture(name); }
 
 	static Model* getModel(const std::string& name) { return &Theme::getCurrentTheme().getModel(name); }
@@ -267,6 +305,7 @@ namespace lua::lib::LUA_theme
 			// Methods //
 			.addStaticFunction("change", &change)
 			.addStaticFunction("getTexture", &getTexture)
+			.addStaticFunction("preloadTextures", &preloadTextures)
 			.addStaticFunction("getCubeMapTexture", &getCubeMapTexture)
 			.addStaticFunction("getModel", &getModel)
 			.addStaticFunction("getBallModel", &getBallModel)
@@ -28,7 +28,7 @@ public:
 	using ConstRef = ConstReference<ThemeTemplate>;
 
 public:
-	static constexpr std::string_view FunctionOnLoad = "OnLoad";
+	static constexpr LuaHookFunction FunctionOnLoad = { "OnLoad", LuaHook::OnLoad };
 
 public:
 	ThemeTemplate() = default;
@@ -149,6 +149,7 @@ public:
 
 public:
 	Texture::Ref getTexture(const std::string& name) const;
+	std::size_t preloadTextures(const std::vector<std::string>& names) const;
 	CubeMapTexture::Ref getCubeMapTexture(const std::string& name) const;
 	Model::Ref getModel(const std::string& name) const;
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "engine/entities.h"
+#include "engine/render_snapshot.h"
 #include "cube_model.h"
 #include "luadefs.h"
 
@@ -25,7 +26,7 @@ public:
 	using ConstRef = ConstReference<TileTemplate>;
 
 public:
-	static constexpr std::string_view FunctionOnRender = "OnRender";
+	static constexpr LuaHookFunction FunctionOnRender = { "OnRender", LuaHook::OnRender };
 
 public:
 	TileTemplate() = default;
@@ -92,6 +93,13 @@ public:
 	{
 		if (_template != nullptr)
 		{
+			if (RenderSnapshot* snapshot = RenderSnapshot::capturing())
+			{
+				snapshot->addDraw(*renderData.camera, *renderData.transform, renderData.material, renderData.staticLights,
+					cubes::model::getModel(), std::addressof(cubes::model::getMesh(sideId)));
+				return;
+			}
+
 			ModelableEntity::bindLightnigShaderRenderData(*renderData.camera, *renderData.transform, renderData.material, renderData.staticLights);
 			cubes::model::render(sideId);
 			ModelableEntity::unbindLightnigShaderRenderData(renderData.material);
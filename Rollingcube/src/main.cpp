@@ -13,6 +13,8 @@
 #include "engine/sampler.h"
 #include "engine/entities.h"
 #include "engine/text.h"
+#include "engine/text_layout.h"
+#include "engine/frame_stats_overlay.h"
 
 #include "utils/logger.h"
 #include "utils/bmp_decoder.h"
@@ -136,6 +138,8 @@ static void renderIfNotTransparency(EntityCameraDistanceCollection<ModelEntity>&
 void tutos()
 {
     window::createMainWindow({ int(window::default_width), int(window::default_height) });
+    Properties::instance().applyFramePacing();
+    Properties::instance().applyUploadQueue();
 
     Theme::changeCurrentTheme("test_theme");
 
@@ -238,9 +242,28 @@ void tutos()
     Font font;
     font.load("default.ttf", 256);
 
+    FrameStatsOverlay statsOverlay;
+    bool statsToggleHeld = false;
+
     Camera ortoCam;
     ortoCam.setToOrthographic(0, window::default_width, 0, window::default_height, -1.f, 1.f);
 
+    // HUD lines are shaped once, each frame only reshapes the fields whose value changed //
+    TextLayout camPosText(font, "Cam pos: (x:{}, y:{}, z:{})", 16);
+    TextLayout camRotText(font, "Cam rot: (pitch:{}, yaw:{}, roll:{})", 16);
+    TextLayout camFrontText(font, "Cam FRONT: (x:{}, y:{}, z:{})", 16);
+    TextLayout camUpText(font, "Cam UP: (x:{}, y:{}, z:{})", 16);
+    TextLayout cube3VisibleText(font, "Cube3 Is Visible: {}", 16);
+    TextLayout cube2VisibleText(font, "Cube2 Is Visible: {}", 16);
+    TextLayout cube1VisibleText(font, "Cube1 Is Visible: {}", 16);
+    TextLayout fpsText(font, "{} fps  1% low {}  p99 {} ms", 16);
+
+    const auto setVectorFields = [](TextLayout& layout, const glm::vec3& v) {
+        layout.setField(0, "{:.2f}", v.x);
+        layout.setField(1, "{:.2f}", v.y);
+        layout.setField(2, "{:.2f}", v.z);
+    };
+
     
 
 
@@ -396,6 +419,11 @@ void tutos()
         if (glfwGetKey(window::getMainWindow(), GLFW_KEY_G) == GLFW_PRESS)
             cam.lookAt(cam.getEye(), glm::vec3(0, 0, 0), glm::vec3(0, 1, 0));
 
+        const bool statsTogglePressed = glfwGetKey(window::getMainWindow(), GLFW_KEY_F3) == GLFW_PRESS;
+        if (statsTogglePressed && !statsToggleHeld)
+            FrameStats::instance().setOverlayVisible(!FrameStats::instance().isOverlayVisible());
+        statsToggleHeld = statsTogglePressed;
+
 
         mainLight.setPosition(cam.getEye() + glm::vec3(0, 0, 0));
         //lightManager->updateLight(lightId, light);
@@ -488,15 +516,23 @@ void tutos()
         const auto& rot = cam.getEulerAngles();
         const auto& camFront = cam.getFront();
         const auto& camUp = cam.getUp();
+        setVectorFields(camPosText, pos);
+        setVectorFields(camRotText, rot);
+        setVectorFields(camFrontText, camFront);
+        setVectorFields(camUpText, camUp);
+        cube3VisibleText.setField(0, "{}", entityCube3->isVisibleInCamera(cam));
+        cube2VisibleText.setField(0, "{}", entityCube2->isVisibleInCamera(cam));
+        cube1VisibleText.setField(0, "{}", entityCube1->isVisibleInCamera(cam));
+
         font.setColor({1, 1, 1});
-        font.print(ortoCam, 5, 5, 16, "Cam pos: (x:{:.2f}, y:{:.2f}, z:{:.2f})", pos.x, pos.y, pos.z);
-        font.print(ortoCam, 5, 5 + 16 + 5, 16, "Cam rot: (pitch:{:.2f}, yaw:{:.2f}, roll:{:.2f})", rot.x, rot.y, rot.z);
-        font.print(ortoCam, 5, 5 + 32 + 10, 16, "Cam FRONT: (x:{:.2f}, y:{:.2f}, z:{:.2f})", camFront.x, camFront.y, camFront.z);
-        font.print(ortoCam, 5, 5 + 48 + 15, 16, "Cam UP: (x:{:.2f}, y:{:.2f}, z:{:.2f})", camUp.x, camUp.y, camUp.z);
+        font.print(ortoCam, 5, 5, camPosText);
+        font.print(ortoCam, 5, 5 + 16 + 5, camRotText);
+        font.print(ortoCam, 5, 5 + 32 + 10, camFrontText);
+        font.print(ortoCam, 5, 5 + 48 + 15, camUpText);
 
-        font.print(ortoCam, 5, 5 + 64 + 20, 16, "Cube3 Is Visible: {}", entityCube3->isVisibleInCamera(cam));
-        font.print(ortoCam, 5, 5 + 80 + 25, 16, "Cube2 Is Visible: {}", entityCube2->isVisibleInCamera(cam));
-        font.print(ortoCam, 5, 5 + 96 + 30, 16, "Cube1 Is Visible: {}", entityCube1->isVisibleInCamera(cam));
+        font.print(ortoCam, 5, 5 + 64 + 20, cube3VisibleText);
+        font.print(ortoCam, 5, 5 + 80 + 25, cube2VisibleText);
+        font.print(ortoCam, 5, 5 + 96 + 30, cube1VisibleText);
 
 
 
@@ -530,8 +566,15 @@ void tutos()
             marksCount = 0;
         }
     }, [&](const TimeController& tc) {
+        fpsText.setField(0, "{}", tc.getFPS());
+        fpsText.setField(1, "{}", tc.getLowFPS());
+        fpsText.setField(2, "{:.2f}", tc.getFrameTimeHistory().percentile(0.99).toHighPrecisionSeconds() * 1000.0);
+
         font.setColor({ 0, 1, 0 });
-        font.print(ortoCam, 5, window::default_height - 16, 16, "{} fps", tc.getFPS());
+        font.print(ortoCam, 5, window::default_height - 16, fpsText);
+        if (FrameStats::instance().isOverlayVisible())
+            statsOverlay.render(font, ortoCam, 5, window::default_height - 40);
+        font.flush();
     });
 
     gl::terminate();
@@ -13,7 +13,7 @@ namespace lua::lib
 
 	void registerGlmToLua()
 	{
-		LuaLibraryManager::instance().registerLibrary(::lua::lib::names::geometry, &LUA_glmLib);
+		LuaLibraryManager::instance().registerLibrary(::lua::lib::names::geometry, &LUA_glmLib, {}, true);
 	}
 
 
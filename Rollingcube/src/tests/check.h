@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <source_location>
+
+
+namespace tests
+{
+	// Records a failure and keeps going, so one run reports every broken check //
+	bool check(bool condition, std::string_view what, const std::source_location& location = std::source_location::current());
+
+	std::size_t getCheckCount();
+	std::size_t getFailureCount();
+}
@@ -0,0 +1,348 @@
+#include "job_system_tests.h"
+
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <memory>
+
+#include "core/job_system.h"
+
+#include "check.h"
+
+
+namespace
+{
+	static constexpr std::size_t ThiefCount = 3;
+	static constexpr std::size_t WorkerCount = 3;
+
+	static void checkDequeOrder()
+	{
+		WorkStealingDeque deque;
+		Job a, b, c;
+
+		tests::check(deque.pop() == nullptr, "pop on an empty deque");
+		tests::check(deque.steal() == nullptr, "steal on an empty deque");
+
+		deque.push(&a);
+		deque.push(&b);
+		deque.push(&c);
+		tests::check(deque.pop() == &c, "the owner pops the newest job");
+		tests::check(deque.steal() == &a, "thieves steal the oldest job");
+		tests::check(deque.pop() == &b, "pop takes the last job");
+		tests::check(deque.pop() == nullptr && deque.empty(), "the deque is empty after taking every job");
+	}
+
+	static void checkDequeCapacity()
+	{
+		WorkStealingDeque deque;
+		std::vector<Job> jobs(std::size_t(WorkStealingDeque::Capacity) + 1);
+
+		bool accepted = true;
+		for (std::int64_t i = 0; i < WorkStealingDeque::Capacity; ++i)
+			accepted = deque.push(std::addressof(jobs[std::size_t(i)])) && accepted;
+
+		tests::check(accepted, "push accepts Capacity jobs");
+		tests::check(!deque.push(std::addressof(jobs.back())), "push fails on a full deque");
+
+		// Stealing one frees a slot at the top, the ring wraps around into it //
+		tests::check(deque.steal() == std::addressof(jobs[0]), "steal on a full deque");
+		tests::check(deque.push(std::addressof(jobs.back())), "push after a steal freed a slot");
+
+		std::size_t popped = 0;
+		while (deque.pop() != nullptr)
+			++popped;
+		tests::check(popped == std::size_t(WorkStealingDeque::Capacity), "every job is popped after wrapping around");
+	}
+
+	// The owner and every thief go for the only job at once, exactly one of them may get it //
+	static void checkLastJobRace()
+	{
+		static constexpr int Rounds = 20000;
+
+		WorkStealingDeque deque;
+		Job job;
+		std::atomic<int> round = 0;
+		std::atomic<int> finished = 0;
+		std::atomic<int> stolen = 0;
+
+		std::vector<std::thread> thieves;
+		for (std::size_t i = 0; i < ThiefCount; ++i)
+		{
+			thieves.emplace_back([&]() {
+				for (int r = 1; r <= Rounds; ++r)
+				{
+					while (round.load(std::memory_order_acquire) < r)
+						std::this_thread::yield();
+
+					if (deque.steal() != nullptr)
+						stolen.fetch_add(1, std::memory_order_relaxed);
+					finished.fetch_add(1, std::memory_order_release);
+				}
+			});
+		}
+
+		int wrongRounds = 0;
+		for (int r = 1; r <= Rounds; ++r)
+		{
+			deque.push(&job);
+			round.store(r, std::memory_order_release);
+			const int popped = deque.pop() != nullptr ? 1 : 0;
+
+			while (finished.load(std::memory_order_acquire) < r * int(ThiefCount))
+				std::this_thread::yield();
+
+			if (popped + stolen.exchange(0, std::memory_order_relaxed) != 1)
+				++wrongRounds;
+		}
+
+		for (auto& thief : thieves)
+			thief.join();
+
+		tests::check(wrongRounds == 0, "the last job is taken exactly once when pop and steal race");
+		tests::check(deque.empty(), "the deque is empty after the race");
+	}
+
+	// The owner pushes and pops while thieves steal, every job must come out exactly once //
+	static void checkDequeContention()
+	{
+		static constexpr std::size_t JobCount = 200000;
+
+		WorkStealingDeque deque;
+		std::vector<Job> jobs(JobCount);
+		std::unique_ptr<std::atomic<std::uint32_t>[]> taken = std::make_unique<std::atomic<std::uint32_t>[]>(JobCount);
+		std::atomic<bool> done = false;
+
+		auto take = [&](Job* job) { taken[std::size_t(job - jobs.data())].fetch_add(1, std::memory_order_relaxed); };
+
+		std::vector<std::thread> thieves;
+		for (std::size_t i = 0; i < ThiefCount; ++i)
+		{
+			thieves.emplace_back([&]() {
+				while (!done.load(std::memory_order_acquire))
+				{
+					if (Job* job = deque.steal())
+						take(job);
+				}
+			});
+		}
+
+		for (std::size_t i = 0; i < JobCount; ++i)
+		{
+			while (!deque.push(std::addressof(jobs[i])))
+			{
+				if (Job* job = deque.pop())
+					take(job);
+			}
+
+			if (i % 3 == 0)
+			{
+				if (Job* job = deque.pop())
+					take(job);
+			}
+		}
+
+		while (Job* job = deque.pop())
+			take(job);
+
+		done.store(true, std::memory_order_release);
+		for (auto& thief : thieves)
+			thief.join();
+
+		std::size_t lost = 0, duplicated = 0;
+		for (std::size_t i = 0; i < JobCount; ++i)
+		{
+			const std::uint32_t count = taken[i].load(std::memory_order_relaxed);
+			lost += count == 0 ? 1 : 0;
+			duplicated += count > 1 ? 1 : 0;
+		}
+
+		tests::check(lost == 0, "no job is lost under contention");
+		tests::check(duplicated == 0, "no job is taken twice under contention");
+	}
+
+
+
+
+	static void checkRunAndWait()
+	{
+		static constexpr int JobCount = 5000;
+
+		JobSystem jobs(WorkerCount);
+		JobCounter counter;
+		std::atomic<int> executed = 0;
+		for (int i = 0; i < JobCount; ++i)
+			jobs.run(counter, [&executed]() { executed.fetch_add(1, std::memory_order_relaxed); });
+
+		jobs.wait(counter);
+		tests::check(executed.load() == JobCount, "wait returns once every job ran");
+		tests::check(counter.isDone(), "the counter is done after wait");
+	}
+
+	static void checkDependencies()
+	{
+		static constexpr int FirstCount = 64;
+		static constexpr int ContinuationCount = 16;
+
+		JobSystem jobs(WorkerCount);
+		JobCounter first, second, third;
+		std::atomic<int> firstDone = 0;
+		std::atomic<int> secondDone = 0;
+		std::atomic<int> earlyContinuations = 0;
+
+		for (int i = 0; i < FirstCount; ++i)
+		{
+			jobs.run(first, [&firstDone]() {
+				std::this_thread::sleep_for(std::chrono::microseconds(200));
+				firstDone.fetch_add(1, std::memory_order_relaxed);
+			});
+		}
+
+		for (int i = 0; i < ContinuationCount; ++i)
+		{
+			jobs.run(second, first, [&]() {
+				if (firstDone.load(std::memory_order_relaxed) != FirstCount)
+					earlyContinuations.fetch_add(1, std::memory_order_relaxed);
+				secondDone.fetch_add(1, std::memory_order_relaxed);
+			});
+		}
+
+		// Chained: third depends on second, which depends on first //
+		jobs.run(third, second, [&]() {
+			if (secondDone.load(std::memory_order_relaxed) != ContinuationCount)
+				earlyContinuations.fetch_add(1, std::memory_order_relaxed);
+		});
+
+		jobs.wait(third);
+		jobs.wait(second);
+		jobs.wait(first);
+
+		tests::check(earlyContinuations.load() == 0, "continuations only start once their dependency is done");
+		tests::check(secondDone.load() == ContinuationCount, "every continuation ran");
+
+		// A dependency that is already done schedules the job right away //
+		JobCounter done, after;
+		bool ran = false;
+		jobs.run(after, done, [&ran]() { ran = true; });
+		jobs.wait(after);
+		tests::check(ran, "a job depending on a done counter runs");
+	}
+
+	// The only worker is held by a job, so the main deque fills up and the jobs past its capacity run inline //
+	static void checkDequeOverflow()
+	{
+		static constexpr int ExtraJobs = 100;
+
+		JobSystem jobs(1);
+		JobCounter counter;
+		std::atomic<bool> started = false;
+		std::atomic<bool> release = false;
+		std::atomic<int> executed = 0;
+		std::atomic<int> inlined = 0;
+		const auto mainThread = std::this_thread::get_id();
+
+		jobs.run(counter, [&]() {
+			started.store(true);
+			while (!release.load())
+				std::this_thread::yield();
+		});
+
+		while (!started.load())
+			std::this_thread::yield();
+
+		const int jobCount = int(WorkStealingDeque::Capacity) + ExtraJobs;
+		for (int i = 0; i < jobCount; ++i)
+		{
+			jobs.run(counter, [&]() {
+				if (std::this_thread::get_id() == mainThread && !release.load())
+					inlined.fetch_add(1, std::memory_order_relaxed);
+				executed.fetch_add(1, std::memory_order_relaxed);
+			});
+		}
+
+		tests::check(inlined.load() == ExtraJobs, "jobs past the deque capacity run inline on the scheduling thread");
+
+		release.store(true);
+		jobs.wait(counter);
+		tests::check(executed.load() == jobCount, "every job runs after the deque overflowed");
+	}
+
+	static std::size_t nestedSum(JobSystem& jobs)
+	{
+		static constexpr std::size_t Outer = 64;
+		static constexpr std::size_t Inner = 1000;
+
+		std::vector<std::size_t> sums(Outer, 0);
+		jobs.parallelFor(Outer, 1, [&jobs, &sums](std::size_t begin, std::size_t end) {
+			for (std::size_t i = begin; i < end; ++i)
+			{
+				std::atomic<std::size_t> sum = 0;
+				jobs.parallelFor(Inner, 16, [&sum](std::size_t innerBegin, std::size_t innerEnd) {
+					std::size_t local = 0;
+					for (std::size_t j = innerBegin; j < innerEnd; ++j)
+						local += j;
+					sum.fetch_add(local, std::memory_order_relaxed);
+				});
+				sums[i] = sum.load();
+			}
+		});
+
+		std::size_t total = 0;
+		for (std::size_t sum : sums)
+			total += sum;
+		return total;
+	}
+
+	static constexpr std::size_t ExpectedNestedSum = 64 * (999 * 1000 / 2);
+
+	static void checkNestedParallelFor()
+	{
+		JobSystem jobs(WorkerCount);
+		tests::check(nestedSum(jobs) == ExpectedNestedSum, "nested parallelFor from the main thread");
+
+		// Like the pipelined simulation thread: no deque of its own, its jobs go through the injection queue and its
+		// waits steal, while the main thread runs its own parallel loops //
+		std::size_t threadSum = 0;
+		bool threadCounterDone = false;
+		std::thread simulation([&]() {
+			threadSum = nestedSum(jobs);
+
+			JobCounter counter;
+			std::atomic<int> executed = 0;
+			for (int i = 0; i < 256; ++i)
+				jobs.run(counter, [&executed]() { executed.fetch_add(1, std::memory_order_relaxed); });
+			jobs.wait(counter);
+			threadCounterDone = executed.load() == 256;
+		});
+
+		std::size_t mainSum = 0;
+		for (int i = 0; i < 8; ++i)
+			mainSum += nestedSum(jobs);
+		simulation.join();
+
+		tests::check(threadSum == ExpectedNestedSum, "nested parallelFor from a thread without a deque");
+		tests::check(threadCounterDone, "run and wait from a thread without a deque");
+		tests::check(mainSum == ExpectedNestedSum * 8, "nested parallelFor on the main thread alongside another thread");
+
+		// Without workers every job runs inline //
+		JobSystem inlineJobs(0);
+		tests::check(nestedSum(inlineJobs) == ExpectedNestedSum, "nested parallelFor without workers");
+	}
+}
+
+
+namespace tests
+{
+	void runJobSystemTests()
+	{
+		checkDequeOrder();
+		checkDequeCapacity();
+		checkLastJobRace();
+		checkDequeContention();
+
+		checkRunAndWait();
+		checkDependencies();
+		checkDequeOverflow();
+		checkNestedParallelFor();
+	}
+}
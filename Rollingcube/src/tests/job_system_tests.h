@@ -0,0 +1,9 @@
+#pragma once
+
+
+namespace tests
+{
+	// WorkStealingDeque under contention, JobCounter dependencies, deque overflow and nested parallelFor, also from a
+	// thread without a deque //
+	void runJobSystemTests();
+}
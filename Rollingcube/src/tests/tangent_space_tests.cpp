@@ -0,0 +1,97 @@
+#include "tangent_space_tests.h"
+
+#include <vector>
+#include <random>
+#include <numeric>
+#include <string>
+#include <algorithm>
+
+#include "utils/tangent_space.h"
+
+#include "check.h"
+
+
+namespace
+{
+	static constexpr float Tolerance = 1e-5f;
+
+	struct Mesh
+	{
+		std::vector<glm::vec3> vertices;
+		std::vector<glm::vec2> uvs;
+		std::vector<glm::vec3> normals;
+	};
+
+	// Random triangles with their face normal on every corner. Triangles without a usable UV gradient are skipped,
+	// the original path turns them into NaNs //
+	static Mesh makeNonIndexedMesh(std::size_t triangleCount, std::uint32_t seed)
+	{
+		std::mt19937 rng(seed);
+		std::uniform_real_distribution<float> position(-10.f, 10.f);
+		std::uniform_real_distribution<float> edge(-1.f, 1.f);
+		std::uniform_real_distribution<float> uv(0.f, 1.f);
+
+		Mesh mesh;
+		mesh.vertices.reserve(triangleCount * 3);
+		mesh.uvs.reserve(triangleCount * 3);
+		mesh.normals.reserve(triangleCount * 3);
+
+		while (mesh.vertices.size() < triangleCount * 3)
+		{
+			const glm::vec3 p0 = { position(rng), position(rng), position(rng) };
+			const glm::vec3 p1 = p0 + glm::vec3(edge(rng), edge(rng), edge(rng));
+			const glm::vec3 p2 = p0 + glm::vec3(edge(rng), edge(rng), edge(rng));
+			const glm::vec2 uv0 = { uv(rng), uv(rng) }, uv1 = { uv(rng), uv(rng) }, uv2 = { uv(rng), uv(rng) };
+
+			const glm::vec3 cross = glm::cross(p1 - p0, p2 - p0);
+			const glm::vec2 duv1 = uv1 - uv0, duv2 = uv2 - uv0;
+			if (glm::length(cross) < 1e-2f || std::abs(duv1.x * duv2.y - duv1.y * duv2.x) < 1e-2f)
+				continue;
+
+			const glm::vec3 normal = glm::normalize(cross);
+			mesh.vertices.insert(mesh.vertices.end(), { p0, p1, p2 });
+			mesh.uvs.insert(mesh.uvs.end(), { uv0, uv1, uv2 });
+			mesh.normals.insert(mesh.normals.end(), { normal, normal, normal });
+		}
+
+		return mesh;
+	}
+
+	static void compareWithPerTriangle(std::size_t triangleCount, const std::string& what)
+	{
+		const Mesh mesh = makeNonIndexedMesh(triangleCount, std::uint32_t(triangleCount));
+
+		std::vector<glm::vec3> baseTangents, baseBitangents;
+		tangents::computeTangentBasis(mesh.vertices, mesh.uvs, mesh.normals, baseTangents, baseBitangents);
+
+		std::vector<std::uint32_t> indices(mesh.vertices.size());
+		std::iota(indices.begin(), indices.end(), std::uint32_t(0));
+
+		std::vector<glm::vec4> tangents;
+		tangents::computeTangentBasis(mesh.vertices, mesh.uvs, mesh.normals, indices, tangents);
+
+		if (!tests::check(tangents.size() == baseTangents.size(), what + ": one tangent per vertex"))
+			return;
+
+		// The original path flips the tangent itself, the indexed one stores the flip in w, so handedness is compared too //
+		float maxError = 0.f;
+		for (std::size_t i = 0; i < tangents.size(); ++i)
+		{
+			const glm::vec3 tangent = glm::vec3(tangents[i]) * tangents[i].w;
+			maxError = std::max(maxError, glm::length(tangent - baseTangents[i]));
+		}
+
+		tests::check(maxError <= Tolerance, what + ": tangents match the per-triangle path (max error " + std::to_string(maxError) + ")");
+	}
+}
+
+
+namespace tests
+{
+	void runTangentSpaceTests()
+	{
+		// Below and above the size the indexed path starts splitting its work over the thread pool //
+		compareWithPerTriangle(1000, "small non-indexed mesh");
+		compareWithPerTriangle(40000, "large non-indexed mesh");
+	}
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+
+namespace tests
+{
+	// The indexed tangent path against the original per-triangle one, on non-indexed meshes both must agree //
+	void runTangentSpaceTests();
+}
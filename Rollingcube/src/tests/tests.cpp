@@ -0,0 +1,52 @@
+#include <iostream>
+#include <string_view>
+#include <functional>
+
+#include "check.h"
+#include "job_system_tests.h"
+#include "tangent_space_tests.h"
+
+
+namespace
+{
+	static std::size_t checkCount = 0;
+	static std::size_t failureCount = 0;
+
+	static void runSuite(std::string_view name, const std::function<void()>& suite)
+	{
+		const std::size_t failuresBefore = failureCount;
+		const std::size_t checksBefore = checkCount;
+		suite();
+
+		std::cout << name << ": " << checkCount - checksBefore << " checks, " << failureCount - failuresBefore << " failed\n";
+	}
+}
+
+
+namespace tests
+{
+	bool check(bool condition, std::string_view what, const std::source_location& location)
+	{
+		++checkCount;
+		if (!condition)
+		{
+			++failureCount;
+			std::cout << "  FAILED " << what << " (" << location.file_name() << ":" << location.line() << ")\n";
+		}
+		return condition;
+	}
+
+	std::size_t getCheckCount() { return checkCount; }
+	std::size_t getFailureCount() { return failureCount; }
+}
+
+
+// Unit tests of the engine parts that can run without a window. Exits with 1 when any check failed //
+int main()
+{
+	runSuite("JobSystem", &tests::runJobSystemTests);
+	runSuite("TangentSpace", &tests::runTangentSpaceTests);
+
+	std::cout << tests::getCheckCount() << " checks, " << tests::getFailureCount() << " failed\n";
+	return tests::getFailureCount() == 0 ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+#include "distance_field.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include "core/thread_pool.h"
+
+
+namespace distance_field
+{
+	namespace
+	{
+		static constexpr float Infinity = 1e20f;
+		static constexpr std::size_t MinParallelLines = 64;
+
+		struct Scratch
+		{
+			std::vector<float> f;
+			std::vector<float> z;
+			std::vector<int> v;
+
+			inline explicit Scratch(std::size_t length) : f(length), z(length + 1), v(length) {}
+		};
+
+		// Felzenszwalb & Huttenlocher 1D squared Euclidean distance transform, in place over a strided line //
+		static void transformLine(float* grid, std::size_t offset, std::size_t stride, std::size_t length, Scratch& scratch)
+		{
+			float* f = scratch.f.data();
+			float* z = scratch.z.data();
+			int* v = scratch.v.data();
+
+			f[0] = grid[offset];
+			v[0] = 0;
+			z[0] = -Infinity;
+			z[1] = Infinity;
+
+			for (int q = 1, k = 0; q < int(length); ++q)
+			{
+				f[q] = grid[offset + (std::size_t(q) * stride)];
+
+				float s;
+				do
+				{
+					const int r = v[k];
+					s = (f[q] - f[r] + float(q * q) - float(r * r)) / float(q - r) / 2.f;
+				} while (s <= z[k] && --k > -1);
+
+				++k;
+				v[k] = q;
+				z[k] = s;
+				z[k + 1] = Infinity;
+			}
+
+			for (int q = 0, k = 0; q < int(length); ++q)
+			{
+				while (z[k + 1] < float(q))
+					++k;
+
+				const int r = v[k];
+				grid[offset + (std::size_t(q) * stride)] = f[r] + float((q - r) * (q - r));
+			}
+		}
+
+		static void transform(std::vector<float>& grid, std::size_t width, std::size_t height, bool parallel)
+		{
+			const auto run = [parallel](std::size_t count, const auto& function) {
+				if (parallel)
+					ThreadPool::instance().parallelFor(count, MinParallelLines, function);
+				else
+					function(std::size_t(0), count);
+			};
+
+			run(width, [&grid, width, height](std::size_t first, std::size_t last) {
+				Scratch scratch = Scratch(height);
+				for (std::size_t x = first; x < last; ++x)
+					transformLine(grid.data(), x, width, height, scratch);
+			});
+
+			run(height, [&grid, width](std::size_t first, std::size_t last) {
+				Scratch scratch = Scratch(width);
+				for (std::size_t y = first; y < last; ++y)
+					transformLine(grid.data(), y * width, 1, width, scratch);
+			});
+		}
+	}
+
+	std::vector<std::uint8_t> fromCoverage(const std::uint8_t* coverage, int width, int height, int pitch, int spread, bool parallel)
+	{
+		const std::size_t paddedWidth = std::size_t(width + (2 * spread));
+		const std::size_t paddedHeight = std::size_t(height + (2 * spread));
+		const std::size_t size = paddedWidth * paddedHeight;
+
+		// Partially covered pixels get a sub pixel distance to the outline, as in Mapbox's TinySDF //
+		std::vector<float> outer(size, Infinity);
+		std::vector<float> inner(size, 0.f);
+
+		for (int y = 0; y < height; ++y)
+		{
+			for (int x = 0; x < width; ++x)
+			{
+				const float a = float(coverage[(y * pitch) + x]) / 255.f;
+				const std::size_t index = (std::size_t(y + spread) * paddedWidth) + std::size_t(x + spread);
+
+				if (a >= 1.f)
+				{
+					outer[index] = 0.f;
+					inner[index] = Infinity;
+				}
+				else if (a > 0.f)
+				{
+					const float outside = std::max(0.f, 0.5f - a);
+					const float inside = std::max(0.f, a - 0.5f);
+					outer[index] = outside * outside;
+					inner[index] = inside * inside;
+				}
+			}
+		}
+
+		transform(outer, paddedWidth, paddedHeight, parallel);
+		transform(inner, paddedWidth, paddedHeight, parallel);
+
+		std::vector<std::uint8_t> field(size);
+		const float scale = 1.f / (2.f * float(std::max(spread, 1)));
+		for (std::size_t i = 0; i < size; ++i)
+		{
+			const float distance = std::sqrt(outer[i]) - std::sqrt(inner[i]);
+			const float value = std::clamp(0.5f - (distance * scale), 0.f, 1.f);
+			field[i] = std::uint8_t(std::lround(value * 255.f));
+		}
+
+		return field;
+	}
+}
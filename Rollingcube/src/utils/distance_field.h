@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+
+namespace distance_field
+{
+	/*
+		Builds a signed distance field from an 8 bit coverage bitmap (rows of pitch bytes). The result is
+		(width + 2 * spread) x (height + 2 * spread) bytes in the same row order, 128 on the outline, 255 at spread
+		pixels inside and 0 at spread pixels outside. Rows and columns are transformed on the ThreadPool when parallel
+		is set, do not set it from a pool task.
+	*/
+	std::vector<std::uint8_t> fromCoverage(const std::uint8_t* coverage, int width, int height, int pitch, int spread, bool parallel = true);
+}
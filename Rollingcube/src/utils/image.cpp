@@ -12,6 +12,8 @@
 #include "png_decoder.h"
 
 #include "core/time.h"
+#include "core/profiler.h"
+#include "core/thread_pool.h"
 
 
 namespace fs = std::filesystem;
@@ -31,6 +33,8 @@ void Image::clear()
 
 bool Image::load(std::string_view filename)
 {
+	PROFILE_SCOPE_CATEGORY("Image::load", ProfileCategory::Asset);
+
 	Path path = Path(filename);
 	auto ext = utils::lower(path.extension().string());
 
@@ -109,7 +113,6 @@ bool Image::loadFromPNG(std::string_view filename)
 	std::vector<std::uint8_t> png;
 
 	unsigned int width, height;
-	std::vector<std::uint8_t> data;
 	
 	lodepng::State state;
 	state.info_raw.colortype = LodePNGColorType::LCT_RGBA;
@@ -122,9 +125,10 @@ bool Image::loadFromPNG(std::string_view filename)
 		return false;
 	}
 
-	result = lodepng::decode(data, width, height, state, png);
+	result = lodepng::decode(_data, width, height, state, png);
 	if (result != 0)
 	{
+		_data.clear();
 		logger::error("Error during PNG image file read: {}.", lodepng_error_text(result));
 		return false;
 	}
@@ -132,7 +136,7 @@ bool Image::loadFromPNG(std::string_view filename)
 	_width = width;
 	_height = height;
 	_bit_depth = BitDepth::bd32;
-	invertRows(_data, data);
+	invertRowsInPlace();
 
 	return true;
 }
@@ -143,23 +147,49 @@ bool Image::loadFromPNG(std::string_view filename)
 
 void Image::invertRows()
 {
-	std::vector<std::uint8_t> temp;
-	
-	invertRows(temp, _data);
-
-	_data = std::move(temp);
+	invertRowsInPlace();
 	_invertedRows = !_invertedRows;
 }
 
-void Image::invertRows(std::vector<std::uint8_t>& dst, const std::vector<std::uint8_t>& src)
+void Image::invertRowsInPlace()
 {
+	if (_height < 2)
+		return;
+
 	const std::size_t rowsize = _width * pixelsize();
-	const std::size_t lastRowPos = std::size_t(_height - 1);
+	std::uint8_t* top = _data.data();
+	std::uint8_t* bottom = _data.data() + (std::size_t(_height - 1) * rowsize);
+
+	for (; top < bottom; top += rowsize, bottom -= rowsize)
+		std::swap_ranges(top, top + rowsize, bottom);
+}
 
-	dst.resize(src.size());
 
-	for (std::int64_t row = lastRowPos; row >= 0; --row)
-	{
-		std::memcpy(&dst[(lastRowPos - row) * rowsize], &src[row * rowsize], rowsize);
-	}
+
+
+
+std::future<Image> Image::loadAsync(std::string_view filename)
+{
+	return ThreadPool::instance().submit([filename = std::string(filename)]() {
+		Image img;
+		img.load(filename);
+		return img;
+	});
+}
+
+std::vector<Image> Image::loadMany(const std::vector<std::string>& filenames)
+{
+	std::vector<std::future<Image>> pending;
+	pending.reserve(filenames.size());
+
+	for (const auto& filename : filenames)
+		pending.push_back(loadAsync(filename));
+
+	std::vector<Image> images;
+	images.reserve(filenames.size());
+
+	for (auto& future : pending)
+		images.push_back(future.get());
+
+	return images;
 }
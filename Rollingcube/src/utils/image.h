@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <vector>
 #include <string>
+#include <future>
 
 
 enum class ImageBitDepth
@@ -46,6 +47,10 @@ public:
 	void invertRows();
 
 
+	static std::future<Image> loadAsync(std::string_view filename);
+	static std::vector<Image> loadMany(const std::vector<std::string>& filenames);
+
+
 	inline bool isValid() const { return _bit_depth == BitDepth::bd24 || _bit_depth == BitDepth::bd32; }
 
 	inline bool hasAlpha() const { return _bit_depth == BitDepth::bd32; }
@@ -64,5 +69,5 @@ public:
 
 
 private:
-	void invertRows(std::vector<std::uint8_t>& dst, const std::vector<std::uint8_t>& src);
+	void invertRowsInPlace();
 };
@@ -10,8 +10,12 @@ namespace lua::lib::names
 	constexpr const char entities[] = "entities";
 	constexpr const char themes[] = "themes";
 	constexpr const char blocks[] = "blocks";
+	constexpr const char blockUpdate[] = "blockupdate";
 	constexpr const char tiles[] = "tiles";
 	constexpr const char models[] = "models";
 	constexpr const char balls[] = "balls";
 	constexpr const char skyboxes[] = "skyboxes";
+	constexpr const char profiler[] = "profiler";
+	constexpr const char stats[] = "stats";
+	constexpr const char tasks[] = "tasks";
 }
@@ -0,0 +1,150 @@
+#include "mapped_file.h"
+
+#include <string>
+#include <memory>
+
+#ifdef _WIN32
+#	define WIN32_LEAN_AND_MEAN
+#	define NOMINMAX
+#	include <Windows.h>
+#else
+#	include <fcntl.h>
+#	include <unistd.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#endif
+
+#include "logger.h"
+
+
+MappedFile::MappedFile(MappedFile&& right) noexcept :
+	_data(right._data),
+	_size(right._size),
+#ifdef _WIN32
+	_file(right._file),
+	_mapping(right._mapping)
+#else
+	_fd(right._fd)
+#endif
+{
+	right._data = nullptr;
+	right._size = 0;
+#ifdef _WIN32
+	right._file = nullptr;
+	right._mapping = nullptr;
+#else
+	right._fd = -1;
+#endif
+}
+
+MappedFile& MappedFile::operator= (MappedFile&& right) noexcept
+{
+	if (this == std::addressof(right))
+		return *this;
+
+	std::destroy_at(this);
+	return *std::construct_at<MappedFile, MappedFile&&>(this, std::move(right));
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(std::string_view filename)
+{
+	close();
+
+	HANDLE file = CreateFileA(std::string(filename).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr)
+	{
+		CloseHandle(file);
+		logger::error("Cannot map file {} into memory.", filename);
+		return false;
+	}
+
+	const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		logger::error("Cannot map file {} into memory.", filename);
+		return false;
+	}
+
+	_file = file;
+	_mapping = mapping;
+	_data = static_cast<const std::uint8_t*>(view);
+	_size = std::size_t(size.QuadPart);
+
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (_data != nullptr)
+		UnmapViewOfFile(_data);
+	if (_mapping != nullptr)
+		CloseHandle(_mapping);
+	if (_file != nullptr)
+		CloseHandle(_file);
+
+	_data = nullptr;
+	_size = 0;
+	_file = nullptr;
+	_mapping = nullptr;
+}
+
+#else
+
+bool MappedFile::open(std::string_view filename)
+{
+	close();
+
+	int fd = ::open(std::string(filename).c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat info;
+	if (::fstat(fd, &info) != 0 || info.st_size <= 0)
+	{
+		::close(fd);
+		return false;
+	}
+
+	void* view = ::mmap(nullptr, std::size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	if (view == MAP_FAILED)
+	{
+		::close(fd);
+		logger::error("Cannot map file {} into memory.", filename);
+		return false;
+	}
+
+	_fd = fd;
+	_data = static_cast<const std::uint8_t*>(view);
+	_size = std::size_t(info.st_size);
+
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (_data != nullptr)
+		::munmap(const_cast<std::uint8_t*>(_data), _size);
+	if (_fd >= 0)
+		::close(_fd);
+
+	_data = nullptr;
+	_size = 0;
+	_fd = -1;
+}
+
+#endif
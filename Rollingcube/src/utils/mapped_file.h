@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+
+class MappedFile
+{
+private:
+	const std::uint8_t* _data = nullptr;
+	std::size_t _size = 0;
+
+#ifdef _WIN32
+	void* _file = nullptr;
+	void* _mapping = nullptr;
+#else
+	int _fd = -1;
+#endif
+
+public:
+	MappedFile() = default;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile(MappedFile&& right) noexcept;
+	inline ~MappedFile() { close(); }
+
+	MappedFile& operator= (const MappedFile&) = delete;
+	MappedFile& operator= (MappedFile&& right) noexcept;
+
+public:
+	bool open(std::string_view filename);
+	void close();
+
+	inline bool isOpen() const { return _data != nullptr; }
+
+	inline const std::uint8_t* data() const { return _data; }
+	inline std::size_t size() const { return _size; }
+
+	inline const std::uint8_t* begin() const { return _data; }
+	inline const std::uint8_t* end() const { return _data + _size; }
+};
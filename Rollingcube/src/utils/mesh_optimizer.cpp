@@ -0,0 +1,307 @@
+#include "mesh_optimizer.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+
+
+namespace mesh_optimizer
+{
+	std::size_t weldVertices(std::vector<std::uint8_t>& vertices, std::size_t stride, std::vector<index_type>& indices)
+	{
+		if (stride == 0)
+			return 0;
+
+		const std::size_t vertexCount = vertices.size() / stride;
+
+		std::vector<std::uint8_t> welded;
+		welded.reserve(vertices.size());
+
+		std::vector<index_type> remap(vertexCount);
+
+		// Keys point into the source buffer, which stays alive until the end of the loop //
+		std::unordered_map<std::string_view, index_type> unique;
+		unique.reserve(vertexCount);
+
+		for (std::size_t i = 0; i < vertexCount; ++i)
+		{
+			const auto* vertex = vertices.data() + (i * stride);
+			const auto key = std::string_view(reinterpret_cast<const char*>(vertex), stride);
+
+			auto [it, inserted] = unique.try_emplace(key, index_type(welded.size() / stride));
+			if (inserted)
+				welded.insert(welded.end(), vertex, vertex + stride);
+
+			remap[i] = it->second;
+		}
+
+		for (auto& index : indices)
+			index = remap[index];
+
+		const std::size_t weldedCount = welded.size() / stride;
+		vertices = std::move(welded);
+
+		return weldedCount;
+	}
+
+
+
+	namespace
+	{
+		static constexpr int CacheSize = 32;
+
+		static float vertexScore(int cachePosition, std::uint32_t remainingTriangles)
+		{
+			// Tom Forsyth's "Linear-Speed Vertex Cache Optimisation" scoring //
+			if (remainingTriangles == 0)
+				return -1.f;
+
+			float score = 0.f;
+			if (cachePosition >= 0)
+			{
+				if (cachePosition < 3)
+					score = 0.75f;
+				else
+					score = std::pow(1.f - (float(cachePosition - 3) / float(CacheSize - 3)), 1.5f);
+			}
+
+			return score + (2.f / std::sqrt(float(remainingTriangles)));
+		}
+	}
+
+	void optimizeVertexCache(std::vector<index_type>& indices, std::size_t vertexCount)
+	{
+		const std::size_t triangleCount = indices.size() / 3;
+		if (triangleCount == 0 || vertexCount == 0)
+			return;
+
+		std::vector<std::uint32_t> remaining(vertexCount, 0);
+		for (const auto index : indices)
+			++remaining[index];
+
+		std::vector<std::uint32_t> offsets(vertexCount + 1, 0);
+		for (std::size_t v = 0; v < vertexCount; ++v)
+			offsets[v + 1] = offsets[v] + remaining[v];
+
+		std::vector<std::uint32_t> adjacency(indices.size());
+		{
+			std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+			for (std::size_t t = 0; t < triangleCount; ++t)
+				for (std::size_t k = 0; k < 3; ++k)
+					adjacency[fill[indices[(t * 3) + k]]++] = std::uint32_t(t);
+		}
+
+		std::vector<int> cachePosition(vertexCount, -1);
+		std::vector<float> scores(vertexCount);
+		for (std::size_t v = 0; v < vertexCount; ++v)
+			scores[v] = vertexScore(-1, remaining[v]);
+
+		std::vector<bool> emitted(triangleCount, false);
+
+		std::vector<index_type> cache;
+		std::vector<index_type> nextCache;
+		cache.reserve(CacheSize + 3);
+		nextCache.reserve(CacheSize + 3);
+
+		std::vector<index_type> result;
+		result.reserve(indices.size());
+
+		std::size_t scanCursor = 0;
+		std::int64_t best = -1;
+
+		while (result.size() < indices.size())
+		{
+			if (best < 0)
+			{
+				while (emitted[scanCursor])
+					++scanCursor;
+				best = std::int64_t(scanCursor);
+			}
+
+			const std::size_t triangle = std::size_t(best);
+			emitted[triangle] = true;
+
+			nextCache.clear();
+			for (std::size_t k = 0; k < 3; ++k)
+			{
+				const index_type v = indices[(triangle * 3) + k];
+				result.push_back(v);
+				nextCache.push_back(v);
+
+				// Drop the emitted triangle from the live adjacency range of the vertex //
+				const std::uint32_t begin = offsets[v];
+				const std::uint32_t end = begin + remaining[v];
+				for (std::uint32_t i = begin; i < end; ++i)
+				{
+					if (adjacency[i] == triangle)
+					{
+						std::swap(adjacency[i], adjacency[end - 1]);
+						break;
+					}
+				}
+				--remaining[v];
+			}
+
+			for (const auto v : cache)
+				if (v != nextCache[0] && v != nextCache[1] && v != nextCache[2])
+					nextCache.push_back(v);
+
+			for (std::size_t i = 0; i < nextCache.size(); ++i)
+			{
+				const index_type v = nextCache[i];
+				cachePosition[v] = i < CacheSize ? int(i) : -1;
+				scores[v] = vertexScore(cachePosition[v], remaining[v]);
+			}
+
+			if (nextCache.size() > CacheSize)
+				nextCache.resize(CacheSize);
+			std::swap(cache, nextCache);
+
+			best = -1;
+			float bestScore = -std::numeric_limits<float>::max();
+			for (const auto v : cache)
+			{
+				const std::uint32_t begin = offsets[v];
+				const std::uint32_t end = begin + remaining[v];
+				for (std::uint32_t i = begin; i < end; ++i)
+				{
+					const std::uint32_t t = adjacency[i];
+					const float score = scores[indices[t * 3]] + scores[indices[(t * 3) + 1]] + scores[indices[(t * 3) + 2]];
+
+					if (score > bestScore)
+					{
+						bestScore = score;
+						best = std::int64_t(t);
+					}
+				}
+			}
+		}
+
+		indices = std::move(result);
+	}
+
+
+
+	void optimizeOverdraw(std::vector<index_type>& indices, const std::vector<glm::vec3>& positions)
+	{
+		static constexpr std::size_t FifoSize = 16;
+
+		const std::size_t triangleCount = indices.size() / 3;
+		if (triangleCount < 2 || positions.empty())
+			return;
+
+		// Split the cache optimised list into clusters at hard boundaries (triangles missing all three vertices) //
+		std::vector<std::size_t> clusters;
+		{
+			std::vector<std::size_t> timestamps(positions.size(), 0);
+			std::size_t time = FifoSize + 1;
+
+			for (std::size_t t = 0; t < triangleCount; ++t)
+			{
+				std::size_t misses = 0;
+				for (std::size_t k = 0; k < 3; ++k)
+				{
+					const index_type v = indices[(t * 3) + k];
+					if (time - timestamps[v] > FifoSize)
+					{
+						timestamps[v] = time++;
+						++misses;
+					}
+				}
+
+				if (t == 0 || misses == 3)
+					clusters.push_back(t);
+			}
+		}
+
+		if (clusters.size() < 2)
+			return;
+
+		glm::vec3 meshCenter = {};
+		for (const auto& position : positions)
+			meshCenter += position;
+		meshCenter /= float(positions.size());
+
+		// Clusters facing away from the mesh center are drawn first, so they occlude the inner ones //
+		std::vector<float> sortKeys(clusters.size());
+		for (std::size_t c = 0; c < clusters.size(); ++c)
+		{
+			const std::size_t begin = clusters[c];
+			const std::size_t end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+
+			glm::vec3 centroid = {};
+			glm::vec3 normal = {};
+			float area = 0.f;
+
+			for (std::size_t t = begin; t < end; ++t)
+			{
+				const glm::vec3& p0 = positions[indices[t * 3]];
+				const glm::vec3& p1 = positions[indices[(t * 3) + 1]];
+				const glm::vec3& p2 = positions[indices[(t * 3) + 2]];
+
+				const glm::vec3 cross = glm::cross(p1 - p0, p2 - p0);
+				const float triangleArea = glm::length(cross);
+
+				centroid += (p0 + p1 + p2) * (triangleArea / 3.f);
+				normal += cross;
+				area += triangleArea;
+			}
+
+			centroid = area > 0.f ? centroid / area : positions[indices[begin * 3]];
+			const float normalLength = glm::length(normal);
+			if (normalLength > 0.f)
+				normal /= normalLength;
+
+			sortKeys[c] = glm::dot(centroid - meshCenter, normal);
+		}
+
+		std::vector<std::size_t> order(clusters.size());
+		std::iota(order.begin(), order.end(), std::size_t(0));
+		std::stable_sort(order.begin(), order.end(), [&sortKeys](std::size_t a, std::size_t b) { return sortKeys[a] > sortKeys[b]; });
+
+		std::vector<index_type> result;
+		result.reserve(indices.size());
+		for (const auto c : order)
+		{
+			const std::size_t begin = clusters[c];
+			const std::size_t end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+			result.insert(result.end(), indices.begin() + (begin * 3), indices.begin() + (end * 3));
+		}
+
+		indices = std::move(result);
+	}
+
+
+
+	void optimizeVertexFetch(std::vector<std::uint8_t>& vertices, std::size_t stride, std::vector<index_type>& indices)
+	{
+		if (stride == 0)
+			return;
+
+		static constexpr index_type Unused = std::numeric_limits<index_type>::max();
+
+		const std::size_t vertexCount = vertices.size() / stride;
+		std::vector<index_type> remap(vertexCount, Unused);
+
+		std::vector<std::uint8_t> reordered;
+		reordered.resize(vertices.size());
+
+		index_type next = 0;
+		for (auto& index : indices)
+		{
+			if (remap[index] == Unused)
+			{
+				std::memcpy(reordered.data() + (std::size_t(next) * stride), vertices.data() + (std::size_t(index) * stride), stride);
+				remap[index] = next++;
+			}
+			index = remap[index];
+		}
+
+		reordered.resize(std::size_t(next) * stride);
+		vertices = std::move(reordered);
+	}
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "math/glm.h"
+
+
+namespace mesh_optimizer
+{
+	using index_type = std::uint32_t;
+
+	std::size_t weldVertices(std::vector<std::uint8_t>& vertices, std::size_t stride, std::vector<index_type>& indices);
+
+	void optimizeVertexCache(std::vector<index_type>& indices, std::size_t vertexCount);
+
+	void optimizeOverdraw(std::vector<index_type>& indices, const std::vector<glm::vec3>& positions);
+
+	void optimizeVertexFetch(std::vector<std::uint8_t>& vertices, std::size_t stride, std::vector<index_type>& indices);
+}
@@ -89,4 +89,6 @@ namespace resources
 	inline const Directory models = { data, "models" };
 
 	inline const Directory user = { "user" };
+	inline const Directory cache = { user, "cache" };
+	inline const Directory traces = { user, "traces" };
 }
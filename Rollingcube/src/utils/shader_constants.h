@@ -121,6 +121,7 @@ namespace constants
 		inline constexpr const ShaderName freetype_font = { 1, "freetype_font" };
 		inline constexpr const ShaderName sky = { 2, "sky" };
 		inline constexpr const ShaderName lines = { 3, "lines" };
+		inline constexpr const ShaderName freetype_font_sdf = { 4, "freetype_font_sdf" };
 
 		namespace internals
 		{
@@ -137,7 +138,8 @@ namespace constants
 				{ lightning.name, "internal/lightning.vert", "internal/lightning.frag" },
 				{ freetype_font.name, "internal/freetype_font.vert", "internal/freetype_font.frag" },
 				{ sky.name, "internal/sky.vert", "internal/sky.frag" },
-				{ lines.name, "internal/lines.vert", "internal/lines.frag" }
+				{ lines.name, "internal/lines.vert", "internal/lines.frag" },
+				{ freetype_font_sdf.name, "internal/freetype_font.vert", "internal/freetype_font_sdf.frag" }
 			};
 			inline constexpr const std::size_t count = sizeof(internals::shaders) / sizeof(ShaderFiles);
 
@@ -0,0 +1,114 @@
+#include "shelf_packer.h"
+
+#include <limits>
+#include <algorithm>
+
+
+std::optional<ShelfPacker::Rect> ShelfPacker::allocate(int width, int height)
+{
+	if (width <= 0 || height <= 0 || width > _width || height > _height)
+		return std::nullopt;
+
+	// Pick the shelf wasting the least height. Non empty shelves only take items of a similar height //
+	Shelf* best = nullptr;
+	std::size_t bestSlot = std::numeric_limits<std::size_t>::max();
+	int bestWaste = std::numeric_limits<int>::max();
+
+	for (auto& shelf : _shelves)
+	{
+		const int waste = shelf.height - height;
+		if (waste < 0 || waste >= bestWaste || (shelf.allocated > 0 && shelf.height > height + (height / 2)))
+			continue;
+
+		std::size_t slot = std::numeric_limits<std::size_t>::max();
+		for (std::size_t i = 0; i < shelf.freeSlots.size(); ++i)
+		{
+			if (shelf.freeSlots[i].width >= width)
+			{
+				slot = i;
+				break;
+			}
+		}
+
+		if (slot == std::numeric_limits<std::size_t>::max() && shelf.cursor + width > _width)
+			continue;
+
+		best = &shelf;
+		bestSlot = slot;
+		bestWaste = waste;
+	}
+
+	if (!best)
+	{
+		if (_nextShelfY + height > _height)
+			return std::nullopt;
+
+		best = &_shelves.emplace_back(Shelf{ _nextShelfY, height, 0, 0, {} });
+		_nextShelfY += height;
+	}
+
+	Rect rect = { 0, best->y, width, height };
+	if (bestSlot != std::numeric_limits<std::size_t>::max())
+	{
+		Slot& slot = best->freeSlots[bestSlot];
+		rect.x = slot.x;
+		slot.x += width;
+		slot.width -= width;
+		if (slot.width == 0)
+			best->freeSlots.erase(best->freeSlots.begin() + bestSlot);
+	}
+	else
+	{
+		rect.x = best->cursor;
+		best->cursor += width;
+	}
+
+	++best->allocated;
+	return rect;
+}
+
+void ShelfPacker::release(const Rect& rect)
+{
+	auto it = std::lower_bound(_shelves.begin(), _shelves.end(), rect.y, [](const Shelf& shelf, int y) { return shelf.y < y; });
+	if (it == _shelves.end() || it->y != rect.y)
+		return;
+
+	Shelf& shelf = *it;
+	if (--shelf.allocated > 0)
+	{
+		// Slots are kept sorted by x and merged with their neighbours, so churn does not cut the shelf in slivers //
+		auto& slots = shelf.freeSlots;
+		auto next = std::lower_bound(slots.begin(), slots.end(), rect.x, [](const Slot& slot, int x) { return slot.x < x; });
+		next = slots.insert(next, { rect.x, rect.width });
+
+		if (next + 1 != slots.end() && next->x + next->width == (next + 1)->x)
+		{
+			next->width += (next + 1)->width;
+			slots.erase(next + 1);
+		}
+
+		if (next != slots.begin() && (next - 1)->x + (next - 1)->width == next->x)
+		{
+			(next - 1)->width += next->width;
+			slots.erase(next);
+		}
+
+		// A free slot touching the cursor goes back to the unused tail //
+		if (!slots.empty() && slots.back().x + slots.back().width == shelf.cursor)
+		{
+			shelf.cursor = slots.back().x;
+			slots.pop_back();
+		}
+		return;
+	}
+
+	shelf.cursor = 0;
+	shelf.freeSlots.clear();
+
+	// Give trailing empty shelves back so they can be reopened with any height //
+	while (!_shelves.empty() && _shelves.back().allocated == 0)
+	{
+		_nextShelfY = _shelves.back().y;
+		_shelves.pop_back();
+	}
+}
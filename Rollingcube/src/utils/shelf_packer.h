@@ -0,0 +1,72 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+
+
+class ShelfPacker
+{
+public:
+	struct Rect
+	{
+		int x = 0;
+		int y = 0;
+		int width = 0;
+		int height = 0;
+	};
+
+private:
+	struct Slot
+	{
+		int x;
+		int width;
+	};
+
+	struct Shelf
+	{
+		int y;
+		int height;
+		int cursor;
+		int allocated;
+		std::vector<Slot> freeSlots;
+	};
+
+private:
+	int _width = 0;
+	int _height = 0;
+	int _nextShelfY = 0;
+	std::vector<Shelf> _shelves;
+
+public:
+	ShelfPacker() = default;
+	ShelfPacker(const ShelfPacker&) = default;
+	ShelfPacker(ShelfPacker&&) noexcept = default;
+	~ShelfPacker() = default;
+
+	ShelfPacker& operator= (const ShelfPacker&) = default;
+	ShelfPacker& operator= (ShelfPacker&&) noexcept = default;
+
+	inline ShelfPacker(int width, int height) : _width(width), _height(height) {}
+
+public:
+	inline int getWidth() const { return _width; }
+	inline int getHeight() const { return _height; }
+	inline bool empty() const { return _shelves.empty(); }
+
+	inline void reset(int width, int height)
+	{
+		_width = width;
+		_height = height;
+		clear();
+	}
+
+	inline void clear()
+	{
+		_nextShelfY = 0;
+		_shelves.clear();
+	}
+
+	std::optional<Rect> allocate(int width, int height);
+
+	void release(const Rect& rect);
+};
@@ -4,6 +4,8 @@
 #include <string>
 #include <format>
 #include <vector>
+#include <span>
+#include <iterator>
 
 
 namespace utils::str
@@ -14,6 +16,36 @@ namespace utils::str
 		return std::vformat(fmt, std::make_format_args(std::forward<_ArgsTys>(args)...));
 	}
 
+	struct truncating_output_iterator
+	{
+		using iterator_category = std::output_iterator_tag;
+		using value_type = void;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = void;
+
+		char* current;
+		char* end;
+
+		constexpr truncating_output_iterator& operator* () { return *this; }
+		constexpr truncating_output_iterator& operator++ () { return *this; }
+		constexpr truncating_output_iterator& operator++ (int) { return *this; }
+		constexpr truncating_output_iterator& operator= (char c)
+		{
+			if (current != end)
+				*current++ = c;
+			return *this;
+		}
+	};
+
+	// Formats into a caller owned buffer without allocating, output exceeding the buffer is truncated //
+	template <typename... _ArgsTys>
+	inline std::string_view format_to(std::span<char> buffer, std::string_view fmt, _ArgsTys&&... args)
+	{
+		const auto out = std::vformat_to(truncating_output_iterator{ buffer.data(), buffer.data() + buffer.size() }, fmt, std::make_format_args(args...));
+		return std::string_view(buffer.data(), std::size_t(out.current - buffer.data()));
+	}
+
 	inline std::vector<std::string> split(std::string str, char separator)
 	{
         std::vector<std::string> res;
@@ -1,5 +1,10 @@
 #include "tangent_space.h"
 
+#include <algorithm>
+
+#include "core/thread_pool.h"
+
+
 namespace tangents
 {
 	void computeTangentBasis(
@@ -9,7 +14,10 @@ namespace tangents
 		std::vector<glm::vec3>& tangents,
 		std::vector<glm::vec3>& bitangents
 	) {
-		for (unsigned int i = 0; i < vertices.size(); i += 3)
+		tangents.resize(vertices.size());
+		bitangents.resize(vertices.size());
+
+		for (unsigned int i = 0; i + 2 < vertices.size(); i += 3)
 		{
 			// Shortcuts for vertices
 			const glm::vec3& v0 = vertices[i + 0];
@@ -34,16 +42,14 @@ namespace tangents
 			glm::vec3 bitangent = (deltaPos2 * deltaUV1.x - deltaPos1 * deltaUV2.x) * r;
 
 			// Set the same tangent for all three vertices of the triangle.
-			// They will be merged later, in vboindexer.cpp
-			tangents.push_back(tangent);
-			tangents.push_back(tangent);
-			tangents.push_back(tangent);
+			tangents[i + 0] = tangent;
+			tangents[i + 1] = tangent;
+			tangents[i + 2] = tangent;
 
 			// Same thing for binormals
-			bitangents.push_back(bitangent);
-			bitangents.push_back(bitangent);
-			bitangents.push_back(bitangent);
-
+			bitangents[i + 0] = bitangent;
+			bitangents[i + 1] = bitangent;
+			bitangents[i + 2] = bitangent;
 		}
 
 		// See "Going Further"
@@ -61,4 +67,149 @@ namespace tangents
 				t = t * -1.0f;
 		}
 	}
+
+
+
+	namespace
+	{
+		static constexpr std::size_t BatchSize = 8;
+		static constexpr std::size_t MinParallelTriangles = 16 * 1024;
+		static constexpr std::size_t MinParallelVertices = 32 * 1024;
+
+		struct TriangleBasis
+		{
+			glm::vec3 tangent;
+			glm::vec3 bitangent;
+		};
+
+		// Triangles are gathered in SoA lanes of BatchSize so the arithmetic part vectorizes //
+		static void computeTriangleBases(
+			std::size_t first,
+			std::size_t last,
+			const glm::vec3* vertices,
+			const glm::vec2* uvs,
+			const std::uint32_t* indices,
+			TriangleBasis* bases
+		) {
+			for (std::size_t base = first; base < last; base += BatchSize)
+			{
+				const std::size_t lanes = std::min(BatchSize, last - base);
+
+				alignas(32) float e1x[BatchSize] = {}, e1y[BatchSize] = {}, e1z[BatchSize] = {};
+				alignas(32) float e2x[BatchSize] = {}, e2y[BatchSize] = {}, e2z[BatchSize] = {};
+				alignas(32) float du1[BatchSize] = {}, dv1[BatchSize] = {}, du2[BatchSize] = {}, dv2[BatchSize] = {};
+
+				for (std::size_t lane = 0; lane < lanes; ++lane)
+				{
+					const std::uint32_t* triangle = indices + ((base + lane) * 3);
+					const glm::vec3& p0 = vertices[triangle[0]];
+					const glm::vec3& p1 = vertices[triangle[1]];
+					const glm::vec3& p2 = vertices[triangle[2]];
+					const glm::vec2& uv0 = uvs[triangle[0]];
+					const glm::vec2& uv1 = uvs[triangle[1]];
+					const glm::vec2& uv2 = uvs[triangle[2]];
+
+					e1x[lane] = p1.x - p0.x; e1y[lane] = p1.y - p0.y; e1z[lane] = p1.z - p0.z;
+					e2x[lane] = p2.x - p0.x; e2y[lane] = p2.y - p0.y; e2z[lane] = p2.z - p0.z;
+					du1[lane] = uv1.x - uv0.x; dv1[lane] = uv1.y - uv0.y;
+					du2[lane] = uv2.x - uv0.x; dv2[lane] = uv2.y - uv0.y;
+				}
+
+				alignas(32) float tx[BatchSize], ty[BatchSize], tz[BatchSize];
+				alignas(32) float bx[BatchSize], by[BatchSize], bz[BatchSize];
+
+				for (std::size_t lane = 0; lane < BatchSize; ++lane)
+				{
+					// Degenerate UV mappings contribute nothing instead of spreading NaNs on the shared vertices //
+					const float det = du1[lane] * dv2[lane] - dv1[lane] * du2[lane];
+					const float r = det != 0.f ? 1.f / det : 0.f;
+
+					tx[lane] = (e1x[lane] * dv2[lane] - e2x[lane] * dv1[lane]) * r;
+					ty[lane] = (e1y[lane] * dv2[lane] - e2y[lane] * dv1[lane]) * r;
+					tz[lane] = (e1z[lane] * dv2[lane] - e2z[lane] * dv1[lane]) * r;
+
+					bx[lane] = (e2x[lane] * du1[lane] - e1x[lane] * du2[lane]) * r;
+					by[lane] = (e2y[lane] * du1[lane] - e1y[lane] * du2[lane]) * r;
+					bz[lane] = (e2z[lane] * du1[lane] - e1z[lane] * du2[lane]) * r;
+				}
+
+				for (std::size_t lane = 0; lane < lanes; ++lane)
+					bases[base + lane] = { { tx[lane], ty[lane], tz[lane] }, { bx[lane], by[lane], bz[lane] } };
+			}
+		}
+
+		static void orthogonalize(
+			std::size_t first,
+			std::size_t last,
+			const glm::vec3* normals,
+			const TriangleBasis* accumulated,
+			glm::vec4* tangents
+		) {
+			static constexpr float MinNormalLength = 1e-6f;
+			static constexpr float MinTangentRatio = 1e-4f;
+
+			for (std::size_t i = first; i < last; ++i)
+			{
+				const glm::vec3& tangent = accumulated[i].tangent;
+				const glm::vec3& b = accumulated[i].bitangent;
+
+				// Zero normals come from degenerate faces, any unit tangent is as good as another there //
+				const float normalLength = glm::length(normals[i]);
+				if (!(normalLength > MinNormalLength))
+				{
+					tangents[i] = glm::vec4(1.f, 0.f, 0.f, 1.f);
+					continue;
+				}
+
+				const glm::vec3 n = normals[i] / normalLength;
+
+				// Gram-Schmidt orthogonalize, with any perpendicular axis for vertices without UV gradient or with a
+				// tangent (almost) parallel to the normal //
+				glm::vec3 t = tangent - n * glm::dot(n, tangent);
+				const float length = glm::length(t);
+				if (length > MinTangentRatio * glm::length(tangent))
+					t /= length;
+				else
+					t = glm::normalize(glm::cross(n, std::abs(n.x) < 0.9f ? glm::vec3(1, 0, 0) : glm::vec3(0, 1, 0)));
+
+				tangents[i] = glm::vec4(t, glm::dot(glm::cross(n, t), b) < 0.f ? -1.f : 1.f);
+			}
+		}
+	}
+
+	void computeTangentBasis(
+		const std::vector<glm::vec3>& vertices,
+		const std::vector<glm::vec2>& uvs,
+		const std::vector<glm::vec3>& normals,
+		const std::vector<std::uint32_t>& indices,
+		std::vector<glm::vec4>& tangents
+	) {
+		const std::size_t vertexCount = vertices.size();
+		const std::size_t triangleCount = indices.size() / 3;
+		ThreadPool& pool = ThreadPool::instance();
+
+		std::vector<TriangleBasis> bases;
+		bases.resize(triangleCount);
+		pool.parallelFor(triangleCount, MinParallelTriangles, [&](std::size_t first, std::size_t last) {
+			computeTriangleBases(first, last, vertices.data(), uvs.data(), indices.data(), bases.data());
+		});
+
+		// The scatter is cheap compared to the rest and stays serial to avoid write conflicts on shared vertices //
+		std::vector<TriangleBasis> accumulated;
+		accumulated.resize(vertexCount, { glm::vec3(0.f), glm::vec3(0.f) });
+		for (std::size_t t = 0; t < triangleCount; ++t)
+		{
+			for (std::size_t k = 0; k < 3; ++k)
+			{
+				TriangleBasis& vertex = accumulated[indices[(t * 3) + k]];
+				vertex.tangent += bases[t].tangent;
+				vertex.bitangent += bases[t].bitangent;
+			}
+		}
+
+		tangents.resize(vertexCount);
+		pool.parallelFor(vertexCount, MinParallelVertices, [&](std::size_t first, std::size_t last) {
+			orthogonalize(first, last, normals.data(), accumulated.data(), tangents.data());
+		});
+	}
 }
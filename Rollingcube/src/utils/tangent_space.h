@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 
 #include "math/glm.h"
@@ -14,4 +15,16 @@ namespace tangents
 		std::vector<glm::vec3>& tangents,
 		std::vector<glm::vec3>& bitangents
 	);
+
+	/*
+		Indexed version: triangle tangents are accumulated on the shared vertices, then orthogonalized against the
+		vertex normal. Each output is (tangent, handedness), the bitangent being cross(normal, tangent) * handedness.
+	*/
+	void computeTangentBasis(
+		const std::vector<glm::vec3>& vertices,
+		const std::vector<glm::vec2>& uvs,
+		const std::vector<glm::vec3>& normals,
+		const std::vector<std::uint32_t>& indices,
+		std::vector<glm::vec4>& tangents
+	);
 }